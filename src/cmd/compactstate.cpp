@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <chrono>
+#include <iostream>
+
+#include "depends/libDatabase/OverlayDB.h"
+#include "libData/AccountData/AccountStore.h"
+#include "libPersistence/BlockStorage.h"
+#include "libPersistence/ContractStorage.h"
+
+using namespace std;
+using namespace dev;
+
+// Deletes the state nodes the latest state root no longer reaches and starts
+// counting references, so that a node can then prune as it goes. Run it with
+// the node stopped, from the directory holding its persistence.
+int main(int argc, const char* argv[]) {
+  if (argc != 1) {
+    cout << "[USAGE] " << argv[0] << endl;
+    return -1;
+  }
+
+  vector<unsigned char> rootBytes;
+  if (!BlockStorage::GetBlockStorage().GetMetadata(STATEROOT, rootBytes) ||
+      rootBytes.size() != h256::size) {
+    cerr << "No state root in persistence" << endl;
+    return -1;
+  }
+  h256 root(rootBytes);
+
+  auto start = chrono::steady_clock::now();
+
+  OverlayDB stateDB("state");
+  OverlayDB& contractStateDB =
+      ContractStorage::GetContractStorage().GetStateDB();
+  stateDB.setValueRefs(&contractStateDB, AccountStore::GetStorageRootRefs);
+
+  // The accounts are walked first to count the storage roots they hold
+  unordered_map<h256, unsigned> storageRootRefs;
+  unordered_map<h256, unsigned> unused;
+  uint64_t freed = stateDB.compact({root}, {}, storageRootRefs);
+  freed += contractStateDB.compact({}, storageRootRefs, unused);
+
+  cout << "Freed " << freed << " bytes in "
+       << chrono::duration_cast<chrono::seconds>(chrono::steady_clock::now() -
+                                                 start)
+              .count()
+       << " s" << endl;
+
+  return 0;
+}
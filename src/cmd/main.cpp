@@ -25,6 +25,7 @@
 #include <iostream>
 #include "libUtils/Logger.h"
 
+#include "common/Constants.h"
 #include "depends/NAT/nat.h"
 #include "libNetwork/P2PComm.h"
 #include "libNetwork/PeerStore.h"
@@ -40,7 +41,11 @@ int main(int argc, const char* argv[]) {
   struct in_addr ip_addr;
   Peer my_network_info;
 
-  INIT_FILE_LOGGER("zilliqa");
+  if (BINARY_LOG) {
+    INIT_BINARY_FILE_LOGGER("zilliqa");
+  } else {
+    INIT_FILE_LOGGER("zilliqa");
+  }
   INIT_STATE_LOGGER("state");
   INIT_EPOCHINFO_LOGGER("epochinfo");
 
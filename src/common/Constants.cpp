@@ -117,6 +117,8 @@ const unsigned int DS_POW_DIFFICULTY{
 const unsigned int POW_DIFFICULTY{ReadFromConstantsFile("POW_DIFFICULTY")};
 const unsigned int POW_SUBMISSION_LIMIT{
     ReadFromConstantsFile("POW_SUBMISSION_LIMIT")};
+const unsigned int CPU_MINING_THREADS{
+    ReadFromConstantsFile("CPU_MINING_THREADS")};
 const unsigned int MICROBLOCK_TIMEOUT{
     ReadFromConstantsFile("MICROBLOCK_TIMEOUT")};
 const unsigned int VIEWCHANGE_TIME{ReadFromConstantsFile("VIEWCHANGE_TIME")};
@@ -156,6 +158,10 @@ const unsigned int MAX_INDEXES_PER_TXN{
     ReadFromConstantsFile("MAX_INDEXES_PER_TXN")};
 const unsigned int SENDQUEUE_SIZE{ReadFromConstantsFile("SENDQUEUE_SIZE")};
 const unsigned int MSGQUEUE_SIZE{ReadFromConstantsFile("MSGQUEUE_SIZE")};
+const unsigned int EXECUTOR_MAX_THREADS{
+    ReadFromConstantsFile("EXECUTOR_MAX_THREADS")};
+const unsigned int EXECUTOR_STATS_INTERVAL{
+    ReadFromConstantsFile("EXECUTOR_STATS_INTERVAL")};
 const unsigned int POW_CHANGE_PERCENT_TO_ADJ_DIFF{
     ReadFromConstantsFile("POW_CHANGE_PERCENT_TO_ADJ_DIFF")};
 const unsigned int FALLBACK_INTERVAL_STARTED{
@@ -213,6 +219,16 @@ const unsigned int LOOKUP_REWARD_IN_PERCENT{
 const unsigned int PUMPMESSAGE_MILLISECONDS{
     ReadFromConstantsFile("PUMPMESSAGE_MILLISECONDS")};
 const unsigned int MAXRETRYCONN{ReadFromConstantsFile("MAXRETRYCONN")};
+const unsigned int CONNECTION_IDLE_TIMEOUT_IN_SECONDS{
+    ReadFromConstantsFile("CONNECTION_IDLE_TIMEOUT_IN_SECONDS")};
+const unsigned int SEND_TIMEOUT_IN_SECONDS{
+    ReadFromConstantsFile("SEND_TIMEOUT_IN_SECONDS")};
+const unsigned int SEND_RETRY_BACKOFF_IN_MS{
+    ReadFromConstantsFile("SEND_RETRY_BACKOFF_IN_MS")};
+const unsigned int SEND_INFLIGHT_LIMIT{
+    ReadFromConstantsFile("SEND_INFLIGHT_LIMIT")};
+const unsigned int MAX_MESSAGE_SIZE_IN_BYTES{
+    ReadFromConstantsFile("MAX_MESSAGE_SIZE_IN_BYTES")};
 const unsigned int SIMULATED_NETWORK_DELAY_IN_MS{
     ReadFromConstantsFile("SIMULATED_NETWORK_DELAY_IN_MS")};
 const unsigned int POW_PACKET_SENDERS{
@@ -225,6 +241,18 @@ const unsigned int DELAY_FIRSTXNEPOCH_IN_MS{
     ReadFromConstantsFile("DELAY_FIRSTXNEPOCH_IN_MS")};
 const unsigned int TXN_MISORDER_TOLERANCE_IN_PERCENT{
     ReadFromConstantsFile("TXN_MISORDER_TOLERANCE_IN_PERCENT")};
+const unsigned int TXN_POOL_CAPACITY{
+    ReadFromConstantsFile("TXN_POOL_CAPACITY")};
+const unsigned int VERIFIED_TXN_CACHE_SIZE{
+    ReadFromConstantsFile("VERIFIED_TXN_CACHE_SIZE")};
+const unsigned int LEVELDB_BLOCK_CACHE_SIZE_IN_MB{
+    ReadFromConstantsFile("LEVELDB_BLOCK_CACHE_SIZE_IN_MB")};
+const unsigned int LEVELDB_WRITE_BUFFER_SIZE_IN_MB{
+    ReadFromConstantsFile("LEVELDB_WRITE_BUFFER_SIZE_IN_MB")};
+const unsigned int LEVELDB_BLOOM_FILTER_BITS_PER_KEY{
+    ReadFromConstantsFile("LEVELDB_BLOOM_FILTER_BITS_PER_KEY")};
+const unsigned int STATE_PRUNING_WINDOW{
+    ReadFromConstantsFile("STATE_PRUNING_WINDOW")};
 
 #ifdef FALLBACK_TEST
 const unsigned int FALLBACK_TEST_EPOCH{
@@ -235,6 +263,7 @@ const unsigned int FALLBACK_TEST_EPOCH{
 const bool EXCLUDE_PRIV_IP{ReadFromOptionsFile("EXCLUDE_PRIV_IP") == "true"};
 const bool GUARD_MODE{ReadFromOptionsFile("GUARD_MODE") == "true"};
 const bool ENABLE_DO_REJOIN{ReadFromOptionsFile("ENABLE_DO_REJOIN") == "true"};
+const bool BINARY_LOG{ReadFromOptionsFile("BINARY_LOG") == "true"};
 const bool FULL_DATASET_MINE{ReadFromOptionsFile("FULL_DATASET_MINE") ==
                              "true"};
 const bool OPENCL_GPU_MINE{ReadFromOptionsFile("OPENCL_GPU_MINE") == "true"};
@@ -254,6 +283,8 @@ const std::string UPGRADE_HOST_REPO{ReadFromOptionsFile("UPGRADE_HOST_REPO")};
 const bool ARCHIVAL_NODE{ReadFromOptionsFile("ARCHIVAL_NODE") == "true"};
 const bool SEND_RESPONSE_FOR_LAZY_PUSH{
     ReadFromOptionsFile("SEND_RESPONSE_FOR_LAZY_PUSH") == "true"};
+const bool LEVELDB_USE_COMPRESSION{
+    ReadFromOptionsFile("LEVELDB_USE_COMPRESSION") == "true"};
 
 // gas
 const unsigned int MICROBLOCK_GAS_LIMIT{
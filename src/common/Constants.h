@@ -50,6 +50,8 @@ const unsigned int CHALLENGE_SIZE = 32;
 const unsigned int RESPONSE_SIZE = 32;
 
 const unsigned int BLOCKCHAIN_SIZE = 50;
+// Number of blocks older than BLOCKCHAIN_SIZE kept in memory after a read
+const unsigned int BLOCKCHAIN_CACHE_SIZE = 100;
 
 // Number of nodes sent from lookup node to newly joined node
 const unsigned int SEED_PEER_LIST_SIZE = 20;
@@ -77,6 +79,8 @@ enum MetaType : unsigned char {
   DSINCOMPLETED,
   LATESTACTIVEDSBLOCKNUM,
   WAKEUPFORUPGRADE,
+  LATESTTXBLOCKNUM,
+  MICROBLOCKINDEXED,
 };
 
 // Sync Type
@@ -129,6 +133,7 @@ extern const unsigned int POW_SUBMISSION_TIMEOUT;
 extern const unsigned int DS_POW_DIFFICULTY;
 extern const unsigned int POW_DIFFICULTY;
 extern const unsigned int POW_SUBMISSION_LIMIT;
+extern const unsigned int CPU_MINING_THREADS;
 extern const unsigned int MICROBLOCK_TIMEOUT;
 extern const unsigned int VIEWCHANGE_TIME;
 extern const unsigned int VIEWCHANGE_PRECHECK_TIME;
@@ -152,6 +157,8 @@ extern const unsigned int NUM_NODES_TO_SEND_LOOKUP;
 extern const unsigned int MAX_INDEXES_PER_TXN;
 extern const unsigned int SENDQUEUE_SIZE;
 extern const unsigned int MSGQUEUE_SIZE;
+extern const unsigned int EXECUTOR_MAX_THREADS;
+extern const unsigned int EXECUTOR_STATS_INTERVAL;
 extern const unsigned int POW_CHANGE_PERCENT_TO_ADJ_DIFF;
 extern const unsigned int FALLBACK_INTERVAL_STARTED;
 extern const unsigned int FALLBACK_INTERVAL_WAITING;
@@ -183,12 +190,23 @@ extern const unsigned int MAX_CODE_SIZE_IN_BYTES;
 extern const unsigned int LOOKUP_REWARD_IN_PERCENT;
 extern const unsigned int PUMPMESSAGE_MILLISECONDS;
 extern const unsigned int MAXRETRYCONN;
+extern const unsigned int CONNECTION_IDLE_TIMEOUT_IN_SECONDS;
+extern const unsigned int SEND_TIMEOUT_IN_SECONDS;
+extern const unsigned int SEND_RETRY_BACKOFF_IN_MS;
+extern const unsigned int SEND_INFLIGHT_LIMIT;
+extern const unsigned int MAX_MESSAGE_SIZE_IN_BYTES;
 extern const unsigned int SIMULATED_NETWORK_DELAY_IN_MS;
 extern const unsigned int POW_PACKET_SENDERS;
 extern const unsigned int POWPACKETSUBMISSION_WINDOW_IN_SECONDS;
 extern const unsigned int LOOKUP_DELAY_SEND_TXNPACKET_IN_MS;
 extern const unsigned int DELAY_FIRSTXNEPOCH_IN_MS;
 extern const unsigned int TXN_MISORDER_TOLERANCE_IN_PERCENT;
+extern const unsigned int TXN_POOL_CAPACITY;
+extern const unsigned int VERIFIED_TXN_CACHE_SIZE;
+extern const unsigned int LEVELDB_BLOCK_CACHE_SIZE_IN_MB;
+extern const unsigned int LEVELDB_WRITE_BUFFER_SIZE_IN_MB;
+extern const unsigned int LEVELDB_BLOOM_FILTER_BITS_PER_KEY;
+extern const unsigned int STATE_PRUNING_WINDOW;
 
 // gas
 extern const unsigned int MICROBLOCK_GAS_LIMIT;
@@ -214,6 +232,7 @@ extern const unsigned int FALLBACK_TEST_EPOCH;
 extern const bool GUARD_MODE;
 extern const bool EXCLUDE_PRIV_IP;
 extern const bool ENABLE_DO_REJOIN;
+extern const bool BINARY_LOG;
 extern const bool FULL_DATASET_MINE;
 extern const bool OPENCL_GPU_MINE;
 extern const bool CUDA_GPU_MINE;
@@ -227,6 +246,7 @@ extern const bool GET_INITIAL_DS_FROM_REPO;
 extern const std::string UPGRADE_HOST_ACCOUNT;
 extern const std::string UPGRADE_HOST_REPO;
 extern const bool SEND_RESPONSE_FOR_LAZY_PUSH;
+extern const bool LEVELDB_USE_COMPRESSION;
 
 extern const std::vector<std::string> GENESIS_WALLETS;
 extern const std::vector<std::string> GENESIS_KEYS;
@@ -14,9 +14,13 @@
 * and which include a reference to GPLv3 in their program files.
 **/
 
+#include <map>
 #include <string>
 
 #include <boost/filesystem.hpp>
+#include <leveldb/cache.h>
+#include <leveldb/filter_policy.h>
+#include <leveldb/write_batch.h>
 
 #include "LevelDB.h"
 #include "common/Constants.h"
@@ -26,34 +30,80 @@
 
 using namespace std;
 
-LevelDB::LevelDB(const string & dbName, const string & subdirectory)
+LevelDB::LevelDB(const string & dbName, const string & subdirectory, Profile profile,
+                 bool keyedByBlockNum)
 {
     this->m_subdirectory = subdirectory;
     this->m_dbName = dbName;
+    this->m_profile = profile;
     
     if (!(boost::filesystem::exists("./" + PERSISTENCE_PATH)))
     {
         boost::filesystem::create_directories("./" + PERSISTENCE_PATH);
     }
 
+    if(!m_subdirectory.empty() &&
+       !(boost::filesystem::exists("./" + PERSISTENCE_PATH + "/" + this->m_subdirectory)))
+    {
+        boost::filesystem::create_directories("./" + PERSISTENCE_PATH + "/" + this->m_subdirectory);
+    }
+
+    Open();
+
+    // Only block number keyed databases can hold decimal keys, and in any
+    // other the scan would walk every key starting with a digit
+    m_hasLegacyKeys = keyedByBlockNum && FindLegacyKeys();
+}
+
+leveldb::Options LevelDB::GetOptions(Profile profile)
+{
+    // Shared by all the databases so that the memory used for caching stays
+    // bounded however many are open. Never freed, as databases may still be
+    // closing while static objects are destroyed.
+    static leveldb::Cache* blockCache
+        = leveldb::NewLRUCache((size_t)LEVELDB_BLOCK_CACHE_SIZE_IN_MB << 20);
+    static const leveldb::FilterPolicy* bloomFilter
+        = LEVELDB_BLOOM_FILTER_BITS_PER_KEY > 0
+              ? leveldb::NewBloomFilterPolicy(LEVELDB_BLOOM_FILTER_BITS_PER_KEY)
+              : nullptr;
+
     leveldb::Options options;
     options.max_open_files = 256;
     options.create_if_missing = true;
+    options.block_cache = blockCache;
+    options.compression = LEVELDB_USE_COMPRESSION ? leveldb::kSnappyCompression
+                                                  : leveldb::kNoCompression;
+
+    switch (profile)
+    {
+        case SMALL:
+            break;
+        case BLOCKS:
+            options.write_buffer_size = (size_t)LEVELDB_WRITE_BUFFER_SIZE_IN_MB << 20;
+            break;
+        case HASH_KEYED:
+            options.write_buffer_size = (size_t)LEVELDB_WRITE_BUFFER_SIZE_IN_MB << 20;
+            options.filter_policy = bloomFilter;
+            options.compression = leveldb::kNoCompression;
+            break;
+    }
 
-    leveldb::DB* db;
+    return options;
+}
+
+void LevelDB::Open()
+{
+    leveldb::DB* db = nullptr;
     leveldb::Status status;
 
     if(m_subdirectory.empty())
     {
-        status = leveldb::DB::Open(options, "./" + PERSISTENCE_PATH + "/" + this->m_dbName, &db);
+        status = leveldb::DB::Open(GetOptions(m_profile),
+                                   "./" + PERSISTENCE_PATH + "/" + this->m_dbName, &db);
     }
     else
     {
-        if (!(boost::filesystem::exists("./" + PERSISTENCE_PATH + "/" + this->m_subdirectory)))
-        {
-            boost::filesystem::create_directories("./" + PERSISTENCE_PATH + "/" + this->m_subdirectory);
-        }
-        status = leveldb::DB::Open(options, 
+        status = leveldb::DB::Open(GetOptions(m_profile),
             "./" + PERSISTENCE_PATH + "/" + this->m_subdirectory + "/" + this->m_dbName,
             &db);
     }
@@ -67,12 +117,72 @@ LevelDB::LevelDB(const string & dbName, const string & subdirectory)
     m_db.reset(db);
 }
 
-leveldb::Slice toSlice(boost::multiprecision::uint256_t num)
+namespace
+{
+    // Decimal block number key written by older versions
+    bool isLegacyBlockNumKey(const leveldb::Slice & key)
+    {
+        if (key.empty() || key.size() > 78)
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < key.size(); i++)
+        {
+            if (key[i] < '0' || key[i] > '9')
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    string toLegacyBlockNumKey(const boost::multiprecision::uint256_t & blockNum)
+    {
+        return blockNum.convert_to<string>();
+    }
+}
+
+string toBlockNumKey(const boost::multiprecision::uint256_t & blockNum)
 {
     dev::FixedHash<32> h;
-    dev::bytesRef ref(h.data(), 32);
-    dev::toBigEndian(num, ref);
-    return (leveldb::Slice)h.ref();
+    dev::bytesRef ref(h.data(), h.size);
+    dev::toBigEndian(blockNum, ref);
+    return string((char const*)h.data(), h.size);
+}
+
+bool isBlockNumKey(const leveldb::Slice & key)
+{
+    // Block numbers never reach 2^248, so the first byte is always zero,
+    // which also tells these keys apart from any decimal or hex string key
+    return key.size() == 32 && key[0] == 0;
+}
+
+boost::multiprecision::uint256_t fromBlockNumKey(const leveldb::Slice & key)
+{
+    return dev::fromBigEndian<boost::multiprecision::uint256_t>(
+        dev::bytesConstRef((unsigned char const*)key.data(), key.size()));
+}
+
+bool LevelDB::FindLegacyKeys() const
+{
+    if (!m_db)
+    {
+        return false;
+    }
+
+    // Decimal keys sort between "0" and "9" followed by digits
+    std::unique_ptr<leveldb::Iterator> it(m_db->NewIterator(leveldb::ReadOptions()));
+    for (it->Seek("0"); it->Valid() && it->key()[0] <= '9'; it->Next())
+    {
+        if (isLegacyBlockNumKey(it->key()))
+        {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 string LevelDB::GetDBName() 
@@ -103,7 +213,25 @@ string LevelDB::Lookup(const std::string & key) const
 string LevelDB::Lookup(const boost::multiprecision::uint256_t & blockNum) const
 {
     string value;
-    leveldb::Status s = m_db->Get(leveldb::ReadOptions(), blockNum.convert_to<string>(), &value);
+    leveldb::Status s;
+
+    if (!m_hasLegacyKeys)
+    {
+        s = m_db->Get(leveldb::ReadOptions(), toBlockNumKey(blockNum), &value);
+    }
+    else
+    {
+        // Read both keys from one snapshot, since a migration batch may move
+        // the value from the decimal key to the binary one in between
+        leveldb::ReadOptions options;
+        options.snapshot = m_db->GetSnapshot();
+        s = m_db->Get(options, toBlockNumKey(blockNum), &value);
+        if (s.IsNotFound())
+        {
+            s = m_db->Get(options, toLegacyBlockNumKey(blockNum), &value);
+        }
+        m_db->ReleaseSnapshot(options.snapshot);
+    }
 
     if (!s.ok())
     {
@@ -154,8 +282,14 @@ int LevelDB::Insert(const dev::h256 & key, dev::bytesConstRef value)
 int LevelDB::Insert(const boost::multiprecision::uint256_t & blockNum, 
                     const vector<unsigned char> & body)
 {
+    std::unique_lock<std::mutex> lock(m_mutexBlockNumKeys, std::defer_lock);
+    if (m_hasLegacyKeys)
+    {
+        lock.lock();
+    }
+
     leveldb::Status s = m_db->Put(leveldb::WriteOptions(), 
-                                  leveldb::Slice(blockNum.convert_to<string>()), 
+                                  leveldb::Slice(toBlockNumKey(blockNum)), 
                                   leveldb::Slice(vector_ref<const unsigned char>(&body[0], 
                                                                                  body.size())));
 
@@ -170,8 +304,14 @@ int LevelDB::Insert(const boost::multiprecision::uint256_t & blockNum,
 int LevelDB::Insert(const boost::multiprecision::uint256_t & blockNum, 
                     const std::string & body)
 {
+    std::unique_lock<std::mutex> lock(m_mutexBlockNumKeys, std::defer_lock);
+    if (m_hasLegacyKeys)
+    {
+        lock.lock();
+    }
+
     leveldb::Status s = m_db->Put(leveldb::WriteOptions(), 
-                                  leveldb::Slice(blockNum.convert_to<string>()), 
+                                  leveldb::Slice(toBlockNumKey(blockNum)), 
                                   leveldb::Slice(body.c_str(), body.size()));
 
     if (!s.ok())
@@ -269,6 +409,46 @@ int LevelDB::BatchInsert(std::unordered_map<dev::h256, std::pair<std::string, un
     return 0;
 }
 
+void LevelDB::AddToBatch(leveldb::WriteBatch & batch, const dev::h256 & key,
+                         const vector<unsigned char> & body)
+{
+    batch.Put(leveldb::Slice(key.hex()),
+              leveldb::Slice((const char*)body.data(), body.size()));
+}
+
+void LevelDB::AddToBatch(leveldb::WriteBatch & batch,
+                         const boost::multiprecision::uint256_t & blockNum,
+                         const vector<unsigned char> & body)
+{
+    batch.Put(leveldb::Slice(toBlockNumKey(blockNum)),
+              leveldb::Slice((const char*)body.data(), body.size()));
+}
+
+void LevelDB::AddToBatch(leveldb::WriteBatch & batch, const string & key,
+                         const vector<unsigned char> & body)
+{
+    batch.Put(leveldb::Slice(key), leveldb::Slice((const char*)body.data(), body.size()));
+}
+
+int LevelDB::Write(leveldb::WriteBatch & batch)
+{
+    std::unique_lock<std::mutex> lock(m_mutexBlockNumKeys, std::defer_lock);
+    if (m_hasLegacyKeys)
+    {
+        lock.lock();
+    }
+
+    leveldb::Status s = m_db->Write(leveldb::WriteOptions(), &batch);
+
+    if (!s.ok())
+    {
+        LOG_GENERAL(WARNING, "Batch write to " << m_dbName << " failed: " << s.ToString());
+        return -1;
+    }
+
+    return 0;
+}
+
 bool LevelDB::Exists(const dev::h256 & key) const
 {
     auto ret = Lookup(key);
@@ -300,7 +480,20 @@ int LevelDB::DeleteKey(const dev::h256 & key)
 
 int LevelDB::DeleteKey(const boost::multiprecision::uint256_t & blockNum)
 {
-    leveldb::Status s = m_db->Delete(leveldb::WriteOptions(), ldb::Slice(blockNum.convert_to<string>()));
+    std::unique_lock<std::mutex> lock(m_mutexBlockNumKeys, std::defer_lock);
+    if (m_hasLegacyKeys)
+    {
+        lock.lock();
+    }
+
+    leveldb::WriteBatch batch;
+    batch.Delete(toBlockNumKey(blockNum));
+    if (m_hasLegacyKeys)
+    {
+        batch.Delete(toLegacyBlockNumKey(blockNum));
+    }
+
+    leveldb::Status s = m_db->Write(leveldb::WriteOptions(), &batch);
     if (!s.ok())
     {
         return -1;
@@ -320,8 +513,142 @@ int LevelDB::DeleteKey(const std::string & key)
     return 0;
 }
 
+void LevelDB::ForEachInRange(const boost::multiprecision::uint256_t & first,
+                             const boost::multiprecision::uint256_t & last,
+                             const std::function<bool(const boost::multiprecision::uint256_t &,
+                                                      const leveldb::Slice &)> & func) const
+{
+    if (first > last)
+    {
+        return;
+    }
+
+    std::unique_ptr<leveldb::Iterator> it(m_db->NewIterator(leveldb::ReadOptions()));
+
+    if (m_hasLegacyKeys)
+    {
+        // Decimal keys are not in numeric order, so the whole database is
+        // read and sorted until they have been migrated
+        std::map<boost::multiprecision::uint256_t, string> values;
+        for (it->SeekToFirst(); it->Valid(); it->Next())
+        {
+            boost::multiprecision::uint256_t blockNum;
+            if (isBlockNumKey(it->key()))
+            {
+                blockNum = fromBlockNumKey(it->key());
+            }
+            else if (isLegacyBlockNumKey(it->key()))
+            {
+                blockNum = boost::multiprecision::uint256_t(it->key().ToString());
+            }
+            else
+            {
+                continue;
+            }
+
+            // A binary key holds the newer value
+            if (blockNum >= first && blockNum <= last &&
+                (isBlockNumKey(it->key()) || values.find(blockNum) == values.end()))
+            {
+                values[blockNum] = it->value().ToString();
+            }
+        }
+
+        for (const auto & entry : values)
+        {
+            if (!func(entry.first, leveldb::Slice(entry.second)))
+            {
+                return;
+            }
+        }
+        return;
+    }
+
+    const string lastKey = toBlockNumKey(last);
+    for (it->Seek(toBlockNumKey(first));
+         it->Valid() && it->key().compare(lastKey) <= 0; it->Next())
+    {
+        if (isBlockNumKey(it->key()) && !func(fromBlockNumKey(it->key()), it->value()))
+        {
+            return;
+        }
+    }
+}
+
+int LevelDB::MigrateBlockNumKeys()
+{
+    int count = 0;
+    string resumeKey = "0";
+
+    while (m_hasLegacyKeys)
+    {
+        // Hold the lock only for one batch so that writers are not stalled
+        std::lock_guard<std::mutex> g(m_mutexBlockNumKeys);
+        if (!m_db)
+        {
+            return -1;
+        }
+
+        leveldb::WriteBatch batch;
+        unsigned int batchSize = 0;
+        bool isDone = true;
+
+        std::unique_ptr<leveldb::Iterator> it(m_db->NewIterator(leveldb::ReadOptions()));
+        for (it->Seek(resumeKey); it->Valid() && it->key()[0] <= '9'; it->Next())
+        {
+            if (batchSize == MIGRATION_BATCH_SIZE)
+            {
+                resumeKey = it->key().ToString();
+                isDone = false;
+                break;
+            }
+
+            if (!isLegacyBlockNumKey(it->key()))
+            {
+                continue;
+            }
+
+            // Values written since the upgrade are already under the new key
+            const string newKey = toBlockNumKey(
+                boost::multiprecision::uint256_t(it->key().ToString()));
+            string value;
+            if (m_db->Get(leveldb::ReadOptions(), newKey, &value).IsNotFound())
+            {
+                batch.Put(newKey, it->value());
+            }
+            batch.Delete(it->key());
+            batchSize++;
+        }
+        it.reset();
+
+        leveldb::Status s = m_db->Write(leveldb::WriteOptions(), &batch);
+        if (!s.ok())
+        {
+            LOG_GENERAL(WARNING, "Key migration of " << m_dbName << " failed: "
+                        << s.ToString());
+            return -1;
+        }
+
+        count += batchSize;
+        if (isDone)
+        {
+            m_hasLegacyKeys = false;
+        }
+    }
+
+    if (count > 0)
+    {
+        LOG_GENERAL(INFO, "Migrated " << count << " block number keys of " << m_dbName);
+    }
+
+    return count;
+}
+
 int LevelDB::DeleteDB()
 {
+    std::lock_guard<std::mutex> g(m_mutexBlockNumKeys);
+    m_hasLegacyKeys = false;
+
     if (LOOKUP_NODE_MODE)
     {
         return DeleteDBForLookupNode();
@@ -334,6 +661,9 @@ int LevelDB::DeleteDB()
 
 bool LevelDB::ResetDB()
 {
+    std::lock_guard<std::mutex> g(m_mutexBlockNumKeys);
+    m_hasLegacyKeys = false;
+
     if (LOOKUP_NODE_MODE)
     {
         return ResetDBForLookupNode();
@@ -370,20 +700,7 @@ bool LevelDB::ResetDBForNormalNode()
     {
         boost::filesystem::remove_all("./" + PERSISTENCE_PATH + "/" + this->m_dbName);
 
-        leveldb::Options options;
-        options.max_open_files = 256;
-        options.create_if_missing = true;
-
-        leveldb::DB* db;
-
-        leveldb::Status status = leveldb::DB::Open(options, "./" + PERSISTENCE_PATH + "/" + this->m_dbName, &db);
-        if(!status.ok())
-        {
-            // throw exception();
-            LOG_GENERAL(WARNING, "LevelDB status is not OK.");
-        }
-
-        m_db.reset(db);
+        Open();
         return true;
     }
     else if(this->m_subdirectory.size())
@@ -414,20 +731,7 @@ bool LevelDB::ResetDBForLookupNode()
     {
         boost::filesystem::remove_all("./" + PERSISTENCE_PATH + "/" + this->m_dbName);
 
-        leveldb::Options options;
-        options.max_open_files = 256;
-        options.create_if_missing = true;
-
-        leveldb::DB* db;
-
-        leveldb::Status status = leveldb::DB::Open(options, "./" + PERSISTENCE_PATH + "/" + this->m_dbName, &db);
-        if(!status.ok())
-        {
-            // throw exception();
-            LOG_GENERAL(WARNING, "LevelDB status is not OK.");
-        }
-
-        m_db.reset(db);
+        Open();
         return true;
     }
     return false;
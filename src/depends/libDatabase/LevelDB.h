@@ -18,32 +18,81 @@
 #ifndef __LEVELDB_H__
 #define __LEVELDB_H__
 
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include <leveldb/db.h>
+#include <leveldb/write_batch.h>
 
 #include "depends/common/Common.h"
 #include "depends/common/FixedHash.h"
 //#include "libUtils/Logger.h"
 
-leveldb::Slice toSlice(boost::multiprecision::uint256_t num); 
+/// Returns the fixed-width big-endian key of a block number. Unlike the
+/// decimal keys written by older versions, these sort in numeric order.
+std::string toBlockNumKey(const boost::multiprecision::uint256_t & blockNum);
+
+/// Returns true if key was made by toBlockNumKey.
+bool isBlockNumKey(const leveldb::Slice & key);
+
+/// Returns the block number of a key made by toBlockNumKey.
+boost::multiprecision::uint256_t fromBlockNumKey(const leveldb::Slice & key);
 
 /// Utility class for providing database-type storage.
 class LevelDB
 {
+public:
+    /// How a database is used, which decides how it is tuned.
+    enum Profile
+    {
+        /// Small or rarely written databases, such as the metadata.
+        SMALL,
+        /// Blocks written every epoch and read by ranges of block numbers.
+        BLOCKS,
+        /// Point lookups by hash, such as the state trie and transaction
+        /// bodies. These get a bloom filter so that lookups of missing keys
+        /// rarely touch the disk, and skip compression as hashes do not
+        /// compress.
+        HASH_KEYED
+    };
+
+private:
     std::string m_dbName;
     
     std::string m_subdirectory;
 
+    Profile m_profile;
+
     std::shared_ptr<leveldb::DB> m_db;
+
+    /// Set while decimal block number keys from older versions may be left.
+    /// Block number reads then also try the decimal key.
+    std::atomic<bool> m_hasLegacyKeys{false};
+
+    /// Orders block number writes against MigrateBlockNumKeys and resets
+    std::mutex m_mutexBlockNumKeys;
+
+    bool FindLegacyKeys() const;
+
+    /// Returns the options to open the database with for the profile.
+    static leveldb::Options GetOptions(Profile profile);
+
+    /// Opens the database, replacing the current handle.
+    void Open();
     
 public:
+    /// Number of keys rewritten per write batch by MigrateBlockNumKeys.
+    static const unsigned int MIGRATION_BATCH_SIZE = 1000;
 
-    /// Constructor.
-    explicit LevelDB(const std::string & dbName, const std::string & subdirectory = "");
+    /// Constructor. keyedByBlockNum marks the databases whose keys are
+    /// block numbers, the only ones older versions wrote decimal keys to.
+    explicit LevelDB(const std::string & dbName, const std::string & subdirectory = "",
+                     Profile profile = SMALL, bool keyedByBlockNum = false);
 
     /// Destructor.
     ~LevelDB() = default;
@@ -96,6 +145,18 @@ public:
     int BatchInsert(std::unordered_map<dev::h256, std::pair<std::string, unsigned>> & m_main,
                     std::unordered_map<dev::h256, std::pair<dev::bytes, bool>> & m_aux);
 
+    /// Adds a write to batch, with the key encoded the same way as Insert.
+    static void AddToBatch(leveldb::WriteBatch & batch, const dev::h256 & key,
+                           const std::vector<unsigned char> & body);
+    static void AddToBatch(leveldb::WriteBatch & batch,
+                           const boost::multiprecision::uint256_t & blockNum,
+                           const std::vector<unsigned char> & body);
+    static void AddToBatch(leveldb::WriteBatch & batch, const std::string & key,
+                           const std::vector<unsigned char> & body);
+
+    /// Applies the writes collected in batch by AddToBatch as one write.
+    int Write(leveldb::WriteBatch & batch);
+
     /// Returns true if value corresponding to specified key exists.
     bool Exists(const dev::h256 & key) const;
     bool Exists(const boost::multiprecision::uint256_t & blockNum) const;
@@ -110,6 +171,19 @@ public:
     /// Deletes the value at the specified key.
     int DeleteKey(const std::string & key);
 
+    /// Calls func with each block number in [first, last] that has a value,
+    /// in increasing order, until func returns false. Only the keys in the
+    /// range are read once the keys have been migrated.
+    void ForEachInRange(const boost::multiprecision::uint256_t & first,
+                        const boost::multiprecision::uint256_t & last,
+                        const std::function<bool(const boost::multiprecision::uint256_t &,
+                                                 const leveldb::Slice &)> & func) const;
+
+    /// Rewrites the decimal block number keys of older versions in the binary
+    /// encoding, a batch at a time, while the database stays in use.
+    /// Returns the number of keys rewritten, or -1 on failure.
+    int MigrateBlockNumKeys();
+
     /// Deletes the entire database.
     int DeleteDB();
     int DeleteDBForNormalNode();
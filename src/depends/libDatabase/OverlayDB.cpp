@@ -16,37 +16,302 @@
  * @date 2014
  */
 
+#include <algorithm>
+#include <chrono>
 #include <shared_mutex>
 #include <thread>
 
 #include <boost/filesystem.hpp>
+#include <leveldb/write_batch.h>
 
 #include "depends/common/Common.h"
 #include "depends/common/SHA3.h"
+#include "libUtils/Logger.h"
 #include "OverlayDB.h"
 
 using namespace std;
 using namespace dev;
 
+namespace
+{
+	// The pruning records live beside the nodes. The reference count of a
+	// node is under its hash plus one byte (aux data uses 255), and the
+	// bookkeeping under keys starting with a zero byte, which no hex node key
+	// does.
+	const unsigned char REFCOUNT_SUFFIX = 254;
+	const string PRUNING_KEY = string(1, '\0') + "pruning";
+	const string COMMITNUM_KEY = string(1, '\0') + "commitNum";
+	const string JOURNAL_PREFIX = string(1, '\0') + "journal";
+	const string PENDING_KEY = string(1, '\0') + "pending";
+
+	/// Journal entries, applied once a commit leaves the pruning window
+	enum JournalOp : char
+	{
+		RELEASE = 'r',	// drop a reference
+		CHECK = 'c'		// delete if nothing refers to it by then
+	};
+
+	string refCountKey(h256 const& _h)
+	{
+		string key((char const*)_h.data(), h256::size);
+		key.push_back((char)REFCOUNT_SUFFIX);
+		return key;
+	}
+
+	string encodeUint(uint64_t _value, unsigned int _size)
+	{
+		string ret(_size, '\0');
+		for (unsigned int i = 0; i < _size; i++)
+			ret[i] = (char)(_value >> (8 * (_size - 1 - i)));
+		return ret;
+	}
+
+	uint64_t decodeUint(char const* _data, unsigned int _size)
+	{
+		uint64_t ret = 0;
+		for (unsigned int i = 0; i < _size; i++)
+			ret = (ret << 8) | (unsigned char)_data[i];
+		return ret;
+	}
+
+	string journalKey(uint64_t _commitNum)
+	{
+		return JOURNAL_PREFIX + encodeUint(_commitNum, sizeof(uint64_t));
+	}
+
+	void appendJournal(string& _journal, JournalOp _op, h256 const& _h)
+	{
+		_journal.push_back(_op);
+		_journal.append((char const*)_h.data(), h256::size);
+	}
+
+	void forEachRef(RLP const& _node, function<void(h256 const&)> const& _child,
+	                function<void(bytesConstRef)> const& _value);
+
+	// A child is either the hash of a stored node or a short node inlined
+	void forEachChildRef(RLP const& _item, function<void(h256 const&)> const& _child,
+	                     function<void(bytesConstRef)> const& _value)
+	{
+		if (_item.isList())
+			forEachRef(_item, _child, _value);
+		else if (_item.isData() && _item.payload().size() == h256::size)
+			_child(_item.toHash<h256>());
+	}
+
+	/// Calls _child with each node a trie node refers to and _value with each
+	/// leaf value it holds
+	void forEachRef(RLP const& _node, function<void(h256 const&)> const& _child,
+	                function<void(bytesConstRef)> const& _value)
+	{
+		if (!_node.isList())
+			return;
+
+		if (_node.itemCount() == 17)
+		{
+			for (unsigned int i = 0; i < 16; i++)
+				forEachChildRef(_node[i], _child, _value);
+			if (!_node[16].isEmpty())
+				_value(_node[16].payload());
+		}
+		else if (_node.itemCount() == 2)
+		{
+			// The hex prefix of the path tells leaves from extensions
+			bytesConstRef path = _node[0].payload();
+			if (!path.empty() && (path[0] & 0x20))
+				_value(_node[1].payload());
+			else
+				forEachChildRef(_node[1], _child, _value);
+		}
+	}
+
+	uint64_t elapsedUs(chrono::steady_clock::time_point _start)
+	{
+		return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - _start).count();
+	}
+}
+
 namespace dev
 {
 	h256 const EmptyTrie = sha3(rlp(""));
 
+	OverlayDB::OverlayDB(const std::string & dbName): m_levelDB(dbName, "", LevelDB::HASH_KEYED)
+	{
+		string value;
+		m_isRefCounted = m_levelDB.GetDB()->Get(leveldb::ReadOptions(), PRUNING_KEY, &value).ok();
+		if (m_isRefCounted && m_levelDB.GetDB()->Get(leveldb::ReadOptions(), COMMITNUM_KEY, &value).ok()
+		    && value.size() == sizeof(uint64_t))
+		{
+			m_commitNum = decodeUint(value.data(), sizeof(uint64_t));
+		}
+		if (m_isRefCounted)
+			m_levelDB.GetDB()->Get(leveldb::ReadOptions(), PENDING_KEY, &m_pendingReleases);
+	}
+
 	void OverlayDB::ResetDB()
 	{
+		lock_guard<mutex> g(m_mutexPrune);
 		m_levelDB.ResetDB();
+		m_pendingReleases.clear();
+
+		if (m_isRefCounted)
+		{
+			leveldb::WriteBatch batch;
+			markPruning(batch, 0);
+			m_levelDB.Write(batch);
+		}
+	}
+
+	void OverlayDB::markPruning(leveldb::WriteBatch& _batch, uint64_t _commitNum)
+	{
+		m_commitNum = _commitNum;
+		_batch.Put(PRUNING_KEY, "1");
+		_batch.Put(COMMITNUM_KEY, encodeUint(m_commitNum, sizeof(uint64_t)));
 	}
 
-	void OverlayDB::commit()
+	bool OverlayDB::enablePruning(unsigned int _window)
+	{
+		lock_guard<mutex> g(m_mutexPrune);
+
+		if (!m_isRefCounted)
+		{
+			// Counting can only start from an empty database, where nothing is
+			// referenced yet
+			unique_ptr<leveldb::Iterator> it(m_levelDB.GetDB()->NewIterator(leveldb::ReadOptions()));
+			it->SeekToFirst();
+			if (it->Valid())
+			{
+				LOG_GENERAL(WARNING, m_levelDB.GetDBName() << " was written without pruning, "
+				            "run compactstate to prune it");
+				return false;
+			}
+			it.reset();
+
+			leveldb::WriteBatch batch;
+			markPruning(batch, 0);
+			if (m_levelDB.Write(batch) != 0)
+				return false;
+			m_isRefCounted = true;
+		}
+
+		m_pruneWindow = _window;
+		return true;
+	}
+
+	void OverlayDB::setValueRefs(OverlayDB* _db, ValueRefs const& _refs)
+	{
+		m_valueRefsDB = _db;
+		m_valueRefs = _refs;
+	}
+
+	bool OverlayDB::loadRefCount(h256 const& _h, uint32_t& o_count) const
+	{
+		string value = m_levelDB.Lookup(refCountKey(_h));
+		if (value.size() != sizeof(uint32_t))
+			return false;
+
+		o_count = (uint32_t)decodeUint(value.data(), sizeof(uint32_t));
+		return true;
+	}
+
+	void OverlayDB::commit(std::vector<h256> const& _roots)
 	{
 	// #if DEV_GUARDED_DB
 	// 		DEV_READ_GUARDED(x_this)
 	// #endif
+		if (!m_isRefCounted)
 		{
 			shared_lock<shared_timed_mutex> lock(x_this);
 			m_levelDB.BatchInsert(m_main, m_aux);
 		}
-			
+		else
+		{
+			auto start = chrono::steady_clock::now();
+			unsigned int numNewNodes = 0;
+			uint64_t refCountUs = 0;
+
+			shared_lock<shared_timed_mutex> lock(x_this);
+			lock_guard<mutex> g(m_mutexPrune);
+
+			// A node is written and its children counted only the first time,
+			// so that a count is the number of stored nodes and roots that
+			// refer to the node
+			leveldb::WriteBatch batch;
+			unordered_map<h256, int> deltas;
+			vector<h256> valueRefs;
+			for (auto const& i: m_main)
+			{
+				uint32_t count;
+				if (!i.second.second || loadRefCount(i.first, count))
+					continue;
+
+				batch.Put(leveldb::Slice(i.first.hex()), leveldb::Slice(i.second.first));
+				deltas[i.first];
+				forEachRef(RLP(i.second.first),
+				           [&deltas](h256 const& _h) { deltas[_h]++; },
+				           [this, &valueRefs](bytesConstRef _v)
+				           {
+				               if (m_valueRefsDB)
+				                   m_valueRefs(_v, valueRefs);
+				           });
+				numNewNodes++;
+			}
+
+			for (auto const& i: m_aux)
+			{
+				if (i.second.second)
+				{
+					bytes b = i.first.asBytes();
+					b.push_back(255);	// for aux
+					batch.Put(leveldb::Slice((char const*)b.data(), b.size()),
+					          leveldb::Slice((char const*)i.second.first.data(), i.second.first.size()));
+				}
+			}
+
+			// Roots are held for the pruning window, and so are the nodes that
+			// nothing refers to, in case a later commit refers to them again
+			string journal;
+			for (auto const& root: _roots)
+			{
+				deltas[root]++;
+				appendJournal(journal, RELEASE, root);
+			}
+			journal += m_pendingReleases;
+			m_pendingReleases.clear();
+			batch.Delete(PENDING_KEY);
+
+			for (auto const& d: deltas)
+			{
+				uint32_t count = 0;
+				loadRefCount(d.first, count);
+				count = (uint32_t)max<int64_t>((int64_t)count + d.second, 0);
+				batch.Put(refCountKey(d.first), encodeUint(count, sizeof(uint32_t)));
+				if (count == 0)
+					appendJournal(journal, CHECK, d.first);
+			}
+			refCountUs = elapsedUs(start);
+
+			m_commitNum++;
+			batch.Put(COMMITNUM_KEY, encodeUint(m_commitNum, sizeof(uint64_t)));
+			// Also when not pruning, as the roots counted above are only
+			// released by this journal
+			if (!journal.empty())
+				batch.Put(journalKey(m_commitNum), journal);
+
+			// Counting the references into the other database first means a
+			// crash in between can leak nodes there but never lose them
+			if (!valueRefs.empty())
+				m_valueRefsDB->addRefs(valueRefs);
+
+			if (m_levelDB.Write(batch) != 0)
+				LOG_GENERAL(WARNING, "Failed to commit " << m_levelDB.GetDBName());
+
+			m_lastCommitUs = elapsedUs(start);
+			m_lastRefCountUs = refCountUs;
+			LOG_GENERAL(INFO, m_levelDB.GetDBName() << " commit " << m_commitNum << ": "
+			            << numNewNodes << " new nodes in " << m_lastCommitUs << " us ("
+			            << refCountUs << " us counting references)");
+		}
+
 	// #if DEV_GUARDED_DB
 	// 		DEV_WRITE_GUARDED(x_this)
 	// #endif
@@ -57,6 +322,294 @@ namespace dev
 		}
 	}
 
+	void OverlayDB::addRefs(std::vector<h256> const& _refs)
+	{
+		if (!m_isRefCounted)
+			return;
+
+		lock_guard<mutex> g(m_mutexPrune);
+
+		unordered_map<h256, uint32_t> counts;
+		for (auto const& h: _refs)
+		{
+			auto it = counts.find(h);
+			if (it == counts.end())
+			{
+				uint32_t count = 0;
+				loadRefCount(h, count);
+				it = counts.emplace(h, count).first;
+			}
+			it->second++;
+		}
+
+		leveldb::WriteBatch batch;
+		for (auto const& c: counts)
+			batch.Put(refCountKey(c.first), encodeUint(c.second, sizeof(uint32_t)));
+		m_levelDB.Write(batch);
+	}
+
+	void OverlayDB::releaseRefs(std::vector<h256> const& _refs)
+	{
+		if (!m_isRefCounted)
+			return;
+
+		lock_guard<mutex> g(m_mutexPrune);
+		for (auto const& h: _refs)
+			appendJournal(m_pendingReleases, RELEASE, h);
+
+		// Written after the other database deleted the nodes holding the
+		// references, so a crash in between leaks the nodes here at worst
+		leveldb::WriteBatch batch;
+		batch.Put(PENDING_KEY, m_pendingReleases);
+		if (m_levelDB.Write(batch) != 0)
+			LOG_GENERAL(WARNING, "Failed to record releases in " << m_levelDB.GetDBName());
+	}
+
+	uint64_t OverlayDB::prune()
+	{
+		if (!m_isRefCounted || !m_pruneWindow || m_isPruneRunning.exchange(true))
+			return 0;
+
+		auto start = chrono::steady_clock::now();
+		uint64_t numNodes = 0;
+		uint64_t numBytes = 0;
+
+		// One journal at a time, so that commits wait for one batch at most
+		while (true)
+		{
+			vector<h256> valueRefs;
+			{
+				lock_guard<mutex> g(m_mutexPrune);
+
+				unique_ptr<leveldb::Iterator> it(m_levelDB.GetDB()->NewIterator(leveldb::ReadOptions()));
+				it->Seek(JOURNAL_PREFIX);
+				if (!it->Valid() || it->key().size() != JOURNAL_PREFIX.size() + sizeof(uint64_t)
+				    || it->key().ToString().compare(0, JOURNAL_PREFIX.size(), JOURNAL_PREFIX) != 0)
+					break;
+
+				uint64_t commitNum = decodeUint(it->key().data() + JOURNAL_PREFIX.size(), sizeof(uint64_t));
+				if (commitNum + m_pruneWindow > m_commitNum)
+					break;
+
+				const string key = it->key().ToString();
+				const string journal = it->value().ToString();
+				it.reset();
+
+				// Counts are read once and written back at the end. Nodes
+				// without a count predate the counting and are never deleted.
+				unordered_map<h256, uint32_t> counts;
+				auto count = [this, &counts](h256 const& _h) -> uint32_t*
+				{
+					auto it = counts.find(_h);
+					if (it == counts.end())
+					{
+						uint32_t c;
+						if (!loadRefCount(_h, c))
+							return nullptr;
+						it = counts.emplace(_h, c).first;
+					}
+					return &it->second;
+				};
+
+				vector<h256> unreferenced;
+				auto release = [&count, &unreferenced](h256 const& _h)
+				{
+					uint32_t* c = count(_h);
+					if (c && *c > 0 && --*c == 0)
+						unreferenced.push_back(_h);
+				};
+
+				const size_t entrySize = 1 + h256::size;
+				for (size_t i = 0; i + entrySize <= journal.size(); i += entrySize)
+				{
+					h256 h(bytesConstRef((byte const*)journal.data() + i + 1, h256::size));
+					if (journal[i] == RELEASE)
+					{
+						release(h);
+					}
+					else
+					{
+						uint32_t* c = count(h);
+						if (c && *c == 0)
+							unreferenced.push_back(h);
+					}
+				}
+
+				leveldb::WriteBatch batch;
+				h256Hash deleted;
+				while (!unreferenced.empty())
+				{
+					h256 h = unreferenced.back();
+					unreferenced.pop_back();
+					if (!deleted.insert(h).second)
+						continue;
+
+					string value = m_levelDB.Lookup(h);
+					batch.Delete(leveldb::Slice(h.hex()));
+					batch.Delete(refCountKey(h));
+					numNodes++;
+					numBytes += value.size();
+
+					if (!value.empty())
+						forEachRef(RLP(value), release,
+						           [this, &valueRefs](bytesConstRef _v)
+						           {
+						               if (m_valueRefsDB)
+						                   m_valueRefs(_v, valueRefs);
+						           });
+				}
+
+				for (auto const& c: counts)
+					if (!deleted.count(c.first))
+						batch.Put(refCountKey(c.first), encodeUint(c.second, sizeof(uint32_t)));
+				batch.Delete(key);
+
+				if (m_levelDB.Write(batch) != 0)
+				{
+					LOG_GENERAL(WARNING, "Failed to prune " << m_levelDB.GetDBName());
+					break;
+				}
+			}
+
+			if (!valueRefs.empty())
+				m_valueRefsDB->releaseRefs(valueRefs);
+		}
+
+		m_isPruneRunning = false;
+
+		if (numNodes > 0)
+		{
+			m_prunedNodes += numNodes;
+			m_prunedBytes += numBytes;
+			LOG_GENERAL(INFO, "Pruned " << numNodes << " nodes (" << numBytes << " bytes) from "
+			            << m_levelDB.GetDBName() << " in " << elapsedUs(start) << " us, "
+			            << m_prunedBytes << " bytes so far");
+		}
+
+		return numBytes;
+	}
+
+	uint64_t OverlayDB::compact(std::vector<h256> const& _roots,
+	                            std::unordered_map<h256, unsigned> const& _externalRefs,
+	                            std::unordered_map<h256, unsigned>& o_valueRefs)
+	{
+		lock_guard<mutex> g(m_mutexPrune);
+
+		// Count the references to every node reachable from the roots
+		unordered_map<h256, uint32_t> counts;
+		vector<h256> toVisit;
+		for (auto const& root: _roots)
+		{
+			counts[root]++;
+			toVisit.push_back(root);
+		}
+		for (auto const& ref: _externalRefs)
+		{
+			counts[ref.first] += ref.second;
+			toVisit.push_back(ref.first);
+		}
+
+		h256Hash visited;
+		while (!toVisit.empty())
+		{
+			h256 h = toVisit.back();
+			toVisit.pop_back();
+			if (!visited.insert(h).second)
+				continue;
+
+			string value = m_levelDB.Lookup(h);
+			if (value.empty())
+			{
+				LOG_GENERAL(WARNING, m_levelDB.GetDBName() << " is missing node " << h);
+				continue;
+			}
+
+			forEachRef(RLP(value),
+			           [&counts, &toVisit](h256 const& _h)
+			           {
+			               counts[_h]++;
+			               toVisit.push_back(_h);
+			           },
+			           [this, &o_valueRefs](bytesConstRef _v)
+			           {
+			               vector<h256> refs;
+			               if (m_valueRefs)
+			                   m_valueRefs(_v, refs);
+			               for (auto const& ref: refs)
+			                   o_valueRefs[ref]++;
+			           });
+		}
+
+		// Delete the unreachable nodes along with any earlier bookkeeping
+		uint64_t numNodes = 0;
+		uint64_t numBytes = 0;
+		leveldb::WriteBatch batch;
+		unsigned int batchSize = 0;
+		auto flush = [this, &batch, &batchSize](bool _force)
+		{
+			if (batchSize == LevelDB::MIGRATION_BATCH_SIZE || (_force && batchSize > 0))
+			{
+				m_levelDB.Write(batch);
+				batch.Clear();
+				batchSize = 0;
+			}
+		};
+
+		unique_ptr<leveldb::Iterator> it(m_levelDB.GetDB()->NewIterator(leveldb::ReadOptions()));
+		for (it->SeekToFirst(); it->Valid(); it->Next())
+		{
+			leveldb::Slice key = it->key();
+			if (key.size() == 2 * h256::size)
+			{
+				if (visited.count(h256(key.ToString())))
+					continue;
+				numNodes++;
+				numBytes += it->value().size();
+			}
+			else if (!(key.size() == h256::size + 1 && (unsigned char)key[h256::size] == REFCOUNT_SUFFIX)
+			         && !(!key.empty() && key[0] == '\0'))
+			{
+				continue;	// aux data
+			}
+
+			batch.Delete(key);
+			batchSize++;
+			flush(false);
+		}
+		it.reset();
+
+		for (auto const& c: counts)
+		{
+			batch.Put(refCountKey(c.first), encodeUint(c.second, sizeof(uint32_t)));
+			batchSize++;
+			flush(false);
+		}
+
+		string journal;
+		for (auto const& root: _roots)
+			appendJournal(journal, RELEASE, root);
+		markPruning(batch, 0);
+		if (!journal.empty())
+			batch.Put(journalKey(0), journal);
+		batchSize++;
+		flush(true);
+		m_isRefCounted = true;
+		m_pendingReleases.clear();
+
+		m_levelDB.GetDB()->CompactRange(nullptr, nullptr);
+
+		m_prunedNodes += numNodes;
+		m_prunedBytes += numBytes;
+		LOG_GENERAL(INFO, "Compacted " << m_levelDB.GetDBName() << ": kept " << visited.size()
+		            << " nodes, deleted " << numNodes << " (" << numBytes << " bytes)");
+		return numBytes;
+	}
+
+	OverlayDB::PruneStats OverlayDB::pruneStats() const
+	{
+		return {m_prunedNodes, m_prunedBytes, m_lastCommitUs, m_lastRefCountUs};
+	}
+
 	bytes OverlayDB::lookupAux(h256 const& _h) const
 	{
 		bytes ret = MemoryDB::lookupAux(_h);
@@ -19,7 +19,12 @@
 #ifndef __OVERLAYDB_H__
 #define __OVERLAYDB_H__
 
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "common/Constants.h"
 #include "depends/common/Common.h"
@@ -33,14 +38,61 @@ namespace dev
 	class OverlayDB: public MemoryDB
 	{
 	public:
-		explicit OverlayDB(const std::string & dbName): m_levelDB(dbName) {}
+		/// Appends the nodes of another database that a leaf value refers
+		/// to, such as the storage root held by an account.
+		using ValueRefs = std::function<void(bytesConstRef _value, std::vector<h256>& o_refs)>;
+
+		/// Totals of the pruning work, for the logs.
+		struct PruneStats
+		{
+			uint64_t m_prunedNodes;
+			uint64_t m_prunedBytes;
+			uint64_t m_lastCommitUs;
+			uint64_t m_lastRefCountUs;
+		};
+
+		explicit OverlayDB(const std::string & dbName);
 		~OverlayDB() = default;
 
 		void ResetDB();
 
-		void commit();
+		/// Lets prune() delete the nodes no longer reachable from the roots of
+		/// the last _window commits. This needs the committed nodes to be
+		/// reference counted, which starts with an empty database or after the
+		/// offline compaction; fails on a database written without it.
+		bool enablePruning(unsigned int _window);
+		bool isPruning() const { return m_pruneWindow > 0; }
+
+		/// True once the committed nodes are reference counted. This then goes
+		/// on for good, as the counts would be wrong after a commit without it.
+		/// Commits keep journaling while not pruning, so that prune() catches
+		/// up once pruning is enabled again.
+		bool isRefCounted() const { return m_isRefCounted; }
+
+		/// Makes the leaf values of this trie count as references to the
+		/// nodes of _db, which must outlive this database.
+		void setValueRefs(OverlayDB* _db, ValueRefs const& _refs);
+
+		/// Writes the inserted nodes to disk. When pruning, _roots stay
+		/// readable for the pruning window even if nothing refers to them.
+		void commit(std::vector<h256> const& _roots = {});
 		void rollback();
 
+		/// Deletes the nodes that have been unreachable for the pruning
+		/// window. Safe to call in the background. Returns the bytes freed.
+		uint64_t prune();
+
+		/// Rebuilds the reference counts from the nodes reachable from _roots
+		/// and _externalRefs and deletes every other node. _roots are held for
+		/// one pruning window, _externalRefs count the references from another
+		/// database, and o_valueRefs receives those made by the leaf values
+		/// here. For offline use only. Returns the bytes freed.
+		uint64_t compact(std::vector<h256> const& _roots,
+		                 std::unordered_map<h256, unsigned> const& _externalRefs,
+		                 std::unordered_map<h256, unsigned>& o_valueRefs);
+
+		PruneStats pruneStats() const;
+
 		std::string lookup(h256 const& _h) const;
 		bool exists(h256 const& _h) const;
 		void kill(h256 const& _h);
@@ -50,7 +102,35 @@ namespace dev
 	private:
 		using MemoryDB::clear;
 
+		/// Counts the references this database holds into m_valueRefsDB.
+		void addRefs(std::vector<h256> const& _refs);
+		/// Releases references into this database once a commit has passed.
+		void releaseRefs(std::vector<h256> const& _refs);
+
+		bool loadRefCount(h256 const& _h, uint32_t& o_count) const;
+		void markPruning(leveldb::WriteBatch& _batch, uint64_t _commitNum);
+
 		LevelDB m_levelDB;
+
+		bool m_isRefCounted = false;
+		/// Commits a node stays on disk after becoming unreachable, 0 when not pruning.
+		unsigned int m_pruneWindow = 0;
+		uint64_t m_commitNum = 0;
+
+		OverlayDB* m_valueRefsDB = nullptr;
+		ValueRefs m_valueRefs;
+
+		/// Serializes the reference count updates of commit, prune and reset.
+		mutable std::mutex m_mutexPrune;
+		/// Journal entries of the references another database released, also
+		/// kept on disk until the next commit records them in its journal.
+		std::string m_pendingReleases;
+		std::atomic<bool> m_isPruneRunning{false};
+
+		std::atomic<uint64_t> m_prunedNodes{0};
+		std::atomic<uint64_t> m_prunedBytes{0};
+		std::atomic<uint64_t> m_lastCommitUs{0};
+		std::atomic<uint64_t> m_lastRefCountUs{0};
 	};
 }
 
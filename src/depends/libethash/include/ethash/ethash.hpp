@@ -108,6 +108,18 @@ result hash(const epoch_context& context, const hash256& header_hash, uint64_t n
 
 result hash(const epoch_context_full& context, const hash256& header_hash, uint64_t nonce) noexcept;
 
+/// Calculates the full dataset items in [begin, end) ahead of hashing.
+///
+/// Disjoint ranges can be filled by different threads at the same time.
+void fill_full_dataset(epoch_context_full& context, uint32_t begin, uint32_t end) noexcept;
+
+/// Same as hash() with the full dataset, but only reads the dataset instead of
+/// filling it lazily, so it can be called by many threads at the same time.
+///
+/// All the items must have been calculated by fill_full_dataset() first.
+result hash_filled(
+    const epoch_context_full& context, const hash256& header_hash, uint64_t nonce) noexcept;
+
 bool verify_final_hash(const hash256& header_hash, const hash256& mix_hash, uint64_t nonce,
     const hash256& boundary) noexcept;
 
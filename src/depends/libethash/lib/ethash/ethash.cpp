@@ -280,6 +280,25 @@ result hash(const epoch_context_full& context, const hash256& header_hash, uint6
     return {hash_final(seed, mix_hash), mix_hash};
 }
 
+void fill_full_dataset(epoch_context_full& context, uint32_t begin, uint32_t end) noexcept
+{
+    for (uint32_t i = begin; i < end; ++i)
+        context.full_dataset[i] = calculate_dataset_item(context, i);
+}
+
+result hash_filled(
+    const epoch_context_full& context, const hash256& header_hash, uint64_t nonce) noexcept
+{
+    static const auto lookup = [](const epoch_context& context, uint32_t index) noexcept
+    {
+        return static_cast<const epoch_context_full&>(context).full_dataset[index];
+    };
+
+    const hash512 seed = hash_seed(header_hash, nonce);
+    const hash256 mix_hash = hash_kernel(context, seed, lookup);
+    return {hash_final(seed, mix_hash), mix_hash};
+}
+
 bool verify_final_hash(const hash256& header_hash, const hash256& mix_hash, uint64_t nonce,
     const hash256& boundary) noexcept
 {
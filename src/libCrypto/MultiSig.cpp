@@ -567,6 +567,8 @@ shared_ptr<PubKey> MultiSig::AggregatePubKeys(const vector<PubKey>& pubkeys) {
     }
   }
 
+  aggregatedPubkey->UpdateEncoding();
+
   return aggregatedPubkey;
 }
 
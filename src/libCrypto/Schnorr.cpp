@@ -36,8 +36,15 @@
 
 using namespace std;
 
-std::mutex BIGNUMSerialize::m_mutexBIGNUM;
-std::mutex ECPOINTSerialize::m_mutexECPOINT;
+namespace {
+/// BN_CTX is scratch space that must not be shared between threads, so each
+/// thread keeps one for all its Schnorr operations.
+BN_CTX* GetThreadContext() {
+  static thread_local unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(),
+                                                                BN_CTX_free);
+  return ctx.get();
+}
+}  // namespace
 
 Curve::Curve()
     : m_group(EC_GROUP_new_by_curve_name(NID_secp256k1), EC_GROUP_clear_free),
@@ -57,6 +64,12 @@ Curve::Curve()
     LOG_GENERAL(WARNING, "Recover curve order failed");
     // throw exception();
   }
+
+  // Precompute multiples of the base point used by every Sign and Verify.
+  // The group is only read from then on, so it can be shared across threads.
+  if (!EC_GROUP_precompute_mult(m_group.get(), NULL)) {
+    LOG_GENERAL(WARNING, "Base point precomputation failed");
+  }
 }
 
 Curve::~Curve() {}
@@ -70,8 +83,6 @@ shared_ptr<BIGNUM> BIGNUMSerialize::GetNumber(const vector<unsigned char>& src,
     return nullptr;
   }
 
-  lock_guard<mutex> g(m_mutexBIGNUM);
-
   if (offset + size <= src.size()) {
     BIGNUM* ret = BN_bin2bn(src.data() + offset, size, NULL);
     if (ret != NULL) {
@@ -94,8 +105,6 @@ void BIGNUMSerialize::SetNumber(vector<unsigned char>& dst, unsigned int offset,
     return;
   }
 
-  lock_guard<mutex> g(m_mutexBIGNUM);
-
   const int actual_bn_size = BN_num_bytes(value.get());
 
   // if (actual_bn_size > 0)
@@ -130,10 +139,9 @@ void BIGNUMSerialize::SetNumber(vector<unsigned char>& dst, unsigned int offset,
 shared_ptr<EC_POINT> ECPOINTSerialize::GetNumber(
     const vector<unsigned char>& src, unsigned int offset, unsigned int size) {
   shared_ptr<BIGNUM> bnvalue = BIGNUMSerialize::GetNumber(src, offset, size);
-  lock_guard<mutex> g(m_mutexECPOINT);
 
   if (bnvalue != nullptr) {
-    unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
+    BN_CTX* ctx = GetThreadContext();
     if (ctx == nullptr) {
       LOG_GENERAL(WARNING, "Memory allocation failure");
       // throw exception();
@@ -142,7 +150,7 @@ shared_ptr<EC_POINT> ECPOINTSerialize::GetNumber(
 
     EC_POINT* ret =
         EC_POINT_bn2point(Schnorr::GetInstance().GetCurve().m_group.get(),
-                          bnvalue.get(), NULL, ctx.get());
+                          bnvalue.get(), NULL, ctx);
     if (ret != NULL) {
       return shared_ptr<EC_POINT>(ret, EC_POINT_clear_free);
     }
@@ -155,9 +163,7 @@ void ECPOINTSerialize::SetNumber(vector<unsigned char>& dst,
                                  shared_ptr<EC_POINT> value) {
   shared_ptr<BIGNUM> bnvalue;
   {
-    std::lock_guard<mutex> g(m_mutexECPOINT);
-
-    unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
+    BN_CTX* ctx = GetThreadContext();
     if (ctx == nullptr) {
       LOG_GENERAL(WARNING, "Memory allocation failure");
       // throw exception();
@@ -166,8 +172,7 @@ void ECPOINTSerialize::SetNumber(vector<unsigned char>& dst,
 
     bnvalue.reset(
         EC_POINT_point2bn(Schnorr::GetInstance().GetCurve().m_group.get(),
-                          value.get(), POINT_CONVERSION_COMPRESSED, NULL,
-                          ctx.get()),
+                          value.get(), POINT_CONVERSION_COMPRESSED, NULL, ctx),
         BN_clear_free);
     if (bnvalue == nullptr) {
       LOG_GENERAL(WARNING, "Memory allocation failure");
@@ -270,7 +275,8 @@ bool PrivKey::operator==(const PrivKey& r) const {
 PubKey::PubKey()
     : m_P(EC_POINT_new(Schnorr::GetInstance().GetCurve().m_group.get()),
           EC_POINT_clear_free),
-      m_initialized(false) {
+      m_initialized(false),
+      m_encoded() {
   if (m_P == nullptr) {
     LOG_GENERAL(WARNING, "Memory allocation failure");
     // throw exception();
@@ -280,7 +286,8 @@ PubKey::PubKey()
 PubKey::PubKey(const PrivKey& privkey)
     : m_P(EC_POINT_new(Schnorr::GetInstance().GetCurve().m_group.get()),
           EC_POINT_clear_free),
-      m_initialized(false) {
+      m_initialized(false),
+      m_encoded() {
   if (m_P == nullptr) {
     LOG_GENERAL(WARNING, "Memory allocation failure");
     // throw exception();
@@ -306,10 +313,12 @@ PubKey::PubKey(const PrivKey& privkey)
     }
 
     m_initialized = true;
+    UpdateEncoding();
   }
 }
 
-PubKey::PubKey(const vector<unsigned char>& src, unsigned int offset) {
+PubKey::PubKey(const vector<unsigned char>& src, unsigned int offset)
+    : m_initialized(false), m_encoded() {
   if (Deserialize(src, offset) != 0) {
     LOG_GENERAL(WARNING, "We failed to init PubKey.");
   }
@@ -318,7 +327,8 @@ PubKey::PubKey(const vector<unsigned char>& src, unsigned int offset) {
 PubKey::PubKey(const PubKey& src)
     : m_P(EC_POINT_new(Schnorr::GetInstance().GetCurve().m_group.get()),
           EC_POINT_clear_free),
-      m_initialized(false) {
+      m_initialized(false),
+      m_encoded(src.m_encoded) {
   if (m_P == nullptr) {
     LOG_GENERAL(WARNING, "Memory allocation failure");
     // throw exception();
@@ -339,10 +349,26 @@ PubKey::~PubKey() {}
 
 bool PubKey::Initialized() const { return m_initialized; }
 
+void PubKey::UpdateEncoding() {
+  m_encoded.fill(0x00);
+
+  if (m_initialized &&
+      (EC_POINT_point2oct(Schnorr::GetInstance().GetCurve().m_group.get(),
+                          m_P.get(), POINT_CONVERSION_COMPRESSED,
+                          m_encoded.data(), m_encoded.size(),
+                          GetThreadContext()) != m_encoded.size())) {
+    LOG_GENERAL(WARNING, "Pubkey octet conversion failed");
+    m_encoded.fill(0x00);
+  }
+}
+
 unsigned int PubKey::Serialize(vector<unsigned char>& dst,
                                unsigned int offset) const {
   if (m_initialized) {
-    ECPOINTSerialize::SetNumber(dst, offset, PUB_KEY_SIZE, m_P);
+    if (offset + PUB_KEY_SIZE > dst.size()) {
+      dst.resize(offset + PUB_KEY_SIZE);
+    }
+    copy(m_encoded.begin(), m_encoded.end(), dst.begin() + offset);
   }
 
   return PUB_KEY_SIZE;
@@ -359,6 +385,7 @@ int PubKey::Deserialize(const vector<unsigned char>& src, unsigned int offset) {
       return -1;
     } else {
       m_initialized = true;
+      UpdateEncoding();
     }
   } catch (const std::exception& e) {
     LOG_GENERAL(WARNING, "Error with PubKey::Deserialize." << ' ' << e.what());
@@ -370,66 +397,23 @@ int PubKey::Deserialize(const vector<unsigned char>& src, unsigned int offset) {
 PubKey& PubKey::operator=(const PubKey& src) {
   m_initialized =
       src.m_initialized && (EC_POINT_copy(m_P.get(), src.m_P.get()) == 1);
+  m_encoded = src.m_encoded;
   return *this;
 }
 
-bool PubKey::operator<(const PubKey& r) const {
-  unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
-  if (ctx == nullptr) {
-    LOG_GENERAL(WARNING, "Memory allocation failure");
-    // throw exception();
-    return false;
-  }
-
-  shared_ptr<BIGNUM> lhs_bnvalue(
-      EC_POINT_point2bn(Schnorr::GetInstance().GetCurve().m_group.get(),
-                        m_P.get(), POINT_CONVERSION_COMPRESSED, NULL,
-                        ctx.get()),
-      BN_clear_free);
-  shared_ptr<BIGNUM> rhs_bnvalue(
-      EC_POINT_point2bn(Schnorr::GetInstance().GetCurve().m_group.get(),
-                        r.m_P.get(), POINT_CONVERSION_COMPRESSED, NULL,
-                        ctx.get()),
-      BN_clear_free);
+// The compressed encodings have the same length and a non-zero first byte,
+// so comparing them bytewise orders keys like comparing them as BIGNUMs.
 
-  return (m_initialized && r.m_initialized &&
-          (BN_cmp(lhs_bnvalue.get(), rhs_bnvalue.get()) == -1));
+bool PubKey::operator<(const PubKey& r) const {
+  return (m_initialized && r.m_initialized && (m_encoded < r.m_encoded));
 }
 
 bool PubKey::operator>(const PubKey& r) const {
-  unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
-  if (ctx == nullptr) {
-    LOG_GENERAL(WARNING, "Memory allocation failure");
-    // throw exception();
-    return false;
-  }
-
-  shared_ptr<BIGNUM> lhs_bnvalue(
-      EC_POINT_point2bn(Schnorr::GetInstance().GetCurve().m_group.get(),
-                        m_P.get(), POINT_CONVERSION_COMPRESSED, NULL,
-                        ctx.get()),
-      BN_clear_free);
-  shared_ptr<BIGNUM> rhs_bnvalue(
-      EC_POINT_point2bn(Schnorr::GetInstance().GetCurve().m_group.get(),
-                        r.m_P.get(), POINT_CONVERSION_COMPRESSED, NULL,
-                        ctx.get()),
-      BN_clear_free);
-
-  return (m_initialized && r.m_initialized &&
-          (BN_cmp(lhs_bnvalue.get(), rhs_bnvalue.get()) == 1));
+  return (m_initialized && r.m_initialized && (m_encoded > r.m_encoded));
 }
 
 bool PubKey::operator==(const PubKey& r) const {
-  unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
-  if (ctx == nullptr) {
-    LOG_GENERAL(WARNING, "Memory allocation failure");
-    // throw exception();
-    return false;
-  }
-
-  return (m_initialized && r.m_initialized &&
-          (EC_POINT_cmp(Schnorr::GetInstance().GetCurve().m_group.get(),
-                        m_P.get(), r.m_P.get(), ctx.get()) == 0));
+  return (m_initialized && r.m_initialized && (m_encoded == r.m_encoded));
 }
 
 Signature::Signature()
@@ -543,7 +527,6 @@ const Curve& Schnorr::GetCurve() const { return m_curve; }
 
 pair<PrivKey, PubKey> Schnorr::GenKeyPair() {
   // LOG_MARKER();
-  lock_guard<mutex> g(m_mutexSchnorr);
 
   PrivKey privkey;
   PubKey pubkey(privkey);
@@ -560,7 +543,6 @@ bool Schnorr::Sign(const vector<unsigned char>& message, unsigned int offset,
                    unsigned int size, const PrivKey& privkey,
                    const PubKey& pubkey, Signature& result) {
   // LOG_MARKER();
-  lock_guard<mutex> g(m_mutexSchnorr);
 
   // Initial checks
 
@@ -609,7 +591,7 @@ bool Schnorr::Sign(const vector<unsigned char>& message, unsigned int offset,
   unique_ptr<BIGNUM, void (*)(BIGNUM*)> k(BN_new(), BN_clear_free);
   unique_ptr<EC_POINT, void (*)(EC_POINT*)> Q(
       EC_POINT_new(m_curve.m_group.get()), EC_POINT_clear_free);
-  unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
+  BN_CTX* ctx = GetThreadContext();
 
   if ((k != nullptr) && (ctx != nullptr) && (Q != nullptr)) {
     do {
@@ -630,7 +612,7 @@ bool Schnorr::Sign(const vector<unsigned char>& message, unsigned int offset,
 
       // 2. Compute the commitment Q = kG, where G is the base point
       err = (EC_POINT_mul(m_curve.m_group.get(), Q.get(), k.get(), NULL, NULL,
-                          NULL) == 0);
+                          ctx) == 0);
       if (err) {
         LOG_GENERAL(WARNING, "Commit generation failed");
         return false;
@@ -680,7 +662,7 @@ bool Schnorr::Sign(const vector<unsigned char>& message, unsigned int offset,
       }
 
       err = (BN_nnmod(result.m_r.get(), result.m_r.get(), m_curve.m_order.get(),
-                      NULL) == 0);
+                      ctx) == 0);
       if (err) {
         LOG_GENERAL(WARNING, "BIGNUM NNmod failed");
         return false;
@@ -689,7 +671,7 @@ bool Schnorr::Sign(const vector<unsigned char>& message, unsigned int offset,
       // 4. Compute s = k - r*krpiv
       // 4.1 r*kpriv
       err = (BN_mod_mul(result.m_s.get(), result.m_r.get(), privkey.m_d.get(),
-                        m_curve.m_order.get(), ctx.get()) == 0);
+                        m_curve.m_order.get(), ctx) == 0);
       if (err) {
         LOG_GENERAL(WARNING, "Response mod mul failed");
         return false;
@@ -697,7 +679,7 @@ bool Schnorr::Sign(const vector<unsigned char>& message, unsigned int offset,
 
       // 4.2 k-r*kpriv
       err = (BN_mod_sub(result.m_s.get(), k.get(), result.m_s.get(),
-                        m_curve.m_order.get(), ctx.get()) == 0);
+                        m_curve.m_order.get(), ctx) == 0);
       if (err) {
         LOG_GENERAL(WARNING, "BIGNUM mod sub failed");
         return false;
@@ -730,7 +712,6 @@ bool Schnorr::Verify(const vector<unsigned char>& message, unsigned int offset,
                      unsigned int size, const Signature& toverify,
                      const PubKey& pubkey) {
   // LOG_MARKER();
-  lock_guard<mutex> g(m_mutexSchnorr);
 
   // Initial checks
 
@@ -776,7 +757,7 @@ bool Schnorr::Verify(const vector<unsigned char>& message, unsigned int offset,
                                                           BN_clear_free);
     unique_ptr<EC_POINT, void (*)(EC_POINT*)> Q(
         EC_POINT_new(m_curve.m_group.get()), EC_POINT_clear_free);
-    unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
+    BN_CTX* ctx = GetThreadContext();
 
     if ((challenge_built != nullptr) && (ctx != nullptr) && (Q != nullptr)) {
       // 1. Check if r,s is in [1, ..., order-1]
@@ -799,7 +780,7 @@ bool Schnorr::Verify(const vector<unsigned char>& message, unsigned int offset,
       // 2. Compute Q = sG + r*kpub
       err2 =
           (EC_POINT_mul(m_curve.m_group.get(), Q.get(), toverify.m_s.get(),
-                        pubkey.m_P.get(), toverify.m_r.get(), ctx.get()) == 0);
+                        pubkey.m_P.get(), toverify.m_r.get(), ctx) == 0);
       err = err || err2;
       if (err2) {
         LOG_GENERAL(WARNING, "Commit regenerate failed");
@@ -860,7 +841,7 @@ bool Schnorr::Verify(const vector<unsigned char>& message, unsigned int offset,
       }
 
       err2 = (BN_nnmod(challenge_built.get(), challenge_built.get(),
-                       m_curve.m_order.get(), NULL) == 0);
+                       m_curve.m_order.get(), ctx) == 0);
       err = err || err2;
       if (err2) {
         LOG_GENERAL(WARNING, "Challenge rebuild mod failed");
@@ -882,7 +863,6 @@ bool Schnorr::Verify(const vector<unsigned char>& message, unsigned int offset,
 
 void Schnorr::PrintPoint(const EC_POINT* point) {
   LOG_MARKER();
-  lock_guard<mutex> g(m_mutexSchnorr);
 
   unique_ptr<BIGNUM, void (*)(BIGNUM*)> x(BN_new(), BN_clear_free);
   unique_ptr<BIGNUM, void (*)(BIGNUM*)> y(BN_new(), BN_clear_free);
@@ -24,6 +24,8 @@
 #include <openssl/ec.h>
 
 #include <array>
+#include <cstring>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -50,8 +52,6 @@ struct Curve {
 
 /// EC-Schnorr utility for serializing BIGNUM data type.
 struct BIGNUMSerialize {
-  static std::mutex m_mutexBIGNUM;
-
   /// Deserializes a BIGNUM from specified byte stream.
   static std::shared_ptr<BIGNUM> GetNumber(
       const std::vector<unsigned char>& src, unsigned int offset,
@@ -64,8 +64,6 @@ struct BIGNUMSerialize {
 
 /// EC-Schnorr utility for serializing ECPOINT data type.
 struct ECPOINTSerialize {
-  static std::mutex m_mutexECPOINT;
-
   /// Deserializes an ECPOINT from specified byte stream.
   static std::shared_ptr<EC_POINT> GetNumber(
       const std::vector<unsigned char>& src, unsigned int offset,
@@ -131,6 +129,10 @@ struct PubKey : public Serializable {
   /// Flag to indicate if parameters have been initialized.
   bool m_initialized;
 
+  /// Compressed encoding of m_P, used to serialize, compare and hash the key
+  /// without converting the point each time.
+  std::array<unsigned char, PUB_KEY_SIZE> m_encoded;
+
   /// Default constructor for an uninitialized key.
   PubKey();
 
@@ -149,6 +151,9 @@ struct PubKey : public Serializable {
   /// Indicates if key parameters have been initialized.
   bool Initialized() const;
 
+  /// Recomputes m_encoded. Must be called after changing m_P directly.
+  void UpdateEncoding();
+
   /// Implements the Serialize function inherited from Serializable.
   unsigned int Serialize(std::vector<unsigned char>& dst,
                          unsigned int offset) const;
@@ -179,6 +184,18 @@ inline std::ostream& operator<<(std::ostream& os, const PubKey& p) {
   return os;
 }
 
+namespace std {
+template <>
+struct hash<PubKey> {
+  size_t operator()(const PubKey& key) const {
+    // Skip the parity byte, the x coordinate is already uniformly distributed
+    size_t value;
+    memcpy(&value, key.m_encoded.data() + 1, sizeof(value));
+    return value;
+  }
+};
+}  // namespace std
+
 /// Stores information on an EC-Schnorr signature.
 struct Signature : public Serializable {
   /// Challenge scalar.
@@ -246,8 +263,6 @@ class Schnorr {
   /// for y. Hence a total of 33 bytes.
   static const unsigned int PUBKEY_COMPRESSED_SIZE_BYTES = 33;
 
-  std::mutex m_mutexSchnorr;
-
   /// Returns the singleton Schnorr instance.
   static Schnorr& GetInstance();
 
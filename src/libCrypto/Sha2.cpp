@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include "Sha2.h"
+
+#include <cstdint>
+#include <cstring>
+
+using namespace std;
+
+const unsigned int SHA256MultiBuffer::LANES;
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#define SHA2_AVX2 __attribute__((target("avx2"), always_inline)) inline
+
+namespace {
+const unsigned int BLOCK_SIZE = 64;
+
+const uint32_t INITIAL_STATE[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372,
+                                   0xa54ff53a, 0x510e527f, 0x9b05688c,
+                                   0x1f83d9ab, 0x5be0cd19};
+
+const uint32_t ROUND_CONSTANTS[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+/// One 32-bit word of the state or message schedule in each lane.
+typedef uint32_t Lanes __attribute__((vector_size(32)));
+
+SHA2_AVX2 Lanes Rotr(Lanes x, int n) { return (x >> n) | (x << (32 - n)); }
+
+SHA2_AVX2 uint32_t LoadBigEndian(const unsigned char* p) {
+  uint32_t word;
+  memcpy(&word, p, sizeof(word));
+  return __builtin_bswap32(word);
+}
+
+/// Runs the compression function on one block per lane.
+__attribute__((target("avx2"))) void Compress(
+    Lanes state[8], const unsigned char* const blocks[8]) {
+  Lanes w[64];
+
+  for (unsigned int t = 0; t < 16; t++) {
+    const unsigned int at = 4 * t;
+    w[t] = Lanes{LoadBigEndian(blocks[0] + at), LoadBigEndian(blocks[1] + at),
+                 LoadBigEndian(blocks[2] + at), LoadBigEndian(blocks[3] + at),
+                 LoadBigEndian(blocks[4] + at), LoadBigEndian(blocks[5] + at),
+                 LoadBigEndian(blocks[6] + at), LoadBigEndian(blocks[7] + at)};
+  }
+
+  for (unsigned int t = 16; t < 64; t++) {
+    const Lanes s0 =
+        Rotr(w[t - 15], 7) ^ Rotr(w[t - 15], 18) ^ (w[t - 15] >> 3);
+    const Lanes s1 = Rotr(w[t - 2], 17) ^ Rotr(w[t - 2], 19) ^ (w[t - 2] >> 10);
+    w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+  }
+
+  Lanes a = state[0], b = state[1], c = state[2], d = state[3];
+  Lanes e = state[4], f = state[5], g = state[6], h = state[7];
+
+  for (unsigned int t = 0; t < 64; t++) {
+    const Lanes S1 = Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25);
+    const Lanes ch = (e & f) ^ (~e & g);
+    const Lanes t1 = h + S1 + ch + ROUND_CONSTANTS[t] + w[t];
+    const Lanes S0 = Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22);
+    const Lanes maj = (a & b) ^ (a & c) ^ (b & c);
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + S0 + maj;
+  }
+
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+/// A buffer being hashed in one lane. Whole blocks are read in place, the
+/// rest of the data and the padding are copied into tail.
+struct Lane {
+  size_t input;
+  const unsigned char* data;
+  size_t wholeBlocks;
+  size_t blocks;
+  size_t next;
+  unsigned char tail[2 * BLOCK_SIZE];
+
+  void Start(size_t index, const SHA256MultiBuffer::Buffer& buffer) {
+    input = index;
+    data = buffer.first;
+    wholeBlocks = buffer.second / BLOCK_SIZE;
+    next = 0;
+
+    // The data is followed by 0x80 and the bit length in the last 8 bytes
+    const size_t rest = buffer.second % BLOCK_SIZE;
+    const size_t tailBlocks = rest + 9 > BLOCK_SIZE ? 2 : 1;
+    blocks = wholeBlocks + tailBlocks;
+
+    memset(tail, 0, sizeof(tail));
+    if (rest > 0) {
+      memcpy(tail, data + wholeBlocks * BLOCK_SIZE, rest);
+    }
+    tail[rest] = 0x80;
+
+    uint64_t bits = static_cast<uint64_t>(buffer.second) * 8;
+    for (size_t i = tailBlocks * BLOCK_SIZE; bits > 0; bits >>= 8) {
+      tail[--i] = static_cast<unsigned char>(bits);
+    }
+  }
+
+  const unsigned char* Block() const {
+    return next < wholeBlocks ? data + next * BLOCK_SIZE
+                              : tail + (next - wholeBlocks) * BLOCK_SIZE;
+  }
+};
+}  // namespace
+
+bool SHA256MultiBuffer::IsSupported() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+
+bool SHA256MultiBuffer::IsPreferred() {
+  static const bool preferred =
+      IsSupported() && !__builtin_cpu_supports("sha");
+  return preferred;
+}
+
+void SHA256MultiBuffer::Hash(const Buffer* inputs, size_t count,
+                             dev::h256* digests) {
+  static const unsigned char idleBlock[BLOCK_SIZE] = {};
+
+  Lanes state[8];
+  Lane lanes[LANES];
+  const unsigned char* blocks[LANES];
+  bool busy[LANES];
+  size_t started = 0;
+
+  // Each lane takes the next buffer as soon as it is done with one, and
+  // hashes a dummy block once there are none left
+  auto startNext = [&](unsigned int lane) {
+    busy[lane] = started < count;
+    if (busy[lane]) {
+      lanes[lane].Start(started, inputs[started]);
+      started++;
+      for (unsigned int j = 0; j < 8; j++) {
+        state[j][lane] = INITIAL_STATE[j];
+      }
+    }
+  };
+
+  for (unsigned int lane = 0; lane < LANES; lane++) {
+    startNext(lane);
+  }
+
+  unsigned int numBusy = min<size_t>(count, LANES);
+  while (numBusy > 0) {
+    for (unsigned int lane = 0; lane < LANES; lane++) {
+      blocks[lane] = busy[lane] ? lanes[lane].Block() : idleBlock;
+    }
+
+    Compress(state, blocks);
+
+    for (unsigned int lane = 0; lane < LANES; lane++) {
+      if (!busy[lane] || ++lanes[lane].next < lanes[lane].blocks) {
+        continue;
+      }
+
+      unsigned char* digest = digests[lanes[lane].input].data();
+      for (unsigned int j = 0; j < 8; j++) {
+        const uint32_t word = __builtin_bswap32(state[j][lane]);
+        memcpy(digest + 4 * j, &word, sizeof(word));
+      }
+
+      startNext(lane);
+      if (!busy[lane]) {
+        numBusy--;
+      }
+    }
+  }
+}
+
+#else  // No x86 SIMD, so HashBatch always hashes one buffer at a time
+
+bool SHA256MultiBuffer::IsSupported() { return false; }
+
+bool SHA256MultiBuffer::IsPreferred() { return false; }
+
+void SHA256MultiBuffer::Hash(const Buffer* inputs, size_t count,
+                             dev::h256* digests) {
+  for (size_t i = 0; i < count; i++) {
+    SHA2<HASH_TYPE::HASH_VARIANT_256>::Hash(inputs[i].first, inputs[i].second,
+                                            digests[i]);
+  }
+}
+
+#endif
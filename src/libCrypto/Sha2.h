@@ -21,7 +21,9 @@
 #define __SHA2_H__
 
 #include <openssl/sha.h>
+#include <utility>
 #include <vector>
+#include "depends/common/FixedHash.h"
 #include "libUtils/Logger.h"
 
 /// List of supported hash variants.
@@ -31,35 +33,54 @@ class HASH_TYPE {
   static const unsigned int HASH_VARIANT_512 = 512;
 };
 
+/// Multi-buffer SHA2-256 kernel, which hashes eight independent buffers side
+/// by side in the lanes of AVX2 registers.
+class SHA256MultiBuffer {
+ public:
+  /// Input buffer: start of the data and its length.
+  using Buffer = std::pair<const unsigned char*, size_t>;
+
+  /// Number of buffers hashed side by side.
+  static const unsigned int LANES = 8;
+
+  /// Whether the CPU can run the kernel.
+  static bool IsSupported();
+
+  /// Whether the kernel beats hashing one buffer at a time with OpenSSL,
+  /// which is the case on CPUs that have AVX2 but not the SHA extensions.
+  static bool IsPreferred();
+
+  /// Writes the hash of inputs[i] to digests[i]. Requires IsSupported().
+  static void Hash(const Buffer* inputs, size_t count, dev::h256* digests);
+};
+
 /// Implements SHA2 hash algorithm.
 template <unsigned int SIZE>
 class SHA2 {
+  static_assert(SIZE == HASH_TYPE::HASH_VARIANT_256,
+                "Only SHA2-256 is supported");
+
   static const unsigned int HASH_OUTPUT_SIZE = SIZE / 8;
   SHA256_CTX m_context;
-  std::vector<unsigned char> output;
 
  public:
-  /// Constructor.
-  SHA2() : output(HASH_OUTPUT_SIZE) {
-    if (SIZE != HASH_TYPE::HASH_VARIANT_256) {
-      LOG_GENERAL(FATAL, "assertion failed (" << __FILE__ << ":" << __LINE__
-                                              << ": " << __FUNCTION__ << ")");
-    }
+  /// Input buffer for HashBatch: start of the data and its length.
+  using Buffer = SHA256MultiBuffer::Buffer;
 
-    Reset();
-  }
+  /// Constructor.
+  SHA2() { Reset(); }
 
   /// Destructor.
   ~SHA2() {}
 
+  /// Hash update function. Empty input is a no-op.
+  void Update(const unsigned char* data, size_t size) {
+    SHA256_Update(&m_context, data, size);
+  }
+
   /// Hash update function.
   void Update(const std::vector<unsigned char>& input) {
-    if (input.size() == 0) {
-      LOG_GENERAL(WARNING, "Nothing to update");
-      return;
-    }
-
-    SHA256_Update(&m_context, input.data(), input.size());
+    Update(input.data(), input.size());
   }
 
   /// Hash update function.
@@ -70,7 +91,7 @@ class SHA2 {
                                               << ": " << __FUNCTION__ << ")");
     }
 
-    SHA256_Update(&m_context, input.data() + offset, size);
+    Update(input.data() + offset, size);
   }
 
   /// Resets the algorithm.
@@ -78,15 +99,56 @@ class SHA2 {
 
   /// Hash finalize function.
   std::vector<unsigned char> Finalize() {
-    switch (SIZE) {
-      case 256:
-        SHA256_Final(output.data(), &m_context);
-        break;
-      default:
-        break;
-    }
+    std::vector<unsigned char> output(HASH_OUTPUT_SIZE);
+    SHA256_Final(output.data(), &m_context);
     return output;
   }
+
+  /// Hash finalize function that writes into the caller's digest.
+  void Finalize(dev::h256& digest) { SHA256_Final(digest.data(), &m_context); }
+
+  /// Hashes a single buffer into digest without any allocation.
+  static void Hash(const unsigned char* data, size_t size, dev::h256& digest) {
+    // Not the one-shot SHA256(), which looks up a provider on every call
+    SHA256_CTX context;
+    SHA256_Init(&context);
+    SHA256_Update(&context, data, size);
+    SHA256_Final(digest.data(), &context);
+  }
+
+  /// Hashes a single buffer into digest without any allocation.
+  static void Hash(const std::vector<unsigned char>& input, dev::h256& digest) {
+    Hash(input.data(), input.size(), digest);
+  }
+
+  /// Hashes independent buffers, writing the hash of inputs[i] to digests[i].
+  /// Batches of at least SHA256MultiBuffer::LANES buffers go through the
+  /// multi-buffer kernel where it is preferred.
+  static void HashBatch(const std::vector<Buffer>& inputs,
+                        std::vector<dev::h256>& digests) {
+    digests.resize(inputs.size());
+
+    if (inputs.size() >= SHA256MultiBuffer::LANES &&
+        SHA256MultiBuffer::IsPreferred()) {
+      SHA256MultiBuffer::Hash(inputs.data(), inputs.size(), digests.data());
+      return;
+    }
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+      Hash(inputs[i].first, inputs[i].second, digests[i]);
+    }
+  }
+
+  /// Hashes independent buffers, writing the hash of inputs[i] to digests[i].
+  static void HashBatch(const std::vector<std::vector<unsigned char>>& inputs,
+                        std::vector<dev::h256>& digests) {
+    std::vector<Buffer> buffers;
+    buffers.reserve(inputs.size());
+    for (const auto& input : inputs) {
+      buffers.emplace_back(input.data(), input.size());
+    }
+    HashBatch(buffers, digests);
+  }
 };
 
-#endif  // __SHA2_H__
\ No newline at end of file
+#endif  // __SHA2_H__
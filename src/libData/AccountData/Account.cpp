@@ -394,9 +394,7 @@ void Account::SetCode(const vector<unsigned char>& code) {
   }
 
   m_codeCache = code;
-  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-  sha2.Update(code);
-  m_codeHash = dev::h256(sha2.Finalize());
+  SHA2<HASH_TYPE::HASH_VARIANT_256>::Hash(code, m_codeHash);
   // LOG_GENERAL(INFO, "m_codeHash: " << m_codeHash);
 
   InitStorage();
@@ -409,7 +407,8 @@ const std::vector<unsigned char>& Account::GetCode() const {
 const dev::h256& Account::GetCodeHash() const { return m_codeHash; }
 
 const h256 Account::GetKeyHash(const string& key) const {
-  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-  sha2.Update(DataConversion::StringToCharArray(key));
-  return h256(sha2.Finalize());
+  h256 keyHash;
+  SHA2<HASH_TYPE::HASH_VARIANT_256>::Hash(
+      reinterpret_cast<const unsigned char*>(key.data()), key.size(), keyHash);
+  return keyHash;
 }
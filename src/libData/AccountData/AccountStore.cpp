@@ -25,6 +25,7 @@
 #include "libMessage/Messenger.h"
 #include "libPersistence/BlockStorage.h"
 #include "libPersistence/ContractStorage.h"
+#include "libUtils/Executor.h"
 #include "libUtils/SysCommand.h"
 
 using namespace std;
@@ -33,6 +34,18 @@ using namespace boost::multiprecision;
 
 AccountStore::AccountStore() {
   m_accountStoreTemp = make_unique<AccountStoreTemp>(*this);
+
+  OverlayDB& contractStateDB =
+      ContractStorage::GetContractStorage().GetStateDB();
+  if (STATE_PRUNING_WINDOW > 0 && m_db.enablePruning(STATE_PRUNING_WINDOW)) {
+    contractStateDB.enablePruning(STATE_PRUNING_WINDOW);
+  }
+
+  // Contract storage can only be pruned once the accounts count the storage
+  // roots they refer to
+  if (m_db.isRefCounted() && contractStateDB.isRefCounted()) {
+    m_db.setValueRefs(&contractStateDB, GetStorageRootRefs);
+  }
 }
 
 AccountStore::~AccountStore() {
@@ -56,6 +69,7 @@ void AccountStore::InitSoft() {
   unique_lock<shared_timed_mutex> g(m_mutexPrimary);
 
   AccountStoreTrie<OverlayDB, unordered_map<Address, Account>>::Init();
+  m_newContracts.clear();
 
   InitReversibles();
 
@@ -85,6 +99,19 @@ AccountStore& AccountStore::GetInstance() {
   return accountstore;
 }
 
+void AccountStore::GetStorageRootRefs(bytesConstRef accountData,
+                                      vector<h256>& refs) {
+  RLP rlp(accountData);
+  if (!rlp.isList() || rlp.itemCount() != 4) {
+    return;
+  }
+
+  h256 storageRoot = rlp[2].toHash<h256>();
+  if (storageRoot != h256()) {
+    refs.emplace_back(storageRoot);
+  }
+}
+
 bool AccountStore::Serialize(vector<unsigned char>& src,
                              unsigned int offset) const {
   LOG_MARKER();
@@ -180,23 +207,56 @@ void AccountStore::MoveUpdatesToDisk() {
   lock_guard<mutex> g2(m_mutexDB, adopt_lock);
 
   ContractStorage::GetContractStorage().GetStateDB().commit();
-  for (auto i : *m_addressToAccount) {
+
+  // Only the accounts written since the last commit have anything to save,
+  // and the code of a contract never changes after its creation
+  for (const auto& address : m_newContracts) {
+    auto it = m_addressToAccount->find(address);
+    if (it == m_addressToAccount->end()) {
+      continue;
+    }
     if (!ContractStorage::GetContractStorage().PutContractCode(
-            i.first, i.second.GetCode())) {
+            address, it->second.GetCode())) {
       LOG_GENERAL(WARNING, "Write Contract Code to Disk Failed");
-      continue;
     }
-    i.second.Commit();
   }
 
+  for (const auto& address : m_dirtyAddresses) {
+    auto it = m_addressToAccount->find(address);
+    if (it != m_addressToAccount->end()) {
+      it->second.Commit();
+    }
+  }
+
+  LOG_GENERAL(INFO, "Committed " << m_dirtyAddresses.size() << " of "
+                                 << m_addressToAccount->size()
+                                 << " cached accounts, "
+                                 << m_newContracts.size() << " new contracts");
+  m_dirtyAddresses.clear();
+  m_newContracts.clear();
+
   try {
-    m_state.db()->commit();
+    m_state.db()->commit({m_state.root()});
     m_prevRoot = m_state.root();
     MoveRootToDisk(m_prevRoot);
   } catch (const boost::exception& e) {
     LOG_GENERAL(WARNING, "Error with AccountStore::MoveUpdatesToDisk. "
                              << boost::diagnostic_information(e));
   }
+
+  if (m_db.isPruning()) {
+    Executor::GetInstance().Execute([this]() { PruneState(); });
+  }
+}
+
+void AccountStore::PruneState() {
+  m_db.prune();
+
+  OverlayDB& contractStateDB =
+      ContractStorage::GetContractStorage().GetStateDB();
+  if (contractStateDB.isPruning() && m_db.isRefCounted()) {
+    contractStateDB.prune();
+  }
 }
 
 void AccountStore::DiscardUnsavedUpdates() {
@@ -207,9 +267,14 @@ void AccountStore::DiscardUnsavedUpdates() {
   lock_guard<mutex> g2(m_mutexDB, adopt_lock);
 
   ContractStorage::GetContractStorage().GetStateDB().rollback();
-  for (auto i : *m_addressToAccount) {
-    i.second.RollBack();
+  for (const auto& address : m_dirtyAddresses) {
+    auto it = m_addressToAccount->find(address);
+    if (it != m_addressToAccount->end() && it->second.isContract()) {
+      it->second.RollBack();
+    }
   }
+  m_dirtyAddresses.clear();
+  m_newContracts.clear();
 
   try {
     m_state.db()->rollback();
@@ -221,6 +286,16 @@ void AccountStore::DiscardUnsavedUpdates() {
   }
 }
 
+size_t AccountStore::GetNumDirtyAccounts() const {
+  shared_lock<shared_timed_mutex> lock(m_mutexPrimary);
+  return m_dirtyAddresses.size();
+}
+
+size_t AccountStore::GetNumNewContracts() const {
+  shared_lock<shared_timed_mutex> lock(m_mutexPrimary);
+  return m_newContracts.size();
+}
+
 bool AccountStore::RetrieveFromDisk() {
   LOG_MARKER();
 
@@ -324,9 +399,10 @@ StateHash AccountStore::GetStateDeltaHash() {
     return StateHash();
   }
 
-  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-  sha2.Update(m_stateDeltaSerialized);
-  return StateHash(sha2.Finalize());
+  StateHash stateDeltaHash;
+  SHA2<HASH_TYPE::HASH_VARIANT_256>::Hash(m_stateDeltaSerialized,
+                                          stateDeltaHash);
+  return stateDeltaHash;
 }
 
 void AccountStore::CommitTemp() {
@@ -25,6 +25,7 @@
 #include <set>
 #include <shared_mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -82,6 +83,8 @@ class AccountStore
 
   std::unordered_map<Address, Account> m_addressToAccountRevChanged;
   std::unordered_map<Address, Account> m_addressToAccountRevCreated;
+  // contracts created since the last commit, whose code is not on disk yet
+  std::unordered_set<Address> m_newContracts;
 
   // primary mutex used by account store for protecting permanent states from
   // external access
@@ -99,10 +102,17 @@ class AccountStore
   /// Store the trie root to leveldb
   void MoveRootToDisk(const dev::h256& root);
 
+  /// Deletes the state that dropped out of the pruning window
+  void PruneState();
+
  public:
   /// Returns the singleton AccountStore instance.
   static AccountStore& GetInstance();
 
+  /// Collects the storage root an account in the state trie refers to
+  static void GetStorageRootRefs(dev::bytesConstRef accountData,
+                                 std::vector<dev::h256>& refs);
+
   bool Serialize(std::vector<unsigned char>& src,
                  unsigned int offset) const override;
 
@@ -128,6 +138,12 @@ class AccountStore
   void MoveUpdatesToDisk();
   void DiscardUnsavedUpdates();
 
+  /// Returns the number of accounts the next commit will save.
+  size_t GetNumDirtyAccounts() const;
+
+  /// Returns the number of contracts whose code the next commit will write.
+  size_t GetNumNewContracts() const;
+
   bool RetrieveFromDisk();
 
   bool UpdateAccountsTemp(const uint64_t& blockNum,
@@ -143,6 +159,12 @@ class AccountStore
                                        const Account& account,
                                        const bool fullCopy = false,
                                        const bool reversible = false) {
+    if (account.isContract() &&
+        (fullCopy || m_addressToAccount->find(address) ==
+                         m_addressToAccount->end())) {
+      m_newContracts.insert(address);
+    }
+
     (*m_addressToAccount)[address] = account;
 
     if (reversible) {
@@ -20,6 +20,8 @@
 #ifndef __ACCOUNTSTORETRIE_H__
 #define __ACCOUNTSTORETRIE_H__
 
+#include <unordered_set>
+
 #include "AccountStoreSC.h"
 #include "depends/libDatabase/MemoryDB.h"
 #include "depends/libDatabase/OverlayDB.h"
@@ -30,6 +32,8 @@ class AccountStoreTrie : public AccountStoreSC<MAP> {
   DB m_db;
   dev::SpecificTrieDB<dev::GenericTrieDB<DB>, Address> m_state;
   dev::h256 m_prevRoot;
+  // accounts updated in the trie since the last commit
+  std::unordered_set<Address> m_dirtyAddresses;
 
   // mutex for AccountStore DB related operations
   std::mutex m_mutexDB;
@@ -32,6 +32,7 @@ void AccountStoreTrie<DB, MAP>::Init() {
   AccountStoreSC<MAP>::Init();
   m_state.init();
   m_prevRoot = m_state.root();
+  m_dirtyAddresses.clear();
 }
 
 template <class DB, class MAP>
@@ -85,6 +86,7 @@ bool AccountStoreTrie<DB, MAP>::UpdateStateTrie(const Address& address,
   rlpStream << account.GetBalance() << account.GetNonce()
             << account.GetStorageRoot() << account.GetCodeHash();
   m_state.insert(address, &rlpStream.out());
+  m_dirtyAddresses.insert(address);
 
   return true;
 }
@@ -93,6 +95,7 @@ template <class DB, class MAP>
 bool AccountStoreTrie<DB, MAP>::RemoveFromTrie(const Address& address) {
   // LOG_MARKER();
   m_state.remove(address);
+  m_dirtyAddresses.insert(address);
 
   return true;
 }
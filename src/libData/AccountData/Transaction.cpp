@@ -61,14 +61,7 @@ Transaction::Transaction(const uint32_t& version, const uint64_t& nonce,
   SerializeCoreFields(txnData, 0);
 
   // Generate the transaction ID
-  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-  sha2.Update(txnData);
-  const vector<unsigned char>& output = sha2.Finalize();
-  if (output.size() != TRAN_HASH_SIZE) {
-    LOG_GENERAL(WARNING, "We failed to generate m_tranID.");
-    return;
-  }
-  copy(output.begin(), output.end(), m_tranID.asArray().begin());
+  SHA2<HASH_TYPE::HASH_VARIANT_256>::Hash(txnData, m_tranID);
 
   // Generate the signature
   if (!Schnorr::GetInstance().Sign(txnData, senderKeyPair.first,
@@ -103,14 +96,7 @@ Transaction::Transaction(const uint32_t& version, const uint64_t& nonce,
   SerializeCoreFields(txnData, 0);
 
   // Generate the transaction ID
-  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-  sha2.Update(txnData);
-  const vector<unsigned char>& output = sha2.Finalize();
-  if (output.size() != TRAN_HASH_SIZE) {
-    LOG_GENERAL(WARNING, "We failed to generate m_tranID.");
-    return;
-  }
-  copy(output.begin(), output.end(), m_tranID.asArray().begin());
+  SHA2<HASH_TYPE::HASH_VARIANT_256>::Hash(txnData, m_tranID);
 
   // Verify the signature
   if (!Schnorr::GetInstance().Verify(txnData, m_signature,
@@ -105,7 +105,7 @@ class TransactionWithReceipt : public SerializableDataBlock {
       sha2.Update(DataConversion::StringToCharArray(
           it->second.GetTransactionReceipt().GetString()));
     }
-    trHash = TxnHash(sha2.Finalize());
+    sha2.Finalize(trHash);
     return true;
   }
 };
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <algorithm>
+
+#include "TxnPool.h"
+
+using namespace std;
+using namespace boost::multiprecision;
+
+TxnPool::TxnPool(unsigned int capacity) : m_capacity(max(capacity, 1u)) {}
+
+void TxnPool::clear() {
+  m_slab.clear();
+  m_freeSlots.clear();
+  m_hashIndex.clear();
+  m_senderQueues.clear();
+  m_blockedSenders.clear();
+  m_bestHeap.clear();
+  m_worstHeap.clear();
+}
+
+bool TxnPool::get(const TxnHash& th, Transaction& t) const {
+  auto it = m_hashIndex.find(th);
+  if (it == m_hashIndex.end()) {
+    return false;
+  }
+
+  t = m_slab[it->second].m_txn;
+  return true;
+}
+
+TxnPool::GasKey TxnPool::MakeKey(const Transaction& t, Slot slot,
+                                 uint32_t generation) {
+  return {t.GetGasPrice(), t.GetTranID(), slot, generation};
+}
+
+bool TxnPool::IsLive(const GasKey& key) const {
+  const Entry& entry = m_slab[key.m_slot];
+  return entry.m_used && (entry.m_generation == key.m_generation);
+}
+
+bool TxnPool::IsHead(Slot slot) const {
+  auto queue = m_senderQueues.find(m_slab[slot].m_txn.GetSenderPubKey());
+  return (queue != m_senderQueues.end()) &&
+         (queue->second.begin()->second == slot);
+}
+
+void TxnPool::PushCandidate(Slot slot) {
+  m_bestHeap.emplace_back(
+      MakeKey(m_slab[slot].m_txn, slot, m_slab[slot].m_generation));
+  push_heap(m_bestHeap.begin(), m_bestHeap.end(), BestOnTop());
+}
+
+TxnPool::Slot TxnPool::Store(const Transaction& t) {
+  Slot slot;
+  if (m_freeSlots.empty()) {
+    slot = m_slab.size();
+    m_slab.emplace_back();
+  } else {
+    slot = m_freeSlots.back();
+    m_freeSlots.pop_back();
+  }
+
+  Entry& entry = m_slab[slot];
+  entry.m_txn = t;
+  entry.m_used = true;
+
+  m_hashIndex.emplace(t.GetTranID(), slot);
+  m_senderQueues[t.GetSenderPubKey()].emplace(t.GetNonce(), slot);
+
+  // A new head may close the nonce gap of a blocked sender
+  if (IsHead(slot)) {
+    m_blockedSenders.erase(t.GetSenderPubKey());
+    PushCandidate(slot);
+  }
+
+  m_worstHeap.emplace_back(MakeKey(t, slot, entry.m_generation));
+  push_heap(m_worstHeap.begin(), m_worstHeap.end(), WorstOnTop());
+
+  return slot;
+}
+
+void TxnPool::Remove(Slot slot) {
+  Entry& entry = m_slab[slot];
+  const Transaction& t = entry.m_txn;
+
+  m_hashIndex.erase(t.GetTranID());
+
+  auto queue = m_senderQueues.find(t.GetSenderPubKey());
+  if (queue != m_senderQueues.end()) {
+    const bool wasHead = queue->second.begin()->second == slot;
+    queue->second.erase(t.GetNonce());
+    if (queue->second.empty()) {
+      m_blockedSenders.erase(queue->first);
+      m_senderQueues.erase(queue);
+    } else if (wasHead && (m_blockedSenders.count(queue->first) == 0)) {
+      // Promote the next txn of the sender
+      PushCandidate(queue->second.begin()->second);
+    }
+  }
+
+  // Heap entries of this slot become stale once the generation moves on,
+  // the txn itself is kept until the slot is reused
+  entry.m_used = false;
+  entry.m_generation++;
+  m_freeSlots.emplace_back(slot);
+
+  Compact();
+}
+
+void TxnPool::Compact() {
+  // Rebuild the heaps once stale entries outnumber the live ones
+  if (m_bestHeap.size() + m_worstHeap.size() < 4 * (size() + 16)) {
+    return;
+  }
+
+  m_worstHeap.clear();
+  for (Slot slot = 0; slot < m_slab.size(); slot++) {
+    if (m_slab[slot].m_used) {
+      m_worstHeap.emplace_back(
+          MakeKey(m_slab[slot].m_txn, slot, m_slab[slot].m_generation));
+    }
+  }
+
+  m_bestHeap.clear();
+  for (const auto& queue : m_senderQueues) {
+    if (m_blockedSenders.count(queue.first) == 0) {
+      const Slot slot = queue.second.begin()->second;
+      m_bestHeap.emplace_back(
+          MakeKey(m_slab[slot].m_txn, slot, m_slab[slot].m_generation));
+    }
+  }
+
+  make_heap(m_bestHeap.begin(), m_bestHeap.end(), BestOnTop());
+  make_heap(m_worstHeap.begin(), m_worstHeap.end(), WorstOnTop());
+}
+
+template <typename Compare>
+bool TxnPool::PruneTop(vector<GasKey>& heap) {
+  while (!heap.empty() && !IsLive(heap.front())) {
+    pop_heap(heap.begin(), heap.end(), Compare());
+    heap.pop_back();
+  }
+  return !heap.empty();
+}
+
+bool TxnPool::insert(const Transaction& t) {
+  if (exist(t.GetTranID())) {
+    return false;
+  }
+
+  auto queue = m_senderQueues.find(t.GetSenderPubKey());
+  if (queue != m_senderQueues.end()) {
+    auto sameNonce = queue->second.find(t.GetNonce());
+    if (sameNonce != queue->second.end()) {
+      const Slot slot = sameNonce->second;
+      if (Before(MakeKey(t, 0, 0), MakeKey(m_slab[slot].m_txn, 0, 0))) {
+        Remove(slot);
+        Store(t);
+      }
+      return true;
+    }
+  }
+
+  if (size() >= m_capacity) {
+    if (!PruneTop<WorstOnTop>(m_worstHeap)) {
+      return false;
+    }
+
+    const GasKey& worst = m_worstHeap.front();
+    if (!Before(MakeKey(t, 0, 0), worst)) {
+      return false;
+    }
+
+    Remove(worst.m_slot);
+  }
+
+  Store(t);
+  return true;
+}
+
+bool TxnPool::findOne(Transaction& t,
+                      const function<uint128_t(const Address&)>& getNonce) {
+  while (!m_bestHeap.empty()) {
+    const GasKey key = m_bestHeap.front();
+    pop_heap(m_bestHeap.begin(), m_bestHeap.end(), BestOnTop());
+    m_bestHeap.pop_back();
+
+    if (!IsLive(key) || !IsHead(key.m_slot)) {
+      continue;
+    }
+
+    const Transaction& head = m_slab[key.m_slot].m_txn;
+    const uint128_t expected = getNonce(head.GetSenderAddr()) + 1;
+
+    if (head.GetNonce() > expected) {
+      // The sender cannot be served until the missing nonce arrives
+      m_blockedSenders.insert(head.GetSenderPubKey());
+      continue;
+    }
+
+    if (head.GetNonce() < expected) {
+      // Already applied, the next txn of the sender gets promoted
+      Remove(key.m_slot);
+      continue;
+    }
+
+    t = head;
+    Remove(key.m_slot);
+    return true;
+  }
+
+  return false;
+}
+
+void TxnPool::unblockSenders() {
+  for (const auto& sender : m_blockedSenders) {
+    auto queue = m_senderQueues.find(sender);
+    if (queue != m_senderQueues.end()) {
+      PushCandidate(queue->second.begin()->second);
+    }
+  }
+  m_blockedSenders.clear();
+}
@@ -17,129 +17,112 @@
  * program files.
  */
 
+#ifndef __TXNPOOL_H__
+#define __TXNPOOL_H__
+
 #include <functional>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include "common/Constants.h"
 #include "libData/AccountData/Transaction.h"
 
-struct TxnPool {
-  struct PubKeyNonceHash {
-    std::size_t operator()(
-        const std::pair<PubKey, boost::multiprecision::uint128_t>& p) const {
-      std::size_t seed = 0;
-      boost::hash_combine(seed, std::string(p.first));
-      boost::hash_combine(seed, p.second.convert_to<std::string>());
-
-      return seed;
-    }
-  };
-
-  std::unordered_map<TxnHash, Transaction> HashIndex;
-  std::map<boost::multiprecision::uint128_t, std::map<TxnHash, Transaction>,
-           std::greater<boost::multiprecision::uint128_t>>
-      GasIndex;
-  std::unordered_map<std::pair<PubKey, uint64_t>, Transaction, PubKeyNonceHash>
-      NonceIndex;
-
-  void clear() {
-    HashIndex.clear();
-    GasIndex.clear();
-    NonceIndex.clear();
+/// Pending transactions of a shard node. Each transaction is stored once in
+/// a slab and referred to by its slot from the other indexes:
+/// - the hash index, for lookups by transaction ID,
+/// - a queue per sender, ordered by nonce, holding one txn per nonce,
+/// - a heap on gas price over the head of each sender queue, to take the
+///   best executable txn,
+/// - a heap on gas price over all txns, to evict the worst one.
+/// Heap entries are removed lazily and skipped once their slot is reused or,
+/// for the first heap, once the txn is no longer the head of its queue.
+class TxnPool {
+ public:
+  explicit TxnPool(unsigned int capacity = TXN_POOL_CAPACITY);
+
+  void clear();
+
+  unsigned int size() const { return m_hashIndex.size(); }
+
+  bool exist(const TxnHash& th) const {
+    return m_hashIndex.find(th) != m_hashIndex.end();
   }
 
-  unsigned int size() { return HashIndex.size(); }
-
-  bool exist(const TxnHash& th) {
-    return HashIndex.find(th) != HashIndex.end();
-  }
-
-  bool get(const TxnHash& th, Transaction& t) {
-    if (!exist(th)) {
-      return false;
-    }
-    t = HashIndex.at(th);
-
-    return true;
-  }
+  bool get(const TxnHash& th, Transaction& t) const;
+
+  /// Adds a txn unless its ID is already pooled. A txn with the same sender
+  /// and nonce as a pooled one replaces it only if it pays a higher gas price
+  /// (or the same price with a lower ID). When the pool is full, the lowest
+  /// priced txn is evicted, or the new txn is refused if it is the lowest.
+  bool insert(const Transaction& t);
+
+  /// Removes the executable txn with the highest gas price (lowest ID among
+  /// equal prices) from the pool. A txn is executable when it is the head of
+  /// its sender queue and its nonce follows the account nonce returned by
+  /// getNonce. Heads with a lower nonce are dropped; senders whose head has a
+  /// higher nonce are skipped until unblockSenders is called.
+  bool findOne(Transaction& t,
+               const std::function<boost::multiprecision::uint128_t(
+                   const Address&)>& getNonce);
+
+  /// Makes the senders skipped by findOne candidates again. To be called when
+  /// a selection round ends.
+  void unblockSenders();
+
+ private:
+  using Slot = uint32_t;
+
+  struct Entry {
+    Transaction m_txn;
+    uint32_t m_generation = 0;
+    bool m_used = false;
+  };
 
-  bool insert(const Transaction& t) {
-    if (exist(t.GetTranID())) {
-      return false;
-    }
+  struct GasKey {
+    boost::multiprecision::uint128_t m_gasPrice;
+    TxnHash m_tranID;
+    Slot m_slot;
+    uint32_t m_generation;
+  };
 
-    auto searchNonce = NonceIndex.find({t.GetSenderPubKey(), t.GetNonce()});
-    if (searchNonce != NonceIndex.end()) {
-      if ((t.GetGasPrice() > searchNonce->second.GetGasPrice()) ||
-          (t.GetGasPrice() == searchNonce->second.GetGasPrice() &&
-           t.GetTranID() < searchNonce->second.GetTranID())) {
-        // erase from HashIdxTxns
-        auto searchHash = HashIndex.find(searchNonce->second.GetTranID());
-        if (searchHash != HashIndex.end()) {
-          HashIndex.erase(searchHash);
-        }
-        // erase from GasIdxTxns
-        auto searchGas = GasIndex.find(searchNonce->second.GetGasPrice());
-        if (searchGas != GasIndex.end()) {
-          auto searchGasHash =
-              searchGas->second.find(searchNonce->second.GetTranID());
-          if (searchGasHash != searchGas->second.end()) {
-            searchGas->second.erase(searchGasHash);
-          }
-        }
-        HashIndex[t.GetTranID()] = t;
-        GasIndex[t.GetGasPrice()][t.GetTranID()] = t;
-        searchNonce->second = t;
-      }
-    } else {
-      HashIndex[t.GetTranID()] = t;
-      GasIndex[t.GetGasPrice()][t.GetTranID()] = t;
-      NonceIndex[{t.GetSenderPubKey(), t.GetNonce()}] = t;
-    }
-    return true;
+  /// Orders the txn to be taken first before the others.
+  static bool Before(const GasKey& l, const GasKey& r) {
+    return (l.m_gasPrice > r.m_gasPrice) ||
+           ((l.m_gasPrice == r.m_gasPrice) && (l.m_tranID < r.m_tranID));
   }
-
-  void findSameNonceButHigherGas(Transaction& t) {
-    auto searchNonce = NonceIndex.find({t.GetSenderPubKey(), t.GetNonce()});
-    if (searchNonce != NonceIndex.end()) {
-      if (searchNonce->second.GetGasPrice() > t.GetGasPrice()) {
-        t = std::move(searchNonce->second);
-
-        // erase tx nonce map
-        NonceIndex.erase(searchNonce);
-        // erase tx gas map
-        GasIndex[t.GetGasPrice()].erase(t.GetTranID());
-        if (GasIndex[t.GetGasPrice()].empty()) {
-          GasIndex.erase(t.GetGasPrice());
-        }
-        // erase tx hash map
-        HashIndex.erase(t.GetTranID());
-      }
+  struct BestOnTop {
+    bool operator()(const GasKey& l, const GasKey& r) const {
+      return Before(r, l);
     }
-  }
-
-  bool findOne(Transaction& t) {
-    if (GasIndex.empty()) {
-      return false;
+  };
+  struct WorstOnTop {
+    bool operator()(const GasKey& l, const GasKey& r) const {
+      return Before(l, r);
     }
+  };
 
-    auto firstGas = GasIndex.begin();
-    auto firstHash = firstGas->second.begin();
-
-    if (firstHash != firstGas->second.end()) {
-      t = std::move(firstHash->second);
-
-      // erase tx gas map
-      firstGas->second.erase(firstHash);
-      if (firstGas->second.empty()) {
-        GasIndex.erase(firstGas);
-      }
-      // erase tx nonce map
-      NonceIndex.erase({t.GetSenderPubKey(), t.GetNonce()});
-      // erase tx hash m ap
-      HashIndex.erase(t.GetTranID());
-      return true;
-    }
-    return false;
-  }
-};
\ No newline at end of file
+  static GasKey MakeKey(const Transaction& t, Slot slot, uint32_t generation);
+  bool IsLive(const GasKey& key) const;
+  bool IsHead(Slot slot) const;
+  void PushCandidate(Slot slot);
+  Slot Store(const Transaction& t);
+  void Remove(Slot slot);
+  void Compact();
+
+  /// Drops stale entries from the top of the heap, returns false if empty.
+  template <typename Compare>
+  bool PruneTop(std::vector<GasKey>& heap);
+
+  unsigned int m_capacity;
+  std::vector<Entry> m_slab;
+  std::vector<Slot> m_freeSlots;
+  std::unordered_map<TxnHash, Slot> m_hashIndex;
+  std::unordered_map<PubKey, std::map<uint64_t, Slot>> m_senderQueues;
+  std::unordered_set<PubKey> m_blockedSenders;
+  std::vector<GasKey> m_bestHeap;
+  std::vector<GasKey> m_worstHeap;
+};
+
+#endif  // __TXNPOOL_H__
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include "VerifiedTxnCache.h"
+#include "common/Constants.h"
+
+using namespace std;
+
+VerifiedTxnCache::VerifiedTxnCache(unsigned int capacity)
+    : m_capacity(capacity) {}
+
+VerifiedTxnCache& VerifiedTxnCache::GetInstance() {
+  static VerifiedTxnCache cache(VERIFIED_TXN_CACHE_SIZE);
+  return cache;
+}
+
+bool VerifiedTxnCache::Contains(const TxnHash& tranID,
+                                const vector<unsigned char>& signature) const {
+  lock_guard<mutex> g(m_mutex);
+
+  auto it = m_signatures.find(tranID);
+  return (it != m_signatures.end()) && (it->second == signature);
+}
+
+void VerifiedTxnCache::Add(const TxnHash& tranID,
+                           const vector<unsigned char>& signature) {
+  if (m_capacity == 0) {
+    return;
+  }
+
+  lock_guard<mutex> g(m_mutex);
+
+  auto it = m_signatures.find(tranID);
+  if (it != m_signatures.end()) {
+    it->second = signature;
+    return;
+  }
+
+  while (m_order.size() >= m_capacity) {
+    m_signatures.erase(m_order.front());
+    m_order.pop_front();
+  }
+
+  m_signatures.emplace(tranID, signature);
+  m_order.emplace_back(tranID);
+}
+
+void VerifiedTxnCache::Clear() {
+  lock_guard<mutex> g(m_mutex);
+  m_signatures.clear();
+  m_order.clear();
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#ifndef __VERIFIEDTXNCACHE_H__
+#define __VERIFIEDTXNCACHE_H__
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "libData/AccountData/Transaction.h"
+
+/// Remembers the most recently verified txns, so that the same txn received
+/// again (e.g. as a missing txn or inside a forwarded block) is not put
+/// through signature verification twice. A txn is only known by its ID
+/// together with its serialized signature, since the signature is not
+/// covered by the ID. The oldest entries are dropped beyond the capacity.
+class VerifiedTxnCache {
+  mutable std::mutex m_mutex;
+  std::unordered_map<TxnHash, std::vector<unsigned char>> m_signatures;
+  std::deque<TxnHash> m_order;
+  const unsigned int m_capacity;
+
+  VerifiedTxnCache(unsigned int capacity);
+
+ public:
+  /// Returns the singleton VerifiedTxnCache instance.
+  static VerifiedTxnCache& GetInstance();
+
+  VerifiedTxnCache(const VerifiedTxnCache&) = delete;
+  VerifiedTxnCache& operator=(const VerifiedTxnCache&) = delete;
+
+  /// Returns true if the txn was verified with this signature before.
+  bool Contains(const TxnHash& tranID,
+                const std::vector<unsigned char>& signature) const;
+
+  /// Records a txn whose ID and signature have been verified.
+  void Add(const TxnHash& tranID, const std::vector<unsigned char>& signature);
+
+  void Clear();
+};
+
+#endif  // __VERIFIEDTXNCACHE_H__
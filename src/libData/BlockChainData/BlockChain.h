@@ -20,7 +20,11 @@
 #ifndef __BLOCKCHAIN_H__
 #define __BLOCKCHAIN_H__
 
+#include <atomic>
+#include <list>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 
 #pragma GCC diagnostic push
@@ -28,29 +32,139 @@
 #include <boost/multiprecision/cpp_int.hpp>
 #pragma GCC diagnostic pop
 
+#include "libData/BlockChainData/BlockStatsIndex.h"
 #include "libData/BlockData/Block/DSBlock.h"
 #include "libData/DataStructures/CircularArray.h"
 #include "libPersistence/BlockStorage.h"
 
+inline void AddToStats(BlockStatsIndex& stats, const TxBlock& block) {
+  const TxBlockHeader& header = block.GetHeader();
+  stats.Add(header.GetBlockNum(), block.GetTimestamp(), header.GetNumTxs(),
+            header.GetGasUsed(), header.GetDSBlockNum());
+}
+
+inline void AddToStats(BlockStatsIndex& stats, const DSBlock& block) {
+  stats.Add(block.GetHeader().GetBlockNum(), block.GetTimestamp());
+}
+
+template <class T>
+void AddToStats([[gnu::unused]] BlockStatsIndex& stats,
+                [[gnu::unused]] const T& block) {}
+
 /// Transient storage for DS/Tx/ Blocks. The block should have function
 /// .GetHeader().GetBlockNum()
+/// Blocks are immutable once added and are handed out as shared pointers, so
+/// readers never copy them. The last block can be read without locking.
 template <class T>
 class BlockChain {
+  using BlockPtr = std::shared_ptr<const T>;
+  using CacheEntry = std::pair<uint64_t, BlockPtr>;
+
   std::mutex m_mutexBlocks;
-  CircularArray<T> m_blocks;
+  CircularArray<BlockPtr> m_blocks;
+
+  /// Last added block, only accessed through std::atomic_load/atomic_store
+  BlockPtr m_lastBlock;
+
+  /// Most recently read blocks older than the ones in m_blocks, latest first
+  std::mutex m_mutexCache;
+  std::list<CacheEntry> m_cache;
+  std::unordered_map<uint64_t, typename std::list<CacheEntry>::iterator>
+      m_cacheIndex;
+
+  /// Cumulative counters of the blocks added since the last Reset, continuing
+  /// the stored ones of the blocks before
+  BlockStatsIndex m_stats;
+
+  /// Shared default block, returned where a dummy block used to be
+  static const BlockPtr& DummyBlock() {
+    static const BlockPtr dummy = std::make_shared<const T>();
+    return dummy;
+  }
+
+  BlockPtr GetOlderBlock(const uint64_t& blockNum) {
+    {
+      std::lock_guard<std::mutex> g(m_mutexCache);
+      auto it = m_cacheIndex.find(blockNum);
+      if (it != m_cacheIndex.end()) {
+        m_cache.splice(m_cache.begin(), m_cache, it->second);
+        return it->second->second;
+      }
+    }
+
+    BlockPtr block = GetBlockFromPersistentStorage(blockNum);
+    if (!block) {
+      LOG_GENERAL(WARNING, "Block " << blockNum
+                                    << " not found, a dummy block is used");
+      return DummyBlock();
+    }
+
+    std::lock_guard<std::mutex> g(m_mutexCache);
+    if (m_cacheIndex.find(blockNum) == m_cacheIndex.end()) {
+      m_cache.emplace_front(blockNum, block);
+      m_cacheIndex[blockNum] = m_cache.begin();
+      if (m_cache.size() > BLOCKCHAIN_CACHE_SIZE) {
+        m_cacheIndex.erase(m_cache.back().first);
+        m_cache.pop_back();
+      }
+    }
+    return block;
+  }
 
  protected:
   /// Constructor.
   BlockChain() { Reset(); }
 
-  virtual T GetBlockFromPersistentStorage(const uint64_t& blockNum) = 0;
+  /// Returns nullptr if the block isn't stored.
+  virtual BlockPtr GetBlockFromPersistentStorage(const uint64_t& blockNum) = 0;
+
+  /// Stores the stats entry of a block, for chains that keep them.
+  virtual void PutStatsToPersistentStorage(
+      [[gnu::unused]] const uint64_t& blockNum,
+      [[gnu::unused]] const BlockStatsIndex::Entry& entry) {}
+
+  /// Returns false if the stats entry of the block isn't stored.
+  virtual bool GetStatsFromPersistentStorage(
+      [[gnu::unused]] const uint64_t& blockNum,
+      [[gnu::unused]] BlockStatsIndex::Entry& entry) {
+    return false;
+  }
 
  public:
   /// Destructor.
   ~BlockChain() {}
 
-  /// Reset
-  void Reset() { m_blocks.resize(BLOCKCHAIN_SIZE); }
+  /// Reset. Blocks before firstBlockNum are counted as present and are
+  /// fetched from persistent storage when read. The stats continue from the
+  /// stored entry of the block before firstBlockNum, if any.
+  void Reset(const uint64_t& firstBlockNum = 0) {
+    {
+      std::lock_guard<std::mutex> g(m_mutexBlocks);
+      m_blocks.resize(BLOCKCHAIN_SIZE);
+      for (unsigned int i = 0; i < BLOCKCHAIN_SIZE; i++) {
+        m_blocks[i] = DummyBlock();
+      }
+      m_blocks.skip(firstBlockNum);
+      std::atomic_store(&m_lastBlock, DummyBlock());
+    }
+
+    {
+      std::lock_guard<std::mutex> g(m_mutexCache);
+      m_cache.clear();
+      m_cacheIndex.clear();
+    }
+
+    m_stats.Reset();
+
+    BlockStatsIndex::Entry entry{};
+    if (firstBlockNum > 0 &&
+        GetStatsFromPersistentStorage(firstBlockNum - 1, entry)) {
+      m_stats.Seed(firstBlockNum - 1, entry);
+    }
+  }
+
+  /// Returns the cumulative per-block counters.
+  const BlockStatsIndex& GetStats() const { return m_stats; }
 
   /// Returns the number of blocks.
   uint64_t GetBlockCount() {
@@ -58,57 +172,94 @@ class BlockChain {
     return m_blocks.size();
   }
 
-  /// Returns the last stored block.
-  T GetLastBlock() {
-    std::lock_guard<std::mutex> g(m_mutexBlocks);
-    try {
-      return m_blocks.back();
-    } catch (...) {
-      return T();
-    }
-  }
+  /// Returns the last stored block without taking the chain lock.
+  BlockPtr GetLastBlockPtr() const { return std::atomic_load(&m_lastBlock); }
+
+  /// Returns a copy of the last stored block.
+  T GetLastBlock() const { return *GetLastBlockPtr(); }
 
   /// Returns the block at the specified block number.
-  T GetBlock(const uint64_t& blockNum) {
-    std::lock_guard<std::mutex> g(m_mutexBlocks);
+  BlockPtr GetBlockPtr(const uint64_t& blockNum) {
+    {
+      std::lock_guard<std::mutex> g(m_mutexBlocks);
+
+      if (m_blocks.size() > 0 &&
+          (m_blocks.back()->GetHeader().GetBlockNum() < blockNum)) {
+        LOG_GENERAL(WARNING,
+                    "BlockNum too high " << blockNum << " Dummy block used");
+        return DummyBlock();
+      }
 
-    if (m_blocks.size() > 0 &&
-        (m_blocks.back().GetHeader().GetBlockNum() < blockNum)) {
-      LOG_GENERAL(WARNING,
-                  "BlockNum too high " << blockNum << " Dummy block used");
-      return T();
+      if (blockNum + m_blocks.capacity() >= m_blocks.size()) {
+        const BlockPtr& block = m_blocks[blockNum];
+        if (block->GetHeader().GetBlockNum() != blockNum) {
+          LOG_GENERAL(WARNING,
+                      "BlockNum : " << blockNum << " != GetBlockNum() : "
+                                    << block->GetHeader().GetBlockNum()
+                                    << ", a dummy block will be used and "
+                                       "abnormal behavior may happen!");
+          return DummyBlock();
+        }
+        return block;
+      }
     }
 
-    else if (blockNum + m_blocks.capacity() < m_blocks.size()) {
-      return GetBlockFromPersistentStorage(blockNum);
+    return GetOlderBlock(blockNum);
+  }
+
+  /// Returns a copy of the block at the specified block number.
+  T GetBlock(const uint64_t& blockNum) { return *GetBlockPtr(blockNum); }
+
+  /// Returns the timestamp of the block, read from the stats if indexed or
+  /// stored.
+  uint64_t GetBlockTimestamp(const uint64_t& blockNum) {
+    uint64_t timestamp = 0;
+    if (m_stats.GetTimestamp(blockNum, timestamp)) {
+      return timestamp;
     }
 
-    if (m_blocks[blockNum].GetHeader().GetBlockNum() != blockNum) {
-      LOG_GENERAL(WARNING,
-                  "BlockNum : " << blockNum << " != GetBlockNum() : "
-                                << m_blocks[blockNum].GetHeader().GetBlockNum()
-                                << ", a dummy block will be used and abnormal "
-                                   "behavior may happen!");
-      return T();
+    BlockStatsIndex::Entry entry{};
+    if (GetStatsFromPersistentStorage(blockNum, entry)) {
+      return entry.m_timestamp;
     }
-    return m_blocks[blockNum];
+    return GetBlockPtr(blockNum)->GetTimestamp();
   }
+
   /// Adds a block to the chain.
   int AddBlock(const T& block) {
     uint64_t blockNumOfNewBlock = block.GetHeader().GetBlockNum();
+    BlockPtr newBlock = std::make_shared<const T>(block);
+    BlockStatsIndex::Entry entry{};
+    bool isIndexed = false;
 
-    std::lock_guard<std::mutex> g(m_mutexBlocks);
+    {
+      std::lock_guard<std::mutex> g(m_mutexBlocks);
+
+      uint64_t blockNumOfExistingBlock =
+          m_blocks[blockNumOfNewBlock]->GetHeader().GetBlockNum();
 
-    uint64_t blockNumOfExistingBlock =
-        m_blocks[blockNumOfNewBlock].GetHeader().GetBlockNum();
+      if (blockNumOfExistingBlock < blockNumOfNewBlock ||
+          INIT_BLOCK_NUMBER == blockNumOfExistingBlock) {
+        m_blocks.insert_new(blockNumOfNewBlock, newBlock);
+        std::atomic_store(&m_lastBlock, newBlock);
+        AddToStats(m_stats, block);
+        isIndexed = m_stats.GetEntry(blockNumOfNewBlock, entry);
+      } else {
+        LOG_GENERAL(WARNING, "Failed to add " << blockNumOfNewBlock << " "
+                                              << blockNumOfExistingBlock);
+        return -1;
+      }
+    }
+
+    if (isIndexed) {
+      PutStatsToPersistentStorage(blockNumOfNewBlock, entry);
+    }
 
-    if (blockNumOfExistingBlock < blockNumOfNewBlock ||
-        INIT_BLOCK_NUMBER == blockNumOfExistingBlock) {
-      m_blocks.insert_new(blockNumOfNewBlock, block);
-    } else {
-      LOG_GENERAL(WARNING, "Failed to add " << blockNumOfNewBlock << " "
-                                            << blockNumOfExistingBlock);
-      return -1;
+    std::lock_guard<std::mutex> g(m_mutexCache);
+    auto it = m_cacheIndex.find(blockNumOfNewBlock);
+    if (it != m_cacheIndex.end()) {
+      m_cache.erase(it->second);
+      m_cacheIndex.erase(it);
     }
 
     return 1;
@@ -117,25 +268,62 @@ class BlockChain {
 
 class DSBlockChain : public BlockChain<DSBlock> {
  public:
-  DSBlock GetBlockFromPersistentStorage(const uint64_t& blockNum) {
+  std::shared_ptr<const DSBlock> GetBlockFromPersistentStorage(
+      const uint64_t& blockNum) {
     DSBlockSharedPtr block;
-    BlockStorage::GetBlockStorage().GetDSBlock(blockNum, block);
-    return *block;
+    if (!BlockStorage::GetBlockStorage().GetDSBlock(blockNum, block)) {
+      return nullptr;
+    }
+    return block;
   }
 };
 
 class TxBlockChain : public BlockChain<TxBlock> {
  public:
-  TxBlock GetBlockFromPersistentStorage(const uint64_t& blockNum) {
+  std::shared_ptr<const TxBlock> GetBlockFromPersistentStorage(
+      const uint64_t& blockNum) {
     TxBlockSharedPtr block;
-    BlockStorage::GetBlockStorage().GetTxBlock(blockNum, block);
-    return *block;
+    if (!BlockStorage::GetBlockStorage().GetTxBlock(blockNum, block)) {
+      return nullptr;
+    }
+    return block;
+  }
+
+  void PutStatsToPersistentStorage(const uint64_t& blockNum,
+                                   const BlockStatsIndex::Entry& entry) {
+    std::vector<unsigned char> stats;
+    entry.Serialize(stats);
+    BlockStorage::GetBlockStorage().PutTxBlockStats(blockNum, stats);
+  }
+
+  bool GetStatsFromPersistentStorage(const uint64_t& blockNum,
+                                     BlockStatsIndex::Entry& entry) {
+    std::vector<unsigned char> stats;
+    return BlockStorage::GetBlockStorage().GetTxBlockStats(blockNum, stats) &&
+           entry.Deserialize(stats);
+  }
+
+  /// Returns the number of txns in the blocks after blockNum.
+  uint64_t GetNumTxsAfter(const uint64_t& blockNum) {
+    const BlockStatsIndex& stats = GetStats();
+    uint64_t res = stats.GetNumTxsAfter(blockNum);
+
+    // The counters of a block before the indexed ones are stored with it
+    uint64_t firstBlockNum = 0, lastBlockNum = 0;
+    BlockStatsIndex::Entry entry{};
+    if (stats.GetRange(firstBlockNum, lastBlockNum) &&
+        blockNum < firstBlockNum &&
+        GetStatsFromPersistentStorage(blockNum, entry) &&
+        entry.m_cumNumTxs <= res) {
+      res -= entry.m_cumNumTxs;
+    }
+    return res;
   }
 };
 
 class VCBlockChain : public BlockChain<VCBlock> {
  public:
-  VCBlock GetBlockFromPersistentStorage([
+  std::shared_ptr<const VCBlock> GetBlockFromPersistentStorage([
       [gnu::unused]] const uint64_t& blockNum) {
     throw "vc block persistent storage not supported";
   }
@@ -143,7 +331,7 @@ class VCBlockChain : public BlockChain<VCBlock> {
 
 class FallbackBlockChain : public BlockChain<FallbackBlock> {
  public:
-  FallbackBlock GetBlockFromPersistentStorage([
+  std::shared_ptr<const FallbackBlock> GetBlockFromPersistentStorage([
       [gnu::unused]] const uint64_t& blockNum) {
     throw "fallback block persistent storage not supported";
   }
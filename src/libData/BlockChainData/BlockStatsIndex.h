@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#ifndef __BLOCKSTATSINDEX_H__
+#define __BLOCKSTATSINDEX_H__
+
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#include <boost/multiprecision/cpp_int.hpp>
+#pragma GCC diagnostic pop
+
+#include "common/Constants.h"
+#include "common/Serializable.h"
+#include "libUtils/Logger.h"
+
+/// Cumulative per-block counters, appended once when a block is committed so
+/// that range and rate queries over the chain don't walk the blocks.
+/// Covers the contiguous run of blocks starting at the first one added, or at
+/// the seeded one, whose counters the later blocks continue.
+class BlockStatsIndex {
+ public:
+  struct Entry {
+    static const unsigned int SIZE =
+        sizeof(uint64_t) + UINT128_SIZE + 3 * sizeof(uint64_t);
+
+    /// Counters summed over all counted blocks up to and including this one
+    uint64_t m_cumNumTxs;
+    boost::multiprecision::uint128_t m_cumGasUsed;
+    uint64_t m_timestamp;
+    uint64_t m_dsBlockNum;
+    /// m_cumNumTxs of the last block before the DS epoch of this one
+    uint64_t m_dsEpochStartNumTxs;
+
+    void Serialize(std::vector<unsigned char>& dst) const {
+      unsigned int offset = 0;
+      dst.clear();
+      Serializable::SetNumber<uint64_t>(dst, offset, m_cumNumTxs,
+                                        sizeof(uint64_t));
+      offset += sizeof(uint64_t);
+      Serializable::SetNumber<boost::multiprecision::uint128_t>(
+          dst, offset, m_cumGasUsed, UINT128_SIZE);
+      offset += UINT128_SIZE;
+      for (const auto& n : {m_timestamp, m_dsBlockNum, m_dsEpochStartNumTxs}) {
+        Serializable::SetNumber<uint64_t>(dst, offset, n, sizeof(uint64_t));
+        offset += sizeof(uint64_t);
+      }
+    }
+
+    bool Deserialize(const std::vector<unsigned char>& src) {
+      if (src.size() != SIZE) {
+        return false;
+      }
+      unsigned int offset = 0;
+      m_cumNumTxs =
+          Serializable::GetNumber<uint64_t>(src, offset, sizeof(uint64_t));
+      offset += sizeof(uint64_t);
+      m_cumGasUsed = Serializable::GetNumber<boost::multiprecision::uint128_t>(
+          src, offset, UINT128_SIZE);
+      offset += UINT128_SIZE;
+      for (uint64_t* n : {&m_timestamp, &m_dsBlockNum, &m_dsEpochStartNumTxs}) {
+        *n = Serializable::GetNumber<uint64_t>(src, offset, sizeof(uint64_t));
+        offset += sizeof(uint64_t);
+      }
+      return true;
+    }
+  };
+
+ private:
+
+  mutable std::shared_timed_mutex m_mutex;
+  uint64_t m_firstBlockNum{0};
+  std::vector<Entry> m_entries;
+
+  bool Covers(const uint64_t& blockNum) const {
+    return blockNum >= m_firstBlockNum &&
+           blockNum - m_firstBlockNum < m_entries.size();
+  }
+
+  const Entry& At(const uint64_t& blockNum) const {
+    return m_entries[blockNum - m_firstBlockNum];
+  }
+
+  uint64_t LastBlockNum() const {
+    return m_firstBlockNum + m_entries.size() - 1;
+  }
+
+ public:
+  /// Drops all entries.
+  void Reset() {
+    std::unique_lock<std::shared_timed_mutex> g(m_mutex);
+    m_firstBlockNum = 0;
+    m_entries.clear();
+  }
+
+  /// Drops all entries but the given one of a block already counted, so that
+  /// the next block added continues its counters.
+  void Seed(const uint64_t& blockNum, const Entry& entry) {
+    std::unique_lock<std::shared_timed_mutex> g(m_mutex);
+    m_firstBlockNum = blockNum;
+    m_entries.assign(1, entry);
+  }
+
+  /// Records a committed block. A block number already indexed rewrites the
+  /// chain from there on, and a gap restarts the index at the new block.
+  void Add(const uint64_t& blockNum, const uint64_t& timestamp,
+           const uint32_t& numTxs = 0, const uint64_t& gasUsed = 0,
+           const uint64_t& dsBlockNum = 0) {
+    std::unique_lock<std::shared_timed_mutex> g(m_mutex);
+
+    if (!m_entries.empty() && blockNum > m_firstBlockNum &&
+        blockNum <= LastBlockNum()) {
+      m_entries.resize(blockNum - m_firstBlockNum);
+    } else if (m_entries.empty() || blockNum != LastBlockNum() + 1) {
+      if (!m_entries.empty()) {
+        LOG_GENERAL(INFO, "Block stats restarted at " << blockNum
+                                                      << ", last indexed "
+                                                      << LastBlockNum());
+      }
+      m_firstBlockNum = blockNum;
+      m_entries.clear();
+    }
+
+    Entry entry{numTxs, gasUsed, timestamp, dsBlockNum, 0};
+    if (!m_entries.empty()) {
+      const Entry& prev = m_entries.back();
+      entry.m_cumNumTxs += prev.m_cumNumTxs;
+      entry.m_cumGasUsed += prev.m_cumGasUsed;
+      entry.m_dsEpochStartNumTxs = (prev.m_dsBlockNum == dsBlockNum)
+                                       ? prev.m_dsEpochStartNumTxs
+                                       : prev.m_cumNumTxs;
+    }
+    m_entries.emplace_back(entry);
+  }
+
+  /// Returns false if the block isn't indexed.
+  bool GetEntry(const uint64_t& blockNum, Entry& entry) const {
+    std::shared_lock<std::shared_timed_mutex> g(m_mutex);
+    if (!Covers(blockNum)) {
+      return false;
+    }
+    entry = At(blockNum);
+    return true;
+  }
+
+  /// Returns false if nothing has been indexed yet.
+  bool GetRange(uint64_t& firstBlockNum, uint64_t& lastBlockNum) const {
+    std::shared_lock<std::shared_timed_mutex> g(m_mutex);
+    if (m_entries.empty()) {
+      return false;
+    }
+    firstBlockNum = m_firstBlockNum;
+    lastBlockNum = LastBlockNum();
+    return true;
+  }
+
+  /// Returns the number of txns in the counted blocks after blockNum.
+  uint64_t GetNumTxsAfter(const uint64_t& blockNum) const {
+    std::shared_lock<std::shared_timed_mutex> g(m_mutex);
+    if (m_entries.empty() || blockNum >= LastBlockNum()) {
+      return 0;
+    }
+    uint64_t total = m_entries.back().m_cumNumTxs;
+    return Covers(blockNum) ? total - At(blockNum).m_cumNumTxs : total;
+  }
+
+  /// Returns the gas used by the counted blocks after blockNum.
+  boost::multiprecision::uint128_t GetGasUsedAfter(
+      const uint64_t& blockNum) const {
+    std::shared_lock<std::shared_timed_mutex> g(m_mutex);
+    if (m_entries.empty() || blockNum >= LastBlockNum()) {
+      return 0;
+    }
+    const boost::multiprecision::uint128_t& total =
+        m_entries.back().m_cumGasUsed;
+    return Covers(blockNum) ? total - At(blockNum).m_cumGasUsed : total;
+  }
+
+  /// Returns false if the block isn't indexed.
+  bool GetTimestamp(const uint64_t& blockNum, uint64_t& timestamp) const {
+    std::shared_lock<std::shared_timed_mutex> g(m_mutex);
+    if (!Covers(blockNum)) {
+      return false;
+    }
+    timestamp = At(blockNum).m_timestamp;
+    return true;
+  }
+
+  /// Returns the number of txns in the counted blocks sharing the DS block
+  /// number of the last block.
+  uint64_t GetNumTxsInLastDSEpoch() const {
+    std::shared_lock<std::shared_timed_mutex> g(m_mutex);
+    if (m_entries.empty()) {
+      return 0;
+    }
+    const Entry& last = m_entries.back();
+    return last.m_cumNumTxs - last.m_dsEpochStartNumTxs;
+  }
+};
+
+#endif  // __BLOCKSTATSINDEX_H__
@@ -95,6 +95,10 @@ class CircularArray {
     return m_array[m_index];
   }
 
+  /// Counts the first count elements of the sequence as stored, without
+  /// inserting them. Used when only the tail of a sequence is loaded.
+  void skip(uint64_t count) { m_size += count; }
+
   /// Returns the number of elements stored till now in the array.
   uint64_t size() { return m_size; }
 
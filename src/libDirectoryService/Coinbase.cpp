@@ -309,7 +309,7 @@ void DirectoryService::InitCoinbase() {
   LOG_GENERAL(INFO, "Left reward: " << balance_left);
 
   uint16_t lastBlockHash = DataConversion::charArrTo16Bits(
-      m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes());
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes());
   uint16_t shardIndex =
       lastBlockHash % m_coinbaseRewardees[m_mediator.m_currentEpochNum].size();
   uint16_t count = 0;
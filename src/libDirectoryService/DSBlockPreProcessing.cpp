@@ -20,6 +20,8 @@
 #include <algorithm>
 #include <chrono>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "DirectoryService.h"
 #include "common/Constants.h"
@@ -390,11 +392,10 @@ bool DirectoryService::VerifyPoWOrdering(
     const DequeOfShard& shards, const MapOfPubKeyPoW& allPoWsFromTheLeader) {
   // Requires mutex for m_shards
   vector<unsigned char> lastBlockHash(BLOCK_HASH_SIZE, 0);
-  set<PubKey> keyset;
 
   if (m_mediator.m_currentEpochNum > 1) {
     lastBlockHash =
-        m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes();
+        m_mediator.m_txBlockChain.GetLastBlockPtr()->GetBlockHash().asBytes();
   }
 
   const float MISORDER_TOLERANCE =
@@ -417,23 +418,46 @@ bool DirectoryService::VerifyPoWOrdering(
     }
   }
 
+  uint32_t misorderNodes = 0;
+  bool ret = VerifyPoWOrderingCore(shards, sortedPoWSolns, allPoWsFromTheLeader,
+                                   lastBlockHash, misorderNodes);
+
+  if (misorderNodes > MAX_MISORDER_NODE) {
+    LOG_EPOCH(WARNING, to_string(m_mediator.m_currentEpochNum).c_str(),
+              "Failed to Verify due to bad PoW ordering count "
+                  << misorderNodes << " "
+                  << "exceed limit " << MAX_MISORDER_NODE);
+    return false;
+  }
+  return ret;
+}
+
+bool DirectoryService::VerifyPoWOrderingCore(
+    const DequeOfShard& shards, const VectorOfPoWSoln& sortedPoWSolns,
+    const MapOfPubKeyPoW& allPoWsFromTheLeader,
+    const vector<unsigned char>& lastBlockHash, uint32_t& misorderNodes) {
+  // Index the solutions once instead of searching them for every shard node
+  unordered_map<PubKey, const array<unsigned char, 32>*> soln_index;
+  soln_index.reserve(sortedPoWSolns.size());
+  for (const auto& soln : sortedPoWSolns) {
+    soln_index.emplace(soln.second, &soln.first);
+  }
+
+  unordered_set<PubKey> keyset;
+  keyset.reserve(soln_index.size());
+
   vector<unsigned char> hashVec(BLOCK_HASH_SIZE + BLOCK_HASH_SIZE);
   std::copy(lastBlockHash.begin(), lastBlockHash.end(), hashVec.begin());
   bool ret = true;
   vector<unsigned char> vec(BLOCK_HASH_SIZE), preVec(BLOCK_HASH_SIZE);
-  uint32_t misorderNodes = 0;
+  misorderNodes = 0;
   for (const auto& shard : shards) {
     for (const auto& shardNode : shard) {
       const PubKey& toFind = std::get<SHARD_NODE_PUBKEY>(shardNode);
-      auto it = std::find_if(
-          sortedPoWSolns.cbegin(), sortedPoWSolns.cend(),
-          [&toFind](
-              const std::pair<std::array<unsigned char, 32>, PubKey>& item) {
-            return item.second == toFind;
-          });
-
-      std::array<unsigned char, 32> result;
-      if (it == sortedPoWSolns.cend()) {
+      auto it = soln_index.find(toFind);
+
+      const array<unsigned char, 32>* result = nullptr;
+      if (it == soln_index.end()) {
         LOG_GENERAL(WARNING, "Failed to find key in the PoW ordering "
                                  << toFind << " " << sortedPoWSolns.size());
 
@@ -444,7 +468,7 @@ bool DirectoryService::VerifyPoWOrdering(
         if (itLeaderMap != allPoWsFromTheLeader.end()) {
           LOG_GENERAL(INFO,
                       "TODO: Verify the PoW submission for this unknown node.");
-          result = itLeaderMap->second.result;
+          result = &itLeaderMap->second.result;
         } else {
           LOG_GENERAL(INFO, "Key also not in the PoWs in the announcement.");
           ret = false;
@@ -454,24 +478,25 @@ bool DirectoryService::VerifyPoWOrdering(
           break;
         }
       } else {
-        result = it->first;
+        result = it->second;
       }
 
-      auto r = keyset.insert(std::get<SHARD_NODE_PUBKEY>(shardNode));
+      auto r = keyset.insert(toFind);
       if (!r.second) {
-        LOG_GENERAL(WARNING, "The key is not unique in the sharding structure "
-                                 << std::get<SHARD_NODE_PUBKEY>(shardNode));
+        LOG_GENERAL(WARNING,
+                    "The key is not unique in the sharding structure "
+                        << toFind);
         ret = false;
         break;
       }
 
-      copy(result.begin(), result.end(), hashVec.begin() + BLOCK_HASH_SIZE);
+      copy(result->begin(), result->end(), hashVec.begin() + BLOCK_HASH_SIZE);
       const vector<unsigned char>& sortHashVec =
           HashUtils::BytesToHash(hashVec);
       if (DEBUG_LEVEL >= 5) {
         LOG_GENERAL(INFO, "[DSSORT]"
                               << DataConversion::Uint8VecToHexStr(sortHashVec)
-                              << " " << std::get<SHARD_NODE_PUBKEY>(shardNode));
+                              << " " << toFind);
       }
       if (sortHashVec < vec) {
         LOG_GENERAL(WARNING,
@@ -493,13 +518,6 @@ bool DirectoryService::VerifyPoWOrdering(
     }
   }
 
-  if (misorderNodes > MAX_MISORDER_NODE) {
-    LOG_EPOCH(WARNING, to_string(m_mediator.m_currentEpochNum).c_str(),
-              "Failed to Verify due to bad PoW ordering count "
-                  << misorderNodes << " "
-                  << "exceed limit " << MAX_MISORDER_NODE);
-    return false;
-  }
   return ret;
 }
 
@@ -638,47 +656,72 @@ void DirectoryService::ComputeTxnSharingAssignments(
 
 VectorOfPoWSoln DirectoryService::SortPoWSoln(const MapOfPubKeyPoW& mapOfPoWs,
                                               bool trimBeyondCommSize) {
-  std::map<array<unsigned char, 32>, PubKey> PoWOrderSorter;
+  function<bool(const PubKey&)> isShardGuard;
+  if (GUARD_MODE) {
+    isShardGuard = [](const PubKey& pubKey) {
+      return Guard::GetInstance().IsNodeInShardGuardList(pubKey);
+    };
+  }
+  return SortAndTrimPoWSoln(mapOfPoWs, trimBeyondCommSize ? COMM_SIZE : 0,
+                            isShardGuard);
+}
+
+VectorOfPoWSoln DirectoryService::SortAndTrimPoWSoln(
+    const MapOfPubKeyPoW& mapOfPoWs, unsigned int commSize,
+    const function<bool(const PubKey&)>& isShardGuard) {
+  // Sort once by solution. The stable sort keeps the map's key order within
+  // equal solutions, and only the last of them is kept, as a map keyed by the
+  // solution would.
+  VectorOfPoWSoln PoWOrderSorter;
+  PoWOrderSorter.reserve(mapOfPoWs.size());
   for (const auto& powsoln : mapOfPoWs) {
-    PoWOrderSorter[powsoln.second.result] = powsoln.first;
+    PoWOrderSorter.emplace_back(powsoln.second.result, powsoln.first);
+  }
+  auto bySoln = [](const VectorOfPoWSoln::value_type& lhs,
+                   const VectorOfPoWSoln::value_type& rhs) {
+    return lhs.first < rhs.first;
+  };
+  stable_sort(PoWOrderSorter.begin(), PoWOrderSorter.end(), bySoln);
+  auto last = PoWOrderSorter.begin();
+  for (auto it = PoWOrderSorter.begin(); it != PoWOrderSorter.end(); it++) {
+    if (last != PoWOrderSorter.begin() && (last - 1)->first == it->first) {
+      *(last - 1) = move(*it);
+    } else {
+      if (last != it) {
+        *last = move(*it);
+      }
+      last++;
+    }
   }
+  PoWOrderSorter.erase(last, PoWOrderSorter.end());
 
   // Put it back to vector for easy manipulation and adjustment of the ordering
   VectorOfPoWSoln sortedPoWSolns;
-  if (trimBeyondCommSize && (COMM_SIZE > 0)) {
+  if (commSize > 0) {
     const unsigned int numNodesTotal = PoWOrderSorter.size();
     const unsigned int numNodesTrimmed =
-        (numNodesTotal < COMM_SIZE)
+        (numNodesTotal < commSize)
             ? numNodesTotal
-            : numNodesTotal - (numNodesTotal % COMM_SIZE);
+            : numNodesTotal - (numNodesTotal % commSize);
 
     LOG_GENERAL(INFO, "Trimming the solutions sorted list from "
                           << numNodesTotal << " to " << numNodesTrimmed
-                          << " to avoid going over COMM_SIZE " << COMM_SIZE);
-
-    unsigned int count = 0;
-    if (!GUARD_MODE) {
-      for (auto kv = PoWOrderSorter.begin();
-           (kv != PoWOrderSorter.end()) && (count < numNodesTrimmed);
-           kv++, count++) {
-        sortedPoWSolns.emplace_back(*kv);
-      }
+                          << " to avoid going over COMM_SIZE " << commSize);
+
+    if (!isShardGuard) {
+      sortedPoWSolns.assign(PoWOrderSorter.begin(),
+                            PoWOrderSorter.begin() + numNodesTrimmed);
     } else {
       // If total num of shard nodes to be trim, ensure shard guards do not get
-      // trimmed. To do it, a new map  will be created to included all shard
-      // guards and a subset of normal shard nods
+      // trimmed. To do it, shard guards and a subset of normal shard nodes are
+      // picked from the sorted solutions
       // Steps:
-      // 1. Maintain a map that called "FilteredPoWOrderSorter". It will
-      // eventually contains Shard guards + subset of normal nodes
-      // 2. Maintain a shadow copy of "PoWOrderSorter" called
-      // "ShadowPoWOrderSorter". It is to track non guards node.
-      // 3. Add shard guards to "FilteredPoWOrderSorter" ands remove it from
+      // 1. Walk the sorted solutions, putting shard guards into
+      // "FilteredPoWOrderSorter" up to the allowed count. Every other
+      // solution goes to "ShadowPoWOrderSorter", which stays sorted.
+      // 2. If there are still slots left, fill them from the front of
       // "ShadowPoWOrderSorter"
-      // 4. If there are still slots left, obtained remaining normal shard node
-      // from "ShadowPoWOrderSorter". Use it to populate
-      // "FilteredPoWOrderSorter"
-      // 5. Finally, sort "FilteredPoWOrderSorter" and stored result in
-      // "PoWOrderSorter"
+      // 3. Finally, merge both sorted lists into "sortedPoWSolns"
       unsigned int trimmedGuardCount =
           ceil(numNodesTrimmed * ConsensusCommon::TOLERANCE_FRACTION);
       unsigned int trimmedNonGuardCount = numNodesTrimmed - trimmedGuardCount;
@@ -691,41 +734,39 @@ VectorOfPoWSoln DirectoryService::SortPoWSoln(const MapOfPubKeyPoW& mapOfPoWs,
             (numNodesTrimmed - trimmedGuardCount - trimmedNonGuardCount);
       }
 
-      // Assign all shard guards first
-      std::map<array<unsigned char, 32>, PubKey> FilteredPoWOrderSorter;
-      std::map<array<unsigned char, 32>, PubKey> ShadowPoWOrderSorter =
-          PoWOrderSorter;
+      VectorOfPoWSoln FilteredPoWOrderSorter;
+      VectorOfPoWSoln ShadowPoWOrderSorter;
+      ShadowPoWOrderSorter.reserve(PoWOrderSorter.size());
 
-      // Add shard guards to "FilteredPoWOrderSorter"
-      // Remove it from "ShadowPoWOrderSorter"
-      for (auto kv = PoWOrderSorter.begin();
-           (kv != PoWOrderSorter.end()) && (count < numNodesTrimmed); kv++) {
-        if (Guard::GetInstance().IsNodeInShardGuardList(kv->second)) {
+      unsigned int count = 0;
+      bool guardsFull = false;
+      for (const auto& kv : PoWOrderSorter) {
+        if (!guardsFull && count < numNodesTrimmed &&
+            isShardGuard(kv.second)) {
           if (count == trimmedGuardCount) {
             LOG_GENERAL(
                 INFO,
                 "Did not manage to form max number of shard. Only allowed "
                     << trimmedGuardCount << " shard guards");
-            break;
+            guardsFull = true;
+          } else {
+            FilteredPoWOrderSorter.emplace_back(kv);
+            count++;
+            continue;
           }
-          FilteredPoWOrderSorter.emplace(*kv);
-          ShadowPoWOrderSorter.erase(kv->first);
-          count++;
         }
+        ShadowPoWOrderSorter.emplace_back(kv);
       }
 
       // Assign non shard guards if there is any slots
-      for (auto kv = ShadowPoWOrderSorter.begin();
-           (kv != ShadowPoWOrderSorter.end()) && (count < numNodesTrimmed);
-           kv++) {
-        FilteredPoWOrderSorter.emplace(*kv);
-        count++;
-      }
-
-      // Sort "FilteredPoWOrderSorter" and stored it in "sortedPoWSolns"
-      for (auto kv : FilteredPoWOrderSorter) {
-        sortedPoWSolns.emplace_back(kv);
-      }
+      ShadowPoWOrderSorter.resize(
+          min<size_t>(ShadowPoWOrderSorter.size(), numNodesTrimmed - count));
+
+      sortedPoWSolns.reserve(FilteredPoWOrderSorter.size() +
+                             ShadowPoWOrderSorter.size());
+      merge(FilteredPoWOrderSorter.begin(), FilteredPoWOrderSorter.end(),
+            ShadowPoWOrderSorter.begin(), ShadowPoWOrderSorter.end(),
+            back_inserter(sortedPoWSolns), bySoln);
       LOG_GENERAL(INFO, "trimmedGuardCount: "
                             << trimmedGuardCount
                             << " trimmedNonGuardCount: " << trimmedNonGuardCount
@@ -734,9 +775,7 @@ VectorOfPoWSoln DirectoryService::SortPoWSoln(const MapOfPubKeyPoW& mapOfPoWs,
     }
 
   } else {
-    for (const auto& kv : PoWOrderSorter) {
-      sortedPoWSolns.emplace_back(kv);
-    }
+    sortedPoWSolns = move(PoWOrderSorter);
   }
 
   return sortedPoWSolns;
@@ -36,6 +36,7 @@
 #include "libPOW/pow.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/DetachedFunction.h"
+#include "libUtils/Executor.h"
 #include "libUtils/HashUtils.h"
 #include "libUtils/Logger.h"
 #include "libUtils/RootComputation.h"
@@ -315,7 +316,7 @@ bool DirectoryService::ProcessSetPrimary(const vector<unsigned char>& message,
     auto func = [this]() mutable -> void {
       this->ProcessAndSendPoWPacketSubmissionToOtherDSComm();
     };
-    DetachedFunction(1, func);
+    Executor::GetInstance().Execute(func);
 
     LOG_EPOCH(INFO, to_string(m_mediator.m_currentEpochNum).c_str(),
               "Waiting " << POWPACKETSUBMISSION_WINDOW_IN_SECONDS
@@ -667,7 +668,7 @@ void DirectoryService::StartNewDSEpochConsensus(bool fromFallback) {
     auto func = [this]() mutable -> void {
       this->ProcessAndSendPoWPacketSubmissionToOtherDSComm();
     };
-    DetachedFunction(1, func);
+    Executor::GetInstance().Execute(func);
 
     LOG_EPOCH(INFO, to_string(m_mediator.m_currentEpochNum).c_str(),
               "Waiting " << POWPACKETSUBMISSION_WINDOW_IN_SECONDS
@@ -700,7 +701,7 @@ void DirectoryService::StartNewDSEpochConsensus(bool fromFallback) {
         auto func = [this]() mutable -> void {
           this->ProcessAndSendPoWPacketSubmissionToOtherDSComm();
         };
-        DetachedFunction(1, func);
+        Executor::GetInstance().Execute(func);
       }
 
       if (cv_DSBlockConsensus.wait_for(
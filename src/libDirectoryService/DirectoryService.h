@@ -615,6 +615,22 @@ class DirectoryService : public Executable, public Broadcastable {
   // covered by auto test.
   static VectorOfPoWSoln SortPoWSoln(const MapOfPubKeyPoW& pows,
                                      bool trimBeyondCommSize = false);
+
+  // Same as SortPoWSoln, with the committee size to trim to (0 for none) and
+  // the shard guard check (empty outside guard mode) passed in, so that the
+  // test covers every setting.
+  static VectorOfPoWSoln SortAndTrimPoWSoln(
+      const MapOfPubKeyPoW& pows, unsigned int commSize,
+      const std::function<bool(const PubKey&)>& isShardGuard);
+
+  // Check the shard nodes follow the order of their PoW solutions hashed with
+  // the last block hash, counting the misordered nodes. Put to public static
+  // function, so it can be covered by auto test and benchmarked.
+  static bool VerifyPoWOrderingCore(
+      const DequeOfShard& shards, const VectorOfPoWSoln& sortedPoWSolns,
+      const MapOfPubKeyPoW& allPoWsFromTheLeader,
+      const std::vector<unsigned char>& lastBlockHash,
+      uint32_t& misorderNodes);
   int64_t GetAllPoWSize() const;
 
   bool ProcessAndSendPoWPacketSubmissionToOtherDSComm();
@@ -34,6 +34,7 @@
 #include "libNetwork/P2PComm.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/DetachedFunction.h"
+#include "libUtils/Executor.h"
 #include "libUtils/Logger.h"
 #include "libUtils/SanityChecks.h"
 #include "libUtils/UpgradeManager.h"
@@ -68,16 +69,22 @@ void DirectoryService::StoreFinalBlockToDisk() {
                 << ", Timestamp: " << m_finalBlock->GetTimestamp()
                 << ", NumTxs: " << m_finalBlock->GetHeader().GetNumTxs());
 
+  BlockStorage::WriteBatch batch;
+
   vector<unsigned char> serializedTxBlock;
   m_finalBlock->Serialize(serializedTxBlock, 0);
   BlockStorage::GetBlockStorage().PutTxBlock(
-      m_finalBlock->GetHeader().GetBlockNum(), serializedTxBlock);
+      m_finalBlock->GetHeader().GetBlockNum(), serializedTxBlock, batch);
 
   vector<unsigned char> stateDelta;
   AccountStore::GetInstance().GetSerializedDelta(stateDelta);
   BlockStorage::GetBlockStorage().PutStateDelta(
       m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum(),
-      stateDelta);
+      stateDelta, batch);
+
+  if (!BlockStorage::GetBlockStorage().CommitBatch(batch)) {
+    LOG_GENERAL(WARNING, "Failed to store final block");
+  }
 }
 
 bool DirectoryService::SendFinalBlockToLookupNodes() {
@@ -376,7 +383,7 @@ void DirectoryService::ProcessFinalBlockConsensusWhenDone() {
       auto func1 = [this]() mutable -> void {
         m_mediator.m_node->CommitTxnPacketBuffer();
       };
-      DetachedFunction(1, func1);
+      Executor::GetInstance().Execute(func1);
 
       CommitMBSubmissionMsgBuffer();
 
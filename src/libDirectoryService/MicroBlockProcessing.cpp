@@ -271,8 +271,9 @@ bool DirectoryService::ProcessMicroblockSubmissionFromShardCore(
 
   vector<unsigned char> body;
   microBlock.Serialize(body, 0);
-  if (!BlockStorage::GetBlockStorage().PutMicroBlock(microBlock.GetBlockHash(),
-                                                     body)) {
+  if (!BlockStorage::GetBlockStorage().PutMicroBlock(
+          microBlock.GetBlockHash(), microBlock.GetHeader().GetEpochNum(),
+          microBlock.GetHeader().GetShardId(), body)) {
     LOG_GENERAL(WARNING, "Failed to put microblock in persistence");
   }
 
@@ -594,7 +595,9 @@ bool DirectoryService::ProcessMissingMicroblockSubmission(
       vector<unsigned char> body;
       microBlocks[i].Serialize(body, 0);
       if (!BlockStorage::GetBlockStorage().PutMicroBlock(
-              microBlocks[i].GetBlockHash(), body)) {
+              microBlocks[i].GetBlockHash(),
+              microBlocks[i].GetHeader().GetEpochNum(),
+              microBlocks[i].GetHeader().GetShardId(), body)) {
         LOG_GENERAL(WARNING, "Failed to put microblock in persistence");
       }
 
@@ -35,7 +35,6 @@
 #include "libNetwork/P2PComm.h"
 #include "libPOW/pow.h"
 #include "libUtils/DataConversion.h"
-#include "libUtils/DetachedFunction.h"
 #include "libUtils/Logger.h"
 #include "libUtils/SanityChecks.h"
 
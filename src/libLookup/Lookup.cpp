@@ -777,7 +777,7 @@ void Lookup::RetrieveDSBlocks(vector<DSBlock>& dsBlocks, uint64_t& lowBlockNum,
   lock_guard<mutex> g(m_mediator.m_node->m_mutexDSBlock);
 
   uint64_t curBlockNum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   if (INIT_BLOCK_NUMBER == curBlockNum) {
     LOG_GENERAL(WARNING,
@@ -911,7 +911,7 @@ void Lookup::RetrieveTxBlocks(vector<TxBlock>& txBlocks, uint64_t& lowBlockNum,
     // To get block num from dsblockchain instead of txblock chain as node
     // recover from the last ds epoch
     lowBlockNum =
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetEpochNum();
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetEpochNum();
   } else if (lowBlockNum == 0) {
     // give all the blocks till now in blockchain
     lowBlockNum = 1;
@@ -919,7 +919,7 @@ void Lookup::RetrieveTxBlocks(vector<TxBlock>& txBlocks, uint64_t& lowBlockNum,
 
   if (highBlockNum == 0) {
     highBlockNum =
-        m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+        m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
   }
 
   if (INIT_BLOCK_NUMBER == highBlockNum) {
@@ -1204,8 +1204,9 @@ bool Lookup::AddMicroBlockToStorage(const MicroBlock& microblock) {
 
   vector<unsigned char> body;
   microblock.Serialize(body, 0);
-  if (!BlockStorage::GetBlockStorage().PutMicroBlock(microblock.GetBlockHash(),
-                                                     body)) {
+  if (!BlockStorage::GetBlockStorage().PutMicroBlock(
+          microblock.GetBlockHash(), microblock.GetHeader().GetEpochNum(),
+          microblock.GetHeader().GetShardId(), body)) {
     LOG_GENERAL(WARNING, "Failed to put microblock in body");
     return false;
   }
@@ -1534,7 +1535,8 @@ bool Lookup::ProcessSetDSBlockFromSeed(const vector<unsigned char>& message,
   }
 
   uint64_t latestSynBlockNum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1;
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum() +
+      1;
 
   if (latestSynBlockNum > highBlockNum) {
     // TODO: We should get blocks from n nodes.
@@ -1629,7 +1631,8 @@ bool Lookup::ProcessSetTxBlockFromSeed(const vector<unsigned char>& message,
   }
 
   uint64_t latestSynBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1;
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum() +
+      1;
 
   if (latestSynBlockNum > highBlockNum) {
     // TODO: We should get blocks from n nodes.
@@ -1721,7 +1724,8 @@ void Lookup::CommitTxBlocks(const vector<TxBlock>& txBlocks) {
   }
 
   m_mediator.m_currentEpochNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1;
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum() +
+      1;
 
   m_mediator.UpdateTxBlockRand();
 
@@ -1774,8 +1778,8 @@ bool Lookup::ProcessSetStateDeltaFromSeed(const vector<unsigned char>& message,
     return false;
   }
   m_mediator.m_ds->SaveCoinbase(
-      m_mediator.m_txBlockChain.GetLastBlock().GetB1(),
-      m_mediator.m_txBlockChain.GetLastBlock().GetB2(),
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetB1(),
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetB2(),
       CoinbaseReward::FINALBLOCK_REWARD, m_mediator.m_currentEpochNum);
   cv_setStateDeltaFromSeed.notify_all();
   return true;
@@ -1866,8 +1870,8 @@ bool Lookup::ProcessSetStateFromSeed(const vector<unsigned char>& message,
           getpowsubmission_message);
     } else if (m_syncType == SyncType::DS_SYNC) {
       if (!m_currDSExpired && m_mediator.m_ds->m_latestActiveDSBlockNum <
-                                  m_mediator.m_dsBlockChain.GetLastBlock()
-                                      .GetHeader()
+                                  m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                                      ->GetHeader()
                                       .GetBlockNum()) {
         m_isFirstLoop = true;
         SetSyncType(SyncType::NO_SYNC);
@@ -2018,7 +2022,9 @@ bool Lookup::CheckStateRoot() {
 
   StateHash stateRoot = AccountStore::GetInstance().GetStateRootHash();
   StateHash rootInFinalBlock =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetStateRootHash();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetStateRootHash();
 
   if (stateRoot == rootInFinalBlock) {
     LOG_GENERAL(INFO, "CheckStateRoot match");
@@ -2050,7 +2056,7 @@ bool Lookup::InitMining(uint32_t lookupIndex) {
   }
 
   uint64_t curDsBlockNum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   m_mediator.UpdateDSBlockRand();
   auto dsBlockRand = m_mediator.m_dsBlockRand;
@@ -2064,7 +2070,8 @@ bool Lookup::InitMining(uint32_t lookupIndex) {
 
     m_mediator.m_node->SetState(Node::POW_SUBMISSION);
     POW::GetInstance().EthashConfigureClient(
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum() + 1,
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum() +
+            1,
         FULL_DATASET_MINE);
 
     this_thread::sleep_for(chrono::seconds(NEW_NODE_POW_DELAY));
@@ -2074,8 +2081,12 @@ bool Lookup::InitMining(uint32_t lookupIndex) {
 
     m_mediator.m_node->StartPoW(
         curDsBlockNum + 1,
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDSDifficulty(),
-        m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDifficulty(),
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetDSDifficulty(),
+        m_mediator.m_dsBlockChain.GetLastBlockPtr()
+            ->GetHeader()
+            .GetDifficulty(),
         dsBlockRand, txBlockRand, lookupIndex);
   } else {
     LOG_GENERAL(WARNING, "State root check failed");
@@ -2433,8 +2444,8 @@ bool Lookup::ProcessSetStartPoWFromSeed(
 
   if (m_syncType == SyncType::DS_SYNC) {
     if (!m_currDSExpired && m_mediator.m_ds->m_latestActiveDSBlockNum <
-                                m_mediator.m_dsBlockChain.GetLastBlock()
-                                    .GetHeader()
+                                m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                                    ->GetHeader()
                                     .GetBlockNum()) {
       m_isFirstLoop = true;
       SetSyncType(SyncType::NO_SYNC);
@@ -2877,7 +2888,7 @@ bool Lookup::ProcessSetDirectoryBlocksFromSeed(
   deque<pair<PubKey, Peer>> newDScomm;
 
   uint64_t dsblocknumbefore =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
   LOG_GENERAL(INFO, "[DSINFOVERIF]"
                         << "Recvd " << dirBlocks.size() << " from lookup");
   {
@@ -2898,7 +2909,7 @@ bool Lookup::ProcessSetDirectoryBlocksFromSeed(
     m_mediator.m_blocklinkchain.SetBuiltDSComm(newDScomm);
   }
   uint64_t dsblocknumafter =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   if (dsblocknumafter > dsblocknumbefore) {
     if (m_syncType == SyncType::NO_SYNC &&
@@ -3177,7 +3188,9 @@ void Lookup::SendTxnPacketToNodes(uint32_t numShards) {
           continue;
         }
         uint16_t lastBlockHash = DataConversion::charArrTo16Bits(
-            m_mediator.m_txBlockChain.GetLastBlock().GetBlockHash().asBytes());
+            m_mediator.m_txBlockChain.GetLastBlockPtr()
+                ->GetBlockHash()
+                .asBytes());
         uint32_t leader_id =
             lastBlockHash % m_mediator.m_ds->m_shards.at(i).size();
         toSend.push_back(get<SHARD_NODE_PEER>(
@@ -3210,8 +3223,8 @@ void Lookup::SendTxnPacketToNodes(uint32_t numShards) {
         const auto& blocktype = get<BlockLinkIndex::BLOCKTYPE>(bl);
         if (blocktype == BlockType::DS) {
           uint16_t lastBlockHash = DataConversion::charArrTo16Bits(
-              m_mediator.m_dsBlockChain.GetLastBlock()
-                  .GetHeader()
+              m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                  ->GetHeader()
                   .GetHashForRandom()
                   .asBytes());
           uint32_t leader_id = 0;
@@ -275,7 +275,7 @@ bool Mediator::CheckWhetherBlockIsLatest(const uint64_t& dsblockNum,
   LOG_MARKER();
 
   uint64_t latestDSBlockNumInBlockchain =
-      m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   if (dsblockNum < (latestDSBlockNumInBlockchain + 1)) {
     LOG_EPOCH(WARNING, to_string(m_currentEpochNum).c_str(),
@@ -20,6 +20,7 @@
 #include "Messenger.h"
 #include "libData/AccountData/AccountStore.h"
 #include "libData/AccountData/Transaction.h"
+#include "libData/AccountData/VerifiedTxnCache.h"
 #include "libData/BlockChainData/BlockLinkChain.h"
 #include "libDirectoryService/DirectoryService.h"
 #include "libMessage/ZilliqaMessage.pb.h"
@@ -682,35 +683,107 @@ void ProtobufToTransaction(const ProtoTransaction& protoTransaction,
 
   ProtobufByteArrayToSerializable(protoTransaction.signature(), signature);
 
-  vector<unsigned char> txnData;
-  if (!SerializeToArray(protoTransaction.info(), txnData, 0)) {
-    LOG_GENERAL(WARNING, "Serialize Proto transaction core info failed.");
-    return;
-  }
+  transaction = Transaction(
+      tranID, txnCoreInfo.version, txnCoreInfo.nonce, txnCoreInfo.toAddr,
+      txnCoreInfo.senderPubKey, txnCoreInfo.amount, txnCoreInfo.gasPrice,
+      txnCoreInfo.gasLimit, txnCoreInfo.code, txnCoreInfo.data, signature);
+}
 
-  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-  sha2.Update(txnData);
-  const vector<unsigned char>& hash = sha2.Finalize();
+// Checks an untrusted transaction, given its core info serialized as txnData
+// and the hash of that, which should be the tranID
+bool ProtobufToTransaction(const ProtoTransaction& protoTransaction,
+                           Transaction& transaction,
+                           const vector<unsigned char>& txnData,
+                           const TxnHash& txnDataHash) {
+  Transaction txn;
+  ProtobufToTransaction(protoTransaction, txn);
 
-  if (!std::equal(hash.begin(), hash.end(), tranID.begin(), tranID.end())) {
-    TxnHash expected;
-    copy(hash.begin(), hash.end(), expected.asArray().begin());
+  if (txnDataHash != txn.GetTranID()) {
     LOG_GENERAL(WARNING, "TranID verification failed. Expected: "
-                             << expected << " Actual: " << tranID);
-    return;
+                             << txnDataHash << " Actual: " << txn.GetTranID());
+    return false;
   }
 
-  // Verify signature
-  if (!Schnorr::GetInstance().Verify(txnData, signature,
-                                     txnCoreInfo.senderPubKey)) {
-    LOG_GENERAL(WARNING, "Signature verification failed.");
-    return;
+  // Verify signature, unless this txn came with the same one before
+  const string& sigData = protoTransaction.signature().data();
+  const vector<unsigned char> sigBytes(sigData.begin(), sigData.end());
+
+  if (!VerifiedTxnCache::GetInstance().Contains(txn.GetTranID(), sigBytes)) {
+    if (!Schnorr::GetInstance().Verify(txnData, txn.GetSignature(),
+                                       txn.GetSenderPubKey())) {
+      LOG_GENERAL(WARNING, "Signature verification failed.");
+      return false;
+    }
+
+    VerifiedTxnCache::GetInstance().Add(txn.GetTranID(), sigBytes);
   }
 
-  transaction = Transaction(
-      tranID, txnCoreInfo.version, txnCoreInfo.nonce, txnCoreInfo.toAddr,
-      txnCoreInfo.senderPubKey, txnCoreInfo.amount, txnCoreInfo.gasPrice,
-      txnCoreInfo.gasLimit, txnCoreInfo.code, txnCoreInfo.data, signature);
+  transaction = txn;
+
+  return true;
+}
+
+bool ProtobufToTransaction(const ProtoTransaction& protoTransaction,
+                           Transaction& transaction,
+                           const Messenger::TrustLevel trustLevel) {
+  if (trustLevel == Messenger::TrustLevel::UNTRUSTED) {
+    vector<unsigned char> txnData;
+    if (!SerializeToArray(protoTransaction.info(), txnData, 0)) {
+      LOG_GENERAL(WARNING, "Serialize Proto transaction core info failed.");
+      return false;
+    }
+
+    TxnHash txnDataHash;
+    SHA2<HASH_TYPE::HASH_VARIANT_256>::Hash(txnData, txnDataHash);
+
+    return ProtobufToTransaction(protoTransaction, transaction, txnData,
+                                 txnDataHash);
+  }
+
+  ProtobufToTransaction(protoTransaction, transaction);
+
+  return true;
+}
+
+// Checks untrusted transactions like ProtobufToTransaction, but hashes the
+// core infos of all of them with one SHA2 HashBatch call. An invalid one fails
+// the whole batch, unless skipInvalid is set.
+bool ProtobufToUntrustedTransactions(
+    const google::protobuf::RepeatedPtrField<ProtoTransaction>&
+        protoTransactions,
+    vector<Transaction>& txns, bool skipInvalid) {
+  vector<vector<unsigned char>> txnData(protoTransactions.size());
+  vector<bool> serialized(protoTransactions.size());
+
+  for (int i = 0; i < protoTransactions.size(); i++) {
+    serialized[i] =
+        SerializeToArray(protoTransactions.Get(i).info(), txnData[i], 0);
+    if (!serialized[i]) {
+      LOG_GENERAL(WARNING, "Serialize Proto transaction core info failed.");
+      if (!skipInvalid) {
+        return false;
+      }
+    }
+  }
+
+  vector<TxnHash> txnDataHashes;
+  SHA2<HASH_TYPE::HASH_VARIANT_256>::HashBatch(txnData, txnDataHashes);
+
+  for (int i = 0; i < protoTransactions.size(); i++) {
+    Transaction txn;
+    if (!serialized[i] ||
+        !ProtobufToTransaction(protoTransactions.Get(i), txn, txnData[i],
+                               txnDataHashes[i])) {
+      if (!skipInvalid) {
+        return false;
+      }
+      LOG_GENERAL(WARNING, "Invalid transaction in packet, skipped.");
+      continue;
+    }
+    txns.emplace_back(txn);
+  }
+
+  return true;
 }
 
 void TransactionOffsetToProtobuf(const std::vector<uint32_t>& txnOffsets,
@@ -735,14 +808,23 @@ void TransactionArrayToProtobuf(const std::vector<Transaction>& txns,
   }
 }
 
-void ProtobufToTransactionArray(
+bool ProtobufToTransactionArray(
     const ProtoTransactionArray& protoTransactionArray,
-    std::vector<Transaction>& txns) {
+    std::vector<Transaction>& txns, const Messenger::TrustLevel trustLevel) {
+  if (trustLevel == Messenger::TrustLevel::UNTRUSTED) {
+    return ProtobufToUntrustedTransactions(
+        protoTransactionArray.transactions(), txns, false);
+  }
+
   for (const auto& protoTransaction : protoTransactionArray.transactions()) {
     Transaction txn;
-    ProtobufToTransaction(protoTransaction, txn);
+    if (!ProtobufToTransaction(protoTransaction, txn, trustLevel)) {
+      return false;
+    }
     txns.push_back(txn);
   }
+
+  return true;
 }
 
 void TransactionReceiptToProtobuf(const TransactionReceipt& transReceipt,
@@ -774,16 +856,22 @@ void TransactionWithReceiptToProtobuf(
                                *protoTranReceipt);
 }
 
-void ProtobufToTransactionWithReceipt(
+bool ProtobufToTransactionWithReceipt(
     const ProtoTransactionWithReceipt& protoWithTransaction,
-    TransactionWithReceipt& transactionWithReceipt) {
+    TransactionWithReceipt& transactionWithReceipt,
+    const Messenger::TrustLevel trustLevel) {
   Transaction transaction;
-  ProtobufToTransaction(protoWithTransaction.transaction(), transaction);
+  if (!ProtobufToTransaction(protoWithTransaction.transaction(), transaction,
+                             trustLevel)) {
+    return false;
+  }
 
   TransactionReceipt receipt;
   ProtobufToTransactionReceipt(protoWithTransaction.receipt(), receipt);
 
   transactionWithReceipt = TransactionWithReceipt(transaction, receipt);
+
+  return true;
 }
 
 void PeerToProtobuf(const Peer& peer, ProtoPeer& protoPeer) {
@@ -2524,7 +2612,8 @@ bool Messenger::SetTransaction(std::vector<unsigned char>& dst,
 
 bool Messenger::GetTransaction(const std::vector<unsigned char>& src,
                                const unsigned int offset,
-                               Transaction& transaction) {
+                               Transaction& transaction,
+                               const TrustLevel trustLevel) {
   ProtoTransaction result;
 
   result.ParseFromArray(src.data() + offset, src.size() - offset);
@@ -2534,9 +2623,7 @@ bool Messenger::GetTransaction(const std::vector<unsigned char>& src,
     return false;
   }
 
-  ProtobufToTransaction(result, transaction);
-
-  return true;
+  return ProtobufToTransaction(result, transaction, trustLevel);
 }
 
 bool Messenger::SetTransactionFileOffset(
@@ -2581,7 +2668,8 @@ bool Messenger::SetTransactionArray(std::vector<unsigned char>& dst,
 
 bool Messenger::GetTransactionArray(const std::vector<unsigned char>& src,
                                     const unsigned int offset,
-                                    std::vector<Transaction>& txns) {
+                                    std::vector<Transaction>& txns,
+                                    const TrustLevel trustLevel) {
   ProtoTransactionArray result;
 
   result.ParseFromArray(src.data() + offset, src.size() - offset);
@@ -2591,8 +2679,7 @@ bool Messenger::GetTransactionArray(const std::vector<unsigned char>& src,
     return false;
   }
 
-  ProtobufToTransactionArray(result, txns);
-  return true;
+  return ProtobufToTransactionArray(result, txns, trustLevel);
 }
 
 bool Messenger::SetTransactionReceipt(
@@ -2642,7 +2729,8 @@ bool Messenger::SetTransactionWithReceipt(
 
 bool Messenger::GetTransactionWithReceipt(
     const std::vector<unsigned char>& src, const unsigned int offset,
-    TransactionWithReceipt& transactionWithReceipt) {
+    TransactionWithReceipt& transactionWithReceipt,
+    const TrustLevel trustLevel) {
   ProtoTransactionWithReceipt result;
 
   result.ParseFromArray(src.data() + offset, src.size() - offset);
@@ -2652,9 +2740,8 @@ bool Messenger::GetTransactionWithReceipt(
     return false;
   }
 
-  ProtobufToTransactionWithReceipt(result, transactionWithReceipt);
-
-  return true;
+  return ProtobufToTransactionWithReceipt(result, transactionWithReceipt,
+                                          trustLevel);
 }
 
 bool Messenger::SetPeer(std::vector<unsigned char>& dst,
@@ -3536,11 +3623,7 @@ bool Messenger::GetNodeForwardTxnBlock(const std::vector<unsigned char>& src,
       return false;
     }
 
-    for (const auto& txn : result.transactions()) {
-      Transaction t;
-      ProtobufToTransaction(txn, t);
-      txns.emplace_back(t);
-    }
+    ProtobufToUntrustedTransactions(result.transactions(), txns, true);
   }
 
   LOG_GENERAL(INFO, "Epoch: " << epochNumber << " Shard: " << shardId
@@ -32,6 +32,11 @@
 
 class Messenger {
  public:
+  /// Where serialized txns come from. Txns read back from our own storage
+  /// were verified before being written, so their ID and signature are not
+  /// checked again.
+  enum class TrustLevel : unsigned char { UNTRUSTED, TRUSTED_STORAGE };
+
   // ============================================================================
   // Primitives
   // ============================================================================
@@ -156,9 +161,10 @@ class Messenger {
   static bool SetTransaction(std::vector<unsigned char>& dst,
                              const unsigned int offset,
                              const Transaction& transaction);
-  static bool GetTransaction(const std::vector<unsigned char>& src,
-                             const unsigned int offset,
-                             Transaction& transaction);
+  static bool GetTransaction(
+      const std::vector<unsigned char>& src, const unsigned int offset,
+      Transaction& transaction,
+      const TrustLevel trustLevel = TrustLevel::UNTRUSTED);
   static bool SetTransactionFileOffset(std::vector<unsigned char>& dst,
                                        const unsigned int offset,
                                        const std::vector<uint32_t>& txnOffsets);
@@ -168,9 +174,10 @@ class Messenger {
   static bool SetTransactionArray(std::vector<unsigned char>& dst,
                                   const unsigned int offset,
                                   const std::vector<Transaction>& txns);
-  static bool GetTransactionArray(const std::vector<unsigned char>& src,
-                                  const unsigned int offset,
-                                  std::vector<Transaction>& txns);
+  static bool GetTransactionArray(
+      const std::vector<unsigned char>& src, const unsigned int offset,
+      std::vector<Transaction>& txns,
+      const TrustLevel trustLevel = TrustLevel::UNTRUSTED);
   static bool SetTransactionReceipt(
       std::vector<unsigned char>& dst, const unsigned int offset,
       const TransactionReceipt& transactionReceipt);
@@ -182,7 +189,8 @@ class Messenger {
       const TransactionWithReceipt& transactionWithReceipt);
   static bool GetTransactionWithReceipt(
       const std::vector<unsigned char>& src, const unsigned int offset,
-      TransactionWithReceipt& transactionWithReceipt);
+      TransactionWithReceipt& transactionWithReceipt,
+      const TrustLevel trustLevel = TrustLevel::UNTRUSTED);
   static bool SetPeer(std::vector<unsigned char>& dst,
                       const unsigned int offset, const Peer& peer);
   static bool GetPeer(const std::vector<unsigned char>& src,
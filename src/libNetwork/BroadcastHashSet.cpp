@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include "BroadcastHashSet.h"
+
+using namespace std;
+
+BroadcastHashSet::BroadcastHashSet(unsigned int generations) {
+  for (auto& shard : m_shards) {
+    shard.m_generations.resize(max(generations, 2u));
+  }
+}
+
+BroadcastHashSet::Shard& BroadcastHashSet::GetShard(const dev::h256& hash) {
+  // The hashes are uniformly distributed, any byte picks a shard evenly
+  return m_shards[hash[0] % NUM_SHARDS];
+}
+
+bool BroadcastHashSet::Insert(const dev::h256& hash) {
+  Shard& shard = GetShard(hash);
+  lock_guard<mutex> g(shard.m_mutex);
+
+  for (const auto& generation : shard.m_generations) {
+    if (generation.find(hash) != generation.end()) {
+      return false;
+    }
+  }
+
+  shard.m_generations[shard.m_current].insert(hash);
+  return true;
+}
+
+bool BroadcastHashSet::Contains(const dev::h256& hash) {
+  Shard& shard = GetShard(hash);
+  lock_guard<mutex> g(shard.m_mutex);
+
+  for (const auto& generation : shard.m_generations) {
+    if (generation.find(hash) != generation.end()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void BroadcastHashSet::Rotate() {
+  for (auto& shard : m_shards) {
+    lock_guard<mutex> g(shard.m_mutex);
+    shard.m_current = (shard.m_current + 1) % shard.m_generations.size();
+    shard.m_generations[shard.m_current].clear();
+  }
+}
+
+size_t BroadcastHashSet::Size() {
+  size_t size = 0;
+
+  for (auto& shard : m_shards) {
+    lock_guard<mutex> g(shard.m_mutex);
+    for (const auto& generation : shard.m_generations) {
+      size += generation.size();
+    }
+  }
+
+  return size;
+}
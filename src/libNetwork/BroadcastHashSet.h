@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#ifndef __BROADCASTHASHSET_H__
+#define __BROADCASTHASHSET_H__
+
+#include <array>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include "depends/common/FixedHash.h"
+
+/// Remembers the hashes of recently seen broadcast messages. Hashes are spread
+/// over independently locked shards, so lookups from different connections
+/// rarely contend. Entries expire by generation: each Rotate() starts a new
+/// generation and forgets the oldest one.
+class BroadcastHashSet {
+ public:
+  static const unsigned int NUM_SHARDS = 16;
+
+  /// An entry survives between (generations - 1) and generations rotations.
+  explicit BroadcastHashSet(unsigned int generations);
+
+  /// Adds the hash. Returns false if it was already present.
+  bool Insert(const dev::h256& hash);
+
+  /// Checks whether the hash has been seen and has not expired yet.
+  bool Contains(const dev::h256& hash);
+
+  /// Drops the oldest generation of hashes.
+  void Rotate();
+
+  /// Returns the number of hashes currently remembered.
+  size_t Size();
+
+ private:
+  struct Shard {
+    std::mutex m_mutex;
+    std::vector<std::unordered_set<dev::h256>> m_generations;
+    unsigned int m_current = 0;
+  };
+
+  Shard& GetShard(const dev::h256& hash);
+
+  std::array<Shard, NUM_SHARDS> m_shards;
+};
+
+#endif  // __BROADCASTHASHSET_H__
@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <event2/buffer.h>
+#include <event2/bufferevent.h>
+#include <event2/event.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <cstring>
+
+#include "ConnectionPool.h"
+#include "common/Constants.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+ConnectionPool::ConnectionPool() : m_base(nullptr) {}
+
+ConnectionPool::~ConnectionPool() { SetEventBase(nullptr); }
+
+void ConnectionPool::SetEventBase(struct event_base* base) {
+  lock_guard<mutex> g(m_mutex);
+
+  if (base == nullptr) {
+    while (!m_connections.empty()) {
+      Close(m_connections.begin()->first);
+    }
+  }
+
+  m_base = base;
+}
+
+bool ConnectionPool::IsReady() {
+  lock_guard<mutex> g(m_mutex);
+  return m_base != nullptr;
+}
+
+size_t ConnectionPool::Size() {
+  lock_guard<mutex> g(m_mutex);
+  return m_connections.size();
+}
+
+bool ConnectionPool::Connect(Connection& conn) {
+  // Callbacks are deferred and run unlocked so that they can take m_mutex
+  // without inverting the lock order used by Send()
+  struct bufferevent* bev = bufferevent_socket_new(
+      m_base, -1,
+      BEV_OPT_CLOSE_ON_FREE | BEV_OPT_THREADSAFE | BEV_OPT_DEFER_CALLBACKS |
+          BEV_OPT_UNLOCK_CALLBACKS);
+  if (bev == NULL) {
+    LOG_GENERAL(WARNING, "bufferevent_socket_new failure. IP address: "
+                             << conn.m_peer);
+    return false;
+  }
+  conn.m_bev = bev;
+
+  // The callbacks only get the pool; the connection may be gone by the time
+  // they run
+  bufferevent_setcb(bev, ReadCallback, NULL, EventCallback, this);
+
+  // The remote end never writes to us, so the read timeout doubles as the
+  // idle timeout. Reading also lets us notice a remote close promptly.
+  // The write timeout only runs while output is pending (including the
+  // connect), so it catches peers that stop making progress.
+  struct timeval idle = {CONNECTION_IDLE_TIMEOUT_IN_SECONDS, 0};
+  struct timeval stall = {SEND_TIMEOUT_IN_SECONDS, 0};
+  bufferevent_set_timeouts(bev, &idle, &stall);
+  bufferevent_enable(bev, EV_READ | EV_WRITE);
+
+  struct sockaddr_in serv_addr;
+  memset(&serv_addr, 0, sizeof(struct sockaddr_in));
+  serv_addr.sin_family = AF_INET;
+  serv_addr.sin_addr.s_addr =
+      conn.m_peer.m_ipAddress.convert_to<unsigned long>();
+  serv_addr.sin_port = htons(conn.m_peer.m_listenPortHost);
+
+  if (bufferevent_socket_connect(bev, (struct sockaddr*)&serv_addr,
+                                 sizeof(serv_addr)) < 0) {
+    LOG_GENERAL(WARNING, "Socket connect failed. Code = "
+                             << errno << " Desc: " << std::strerror(errno)
+                             << ". IP address: " << conn.m_peer);
+    return false;
+  }
+
+  return true;
+}
+
+void ConnectionPool::Close(const Peer& peer) {
+  auto it = m_connections.find(peer);
+  if (it == m_connections.end()) {
+    return;
+  }
+
+  it->second->m_closed->store(true);
+  m_peerByBev.erase(it->second->m_bev);
+  bufferevent_free(it->second->m_bev);
+  m_connections.erase(it);
+}
+
+bool ConnectionPool::RunOnLoop(struct event_base* base,
+                               const function<void()>& func,
+                               const chrono::milliseconds& delay) {
+  auto arg = new function<void()>(func);
+  struct timeval tv = {static_cast<time_t>(delay.count() / 1000),
+                       static_cast<suseconds_t>((delay.count() % 1000) * 1000)};
+
+  if (event_base_once(base, -1, EV_TIMEOUT, RunCallback, arg, &tv) != 0) {
+    LOG_GENERAL(WARNING, "event_base_once failure.");
+    delete arg;
+    return false;
+  }
+
+  return true;
+}
+
+void ConnectionPool::RunCallback([[gnu::unused]] evutil_socket_t fd,
+                                 [[gnu::unused]] short events, void* arg) {
+  unique_ptr<function<void()>> func(static_cast<function<void()>*>(arg));
+  (*func)();
+}
+
+bool ConnectionPool::Defer(const function<void()>& func,
+                           const chrono::milliseconds& delay) {
+  lock_guard<mutex> g(m_mutex);
+
+  if (m_base == nullptr) {
+    return false;
+  }
+
+  return RunOnLoop(m_base, func, delay);
+}
+
+void ConnectionPool::ReleaseFrame([[gnu::unused]] const void* data,
+                                  [[gnu::unused]] size_t datalen,
+                                  void* extra) {
+  unique_ptr<Frame> frame(static_cast<Frame*>(extra));
+
+  if (!frame->m_done) {
+    return;
+  }
+
+  // We may be inside libevent with the connection locked here, so report
+  // the result from a fresh loop callback
+  const bool sent = !frame->m_closed->load();
+  SendCallback done = move(frame->m_done);
+  RunOnLoop(frame->m_base, [done, sent]() { done(sent); },
+            chrono::milliseconds(0));
+}
+
+bool ConnectionPool::Send(const Peer& peer, const vector<unsigned char>& header,
+                          const shared_ptr<const vector<unsigned char>>& body,
+                          const SendCallback& done) {
+  lock_guard<mutex> g(m_mutex);
+
+  if (m_base == nullptr) {
+    LOG_GENERAL(WARNING, "Event loop not started yet. IP address: " << peer);
+    return false;
+  }
+
+  auto it = m_connections.find(peer);
+  if (it == m_connections.end()) {
+    unique_ptr<Connection> conn(
+        new Connection{peer, NULL, chrono::steady_clock::now(),
+                       make_shared<atomic<bool>>(false)});
+    if (!Connect(*conn)) {
+      if (conn->m_bev != NULL) {
+        bufferevent_free(conn->m_bev);
+      }
+      return false;
+    }
+    m_peerByBev.emplace(conn->m_bev, peer);
+    it = m_connections.emplace(peer, move(conn)).first;
+  }
+  Connection& conn = *it->second;
+
+  // Assemble the frame separately so that it lands in the output buffer in
+  // one piece, even with other threads writing to the same connection.
+  // Both parts are added by reference; the last chain releases the frame.
+  unique_ptr<struct evbuffer, decltype(&evbuffer_free)> buffer(evbuffer_new(),
+                                                               evbuffer_free);
+  if (buffer == nullptr) {
+    LOG_GENERAL(WARNING, "evbuffer_new failure. IP address: " << peer);
+    return false;
+  }
+
+  Frame* frame = new Frame{header, body, done, conn.m_closed, m_base};
+  const bool hasBody = (body != nullptr) && !body->empty();
+
+  if (evbuffer_add_reference(buffer.get(), frame->m_header.data(),
+                             frame->m_header.size(),
+                             hasBody ? NULL : ReleaseFrame,
+                             hasBody ? NULL : frame) != 0) {
+    delete frame;
+    LOG_GENERAL(WARNING, "evbuffer_add_reference failure. IP address: "
+                             << peer);
+    return false;
+  }
+
+  if (hasBody && (evbuffer_add_reference(buffer.get(), body->data(),
+                                         body->size(), ReleaseFrame,
+                                         frame) != 0)) {
+    buffer.reset();
+    delete frame;
+    LOG_GENERAL(WARNING, "evbuffer_add_reference failure. IP address: "
+                             << peer);
+    return false;
+  }
+
+  if (bufferevent_write_buffer(conn.m_bev, buffer.get()) != 0) {
+    // Frame is released together with buffer, without calling done
+    frame->m_done = nullptr;
+    LOG_GENERAL(WARNING,
+                "bufferevent_write_buffer failure. IP address: " << peer);
+    buffer.reset();
+    Close(peer);
+    return false;
+  }
+  conn.m_lastActive = chrono::steady_clock::now();
+
+  return true;
+}
+
+void ConnectionPool::ReadCallback(struct bufferevent* bev,
+                                  [[gnu::unused]] void* ctx) {
+  // Outgoing connections are write-only; discard anything the peer sends
+  struct evbuffer* input = bufferevent_get_input(bev);
+  evbuffer_drain(input, evbuffer_get_length(input));
+}
+
+void ConnectionPool::EventCallback(struct bufferevent* bev, short events,
+                                   void* ctx) {
+  ConnectionPool* pool = static_cast<ConnectionPool*>(ctx);
+  lock_guard<mutex> g(pool->m_mutex);
+
+  // Send() may have closed the connection while this callback was queued
+  auto peerIt = pool->m_peerByBev.find(bev);
+  if (peerIt == pool->m_peerByBev.end()) {
+    return;
+  }
+  auto it = pool->m_connections.find(peerIt->second);
+  if ((it == pool->m_connections.end()) || (it->second->m_bev != bev)) {
+    return;
+  }
+  Connection* conn = it->second.get();
+
+  if (events & BEV_EVENT_CONNECTED) {
+    return;
+  }
+
+  const size_t pending = evbuffer_get_length(bufferevent_get_output(bev));
+
+  if ((events & BEV_EVENT_TIMEOUT) && (events & BEV_EVENT_READING)) {
+    if ((pending == 0) &&
+        (chrono::steady_clock::now() - conn->m_lastActive >=
+         chrono::seconds(CONNECTION_IDLE_TIMEOUT_IN_SECONDS))) {
+      LOG_GENERAL(DEBUG, "Closing idle connection to " << conn->m_peer);
+      pool->Close(Peer(conn->m_peer));
+      return;
+    }
+
+    // Timeouts disable the event, so turn reading back on
+    bufferevent_enable(bev, EV_READ);
+    return;
+  }
+
+  if (events & BEV_EVENT_TIMEOUT) {
+    LOG_GENERAL(WARNING, "No progress sending to " << conn->m_peer << " in "
+                                                   << SEND_TIMEOUT_IN_SECONDS
+                                                   << " seconds.");
+  } else if (events & BEV_EVENT_ERROR) {
+    LOG_GENERAL(WARNING, "Connection to " << conn->m_peer << " failed. Desc: "
+                                          << evutil_socket_error_to_string(
+                                                 EVUTIL_SOCKET_ERROR()));
+  }
+
+  if (pending > 0) {
+    LOG_GENERAL(WARNING, "Dropped " << pending << " unsent bytes to "
+                                    << conn->m_peer);
+  }
+
+  pool->Close(Peer(conn->m_peer));
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#ifndef __CONNECTIONPOOL_H__
+#define __CONNECTIONPOOL_H__
+
+#include <event2/util.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Peer.h"
+
+struct bufferevent;
+struct event_base;
+
+/// Keeps one long-lived outgoing connection per peer and writes framed
+/// messages back to back on it. Socket I/O is driven by the libevent loop of
+/// P2PComm; callers only append to the output buffer of the connection.
+class ConnectionPool {
+ public:
+  /// Called on the event loop thread once a frame has been handed to the
+  /// kernel (true), or has been dropped with its connection (false).
+  using SendCallback = std::function<void(bool sent)>;
+
+ private:
+  struct Connection {
+    Peer m_peer;
+    struct bufferevent* m_bev;
+    std::chrono::time_point<std::chrono::steady_clock> m_lastActive;
+    /// Set when the connection is closed, so that frames still queued on it
+    /// report failure when they are released
+    std::shared_ptr<std::atomic<bool>> m_closed;
+  };
+
+  /// Owns the header of a queued frame and keeps its body alive until the
+  /// frame leaves the output buffer.
+  struct Frame {
+    std::vector<unsigned char> m_header;
+    std::shared_ptr<const std::vector<unsigned char>> m_body;
+    SendCallback m_done;
+    std::shared_ptr<std::atomic<bool>> m_closed;
+    struct event_base* m_base;
+  };
+
+  std::mutex m_mutex;
+  struct event_base* m_base;
+  std::map<Peer, std::unique_ptr<Connection>> m_connections;
+  /// Maps the socket back to its peer for the event callback, which runs
+  /// unlocked and may race with Close()
+  std::map<struct bufferevent*, Peer> m_peerByBev;
+
+  /// Creates the socket for the connection and starts connecting.
+  /// Caller must hold m_mutex.
+  bool Connect(Connection& conn);
+
+  /// Frees the socket and forgets the connection; frames still queued on it
+  /// are reported as not sent. Caller must hold m_mutex.
+  void Close(const Peer& peer);
+
+  static bool RunOnLoop(struct event_base* base,
+                        const std::function<void()>& func,
+                        const std::chrono::milliseconds& delay);
+  static void RunCallback(evutil_socket_t fd, short events, void* arg);
+  static void ReleaseFrame(const void* data, size_t datalen, void* extra);
+  static void ReadCallback(struct bufferevent* bev, void* ctx);
+  static void EventCallback(struct bufferevent* bev, short events, void* ctx);
+
+ public:
+  /// Constructor.
+  ConnectionPool();
+
+  /// Destructor.
+  ~ConnectionPool();
+
+  // Should not implement these
+  ConnectionPool(ConnectionPool const&) = delete;
+  void operator=(ConnectionPool const&) = delete;
+
+  /// Binds the pool to the event loop that drives its sockets.
+  /// Passing nullptr closes all connections and detaches the pool.
+  void SetEventBase(struct event_base* base);
+
+  /// Returns true if the pool is bound to a running event loop.
+  bool IsReady();
+
+  /// Appends header + body to the connection of the specified peer,
+  /// connecting first if there is no open connection yet. The body is not
+  /// copied; the connection keeps a reference to it until it has been sent.
+  /// If false is returned nothing was queued and done will not be called.
+  bool Send(const Peer& peer, const std::vector<unsigned char>& header,
+            const std::shared_ptr<const std::vector<unsigned char>>& body,
+            const SendCallback& done = nullptr);
+
+  /// Runs func on the event loop thread after the specified delay.
+  bool Defer(const std::function<void()>& func,
+             const std::chrono::milliseconds& delay);
+
+  /// Returns the number of open (or connecting) connections.
+  size_t Size();
+};
+
+#endif  // __CONNECTIONPOOL_H__
@@ -23,11 +23,13 @@
 #include <event2/event-config.h>
 #include <event2/event.h>
 #include <event2/listener.h>
+#include <event2/thread.h>
 #include <event2/util.h>
 #include <netinet/in.h>
 #include <signal.h>
 #include <stdint.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <cstring>
 #include <memory>
@@ -35,10 +37,12 @@
 #include "Blacklist.h"
 #include "P2PComm.h"
 #include "PeerStore.h"
+#include "SendScheduler.h"
 #include "common/Messages.h"
 #include "libCrypto/Sha2.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/DetachedFunction.h"
+#include "libUtils/Executor.h"
 #include "libUtils/JoinableFunction.h"
 #include "libUtils/Logger.h"
 
@@ -57,14 +61,6 @@ const unsigned int GOSSIP_SNDR_LISTNR_PORT_LEN = 4;
 P2PComm::Dispatcher P2PComm::m_dispatcher;
 P2PComm::BroadcastListFunc P2PComm::m_broadcast_list_retriever;
 
-/// Comparison operator for ordering the list of message hashes.
-struct hash_compare {
-  bool operator()(const vector<unsigned char>& l,
-                  const vector<unsigned char>& r) {
-    return equal(l.begin(), l.end(), r.begin(), r.end());
-  }
-};
-
 static void close_socket(int* cli_sock) {
   if (cli_sock != NULL) {
     shutdown(*cli_sock, SHUT_RDWR);
@@ -72,48 +68,19 @@ static void close_socket(int* cli_sock) {
   }
 }
 
-static bool comparePairSecond(
-    const pair<vector<unsigned char>, chrono::time_point<chrono::system_clock>>&
-        a,
-    const pair<vector<unsigned char>, chrono::time_point<chrono::system_clock>>&
-        b) {
-  return a.second < b.second;
-}
-
-P2PComm::P2PComm() : m_sendQueue(SENDQUEUE_SIZE) {
-  auto func = [this]() -> void {
-    std::vector<unsigned char> emptyHash;
-
-    while (true) {
-      this_thread::sleep_for(chrono::seconds(BROADCAST_INTERVAL));
-      lock(m_broadcastToRemoveMutex, m_broadcastHashesMutex);
-      lock_guard<mutex> g(m_broadcastToRemoveMutex, adopt_lock);
-      lock_guard<mutex> g2(m_broadcastHashesMutex, adopt_lock);
-
-      if (m_broadcastToRemove.empty() ||
-          m_broadcastToRemove.front().second >
-              chrono::system_clock::now() - chrono::seconds(BROADCAST_EXPIRY)) {
-        continue;
-      }
-
-      auto up = upper_bound(
-          m_broadcastToRemove.begin(), m_broadcastToRemove.end(),
-          make_pair(emptyHash, chrono::system_clock::now() -
-                                   chrono::seconds(BROADCAST_EXPIRY)),
-          comparePairSecond);
-
-      for (auto it = m_broadcastToRemove.begin(); it != up; ++it) {
-        m_broadcastHashes.erase(it->first);
-      }
-
-      m_broadcastToRemove.erase(m_broadcastToRemove.begin(), up);
-    }
-  };
+P2PComm::P2PComm()
+    : m_broadcastHashes(BROADCAST_EXPIRY / max(BROADCAST_INTERVAL, 1u) + 1),
+      m_sendQueue(SENDQUEUE_SIZE) {
+  auto func = [this]() -> void { m_broadcastHashes.Rotate(); };
 
-  DetachedFunction(1, func);
+  m_rotateTimer = Executor::GetInstance().ExecutePeriodically(
+      chrono::seconds(BROADCAST_INTERVAL), func);
 }
 
 P2PComm::~P2PComm() {
+  // The executor outlives us, so stop the timer before the hashes go away
+  Executor::GetInstance().Cancel(m_rotateTimer);
+
   SendJob* job = NULL;
   while (m_sendQueue.pop(job)) {
     delete job;
@@ -125,13 +92,18 @@ P2PComm& P2PComm::GetInstance() {
   return comm;
 }
 
-uint32_t SendJob::writeMsg(const void* buf, int cli_sock, const Peer& from,
-                           const uint32_t message_length) {
+uint32_t SendJob::writeMsg(struct iovec* iov, int iovcnt, int cli_sock,
+                           const Peer& from) {
+  uint32_t message_length = 0;
+  for (int i = 0; i < iovcnt; ++i) {
+    message_length += iov[i].iov_len;
+  }
+
   uint32_t written_length = 0;
 
+  // Header, hash and body go out in a single writev; loop only on short writes
   while (written_length < message_length) {
-    ssize_t n = write(cli_sock, (unsigned char*)buf + written_length,
-                      message_length - written_length);
+    ssize_t n = writev(cli_sock, iov, iovcnt);
 
     if (errno == EPIPE) {
       LOG_GENERAL(WARNING, " SIGPIPE detected. Error No: "
@@ -149,6 +121,18 @@ uint32_t SendJob::writeMsg(const void* buf, int cli_sock, const Peer& from,
     }
 
     written_length += n;
+
+    // Skip the buffers that have been fully written
+    size_t done = n;
+    while ((iovcnt > 0) && (done >= iov->iov_len)) {
+      done -= iov->iov_len;
+      ++iov;
+      --iovcnt;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = (unsigned char*)iov->iov_base + done;
+      iov->iov_len -= done;
+    }
   }
 
   if (written_length > 1000000) {
@@ -158,10 +142,47 @@ uint32_t SendJob::writeMsg(const void* buf, int cli_sock, const Peer& from,
   return written_length;
 }
 
+vector<unsigned char> SendJob::ComposeHeader(
+    unsigned char start_byte, uint32_t message_size,
+    const vector<unsigned char>& msg_hash) {
+  // Transmission format:
+  // 0x01 ~ 0xFF - version, defined in constant file
+  // 0x11 - start byte
+  // 0xLL 0xLL 0xLL 0xLL - 4-byte length of message
+  // <message>
+
+  // 0x01 ~ 0xFF - version, defined in constant file
+  // 0x22 - start byte (broadcast)
+  // 0xLL 0xLL 0xLL 0xLL - 4-byte length of hash + message
+  // <32-byte hash> <message>
+
+  // 0x01 ~ 0xFF - version, defined in constant file
+  // 0x33 - start byte (report)
+  // 0x00 0x00 0x00 0x01 - 4-byte length of message
+  // 0x00
+  uint32_t length = message_size;
+
+  if (start_byte == START_BYTE_BROADCAST) {
+    length += HASH_LEN;
+  }
+
+  vector<unsigned char> header = {(unsigned char)(MSG_VERSION & 0xFF),
+                                  start_byte,
+                                  (unsigned char)((length >> 24) & 0xFF),
+                                  (unsigned char)((length >> 16) & 0xFF),
+                                  (unsigned char)((length >> 8) & 0xFF),
+                                  (unsigned char)(length & 0xFF)};
+
+  if (start_byte == START_BYTE_BROADCAST) {
+    header.insert(header.end(), msg_hash.begin(), msg_hash.end());
+  }
+
+  return header;
+}
+
 bool SendJob::SendMessageSocketCore(const Peer& peer,
-                                    const std::vector<unsigned char>& message,
-                                    unsigned char start_byte,
-                                    const vector<unsigned char>& msg_hash) {
+                                    const vector<unsigned char>& header,
+                                    const vector<unsigned char>& message) {
   // LOG_MARKER();
   LOG_PAYLOAD(DEBUG, "Sending message to " << peer, message,
               Logger::MAX_BYTES_TO_DISPLAY);
@@ -205,50 +226,14 @@ bool SendJob::SendMessageSocketCore(const Peer& peer,
       return false;
     }
 
-    // Transmission format:
-    // 0x01 ~ 0xFF - version, defined in constant file
-    // 0x11 - start byte
-    // 0xLL 0xLL 0xLL 0xLL - 4-byte length of message
-    // <message>
-
-    // 0x01 ~ 0xFF - version, defined in constant file
-    // 0x22 - start byte (broadcast)
-    // 0xLL 0xLL 0xLL 0xLL - 4-byte length of hash + message
-    // <32-byte hash> <message>
-
-    // 0x01 ~ 0xFF - version, defined in constant file
-    // 0x33 - start byte (report)
-    // 0x00 0x00 0x00 0x01 - 4-byte length of message
-    // 0x00
-    uint32_t length = message.size();
-
-    if (start_byte == START_BYTE_BROADCAST) {
-      length += HASH_LEN;
-    }
+    struct iovec iov[2] = {
+        {const_cast<unsigned char*>(header.data()), header.size()},
+        {const_cast<unsigned char*>(message.data()), message.size()}};
+    const uint32_t length = header.size() + message.size();
 
-    unsigned char buf[HDR_LEN] = {(unsigned char)(MSG_VERSION & 0xFF),
-                                  start_byte,
-                                  (unsigned char)((length >> 24) & 0xFF),
-                                  (unsigned char)((length >> 16) & 0xFF),
-                                  (unsigned char)((length >> 8) & 0xFF),
-                                  (unsigned char)(length & 0xFF)};
-
-    if (HDR_LEN != writeMsg(buf, cli_sock, peer, HDR_LEN)) {
-      LOG_GENERAL(INFO, "DEBUG: not written_length == " << HDR_LEN);
-    }
-
-    if (start_byte != START_BYTE_BROADCAST) {
-      writeMsg(&message.at(0), cli_sock, peer, length);
-      return true;
-    }
-
-    if (HASH_LEN != writeMsg(&msg_hash.at(0), cli_sock, peer, HASH_LEN)) {
-      LOG_GENERAL(WARNING, "Wrong message hash length.");
-      return false;
+    if (length != writeMsg(iov, 2, cli_sock, peer)) {
+      LOG_GENERAL(INFO, "DEBUG: not written_length == " << length);
     }
-
-    length -= HASH_LEN;
-    writeMsg(&message.at(0), cli_sock, peer, length);
   } catch (const std::exception& e) {
     LOG_GENERAL(WARNING, "Error with write socket." << ' ' << e.what());
     return false;
@@ -257,11 +242,19 @@ bool SendJob::SendMessageSocketCore(const Peer& peer,
 }
 
 void SendJob::SendMessageCore(const Peer& peer,
-                              const vector<unsigned char> message,
+                              const vector<unsigned char>& message,
                               unsigned char startbyte,
-                              const vector<unsigned char> hash) {
+                              const vector<unsigned char>& hash) {
+  if ((startbyte == START_BYTE_BROADCAST) && (hash.size() != HASH_LEN)) {
+    LOG_GENERAL(WARNING, "Wrong message hash length.");
+    return;
+  }
+
+  const vector<unsigned char> header =
+      ComposeHeader(startbyte, message.size(), hash);
+
   uint32_t retry_counter = 0;
-  while (!SendMessageSocketCore(peer, message, startbyte, hash)) {
+  while (!SendMessageSocketCore(peer, header, message)) {
     retry_counter++;
     LOG_GENERAL(WARNING, "Socket connect failed " << retry_counter << "/"
                                                   << MAXRETRYCONN
@@ -277,6 +270,71 @@ void SendJob::SendMessageCore(const Peer& peer,
   }
 }
 
+static bool IsUnroutable(const Peer& peer) {
+  if (peer.m_ipAddress == 0 && peer.m_listenPortHost == 0) {
+    LOG_GENERAL(INFO,
+                "I am sending to 0.0.0.0 at port 0. Don't send anything.");
+    return true;
+  } else if (peer.m_listenPortHost == 0) {
+    LOG_GENERAL(INFO, "I am sending to " << peer.GetPrintableIPAddress()
+                                         << " at port 0. Investigate why!");
+    return true;
+  }
+
+  return false;
+}
+
+void SendJob::Dispatch(vector<Peer>&& peers) {
+  if ((m_startbyte == START_BYTE_BROADCAST) && (m_hash.size() != HASH_LEN)) {
+    LOG_GENERAL(WARNING, "Wrong message hash length.");
+    return;
+  }
+
+  const bool logState =
+      (m_startbyte == START_BYTE_BROADCAST) && (m_selfPeer != Peer());
+  ConnectionPool& pool = P2PComm::GetInstance().m_connectionPool;
+
+  if (!pool.IsReady()) {
+    for (const auto& peer : peers) {
+      SendMessageCore(peer, *m_message, m_startbyte, m_hash);
+    }
+
+    if (logState) {
+      LOG_STATE(
+          "[BROAD][" << std::setw(15) << std::left
+                     << m_selfPeer.GetPrintableIPAddress() << "]["
+                     << DataConversion::Uint8VecToHexStr(m_hash).substr(0, 6)
+                     << "] DONE");
+    }
+    return;
+  }
+
+  LOG_PAYLOAD(DEBUG, "Sending message to " << peers.size() << " peers",
+              *m_message, Logger::MAX_BYTES_TO_DISPLAY);
+
+  peers.erase(remove_if(peers.begin(), peers.end(), IsUnroutable),
+              peers.end());
+
+  // All peers are sent to in parallel and share the same message body.
+  // The job itself may be gone by the time the last peer is done.
+  const Peer selfPeer = m_selfPeer;
+  const string hashPrefix =
+      DataConversion::Uint8VecToHexStr(m_hash).substr(0, 6);
+  auto done = [logState, selfPeer,
+               hashPrefix](const SendScheduler::Stats& stats) -> void {
+    if (logState) {
+      LOG_STATE("[BROAD][" << std::setw(15) << std::left
+                           << selfPeer.GetPrintableIPAddress() << "]["
+                           << hashPrefix << "] DONE "
+                           << stats.m_elapsed.count() << "ms");
+    }
+  };
+
+  SendScheduler::Start(pool, move(peers),
+                       ComposeHeader(m_startbyte, m_message->size(), m_hash),
+                       m_message, done);
+}
+
 void SendJobPeer::DoSend() {
   if (Blacklist::GetInstance().Exist(m_peer.m_ipAddress)) {
     LOG_GENERAL(INFO, "The node "
@@ -285,30 +343,15 @@ void SendJobPeer::DoSend() {
     return;
   }
 
-  SendMessageCore(m_peer, m_message, m_startbyte, m_hash);
+  Dispatch({m_peer});
 }
 
 template <class T>
 void SendJobPeers<T>::DoSend() {
-  vector<unsigned int> indexes(m_peers.size());
-
-  for (unsigned int i = 0; i < indexes.size(); i++) {
-    indexes.at(i) = i;
-  }
-  random_shuffle(indexes.begin(), indexes.end());
-
-  if ((m_startbyte == START_BYTE_BROADCAST) && (m_selfPeer != Peer())) {
-    LOG_STATE(
-        "[BROAD][" << std::setw(15) << std::left
-                   << m_selfPeer.GetPrintableIPAddress() << "]["
-                   << DataConversion::Uint8VecToHexStr(m_hash).substr(0, 6)
-                   << "] BEGN");
-  }
-
-  for (vector<unsigned int>::const_iterator curr = indexes.begin();
-       curr < indexes.end(); curr++) {
-    const Peer& peer = m_peers.at(*curr);
+  vector<Peer> peers;
+  peers.reserve(m_peers.size());
 
+  for (const auto& peer : m_peers) {
     /// TBD: Update the container dynamically when blacklist is updated
     if (Blacklist::GetInstance().Exist(peer.m_ipAddress)) {
       LOG_GENERAL(INFO, "The node "
@@ -317,16 +360,19 @@ void SendJobPeers<T>::DoSend() {
       continue;
     }
 
-    SendMessageCore(peer, m_message, m_startbyte, m_hash);
+    peers.emplace_back(peer);
   }
+  random_shuffle(peers.begin(), peers.end());
 
   if ((m_startbyte == START_BYTE_BROADCAST) && (m_selfPeer != Peer())) {
     LOG_STATE(
         "[BROAD][" << std::setw(15) << std::left
                    << m_selfPeer.GetPrintableIPAddress() << "]["
                    << DataConversion::Uint8VecToHexStr(m_hash).substr(0, 6)
-                   << "] DONE");
+                   << "] BEGN");
   }
+
+  Dispatch(move(peers));
 }
 
 void P2PComm::ProcessSendJob(SendJob* job) {
@@ -337,13 +383,6 @@ void P2PComm::ProcessSendJob(SendJob* job) {
   m_SendPool.AddJob(funcSendMsg);
 }
 
-void P2PComm::ClearBroadcastHashAsync(
-    const vector<unsigned char>& message_hash) {
-  LOG_MARKER();
-  lock_guard<mutex> guard(m_broadcastToRemoveMutex);
-  m_broadcastToRemove.emplace_back(message_hash, chrono::system_clock::now());
-}
-
 void P2PComm::EventCallback(struct bufferevent* bev, short events,
                             [[gnu::unused]] void* ctx) {
   unique_ptr<struct bufferevent, decltype(&bufferevent_free)> socket_closer(
@@ -354,12 +393,37 @@ void P2PComm::EventCallback(struct bufferevent* bev, short events,
     return;
   }
 
+  if (events & BEV_EVENT_TIMEOUT) {
+    LOG_GENERAL(DEBUG, "Closing idle incoming connection.");
+    return;
+  }
+
   // Not all bytes read out
-  if (!(events & (BEV_EVENT_EOF | BEV_EVENT_ERROR))) {
+  if (!(events & BEV_EVENT_EOF)) {
     LOG_GENERAL(WARNING, "Unknown error from bufferevent.");
     return;
   }
 
+  // Peer closed the connection, pick up any frames not yet processed
+  if (!ReadFrames(bev)) {
+    return;
+  }
+
+  struct evbuffer* input = bufferevent_get_input(bev);
+  if ((input != NULL) && (evbuffer_get_length(input) > 0)) {
+    LOG_GENERAL(WARNING, "Incomplete message received ("
+                             << evbuffer_get_length(input) << " bytes).");
+  }
+}
+
+void P2PComm::ReadCallback(struct bufferevent* bev,
+                           [[gnu::unused]] void* ctx) {
+  if (!ReadFrames(bev)) {
+    bufferevent_free(bev);
+  }
+}
+
+bool P2PComm::ReadFrames(struct bufferevent* bev) {
   // Get the IP info
   int fd = bufferevent_getfd(bev);
   struct sockaddr_in cli_addr;
@@ -371,24 +435,78 @@ void P2PComm::EventCallback(struct bufferevent* bev, short events,
   struct evbuffer* input = bufferevent_get_input(bev);
   if (input == NULL) {
     LOG_GENERAL(WARNING, "bufferevent_get_input failure.");
-    return;
-  }
-  size_t len = evbuffer_get_length(input);
-  if (len == 0) {
-    LOG_GENERAL(WARNING, "evbuffer_get_length failure.");
-    return;
+    return false;
   }
-  vector<unsigned char> message(len);
-  if (evbuffer_copyout(input, message.data(), len) !=
-      static_cast<ev_ssize_t>(len)) {
-    LOG_GENERAL(WARNING, "evbuffer_copyout failure.");
-    return;
+
+  // A connection may carry any number of frames back to back
+  while (true) {
+    const size_t len = evbuffer_get_length(input);
+    if (len < HDR_LEN) {
+      // Wake up again as soon as the next header is complete
+      bufferevent_setwatermark(bev, EV_READ, HDR_LEN, 0);
+      return true;
+    }
+
+    unsigned char header[HDR_LEN];
+    if (evbuffer_copyout(input, header, HDR_LEN) !=
+        static_cast<ev_ssize_t>(HDR_LEN)) {
+      LOG_GENERAL(WARNING, "evbuffer_copyout failure.");
+      return false;
+    }
+
+    // Once the version is wrong we can no longer find the frame boundaries
+    if (header[0] != (unsigned char)(MSG_VERSION & 0xFF)) {
+      LOG_GENERAL(WARNING, "Header version wrong, received ["
+                               << header[0] - 0x00 << "] while expected ["
+                               << MSG_VERSION << "].");
+      return false;
+    }
+
+    const uint32_t messageLength =
+        (header[2] << 24) + (header[3] << 16) + (header[4] << 8) + header[5];
+
+    // Refuse to buffer a frame we would drop anyway
+    if (messageLength > MAX_MESSAGE_SIZE_IN_BYTES) {
+      LOG_GENERAL(WARNING, "Message too large from "
+                               << from << " (messageLength = "
+                               << messageLength << ", max "
+                               << MAX_MESSAGE_SIZE_IN_BYTES << ").");
+      return false;
+    }
+
+    if (len < HDR_LEN + messageLength) {
+      // Let libevent keep reading without calling us for every chunk
+      bufferevent_setwatermark(bev, EV_READ, HDR_LEN + messageLength, 0);
+      return true;
+    }
+
+    evbuffer_drain(input, HDR_LEN);
+    const size_t next = len - HDR_LEN - messageLength;
+
+    ProcessMessage(header[1], messageLength, input, from);
+
+    // Skip whatever ProcessMessage left of a frame it dropped
+    const size_t left = evbuffer_get_length(input);
+    if (left > next) {
+      evbuffer_drain(input, left - next);
+    }
   }
-  if (evbuffer_drain(input, len) != 0) {
-    LOG_GENERAL(WARNING, "evbuffer_drain failure.");
-    return;
+}
+
+namespace {
+// Moves the next dst.size() bytes of the input buffer into dst.
+bool RemoveFromInput(struct evbuffer* input, vector<unsigned char>& dst) {
+  if (evbuffer_remove(input, dst.data(), dst.size()) !=
+      static_cast<int>(dst.size())) {
+    LOG_GENERAL(WARNING, "evbuffer_remove failure.");
+    return false;
   }
+  return true;
+}
+}  // namespace
 
+void P2PComm::ProcessMessage(unsigned char startByte, uint32_t messageLength,
+                             struct evbuffer* input, Peer from) {
   // Reception format:
   // 0x01 ~ 0xFF - version, defined in constant file
   // 0x11 - start byte
@@ -411,82 +529,60 @@ void P2PComm::EventCallback(struct bufferevent* bev, short events,
   // 0x00 0x00 0x00 0x01 - 4-byte length of message
   // 0x00
 
+  // The header was already read and checked by ReadFrames; input holds the
+  // messageLength bytes that follow it. The payload is removed straight into
+  // the buffer handed to the dispatcher.
+
   // Check for minimum message size
-  if (message.size() <= HDR_LEN) {
+  if (messageLength == 0) {
     LOG_GENERAL(WARNING, "Empty message received.");
     return;
   }
 
-  const unsigned char version = message[0];
-  const unsigned char startByte = message[1];
-
-  // Check for version requirement
-  if (version != (unsigned char)(MSG_VERSION & 0xFF)) {
-    LOG_GENERAL(WARNING, "Header version wrong, received ["
-                             << version - 0x00 << "] while expected ["
-                             << MSG_VERSION << "].");
-    return;
-  }
-
-  const uint32_t messageLength =
-      (message[2] << 24) + (message[3] << 16) + (message[4] << 8) + message[5];
-
-  // Check for length consistency
-  if (messageLength != message.size() - HDR_LEN) {
-    LOG_GENERAL(WARNING, "Incorrect message length.");
-    return;
-  }
-
   if (startByte == START_BYTE_BROADCAST) {
-    LOG_PAYLOAD(INFO, "Incoming broadcast message from " << from, message,
-                Logger::MAX_BYTES_TO_DISPLAY);
-
-    if ((messageLength - HDR_LEN) <= HASH_LEN) {
+    if (messageLength <= HASH_LEN) {
       LOG_GENERAL(WARNING,
                   "Hash missing or empty broadcast message (messageLength = "
                       << messageLength << ")");
       return;
     }
 
-    vector<unsigned char> msg_hash(message.begin() + HDR_LEN,
-                                   message.begin() + HDR_LEN + HASH_LEN);
+    vector<unsigned char> msg_hash(HASH_LEN);
+    vector<unsigned char> message(messageLength - HASH_LEN);
+    if (!RemoveFromInput(input, msg_hash) || !RemoveFromInput(input, message)) {
+      return;
+    }
+
+    LOG_PAYLOAD(INFO, "Incoming broadcast message from " << from, message,
+                Logger::MAX_BYTES_TO_DISPLAY);
 
     P2PComm& p2p = P2PComm::GetInstance();
 
-    // Check if this message has been received before
-    bool found = false;
-    {
-      lock_guard<mutex> guard(p2p.m_broadcastHashesMutex);
-
-      found =
-          (p2p.m_broadcastHashes.find(msg_hash) != p2p.m_broadcastHashes.end());
-      // While we have the lock, we should quickly add the hash
-      if (!found) {
-        SHA2<HASH_TYPE::HASH_VARIANT_256> sha256;
-        sha256.Update(message, HDR_LEN + HASH_LEN,
-                      message.size() - HDR_LEN - HASH_LEN);
-        vector<unsigned char> this_msg_hash = sha256.Finalize();
-
-        if (this_msg_hash == msg_hash) {
-          p2p.m_broadcastHashes.insert(this_msg_hash);
-        } else {
-          LOG_GENERAL(WARNING, "Incorrect message hash.");
-          return;
-        }
-      }
+    // Cheap check first, most duplicates are dropped here without hashing
+    const dev::h256 hashKey(msg_hash);
+    if (p2p.m_broadcastHashes.Contains(hashKey)) {
+      LOG_GENERAL(INFO, "Discarding duplicate broadcast message.");
+      return;
+    }
+
+    dev::h256 computedHash;
+    SHA2<HASH_TYPE::HASH_VARIANT_256>::Hash(message, computedHash);
+    if (computedHash != hashKey) {
+      LOG_GENERAL(WARNING, "Incorrect message hash.");
+      return;
     }
 
-    if (found) {
-      // We already sent and/or received this message before -> discard
+    // Another connection may have delivered the same message meanwhile
+    if (!p2p.m_broadcastHashes.Insert(hashKey)) {
       LOG_GENERAL(INFO, "Discarding duplicate broadcast message.");
       return;
     }
 
     unsigned char msg_type = 0xFF;
     unsigned char ins_type = 0xFF;
-    if (messageLength - HASH_LEN > MessageOffset::INST) {
-      msg_type = message.at(HDR_LEN + HASH_LEN + MessageOffset::TYPE);
-      ins_type = message.at(HDR_LEN + HASH_LEN + MessageOffset::INST);
+    if (message.size() > MessageOffset::INST) {
+      msg_type = message.at(MessageOffset::TYPE);
+      ins_type = message.at(MessageOffset::INST);
     }
 
     vector<Peer> broadcast_list =
@@ -496,36 +592,27 @@ void P2PComm::EventCallback(struct bufferevent* bev, short events,
       p2p.RebroadcastMessage(broadcast_list, message, msg_hash);
     }
 
-    p2p.ClearBroadcastHashAsync(msg_hash);
-
     LOG_STATE(
         "[BROAD][" << std::setw(15) << std::left << p2p.m_selfPeer << "]["
                    << DataConversion::Uint8VecToHexStr(msg_hash).substr(0, 6)
                    << "] RECV");
 
-    // Move the shared_ptr message to raw pointer type
-    pair<vector<unsigned char>, Peer>* raw_message =
-        new pair<vector<unsigned char>, Peer>(
-            vector<unsigned char>(message.begin() + HDR_LEN + HASH_LEN,
-                                  message.end()),
-            from);
     LOG_GENERAL(INFO, "Size of Message: " << message.size());
 
     // Queue the message
-    m_dispatcher(raw_message);
+    m_dispatcher(new pair<vector<unsigned char>, Peer>(move(message), from));
   } else if (startByte == START_BYTE_NORMAL) {
+    vector<unsigned char> message(messageLength);
+    if (!RemoveFromInput(input, message)) {
+      return;
+    }
+
     LOG_PAYLOAD(INFO, "Incoming normal message from " << from, message,
                 Logger::MAX_BYTES_TO_DISPLAY);
-
-    // Move the shared_ptr message to raw pointer type
-    pair<vector<unsigned char>, Peer>* raw_message =
-        new pair<vector<unsigned char>, Peer>(
-            vector<unsigned char>(message.begin() + HDR_LEN, message.end()),
-            from);
     LOG_GENERAL(INFO, "Size of Message: " << message.size());
 
     // Queue the message
-    m_dispatcher(raw_message);
+    m_dispatcher(new pair<vector<unsigned char>, Peer>(move(message), from));
   } else if (startByte == START_BYTE_GOSSIP) {
     if (messageLength <
         GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN + GOSSIP_SNDR_LISTNR_PORT_LEN) {
@@ -536,49 +623,49 @@ void P2PComm::EventCallback(struct bufferevent* bev, short events,
       return;
     }
 
-    unsigned char gossipMsgTyp = message.at(HDR_LEN);
+    vector<unsigned char> gossipHeader(GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN +
+                                       GOSSIP_SNDR_LISTNR_PORT_LEN);
+    RumorManager::RawBytes rumor_message(messageLength - gossipHeader.size());
+    if (!RemoveFromInput(input, gossipHeader) ||
+        !RemoveFromInput(input, rumor_message)) {
+      return;
+    }
+
+    unsigned char gossipMsgTyp = gossipHeader.at(0);
 
     const uint32_t gossipMsgRound =
-        (message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN) << 24) +
-        (message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN + 1) << 16) +
-        (message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN + 2) << 8) +
-        message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN + 3);
+        (gossipHeader.at(GOSSIP_MSGTYPE_LEN) << 24) +
+        (gossipHeader.at(GOSSIP_MSGTYPE_LEN + 1) << 16) +
+        (gossipHeader.at(GOSSIP_MSGTYPE_LEN + 2) << 8) +
+        gossipHeader.at(GOSSIP_MSGTYPE_LEN + 3);
 
     const uint32_t gossipSenderPort =
-        (message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN) << 24) +
-        (message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN + 1)
-         << 16) +
-        (message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN + 2) << 8) +
-        message.at(HDR_LEN + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN + 3);
+        (gossipHeader.at(GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN) << 24) +
+        (gossipHeader.at(GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN + 1) << 16) +
+        (gossipHeader.at(GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN + 2) << 8) +
+        gossipHeader.at(GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN + 3);
     from.m_listenPortHost = gossipSenderPort;
 
-    RumorManager::RawBytes rumor_message(
-        message.begin() + HDR_LEN + GOSSIP_MSGTYPE_LEN + GOSSIP_ROUND_LEN +
-            GOSSIP_SNDR_LISTNR_PORT_LEN,
-        message.end());
-
     P2PComm& p2p = P2PComm::GetInstance();
     if (gossipMsgTyp == (uint8_t)RRS::Message::Type::FORWARD) {
       LOG_GENERAL(INFO,
                   "Received Gossip of type - FORWARD from Peer :" << from);
 
       if (p2p.SpreadRumor(rumor_message)) {
-        std::pair<vector<unsigned char>, Peer>* raw_message =
-            new pair<vector<unsigned char>, Peer>(rumor_message, from);
         LOG_GENERAL(INFO, "Size of Message: " << rumor_message.size());
 
         // Queue the message
-        m_dispatcher(raw_message);
+        m_dispatcher(
+            new pair<vector<unsigned char>, Peer>(move(rumor_message), from));
       }
     } else if (p2p.m_rumorManager.RumorReceived((unsigned int)gossipMsgTyp,
                                                 gossipMsgRound, rumor_message,
                                                 from)) {
-      std::pair<vector<unsigned char>, Peer>* raw_message =
-          new pair<vector<unsigned char>, Peer>(rumor_message, from);
       LOG_GENERAL(INFO, "Size of Message: " << rumor_message.size());
 
       // Queue the message
-      m_dispatcher(raw_message);
+      m_dispatcher(
+          new pair<vector<unsigned char>, Peer>(move(rumor_message), from));
     }
   } else {
     // Unexpected start byte. Drop this message
@@ -629,7 +716,14 @@ void P2PComm::AcceptConnectionCallback([[gnu::unused]] evconnlistener* listener,
     return;
   }
 
-  bufferevent_setcb(bev, NULL, NULL, EventCallback, NULL);
+  // Senders keep their connections open and close them when idle, so wait
+  // longer than them before dropping an idle incoming connection
+  struct timeval idle = {2 * CONNECTION_IDLE_TIMEOUT_IN_SECONDS, 0};
+  bufferevent_set_timeouts(bev, &idle, NULL);
+
+  // Frames are parsed as they arrive, starting from the first header
+  bufferevent_setwatermark(bev, EV_READ, HDR_LEN, 0);
+  bufferevent_setcb(bev, ReadCallback, NULL, EventCallback, NULL);
   bufferevent_enable(bev, EV_READ | EV_WRITE);
 }
 
@@ -673,13 +767,21 @@ void P2PComm::StartMessagePump(uint32_t listen_port_host, Dispatcher dispatcher,
   serv_addr.sin_port = htons(listen_port_host);
   serv_addr.sin_addr.s_addr = INADDR_ANY;
 
+  // Outgoing connections are written to from the send pool threads
+  if (evthread_use_pthreads() != 0) {
+    LOG_GENERAL(WARNING, "evthread_use_pthreads failure.");
+    return;
+  }
+
   // Create the listener
   struct event_base* base = event_base_new();
   struct evconnlistener* listener = evconnlistener_new_bind(
       base, AcceptConnectionCallback, nullptr,
       LEV_OPT_REUSEABLE | LEV_OPT_CLOSE_ON_FREE, -1,
       (struct sockaddr*)&serv_addr, sizeof(struct sockaddr_in));
+  m_connectionPool.SetEventBase(base);
   event_base_dispatch(base);
+  m_connectionPool.SetEventBase(nullptr);
   evconnlistener_free(listener);
   event_base_free(base);
 }
@@ -698,7 +800,7 @@ void P2PComm::SendMessage(const vector<Peer>& peers,
   dynamic_cast<SendJobPeers<vector<Peer>>*>(job)->m_peers = peers;
   job->m_selfPeer = m_selfPeer;
   job->m_startbyte = startByteType;
-  job->m_message = message;
+  job->m_message = make_shared<const vector<unsigned char>>(message);
   job->m_hash.clear();
 
   // Queue job
@@ -721,7 +823,7 @@ void P2PComm::SendMessage(const deque<Peer>& peers,
   dynamic_cast<SendJobPeers<deque<Peer>>*>(job)->m_peers = peers;
   job->m_selfPeer = m_selfPeer;
   job->m_startbyte = startByteType;
-  job->m_message = message;
+  job->m_message = make_shared<const vector<unsigned char>>(message);
   job->m_hash.clear();
 
   // Queue job
@@ -740,7 +842,7 @@ void P2PComm::SendMessage(const Peer& peer,
   dynamic_cast<SendJobPeer*>(job)->m_peer = peer;
   job->m_selfPeer = m_selfPeer;
   job->m_startbyte = startByteType;
-  job->m_message = message;
+  job->m_message = make_shared<const vector<unsigned char>>(message);
   job->m_hash.clear();
 
   // Queue job
@@ -765,18 +867,15 @@ void P2PComm::SendBroadcastMessage(const vector<Peer>& peers,
   dynamic_cast<SendJobPeers<vector<Peer>>*>(job)->m_peers = peers;
   job->m_selfPeer = m_selfPeer;
   job->m_startbyte = START_BYTE_BROADCAST;
-  job->m_message = message;
+  job->m_message = make_shared<const vector<unsigned char>>(message);
   job->m_hash = sha256.Finalize();
 
-  vector<unsigned char> hashCopy(job->m_hash);
+  m_broadcastHashes.Insert(dev::h256(job->m_hash));
 
   // Queue job
   while (!m_sendQueue.push(job)) {
     // Keep attempting to push until success
   }
-
-  lock_guard<mutex> guard(m_broadcastHashesMutex);
-  m_broadcastHashes.insert(hashCopy);
 }
 
 void P2PComm::SendBroadcastMessage(const deque<Peer>& peers,
@@ -795,18 +894,15 @@ void P2PComm::SendBroadcastMessage(const deque<Peer>& peers,
   dynamic_cast<SendJobPeers<deque<Peer>>*>(job)->m_peers = peers;
   job->m_selfPeer = m_selfPeer;
   job->m_startbyte = START_BYTE_BROADCAST;
-  job->m_message = message;
+  job->m_message = make_shared<const vector<unsigned char>>(message);
   job->m_hash = sha256.Finalize();
 
-  vector<unsigned char> hashCopy(job->m_hash);
+  m_broadcastHashes.Insert(dev::h256(job->m_hash));
 
   // Queue job
   while (!m_sendQueue.push(job)) {
     // Keep attempting to push until success
   }
-
-  lock_guard<mutex> guard(m_broadcastHashesMutex);
-  m_broadcastHashes.insert(hashCopy);
 }
 
 void P2PComm::RebroadcastMessage(const vector<Peer>& peers,
@@ -819,8 +915,7 @@ void P2PComm::RebroadcastMessage(const vector<Peer>& peers,
   dynamic_cast<SendJobPeers<vector<Peer>>*>(job)->m_peers = peers;
   job->m_selfPeer = Peer();
   job->m_startbyte = START_BYTE_BROADCAST;
-  copy(message.begin() + HDR_LEN + HASH_LEN, message.end(),
-       back_inserter(job->m_message));
+  job->m_message = make_shared<const vector<unsigned char>>(message);
   job->m_hash = msg_hash;
 
   // Queue job
@@ -24,40 +24,55 @@
 #include <boost/lockfree/queue.hpp>
 #include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <vector>
 
+#include "BroadcastHashSet.h"
+#include "ConnectionPool.h"
 #include "Peer.h"
 #include "RumorManager.h"
 #include "common/Constants.h"
+#include "libUtils/Executor.h"
 #include "libUtils/Logger.h"
 #include "libUtils/ThreadPool.h"
 
+struct evbuffer;
 struct evconnlistener;
+struct iovec;
 
 extern const unsigned char START_BYTE_NORMAL;
 extern const unsigned char START_BYTE_GOSSIP;
 
 class SendJob {
  protected:
-  static uint32_t writeMsg(const void* buf, int cli_sock, const Peer& from,
-                           const uint32_t message_length);
+  static uint32_t writeMsg(struct iovec* iov, int iovcnt, int cli_sock,
+                           const Peer& from);
   static bool SendMessageSocketCore(const Peer& peer,
-                                    const std::vector<unsigned char>& message,
-                                    unsigned char start_byte,
-                                    const std::vector<unsigned char>& msg_hash);
+                                    const std::vector<unsigned char>& header,
+                                    const std::vector<unsigned char>& message);
+
+  /// Builds the frame header, followed by the hash for broadcast messages.
+  static std::vector<unsigned char> ComposeHeader(
+      unsigned char start_byte, uint32_t message_size,
+      const std::vector<unsigned char>& msg_hash);
+
+  /// Sends the message to all peers in parallel over the persistent
+  /// connections, or one by one over one-shot sockets if the event loop is
+  /// not running.
+  void Dispatch(std::vector<Peer>&& peers);
 
  public:
   Peer m_selfPeer;
   unsigned char m_startbyte;
-  std::vector<unsigned char> m_message;
+  std::shared_ptr<const std::vector<unsigned char>> m_message;
   std::vector<unsigned char> m_hash;
 
   static void SendMessageCore(const Peer& peer,
-                              const std::vector<unsigned char> message,
+                              const std::vector<unsigned char>& message,
                               unsigned char startbyte,
-                              const std::vector<unsigned char> hash);
+                              const std::vector<unsigned char>& hash);
 
   virtual ~SendJob() {}
   virtual void DoSend() = 0;
@@ -78,18 +93,15 @@ class SendJobPeers : public SendJob {
 
 /// Provides network layer functionality.
 class P2PComm {
-  std::set<std::vector<unsigned char>> m_broadcastHashes;
-  std::mutex m_broadcastHashesMutex;
-  std::deque<std::pair<std::vector<unsigned char>,
-                       std::chrono::time_point<std::chrono::system_clock>>>
-      m_broadcastToRemove;
-  std::mutex m_broadcastToRemoveMutex;
+  /// Hashes of broadcasts sent or received in the last BROADCAST_EXPIRY
+  /// seconds, rotated every BROADCAST_INTERVAL seconds.
+  BroadcastHashSet m_broadcastHashes;
+  /// Rotates m_broadcastHashes, cancelled on destruction
+  Executor::TimerId m_rotateTimer;
   RumorManager m_rumorManager;
 
   const static uint32_t MAXPUMPMESSAGE = 128;
 
-  void ClearBroadcastHashAsync(const std::vector<unsigned char>& message_hash);
-
   P2PComm();
   ~P2PComm();
 
@@ -107,6 +119,14 @@ class P2PComm {
   boost::lockfree::queue<SendJob*> m_sendQueue;
   void ProcessSendJob(SendJob* job);
 
+  /// Persistent outgoing connections, driven by the message pump event loop.
+  ConnectionPool m_connectionPool;
+  friend class SendJob;
+
+  static bool ReadFrames(struct bufferevent* bev);
+  static void ProcessMessage(unsigned char startByte, uint32_t messageLength,
+                             struct evbuffer* input, Peer from);
+  static void ReadCallback(struct bufferevent* bev, void* ctx);
   static void EventCallback(struct bufferevent* bev, short events, void* ctx);
   static void AcceptConnectionCallback(evconnlistener* listener,
                                        evutil_socket_t cli_sock,
@@ -163,6 +183,7 @@ class P2PComm {
   void SendBroadcastMessage(const std::deque<Peer>& peers,
                             const std::vector<unsigned char>& message);
 
+  /// Forwards a received broadcast payload (without header and hash).
   void RebroadcastMessage(const std::vector<Peer>& peers,
                           const std::vector<unsigned char>& message,
                           const std::vector<unsigned char>& msg_hash);
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <cstdlib>
+
+#include "SendScheduler.h"
+#include "common/Constants.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+SendScheduler::SendScheduler(
+    ConnectionPool& pool, vector<Peer>&& peers, vector<unsigned char>&& header,
+    const shared_ptr<const vector<unsigned char>>& body, const DoneFunc& done)
+    : m_pool(pool),
+      m_peers(move(peers)),
+      m_header(move(header)),
+      m_body(body),
+      m_done(done),
+      m_start(chrono::steady_clock::now()),
+      m_attempts(m_peers.size(), 0),
+      m_next(0),
+      m_inFlight(0),
+      m_stats{0, 0, 0, chrono::milliseconds(0), chrono::milliseconds(0)} {}
+
+void SendScheduler::Start(ConnectionPool& pool, vector<Peer>&& peers,
+                          vector<unsigned char>&& header,
+                          const shared_ptr<const vector<unsigned char>>& body,
+                          const DoneFunc& done) {
+  if (peers.empty()) {
+    if (done) {
+      done(Stats{0, 0, 0, chrono::milliseconds(0), chrono::milliseconds(0)});
+    }
+    return;
+  }
+
+  shared_ptr<SendScheduler> scheduler(
+      new SendScheduler(pool, move(peers), move(header), body, done));
+  scheduler->Pump();
+}
+
+void SendScheduler::Pump() {
+  while (true) {
+    size_t index = 0;
+
+    {
+      lock_guard<mutex> g(m_mutex);
+
+      if ((m_inFlight >= SEND_INFLIGHT_LIMIT) || (m_next >= m_peers.size())) {
+        return;
+      }
+
+      index = m_next++;
+      m_inFlight++;
+    }
+
+    // A refused send is recorded here rather than through OnSent(), which
+    // would re-enter Pump() once for every peer that fails in a row
+    if (!Send(index)) {
+      Record(index, false);
+    }
+  }
+}
+
+bool SendScheduler::Send(size_t index) {
+  {
+    lock_guard<mutex> g(m_mutex);
+    m_attempts.at(index)++;
+  }
+
+  auto self = shared_from_this();
+  return m_pool.Send(m_peers.at(index), m_header, m_body,
+                     [self, index](bool sent) { self->OnSent(index, sent); });
+}
+
+void SendScheduler::OnSent(size_t index, bool sent) {
+  Record(index, sent);
+  Pump();
+}
+
+void SendScheduler::Record(size_t index, bool sent) {
+  const Peer& peer = m_peers.at(index);
+
+  if (!sent) {
+    unsigned int attempts = 0;
+    {
+      lock_guard<mutex> g(m_mutex);
+      attempts = m_attempts.at(index);
+    }
+
+    if (attempts <= MAXRETRYCONN) {
+      // Exponential backoff with jitter, so that peers which failed together
+      // do not all come back at the same moment
+      const unsigned int backoff = SEND_RETRY_BACKOFF_IN_MS << (attempts - 1);
+      const chrono::milliseconds delay(backoff + rand() % (backoff + 1));
+
+      LOG_GENERAL(WARNING, "Send failed " << attempts << "/" << MAXRETRYCONN
+                                          << ", retrying in " << delay.count()
+                                          << " ms. IP address: " << peer);
+
+      auto self = shared_from_this();
+      if (m_pool.Defer(
+              [self, index]() {
+                if (!self->Send(index)) {
+                  self->OnSent(index, false);
+                }
+              },
+              delay)) {
+        lock_guard<mutex> g(m_mutex);
+        m_stats.m_retries++;
+        return;
+      }
+    }
+
+    LOG_GENERAL(WARNING,
+                "Send failed over " << MAXRETRYCONN << " times. IP address: "
+                                    << peer);
+  }
+
+  bool finished = false;
+  {
+    lock_guard<mutex> g(m_mutex);
+
+    m_inFlight--;
+
+    if (sent) {
+      m_stats.m_sent++;
+      m_stats.m_slowestPeer =
+          max(m_stats.m_slowestPeer,
+              chrono::duration_cast<chrono::milliseconds>(
+                  chrono::steady_clock::now() - m_start));
+    } else {
+      m_stats.m_failed++;
+    }
+
+    finished = (m_stats.m_sent + m_stats.m_failed == m_peers.size());
+
+    if (finished) {
+      m_stats.m_elapsed = chrono::duration_cast<chrono::milliseconds>(
+          chrono::steady_clock::now() - m_start);
+    }
+  }
+
+  if (!finished) {
+    return;
+  }
+
+  LOG_GENERAL(INFO, "Sent to " << m_stats.m_sent << "/" << m_peers.size()
+                                << " peers in " << m_stats.m_elapsed.count()
+                                << " ms (slowest "
+                                << m_stats.m_slowestPeer.count() << " ms, "
+                                << m_stats.m_retries << " retries)");
+
+  if (m_done) {
+    m_done(m_stats);
+  }
+}
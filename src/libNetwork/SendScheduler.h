@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#ifndef __SENDSCHEDULER_H__
+#define __SENDSCHEDULER_H__
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ConnectionPool.h"
+#include "Peer.h"
+
+/// Fans one message out to a list of peers over the ConnectionPool.
+/// At most SEND_INFLIGHT_LIMIT peers are being sent to at any time. A peer
+/// that fails or stalls is retried asynchronously with exponential backoff,
+/// up to MAXRETRYCONN times, without holding up the other peers.
+class SendScheduler : public std::enable_shared_from_this<SendScheduler> {
+ public:
+  /// Per-send results, reported once every peer has succeeded or given up.
+  struct Stats {
+    unsigned int m_sent;
+    unsigned int m_failed;
+    unsigned int m_retries;
+    /// Time from the start of the send until the last peer finished
+    std::chrono::milliseconds m_elapsed;
+    /// Slowest time until a peer received the whole message
+    std::chrono::milliseconds m_slowestPeer;
+  };
+
+  using DoneFunc = std::function<void(const Stats& stats)>;
+
+  /// Starts sending header + body to all peers. done (optional) is called
+  /// from the event loop thread when the send has completed.
+  static void Start(
+      ConnectionPool& pool, std::vector<Peer>&& peers,
+      std::vector<unsigned char>&& header,
+      const std::shared_ptr<const std::vector<unsigned char>>& body,
+      const DoneFunc& done);
+
+ private:
+  ConnectionPool& m_pool;
+  const std::vector<Peer> m_peers;
+  const std::vector<unsigned char> m_header;
+  const std::shared_ptr<const std::vector<unsigned char>> m_body;
+  const DoneFunc m_done;
+  const std::chrono::time_point<std::chrono::steady_clock> m_start;
+
+  std::mutex m_mutex;
+  std::vector<unsigned int> m_attempts;
+  size_t m_next;
+  unsigned int m_inFlight;
+  Stats m_stats;
+
+  SendScheduler(ConnectionPool& pool, std::vector<Peer>&& peers,
+                std::vector<unsigned char>&& header,
+                const std::shared_ptr<const std::vector<unsigned char>>& body,
+                const DoneFunc& done);
+
+  /// Starts sends to pending peers until the in-flight limit is reached.
+  void Pump();
+
+  /// Hands the message for one peer to the connection pool. Returns false
+  /// if the pool refused it, in which case no result will be reported.
+  bool Send(size_t index);
+
+  /// Records the result reported for one peer and starts the next peers.
+  void OnSent(size_t index, bool sent);
+
+  /// Handles the result for one peer: retry, or count it and move on.
+  /// Never starts other sends, so that Pump() can call it in its loop.
+  void Record(size_t index, bool sent);
+};
+
+#endif  // __SENDSCHEDULER_H__
@@ -35,7 +35,6 @@
 #include "libMessage/Messenger.h"
 #include "libUtils/BitVector.h"
 #include "libUtils/DataConversion.h"
-#include "libUtils/DetachedFunction.h"
 #include "libUtils/Logger.h"
 #include "libUtils/TimeLockedFunction.h"
 #include "libUtils/TimeUtils.h"
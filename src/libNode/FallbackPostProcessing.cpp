@@ -228,8 +228,8 @@ void Node::ProcessFallbackConsensusWhenDone() {
     lock_guard<mutex> g(m_mediator.m_mutexCurSWInfo);
     if (m_mediator.GetIsVacuousEpoch() &&
         m_mediator.m_curSWInfo.GetUpgradeDS() - 1 ==
-            m_mediator.m_dsBlockChain.GetLastBlock()
-                .GetHeader()
+            m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                ->GetHeader()
                 .GetBlockNum()) {
       auto func = [this]() mutable -> void {
         UpgradeManager::GetInstance().ReplaceNode(m_mediator);
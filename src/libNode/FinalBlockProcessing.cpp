@@ -883,6 +883,9 @@ bool Node::ProcessStateDeltaFromFinalBlock(
 void Node::CommitForwardedTransactions(const ForwardedTxnEntry& entry) {
   LOG_MARKER();
 
+  // The bodies of the micro block go to disk in one write per database
+  BlockStorage::WriteBatch batch;
+
   unsigned int txn_counter = 0;
   for (const auto& twr : entry.m_transactions) {
     if (LOOKUP_NODE_MODE) {
@@ -893,7 +896,10 @@ void Node::CommitForwardedTransactions(const ForwardedTxnEntry& entry) {
     vector<unsigned char> serializedTxBody;
     twr.Serialize(serializedTxBody, 0);
     BlockStorage::GetBlockStorage().PutTxBody(twr.GetTransaction().GetTranID(),
-                                              serializedTxBody);
+                                              serializedTxBody, batch);
+    // Lets GetTransaction find the micro block for the inclusion proof
+    BlockStorage::GetBlockStorage().PutTxMicroBlock(
+        twr.GetTransaction().GetTranID(), entry.m_hash, batch);
 
     txn_counter++;
     if (txn_counter % 10000 == 0) {
@@ -901,6 +907,10 @@ void Node::CommitForwardedTransactions(const ForwardedTxnEntry& entry) {
                 "Proceessed " << txn_counter << " of txns.");
     }
   }
+
+  if (!BlockStorage::GetBlockStorage().CommitBatch(batch)) {
+    LOG_GENERAL(WARNING, "Failed to store txn bodies");
+  }
 }
 
 void Node::DeleteEntryFromFwdingAssgnAndMissingBodyCountMap(
@@ -45,7 +45,6 @@
 #include "libPOW/pow.h"
 #include "libUtils/BitVector.h"
 #include "libUtils/DataConversion.h"
-#include "libUtils/DetachedFunction.h"
 #include "libUtils/Logger.h"
 #include "libUtils/RootComputation.h"
 #include "libUtils/SanityChecks.h"
@@ -283,29 +282,9 @@ void Node::ProcessTransactionWhenShardLeader() {
   lock_guard<mutex> g(m_mutexCreatedTransactions);
 
   t_createdTxns = m_createdTxns;
-  map<Address, map<uint64_t, Transaction>> t_addrNonceTxnMap;
   t_processedTransactions.clear();
   m_TxnOrder.clear();
 
-  auto findOneFromAddrNonceTxnMap =
-      [](Transaction& t,
-         map<Address, map<uint64_t, Transaction>>& t_addrNonceTxnMap) -> bool {
-    for (auto it = t_addrNonceTxnMap.begin(); it != t_addrNonceTxnMap.end();
-         it++) {
-      if (it->second.begin()->first ==
-          AccountStore::GetInstance().GetNonceTemp(it->first) + 1) {
-        t = std::move(it->second.begin()->second);
-        it->second.erase(it->second.begin());
-
-        if (it->second.empty()) {
-          t_addrNonceTxnMap.erase(it);
-        }
-        return true;
-      }
-    }
-    return false;
-  };
-
   auto appendOne = [this](const Transaction& t, const TransactionReceipt& tr) {
     t_processedTransactions.insert(
         make_pair(t.GetTranID(), TransactionWithReceipt(t, tr)));
@@ -315,109 +294,39 @@ void Node::ProcessTransactionWhenShardLeader() {
   m_gasUsedTotal = 0;
   m_txnFees = 0;
 
+  auto getNonce = [](const Address& addr) {
+    return AccountStore::GetInstance().GetNonceTemp(addr);
+  };
+
   while (m_gasUsedTotal < MICROBLOCK_GAS_LIMIT) {
     Transaction t;
     TransactionReceipt tr;
 
-    // check m_addrNonceTxnMap contains any txn meets right nonce,
-    // if contains, process it
-    if (findOneFromAddrNonceTxnMap(t, t_addrNonceTxnMap)) {
-      // check whether m_createdTransaction have transaction with same Addr and
-      // nonce if has and with larger gasPrice then replace with that one.
-      // (*optional step)
-      t_createdTxns.findSameNonceButHigherGas(t);
-
-      if (m_mediator.m_validator->CheckCreatedTransaction(t, tr)) {
-        if (!SafeMath<uint64_t>::add(m_gasUsedTotal, tr.GetCumGas(),
-                                     m_gasUsedTotal)) {
-          LOG_GENERAL(WARNING, "m_gasUsedTotal addition unsafe!");
-          break;
-        }
-        uint128_t txnFee;
-        if (!SafeMath<uint128_t>::mul(tr.GetCumGas(), t.GetGasPrice(),
-                                      txnFee)) {
-          LOG_GENERAL(WARNING, "txnFee multiplication unsafe!");
-          continue;
-        }
-        if (!SafeMath<uint128_t>::add(m_txnFees, txnFee, m_txnFees)) {
-          LOG_GENERAL(WARNING, "m_txnFees addition unsafe!");
-          break;
-        }
-        appendOne(t, tr);
-
-        continue;
-      }
+    if (!t_createdTxns.findOne(t, getNonce)) {
+      break;
     }
-    // if no txn in u_map meet right nonce process new come-in transactions
-    else if (t_createdTxns.findOne(t)) {
-      // LOG_GENERAL(INFO, "findOneFromCreated");
-
-      Address senderAddr = t.GetSenderAddr();
-      // check nonce, if nonce larger than expected, put it into
-      // m_addrNonceTxnMap
-      if (t.GetNonce() >
-          AccountStore::GetInstance().GetNonceTemp(senderAddr) + 1) {
-        // LOG_GENERAL(INFO, "High nonce: "
-        //                     << t.GetNonce() << " cur sender " <<
-        //                     senderAddr.hex()
-        //                     << " nonce: "
-        //                     <<
-        //                     AccountStore::GetInstance().GetNonceTemp(senderAddr));
-        auto it1 = t_addrNonceTxnMap.find(senderAddr);
-        if (it1 != t_addrNonceTxnMap.end()) {
-          auto it2 = it1->second.find(t.GetNonce());
-          if (it2 != it1->second.end()) {
-            // found the txn with same addr and same nonce
-            // then compare the gasprice and remains the higher one
-            if (t.GetGasPrice() > it2->second.GetGasPrice()) {
-              it2->second = t;
-            }
-            continue;
-          }
-        }
-        t_addrNonceTxnMap[senderAddr].insert({t.GetNonce(), t});
+
+    if (m_mediator.m_validator->CheckCreatedTransaction(t, tr)) {
+      if (!SafeMath<uint64_t>::add(m_gasUsedTotal, tr.GetCumGas(),
+                                   m_gasUsedTotal)) {
+        LOG_GENERAL(WARNING, "m_gasUsedTotal addition unsafe!");
+        break;
       }
-      // if nonce too small, ignore it
-      else if (t.GetNonce() <
-               AccountStore::GetInstance().GetNonceTemp(senderAddr) + 1) {
-        // LOG_GENERAL(INFO,
-        //             "Nonce too small"
-        //                 << " Expected "
-        //                 <<
-        //                 AccountStore::GetInstance().GetNonceTemp(senderAddr)
-        //                 << " Found " << t.GetNonce());
+      uint128_t txnFee;
+      if (!SafeMath<uint128_t>::mul(tr.GetCumGas(), t.GetGasPrice(),
+                                    txnFee)) {
+        LOG_GENERAL(WARNING, "txnFee multiplication unsafe!");
+        continue;
       }
-      // if nonce correct, process it
-      else if (m_mediator.m_validator->CheckCreatedTransaction(t, tr)) {
-        if (!SafeMath<uint64_t>::add(m_gasUsedTotal, tr.GetCumGas(),
-                                     m_gasUsedTotal)) {
-          LOG_GENERAL(WARNING, "m_gasUsedTotal addition unsafe!");
-          break;
-        }
-        uint128_t txnFee;
-        if (!SafeMath<uint128_t>::mul(tr.GetCumGas(), t.GetGasPrice(),
-                                      txnFee)) {
-          LOG_GENERAL(WARNING, "txnFee multiplication unsafe!");
-          continue;
-        }
-        if (!SafeMath<uint128_t>::add(m_txnFees, txnFee, m_txnFees)) {
-          LOG_GENERAL(WARNING, "m_txnFees addition unsafe!");
-          break;
-        }
-        appendOne(t, tr);
-      } else {
-        // LOG_GENERAL(WARNING, "CheckCreatedTransaction failed");
+      if (!SafeMath<uint128_t>::add(m_txnFees, txnFee, m_txnFees)) {
+        LOG_GENERAL(WARNING, "m_txnFees addition unsafe!");
+        break;
       }
-    } else {
-      break;
-    }
-  }
-  // Put txns in map back into pool
-  for (const auto& kv : t_addrNonceTxnMap) {
-    for (const auto& nonceTxn : kv.second) {
-      t_createdTxns.insert(nonceTxn.second);
+      appendOne(t, tr);
     }
   }
+
+  t_createdTxns.unblockSenders();
 }
 
 bool Node::ProcessTransactionWhenShardBackup(
@@ -470,29 +379,8 @@ bool Node::VerifyTxnsOrdering(const vector<TxnHash>& tranHashes) {
 
   t_createdTxns = m_createdTxns;
   vector<TxnHash> t_tranHashes;
-  map<Address, map<uint64_t, Transaction>> t_addrNonceTxnMap;
   t_processedTransactions.clear();
 
-  auto findOneFromAddrNonceTxnMap =
-      [](Transaction& t,
-         std::map<Address, map<uint64_t, Transaction>>& t_addrNonceTxnMap)
-      -> bool {
-    for (auto it = t_addrNonceTxnMap.begin(); it != t_addrNonceTxnMap.end();
-         it++) {
-      if (it->second.begin()->first ==
-          AccountStore::GetInstance().GetNonceTemp(it->first) + 1) {
-        t = std::move(it->second.begin()->second);
-        it->second.erase(it->second.begin());
-
-        if (it->second.empty()) {
-          t_addrNonceTxnMap.erase(it);
-        }
-        return true;
-      }
-    }
-    return false;
-  };
-
   auto appendOne = [this, &t_tranHashes](const Transaction& t,
                                          const TransactionReceipt& tr) {
     t_tranHashes.emplace_back(t.GetTranID());
@@ -503,94 +391,39 @@ bool Node::VerifyTxnsOrdering(const vector<TxnHash>& tranHashes) {
   m_gasUsedTotal = 0;
   m_txnFees = 0;
 
+  auto getNonce = [](const Address& addr) {
+    return AccountStore::GetInstance().GetNonceTemp(addr);
+  };
+
   while (m_gasUsedTotal < MICROBLOCK_GAS_LIMIT) {
     Transaction t;
     TransactionReceipt tr;
 
-    // check t_addrNonceTxnMap contains any txn meets right nonce,
-    // if contains, process it
-    if (findOneFromAddrNonceTxnMap(t, t_addrNonceTxnMap)) {
-      // check whether m_createdTransaction have transaction with same Addr and
-      // nonce if has and with larger gasPrice then replace with that one.
-      // (*optional step)
-      t_createdTxns.findSameNonceButHigherGas(t);
-
-      if (m_mediator.m_validator->CheckCreatedTransaction(t, tr)) {
-        if (!SafeMath<uint64_t>::add(m_gasUsedTotal, tr.GetCumGas(),
-                                     m_gasUsedTotal)) {
-          LOG_GENERAL(WARNING, "m_gasUsedTotal addition unsafe!");
-          break;
-        }
-        uint128_t txnFee;
-        if (!SafeMath<uint128_t>::mul(tr.GetCumGas(), t.GetGasPrice(),
-                                      txnFee)) {
-          LOG_GENERAL(WARNING, "txnFee multiplication unsafe!");
-          continue;
-        }
-        if (!SafeMath<uint128_t>::add(m_txnFees, txnFee, m_txnFees)) {
-          LOG_GENERAL(WARNING, "m_txnFees addition unsafe!");
-          break;
-        }
-        appendOne(t, tr);
-        continue;
-      }
+    if (!t_createdTxns.findOne(t, getNonce)) {
+      break;
     }
-    // if no txn in u_map meet right nonce process new come-in transactions
-    else if (t_createdTxns.findOne(t)) {
-      Address senderAddr = t.GetSenderAddr();
-      // check nonce, if nonce larger than expected, put it into
-      // t_addrNonceTxnMap
-      if (t.GetNonce() >
-          AccountStore::GetInstance().GetNonceTemp(senderAddr) + 1) {
-        auto it1 = t_addrNonceTxnMap.find(senderAddr);
-        if (it1 != t_addrNonceTxnMap.end()) {
-          auto it2 = it1->second.find(t.GetNonce());
-          if (it2 != it1->second.end()) {
-            // found the txn with same addr and same nonce
-            // then compare the gasprice and remains the higher one
-            if (t.GetGasPrice() > it2->second.GetGasPrice()) {
-              it2->second = t;
-            }
-            continue;
-          }
-        }
-        t_addrNonceTxnMap[senderAddr].insert({t.GetNonce(), t});
+
+    if (m_mediator.m_validator->CheckCreatedTransaction(t, tr)) {
+      if (!SafeMath<uint64_t>::add(m_gasUsedTotal, tr.GetCumGas(),
+                                   m_gasUsedTotal)) {
+        LOG_GENERAL(WARNING, "m_gasUsedTotal addition overflow!");
+        break;
       }
-      // if nonce too small, ignore it
-      else if (t.GetNonce() <
-               AccountStore::GetInstance().GetNonceTemp(senderAddr) + 1) {
+      uint128_t txnFee;
+      if (!SafeMath<uint128_t>::mul(tr.GetCumGas(), t.GetGasPrice(),
+                                    txnFee)) {
+        LOG_GENERAL(WARNING, "txnFee multiplication overflow!");
+        continue;
       }
-      // if nonce correct, process it
-      else if (m_mediator.m_validator->CheckCreatedTransaction(t, tr)) {
-        if (!SafeMath<uint64_t>::add(m_gasUsedTotal, tr.GetCumGas(),
-                                     m_gasUsedTotal)) {
-          LOG_GENERAL(WARNING, "m_gasUsedTotal addition overflow!");
-          break;
-        }
-        uint128_t txnFee;
-        if (!SafeMath<uint128_t>::mul(tr.GetCumGas(), t.GetGasPrice(),
-                                      txnFee)) {
-          LOG_GENERAL(WARNING, "txnFee multiplication overflow!");
-          continue;
-        }
-        if (!SafeMath<uint128_t>::add(m_txnFees, txnFee, m_txnFees)) {
-          LOG_GENERAL(WARNING, "m_txnFees addition overflow!");
-          break;
-        }
-        appendOne(t, tr);
+      if (!SafeMath<uint128_t>::add(m_txnFees, txnFee, m_txnFees)) {
+        LOG_GENERAL(WARNING, "m_txnFees addition overflow!");
+        break;
       }
-    } else {
-      break;
+      appendOne(t, tr);
     }
   }
 
-  // Put remaining txns back in pool
-
-  for (const auto& kv : t_addrNonceTxnMap) {
-    for (const auto& nonceTxn : kv.second) {
-      t_createdTxns.insert(nonceTxn.second);
-    }
-  }
+  t_createdTxns.unblockSenders();
 
   // check for txn misorder tolerance
   const float TXN_MISORDER_TOLERANCE =
@@ -47,6 +47,7 @@
 #include "libPersistence/Retriever.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/DetachedFunction.h"
+#include "libUtils/Executor.h"
 #include "libUtils/Logger.h"
 #include "libUtils/SanityChecks.h"
 #include "libUtils/TimeLockedFunction.h"
@@ -291,6 +292,8 @@ bool Node::StartRetrieveHistory(bool& wakeupForUpgrade) {
 
   m_retriever = std::make_shared<Retriever>(m_mediator);
 
+  auto retrieveStart = r_timer_start();
+
   /// Retrieve block link
   bool ds_result = m_retriever->RetrieveBlockLink(wakeupForUpgrade);
 
@@ -298,6 +301,12 @@ bool Node::StartRetrieveHistory(bool& wakeupForUpgrade) {
   bool st_result = m_retriever->RetrieveStates();
   bool tx_result = m_retriever->RetrieveTxBlocks(wakeupForUpgrade);
 
+  LOG_GENERAL(INFO, "Retrieved blocks and states from disk in "
+                        << r_timer_end(retrieveStart) / 1000 << " ms (Tx "
+                        << m_mediator.m_txBlockChain.GetBlockCount()
+                        << " DS "
+                        << m_mediator.m_dsBlockChain.GetBlockCount() << ")");
+
   if (!tx_result) {
     return false;
   }
@@ -487,7 +496,7 @@ void Node::WakeupForUpgrade() {
         auto func = [this]() mutable -> void {
           m_mediator.m_ds->ProcessAndSendPoWPacketSubmissionToOtherDSComm();
         };
-        DetachedFunction(1, func);
+        Executor::GetInstance().Execute(func);
 
         LOG_EPOCH(INFO, to_string(m_mediator.m_currentEpochNum).c_str(),
                   "Waiting "
@@ -526,17 +535,19 @@ void Node::WakeupForUpgrade() {
       m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDifficulty();
   SetState(POW_SUBMISSION);
 
-  auto func = [this, block_num, dsDifficulty, difficulty]() mutable -> void {
-    LOG_GENERAL(
-        INFO, "Shard node, wait "
+  LOG_GENERAL(INFO,
+              "Shard node, wait "
                   << SHARD_DELAY_WAKEUP_IN_SECONDS - DS_DELAY_WAKEUP_IN_SECONDS
                   << " more seconds for lookup and DS nodes wakeup...");
-    this_thread::sleep_for(chrono::seconds(SHARD_DELAY_WAKEUP_IN_SECONDS -
-                                           DS_DELAY_WAKEUP_IN_SECONDS));
+  auto func = [this, block_num, dsDifficulty, difficulty]() mutable -> void {
     StartPoW(block_num, dsDifficulty, difficulty, m_mediator.m_dsBlockRand,
              m_mediator.m_txBlockRand);
   };
-  DetachedFunction(1, func);
+  // Only the wait is on the executor, mining runs on its own thread
+  Executor::GetInstance().ExecuteAfter(
+      chrono::seconds(SHARD_DELAY_WAKEUP_IN_SECONDS -
+                      DS_DELAY_WAKEUP_IN_SECONDS),
+      [func]() mutable { DetachedFunction(1, func); });
 }
 
 void Node::WakeupForRecovery() {
@@ -1071,24 +1082,25 @@ bool Node::ProcessTxnPacketFromLookupCore(const vector<unsigned char>& message,
 #endif  // DM_TEST_DM_LESSTXN_ALL
 
   // Process the txns
-  unsigned int processed_count = 0;
+  unsigned int processed_count = txns.size();
 
   LOG_GENERAL(INFO, "Start check txn packet from lookup");
 
-  std::vector<Transaction> checkedTxns;
-  for (const auto& txn : txns) {
-    if (m_mediator.m_validator->CheckCreatedTransactionFromLookup(txn)) {
-      checkedTxns.push_back(txn);
-    } else {
-      LOG_GENERAL(WARNING, "Txn is not valid.");
-    }
-
-    processed_count++;
+  auto checkStart = r_timer_start();
 
-    if (processed_count % 100 == 0) {
-      LOG_GENERAL(INFO, processed_count << " txns from packet processed");
-    }
-  }
+  std::vector<Transaction> checkedTxns;
+  checkedTxns.reserve(txns.size());
+  m_mediator.m_validator->CheckCreatedTransactionsFromLookup(txns,
+                                                             checkedTxns);
+
+  double checkTime = r_timer_end(checkStart);
+  LOG_GENERAL(INFO, "Txn packet checked: "
+                        << checkedTxns.size() << "/" << processed_count
+                        << " valid in " << checkTime / 1000 << " ms ("
+                        << (checkTime > 0 ? processed_count * 1e6 / checkTime
+                                          : 0)
+                        << " txns/s over "
+                        << std::thread::hardware_concurrency() << " cores)");
 
   {
     lock_guard<mutex> g(m_mutexCreatedTransactions);
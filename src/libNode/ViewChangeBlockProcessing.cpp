@@ -41,7 +41,6 @@
 #include "libNetwork/Guard.h"
 #include "libUtils/BitVector.h"
 #include "libUtils/DataConversion.h"
-#include "libUtils/DetachedFunction.h"
 #include "libUtils/Logger.h"
 #include "libUtils/SanityChecks.h"
 #include "libUtils/TimeLockedFunction.h"
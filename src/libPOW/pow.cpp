@@ -26,6 +26,7 @@
 #include "common/Serializable.h"
 #include "libCrypto/Sha2.h"
 #include "libUtils/DataConversion.h"
+#include "libUtils/DetachedFunction.h"
 #include "pow.h"
 
 #ifdef OPENCL_MINE
@@ -36,15 +37,17 @@
 #include "depends/libethash-cuda/CUDAMiner.h"
 #endif
 
+// Nonces searched by each miner thread or GPU before overlapping the next one
+constexpr uint32_t NONCE_SEGMENT_WIDTH = 40;
+const uint64_t NONCE_SEGMENT = (uint64_t)1 << NONCE_SEGMENT_WIDTH;
+
 POW::POW() {
   m_currentBlockNum = 0;
   m_epochContextLight =
       ethash::create_epoch_context(ethash::get_epoch_number(m_currentBlockNum));
 
-  if (FULL_DATASET_MINE && !CUDA_GPU_MINE && !OPENCL_GPU_MINE) {
-    m_epochContextFull = ethash::create_epoch_context_full(
-        ethash::get_epoch_number(m_currentBlockNum));
-  }
+  // The full dataset is only calculated once EthashConfigureClient asks for
+  // it, so that nodes which only verify do not pay for it
 
   if (!LOOKUP_NODE_MODE) {
     if (OPENCL_GPU_MINE) {
@@ -137,9 +140,53 @@ ethash_hash256 POW::DifficultyLevelInInt(uint8_t difficulty) {
   return StringToBlockhash(BytesToHexString(b, UINT256_SIZE));
 }
 
+unsigned int POW::GetNumMiningThreads() {
+  return CPU_MINING_THREADS > 0
+             ? CPU_MINING_THREADS
+             : std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::shared_ptr<ethash::epoch_context_full> POW::CreateEpochContextFull(
+    int epochNumber) {
+  std::shared_ptr<ethash::epoch_context_full> context =
+      ethash::create_epoch_context_full(epochNumber);
+  if (context == nullptr) {
+    LOG_GENERAL(WARNING, "Failed to allocate ethash full dataset for epoch "
+                             << epochNumber);
+    return context;
+  }
+
+  // Each thread calculates its own range of items
+  const uint64_t numItems =
+      ethash::calculate_full_dataset_num_items(epochNumber);
+  const unsigned int numThreads = GetNumMiningThreads();
+  auto startTime = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (unsigned int i = 0; i < numThreads; i++) {
+    threads.emplace_back([&context, numItems, numThreads, i]() {
+      ethash::fill_full_dataset(*context, numItems * i / numThreads,
+                                numItems * (i + 1) / numThreads);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - startTime)
+                       .count();
+  LOG_GENERAL(INFO, "Calculated ethash full dataset for epoch "
+                        << epochNumber << " with " << numThreads
+                        << " threads in " << elapsedMs << " ms");
+  return context;
+}
+
 bool POW::EthashConfigureClient(uint64_t block_number, bool fullDataset) {
   std::lock_guard<std::mutex> g(m_mutexLightClientConfigure);
+  ConfigureEpochContexts(block_number, fullDataset);
+  return true;
+}
 
+void POW::ConfigureEpochContexts(uint64_t block_number, bool fullDataset) {
   if (block_number < m_currentBlockNum) {
     LOG_GENERAL(WARNING,
                 "WARNING: How come the latest block number is smaller than "
@@ -148,60 +195,174 @@ bool POW::EthashConfigureClient(uint64_t block_number, bool fullDataset) {
                     << " currentBlockNum: " << m_currentBlockNum);
   }
 
-  if (ethash::get_epoch_number(block_number) !=
-      ethash::get_epoch_number(m_currentBlockNum)) {
-    auto epochNumber = ethash::get_epoch_number(block_number);
-    m_epochContextLight = ethash::create_epoch_context(epochNumber);
-  }
-
+  auto epochNumber = ethash::get_epoch_number(block_number);
   bool isMineFullCpu = fullDataset && !CUDA_GPU_MINE && !OPENCL_GPU_MINE;
 
-  if (isMineFullCpu && (m_epochContextFull == nullptr ||
-                        ethash::get_epoch_number(block_number) !=
-                            ethash::get_epoch_number(m_currentBlockNum))) {
-    m_epochContextFull = ethash::create_epoch_context_full(
-        ethash::get_epoch_number(block_number));
+  if (epochNumber != m_epochContextLight->epoch_number) {
+    auto prevEpochContextLight = m_epochContextLight;
+    if (m_nextEpochNumber == epochNumber) {
+      // Wait for the pre-generation if still in flight rather than
+      // generating the contexts a second time
+      m_epochContextLight = m_nextEpochContextLight.get();
+      if (m_nextEpochContextFull.valid()) {
+        m_epochContextFull = m_nextEpochContextFull.get();
+        m_epochNumberFull = epochNumber;
+      }
+    } else if (m_prevEpochContextLight != nullptr &&
+               m_prevEpochContextLight->epoch_number == epochNumber) {
+      m_epochContextLight = m_prevEpochContextLight;
+    } else if (m_verifyEpochNumber == epochNumber) {
+      m_epochContextLight = m_verifyEpochContextLight.get();
+    } else {
+      LOG_GENERAL(INFO, "Generating ethash context for epoch " << epochNumber);
+      m_epochContextLight = ethash::create_epoch_context(epochNumber);
+    }
+    m_prevEpochContextLight = prevEpochContextLight;
+  }
+
+  if (isMineFullCpu &&
+      (m_epochContextFull == nullptr || m_epochNumberFull != epochNumber)) {
+    LOG_GENERAL(INFO,
+                "Generating ethash full context for epoch " << epochNumber);
+    m_epochContextFull = CreateEpochContextFull(epochNumber);
+    m_epochNumberFull = epochNumber;
   }
 
   m_currentBlockNum = block_number;
 
-  return true;
+  PrepareNextEpochContexts(epochNumber + 1, isMineFullCpu);
 }
 
-ethash_mining_result_t POW::MineLight(ethash_hash256 const& header_hash,
-                                      ethash_hash256 const& boundary) {
-  uint64_t nonce = std::time(0);
-  while (m_shouldMine) {
-    auto mineResult = ethash::hash(*m_epochContextLight, header_hash, nonce);
-    if (ethash::is_less_or_equal(mineResult.final_hash, boundary)) {
-      ethash_mining_result_t winning_result = {
-          BlockhashToHexString(mineResult.final_hash),
-          BlockhashToHexString(mineResult.mix_hash), nonce, true};
-      return winning_result;
+void POW::PrepareNextEpochContexts(int epochNumber, bool fullDataset) {
+  if (m_nextEpochNumber == epochNumber) {
+    return;
+  }
+
+  // Drop the contexts of another epoch, a late generation of them is
+  // discarded as well
+  auto promiseLight =
+      std::make_shared<std::promise<std::shared_ptr<ethash::epoch_context>>>();
+  auto promiseFull = std::make_shared<
+      std::promise<std::shared_ptr<ethash::epoch_context_full>>>();
+  m_nextEpochNumber = epochNumber;
+  m_nextEpochContextLight = promiseLight->get_future().share();
+  m_nextEpochContextFull =
+      fullDataset
+          ? promiseFull->get_future().share()
+          : std::shared_future<std::shared_ptr<ethash::epoch_context_full>>();
+
+  auto func = [epochNumber, fullDataset, promiseLight, promiseFull]() -> void {
+    LOG_GENERAL(INFO, "Pre-generating ethash context for epoch "
+                          << epochNumber << (fullDataset ? " (full)" : ""));
+    // The light context is published first, verifying does not need to wait
+    // for the full dataset
+    promiseLight->set_value(ethash::create_epoch_context(epochNumber));
+    if (fullDataset) {
+      promiseFull->set_value(CreateEpochContextFull(epochNumber));
+    }
+  };
+  DetachedFunction(1, func);
+}
+
+std::shared_ptr<ethash::epoch_context> POW::GetLightContext(
+    uint64_t blockNum) {
+  auto epochNumber = ethash::get_epoch_number(blockNum);
+  std::shared_future<std::shared_ptr<ethash::epoch_context>> context;
+  std::shared_ptr<std::promise<std::shared_ptr<ethash::epoch_context>>>
+      promise;
+  {
+    std::lock_guard<std::mutex> g(m_mutexLightClientConfigure);
+    for (const auto& c : {m_epochContextLight, m_prevEpochContextLight}) {
+      if (c != nullptr && c->epoch_number == epochNumber) {
+        return c;
+      }
+    }
+
+    if (m_nextEpochNumber == epochNumber) {
+      context = m_nextEpochContextLight;
+    } else if (m_verifyEpochNumber == epochNumber) {
+      context = m_verifyEpochContextLight;
+    } else {
+      // Generate it only for verifying, the client stays configured for the
+      // current epoch
+      promise = std::make_shared<
+          std::promise<std::shared_ptr<ethash::epoch_context>>>();
+      m_verifyEpochNumber = epochNumber;
+      m_verifyEpochContextLight = promise->get_future().share();
+      context = m_verifyEpochContextLight;
     }
-    nonce++;
   }
 
-  ethash_mining_result_t failure_result = {"", "", 0, false};
-  return failure_result;
+  // Generate or wait without the lock, the configured contexts stay usable
+  if (promise != nullptr) {
+    LOG_GENERAL(INFO, "Generating ethash context for epoch "
+                          << epochNumber << " to verify block " << blockNum);
+    promise->set_value(ethash::create_epoch_context(epochNumber));
+  }
+  return context.get();
 }
 
-ethash_mining_result_t POW::MineFull(ethash_hash256 const& header_hash,
-                                     ethash_hash256 const& boundary) {
-  uint64_t nonce = std::time(0);
-  while (m_shouldMine) {
-    auto mineResult = ethash::hash(*m_epochContextFull, header_hash, nonce);
-    if (ethash::is_less_or_equal(mineResult.final_hash, boundary)) {
-      ethash_mining_result_t winning_result = {
-          BlockhashToHexString(mineResult.final_hash),
-          BlockhashToHexString(mineResult.mix_hash), nonce, true};
-      return winning_result;
+ethash_mining_result_t POW::MineCPU(ethash_hash256 const& header_hash,
+                                    uint8_t difficulty, bool fullDataset,
+                                    unsigned int numThreads,
+                                    uint64_t& numHashes) {
+  // Keep the contexts alive, EthashConfigureClient may replace them
+  std::shared_ptr<ethash::epoch_context> contextLight;
+  std::shared_ptr<ethash::epoch_context_full> contextFull;
+  {
+    std::lock_guard<std::mutex> g(m_mutexLightClientConfigure);
+    contextLight = m_epochContextLight;
+    contextFull = m_epochContextFull;
+  }
+  if (fullDataset && contextFull == nullptr) {
+    LOG_GENERAL(WARNING, "Full dataset not generated, mining with light one");
+    fullDataset = false;
+  }
+
+  const auto boundary = DifficultyLevelInInt(difficulty);
+  const uint64_t startNonce = std::time(0);
+  ethash_mining_result_t winning_result = {"", "", 0, false};
+  std::mutex mutexResult;
+  std::atomic<uint64_t> totalHashes{0};
+
+  auto mine = [&](uint64_t nonce) {
+    uint64_t count = 0;
+    while (m_shouldMine) {
+      // The full dataset was calculated when the context was created, so
+      // the threads only read it
+      auto mineResult =
+          fullDataset ? ethash::hash_filled(*contextFull, header_hash, nonce)
+                      : ethash::hash(*contextLight, header_hash, nonce);
+      count++;
+      if (ethash::is_less_or_equal(mineResult.final_hash, boundary)) {
+        std::lock_guard<std::mutex> g(mutexResult);
+        if (!winning_result.success) {
+          winning_result = {BlockhashToHexString(mineResult.final_hash),
+                            BlockhashToHexString(mineResult.mix_hash), nonce,
+                            true};
+        }
+        m_shouldMine = false;
+        break;
+      }
+      nonce++;
     }
-    nonce++;
+    totalHashes += count;
+  };
+
+  m_shouldMine = true;
+
+  // Each thread searches its own nonce segment
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < numThreads; i++) {
+    threads.emplace_back(mine, startNonce + i * NONCE_SEGMENT);
+  }
+  mine(startNonce);
+  for (auto& thread : threads) {
+    thread.join();
   }
 
-  ethash_mining_result_t failure_result = {"", "", 0, false};
-  return failure_result;
+  numHashes = totalHashes;
+  return winning_result;
 }
 
 ethash_mining_result_t POW::MineFullGPU(uint64_t blockNum,
@@ -251,8 +412,6 @@ void POW::MineFullGPUThread(uint64_t blockNum,
 
   wp.header = dev::h256{header_hash.bytes, dev::h256::ConstructFromPointer};
 
-  constexpr uint32_t NONCE_SEGMENT_WIDTH = 40;
-  const uint64_t NONCE_SEGMENT = (uint64_t)pow(2, NONCE_SEGMENT_WIDTH);
   wp.startNonce = nonce + index * NONCE_SEGMENT;
 
   dev::eth::Solution solution;
@@ -325,7 +484,6 @@ ethash_mining_result_t POW::PoWMine(
   // result.success has been returned)
   std::lock_guard<std::mutex> g(m_mutexPoWMine);
   EthashConfigureClient(blockNum, fullDataset);
-  auto boundary = DifficultyLevelInInt(difficulty);
   std::vector<unsigned char> sha3_result =
       ConcatAndhash(rand1, rand2, ipAddr, pubKey, lookupId, gasPrice);
 
@@ -334,14 +492,20 @@ ethash_mining_result_t POW::PoWMine(
       StringToBlockhash(DataConversion::Uint8VecToHexStr(sha3_result));
   ethash_mining_result_t result;
 
-  m_shouldMine = true;
-
   if (OPENCL_GPU_MINE || CUDA_GPU_MINE) {
+    m_shouldMine = true;
     result = MineFullGPU(blockNum, headerHash, difficulty);
-  } else if (fullDataset) {
-    result = MineFull(headerHash, boundary);
   } else {
-    result = MineLight(headerHash, boundary);
+    const unsigned int numThreads = GetNumMiningThreads();
+    uint64_t numHashes = 0;
+    auto startTime = std::chrono::steady_clock::now();
+    result = MineCPU(headerHash, difficulty, fullDataset, numThreads,
+                     numHashes);
+    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         std::chrono::steady_clock::now() - startTime)
+                         .count();
+    LOG_GENERAL(INFO, "Mined " << numHashes << " hashes with " << numThreads
+                               << " threads in " << elapsedMs << " ms");
   }
   return result;
 }
@@ -355,7 +519,6 @@ bool POW::PoWVerify(uint64_t blockNum, uint8_t difficulty,
                     uint64_t winning_nonce, const std::string& winning_result,
                     const std::string& winning_mixhash) {
   LOG_MARKER();
-  EthashConfigureClient(blockNum);
   const auto boundary = DifficultyLevelInInt(difficulty);
   std::vector<unsigned char> sha3_result =
       ConcatAndhash(rand1, rand2, ipAddr, pubKey, lookupId, gasPrice);
@@ -369,15 +532,14 @@ bool POW::PoWVerify(uint64_t blockNum, uint8_t difficulty,
     return false;
   }
 
-  return ethash::verify(*m_epochContextLight, headerHash, winningMixhash,
+  return ethash::verify(*GetLightContext(blockNum), headerHash, winningMixhash,
                         winning_nonce, boundary);
 }
 
 ethash::result POW::LightHash(uint64_t blockNum,
                               ethash_hash256 const& header_hash,
                               uint64_t nonce) {
-  EthashConfigureClient(blockNum);
-  return ethash::hash(*m_epochContextLight, header_hash, nonce);
+  return ethash::hash(*GetLightContext(blockNum), header_hash, nonce);
 }
 
 bool POW::CheckSolnAgainstsTargetedDifficulty(const ethash_hash256& result,
@@ -22,6 +22,9 @@
 
 #include <stdint.h>
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <future>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #include <boost/multiprecision/cpp_int.hpp>
@@ -107,9 +110,30 @@ class POW {
                                            uint8_t difficulty);
   static std::set<unsigned int> GetGpuToUse();
 
+  /// Mines on the CPU with numThreads threads, each one searching its own
+  /// range of nonces until a solution is found or mining is stopped.
+  /// numHashes returns the number of hashes computed by all threads.
+  ethash_mining_result_t MineCPU(ethash_hash256 const& header_hash,
+                                 uint8_t difficulty, bool fullDataset,
+                                 unsigned int numThreads, uint64_t& numHashes);
+
  private:
   std::shared_ptr<ethash::epoch_context> m_epochContextLight = nullptr;
   std::shared_ptr<ethash::epoch_context_full> m_epochContextFull = nullptr;
+  int m_epochNumberFull = -1;
+  /// Light context of the epoch before, for submissions still referring to it
+  std::shared_ptr<ethash::epoch_context> m_prevEpochContextLight = nullptr;
+  /// Contexts of the next epoch, generated in the background ahead of it.
+  /// The full one is only valid when the next epoch is mined with it.
+  std::shared_future<std::shared_ptr<ethash::epoch_context>>
+      m_nextEpochContextLight;
+  std::shared_future<std::shared_ptr<ethash::epoch_context_full>>
+      m_nextEpochContextFull;
+  int m_nextEpochNumber = -1;
+  /// Light context of another epoch, generated only to verify submissions
+  std::shared_future<std::shared_ptr<ethash::epoch_context>>
+      m_verifyEpochContextLight;
+  int m_verifyEpochNumber = -1;
   uint64_t m_currentBlockNum;
   std::atomic<bool> m_shouldMine;
   std::vector<dev::eth::MinerPtr> m_miners;
@@ -118,10 +142,22 @@ class POW {
   std::condition_variable m_cvMiningResult;
   std::mutex m_mutexMiningResult;
 
-  ethash_mining_result_t MineLight(ethash_hash256 const& header_hash,
-                                   ethash_hash256 const& boundary);
-  ethash_mining_result_t MineFull(ethash_hash256 const& header_hash,
-                                  ethash_hash256 const& boundary);
+  /// Returns CPU_MINING_THREADS, or the number of cores if it is 0.
+  static unsigned int GetNumMiningThreads();
+  /// Creates the full context of epochNumber and calculates its whole dataset
+  /// over the mining threads, so that mining only reads the dataset.
+  static std::shared_ptr<ethash::epoch_context_full> CreateEpochContextFull(
+      int epochNumber);
+  /// Switches the contexts to the epoch of block_number, taking the
+  /// pre-generated ones if ready. Requires m_mutexLightClientConfigure.
+  void ConfigureEpochContexts(uint64_t block_number, bool fullDataset);
+  /// Starts generating the contexts of epochNumber in the background unless
+  /// already done. Requires m_mutexLightClientConfigure.
+  void PrepareNextEpochContexts(int epochNumber, bool fullDataset);
+  /// Returns the light context for blockNum without reconfiguring the client.
+  /// Waits for the next epoch's one if still being pre-generated, and only
+  /// generates one if no other context matches.
+  std::shared_ptr<ethash::epoch_context> GetLightContext(uint64_t blockNum);
   ethash_mining_result_t MineFullGPU(uint64_t blockNum,
                                      ethash_hash256 const& header_hash,
                                      uint8_t difficulty);
@@ -21,12 +21,16 @@
 #include <sys/syscall.h>
 #include <unistd.h>
 #include <algorithm>
+#include <atomic>
 #include <fstream>
 #include <iostream>
+#include <numeric>
 #include <sstream>
 #include <string>
+#include <thread>
 
 #include <leveldb/db.h>
+#include <leveldb/write_batch.h>
 #include <boost/filesystem.hpp>
 
 #include "BlockStorage.h"
@@ -34,6 +38,7 @@
 #include "common/Serializable.h"
 #include "libMessage/Messenger.h"
 #include "libUtils/DataConversion.h"
+#include "libUtils/ThreadPool.h"
 
 using namespace std;
 
@@ -94,29 +99,143 @@ bool BlockStorage::PutBlockLink(const uint64_t& index,
 
 bool BlockStorage::PutTxBlock(const uint64_t& blockNum,
                               const vector<unsigned char>& body) {
-  return PutBlock(blockNum, body, BlockType::Tx);
+  WriteBatch batch;
+  return PutTxBlock(blockNum, body, batch) && CommitBatch(batch);
+}
+
+bool BlockStorage::PutTxBlock(const uint64_t& blockNum,
+                              const vector<unsigned char>& body,
+                              WriteBatch& batch) {
+  LevelDB::AddToBatch(batch.Of(m_txBlockchainDB), blockNum, body);
+  LOG_GENERAL(INFO, "Stored TxBlock  Num:" << blockNum);
+
+  // Keep the tip record so that a restart only has to load the recent blocks
+  uint64_t latestBlockNum = 0;
+  if (!GetLatestTxBlockNum(latestBlockNum) || latestBlockNum <= blockNum) {
+    LevelDB::AddToBatch(
+        batch.Of(m_metadataDB), to_string((int)MetaType::LATESTTXBLOCKNUM),
+        DataConversion::StringToCharArray(to_string(blockNum)));
+  }
+  return true;
 }
 
 bool BlockStorage::PutTxBody(const dev::h256& key,
                              const vector<unsigned char>& body) {
-  int ret;
+  WriteBatch batch;
+  return PutTxBody(key, body, batch) && CommitBatch(batch);
+}
 
+bool BlockStorage::PutTxBody(const dev::h256& key,
+                             const vector<unsigned char>& body,
+                             WriteBatch& batch) {
   if (!LOOKUP_NODE_MODE) {
     LOG_GENERAL(WARNING, "Non lookup node should not trigger this.");
     return false;
-  } else  // IS_LOOKUP_NODE
-  {
-    ret = m_txBodyDB->Insert(key, body) && m_txBodyTmpDB->Insert(key, body);
   }
 
-  return (ret == 0);
+  LevelDB::AddToBatch(batch.Of(m_txBodyDB), key, body);
+  LevelDB::AddToBatch(batch.Of(m_txBodyTmpDB), key, body);
+  return true;
+}
+
+bool BlockStorage::PutTxMicroBlock(const TxnHash& txnHash,
+                                   const BlockHash& microBlockHash) {
+  WriteBatch batch;
+  return PutTxMicroBlock(txnHash, microBlockHash, batch) && CommitBatch(batch);
+}
+
+bool BlockStorage::PutTxMicroBlock(const TxnHash& txnHash,
+                                   const BlockHash& microBlockHash,
+                                   WriteBatch& batch) {
+  if (!LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING, "Non lookup node should not trigger this.");
+    return false;
+  }
+
+  LevelDB::AddToBatch(batch.Of(m_txMicroBlockDB), txnHash,
+                      microBlockHash.asBytes());
+  return true;
+}
+
+leveldb::WriteBatch& BlockStorage::WriteBatch::Of(
+    const shared_ptr<LevelDB>& db) {
+  for (auto& entry : m_batches) {
+    if (entry.first == db) {
+      return entry.second;
+    }
+  }
+
+  m_batches.emplace_back(db, leveldb::WriteBatch());
+  return m_batches.back().second;
+}
+
+bool BlockStorage::CommitBatch(WriteBatch& batch) {
+  bool ret = true;
+  for (auto& entry : batch.m_batches) {
+    if (entry.first->Write(entry.second) != 0) {
+      ret = false;
+    }
+  }
+  batch.m_batches.clear();
+  return ret;
+}
+
+namespace {
+// Micro block index key: big-endian epoch number, shard ID and block hash,
+// so that the index sorts by epoch and then by shard
+string MicroBlockIndexKey(const uint64_t& epochNum, const uint32_t& shardId,
+                          const BlockHash& blockHash = BlockHash()) {
+  string key(sizeof(uint64_t) + sizeof(uint32_t) + BlockHash::size, '\0');
+  for (unsigned int i = 0; i < sizeof(uint64_t); i++) {
+    key[i] = (char)(epochNum >> (8 * (sizeof(uint64_t) - 1 - i)));
+  }
+  for (unsigned int i = 0; i < sizeof(uint32_t); i++) {
+    key[sizeof(uint64_t) + i] =
+        (char)(shardId >> (8 * (sizeof(uint32_t) - 1 - i)));
+  }
+  copy(blockHash.begin(), blockHash.end(),
+       key.begin() + sizeof(uint64_t) + sizeof(uint32_t));
+  return key;
+}
+
+bool ParseMicroBlockIndexKey(const leveldb::Slice& key, uint64_t& epochNum,
+                             uint32_t& shardId, BlockHash& blockHash) {
+  if (key.size() != sizeof(uint64_t) + sizeof(uint32_t) + BlockHash::size) {
+    return false;
+  }
+
+  const unsigned char* data = (const unsigned char*)key.data();
+  epochNum = 0;
+  for (unsigned int i = 0; i < sizeof(uint64_t); i++) {
+    epochNum = (epochNum << 8) | data[i];
+  }
+  shardId = 0;
+  for (unsigned int i = 0; i < sizeof(uint32_t); i++) {
+    shardId = (shardId << 8) | data[sizeof(uint64_t) + i];
+  }
+  blockHash = BlockHash(dev::bytesConstRef(
+      data + sizeof(uint64_t) + sizeof(uint32_t), BlockHash::size));
+  return true;
+}
+
+// Block number keys are binary, older decimal ones are printed as they are
+string BlockNumKeyToString(const leveldb::Slice& key) {
+  return isBlockNumKey(key) ? fromBlockNumKey(key).convert_to<string>()
+                            : key.ToString();
 }
+}  // namespace
 
 bool BlockStorage::PutMicroBlock(const BlockHash& blockHash,
+                                 const uint64_t& epochNum,
+                                 const uint32_t& shardId,
                                  const vector<unsigned char>& body) {
-  int ret = m_microBlockDB->Insert(blockHash, body);
+  if (m_microBlockDB->Insert(blockHash, body) != 0) {
+    return false;
+  }
 
-  return (ret == 0);
+  return m_microBlockIndexDB->Insert(
+             leveldb::Slice(MicroBlockIndexKey(epochNum, shardId, blockHash)),
+             leveldb::Slice()) == 0;
 }
 
 bool BlockStorage::GetMicroBlock(const BlockHash& blockHash,
@@ -141,6 +260,26 @@ bool BlockStorage::GetRangeMicroBlocks(const uint64_t lowEpochNum,
                                        list<MicroBlockSharedPtr>& blocks) {
   LOG_MARKER();
 
+  vector<unsigned char> isIndexed;
+  if (GetMetadata(MetaType::MICROBLOCKINDEXED, isIndexed)) {
+    ForEachMicroBlockHash(lowEpochNum, hiEpochNum, loShardId, hiShardId,
+                          [this, &blocks](const BlockHash& blockHash) {
+                            MicroBlockSharedPtr block;
+                            if (GetMicroBlock(blockHash, block)) {
+                              blocks.emplace_back(block);
+                            }
+                            return true;
+                          });
+
+    if (blocks.empty()) {
+      LOG_GENERAL(INFO, "Disk has no MicroBlock matching the criteria");
+      return false;
+    }
+
+    return true;
+  }
+
+  // Micro blocks stored before the index existed are not indexed yet
   leveldb::Iterator* it =
       m_microBlockDB->GetDB()->NewIterator(leveldb::ReadOptions());
   for (it->SeekToFirst(); it->Valid(); it->Next()) {
@@ -275,8 +414,32 @@ bool BlockStorage::GetTxBody(const dev::h256& key, TxBodySharedPtr& body) {
   if (bodyString.empty()) {
     return false;
   }
-  body = TxBodySharedPtr(new TransactionWithReceipt(
-      std::vector<unsigned char>(bodyString.begin(), bodyString.end()), 0));
+  // Bodies are verified before being stored, skip the signature check here
+  body = TxBodySharedPtr(new TransactionWithReceipt());
+  if (!Messenger::GetTransactionWithReceipt(
+          std::vector<unsigned char>(bodyString.begin(), bodyString.end()), 0,
+          *body, Messenger::TrustLevel::TRUSTED_STORAGE)) {
+    LOG_GENERAL(WARNING, "Messenger::GetTransactionWithReceipt failed.");
+    return false;
+  }
+
+  return true;
+}
+
+bool BlockStorage::GetTxMicroBlock(const TxnHash& txnHash,
+                                   BlockHash& microBlockHash) {
+  if (!LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING, "Non lookup node should not trigger this.");
+    return false;
+  }
+
+  string hashString = m_txMicroBlockDB->Lookup(txnHash);
+
+  if (hashString.size() != BlockHash::size) {
+    return false;
+  }
+  microBlockHash = BlockHash(
+      vector<unsigned char>(hashString.begin(), hashString.end()));
 
   return true;
 }
@@ -332,13 +495,249 @@ bool BlockStorage::DeleteTxBody(const dev::h256& key) {
 //                                             0) );
 // }
 
+namespace {
+ThreadPool& GetBlockLoadPool() {
+  static ThreadPool pool(max(thread::hardware_concurrency(), 1u),
+                         "BlockLoadPool");
+  return pool;
+}
+
+// Deserializes the blocks on a thread pool, since that dominates the cost of
+// loading blocks
+template <class T>
+void DeserializeInParallel(const vector<string>& blockStrings,
+                           vector<shared_ptr<T>>& blocks) {
+  blocks.assign(blockStrings.size(), nullptr);
+  GetBlockLoadPool().ParallelFor(0, blockStrings.size(), [&](size_t i) {
+    blocks[i] = make_shared<T>(
+        vector<unsigned char>(blockStrings[i].begin(), blockStrings[i].end()),
+        0);
+  });
+}
+}  // namespace
+
+bool BlockStorage::GetDSBlocks(const vector<uint64_t>& blockNums,
+                               vector<DSBlockSharedPtr>& blocks) {
+  LOG_MARKER();
+
+  vector<string> blockStrings(blockNums.size());
+  atomic<bool> result{true};
+
+  GetBlockLoadPool().ParallelFor(0, blockNums.size(), [&](size_t i) {
+    if (!result) {
+      return;
+    }
+
+    blockStrings[i] = m_dsBlockchainDB->Lookup(blockNums[i]);
+    if (blockStrings[i].empty()) {
+      LOG_GENERAL(WARNING, "DSBlock " << blockNums[i] << " not found");
+      result = false;
+    }
+  });
+
+  if (!result) {
+    return false;
+  }
+
+  DeserializeInParallel(blockStrings, blocks);
+  return true;
+}
+
+bool BlockStorage::GetTxBlocks(const uint64_t& first, const uint64_t& last,
+                               vector<TxBlockSharedPtr>& blocks) {
+  LOG_MARKER();
+
+  blocks.clear();
+  if (first > last) {
+    return true;
+  }
+
+  // The range is read in one pass over consecutive keys
+  vector<string> blockStrings;
+  uint64_t expectedBlockNum = first;
+  m_txBlockchainDB->ForEachInRange(
+      first, last,
+      [&](const boost::multiprecision::uint256_t& blockNum,
+          const leveldb::Slice& value) {
+        if (blockNum != expectedBlockNum) {
+          return false;
+        }
+        blockStrings.emplace_back(value.ToString());
+        expectedBlockNum++;
+        return true;
+      });
+
+  if (blockStrings.size() != last - first + 1) {
+    LOG_GENERAL(WARNING, "TxBlock " << expectedBlockNum << " not found");
+    return false;
+  }
+
+  DeserializeInParallel(blockStrings, blocks);
+  return true;
+}
+
+void BlockStorage::ForEachDSBlock(
+    const uint64_t& first, const uint64_t& last,
+    const function<bool(const DSBlockSharedPtr&)>& func) {
+  m_dsBlockchainDB->ForEachInRange(
+      first, last,
+      [&func](const boost::multiprecision::uint256_t&,
+              const leveldb::Slice& value) {
+        return func(make_shared<DSBlock>(
+            vector<unsigned char>(value.data(), value.data() + value.size()),
+            0));
+      });
+}
+
+void BlockStorage::ForEachTxBlock(
+    const uint64_t& first, const uint64_t& last,
+    const function<bool(const TxBlockSharedPtr&)>& func) {
+  m_txBlockchainDB->ForEachInRange(
+      first, last,
+      [&func](const boost::multiprecision::uint256_t&,
+              const leveldb::Slice& value) {
+        return func(make_shared<TxBlock>(
+            vector<unsigned char>(value.data(), value.data() + value.size()),
+            0));
+      });
+}
+
+void BlockStorage::ForEachMicroBlockHash(
+    const uint64_t& lowEpochNum, const uint64_t& hiEpochNum,
+    const uint32_t& loShardId, const uint32_t& hiShardId,
+    const function<bool(const BlockHash&)>& func) {
+  if (lowEpochNum > hiEpochNum || loShardId > hiShardId) {
+    return;
+  }
+
+  unique_ptr<leveldb::Iterator> it(
+      m_microBlockIndexDB->GetDB()->NewIterator(leveldb::ReadOptions()));
+
+  it->Seek(MicroBlockIndexKey(lowEpochNum, loShardId));
+  while (it->Valid()) {
+    uint64_t epochNum = 0;
+    uint32_t shardId = 0;
+    BlockHash blockHash;
+    if (!ParseMicroBlockIndexKey(it->key(), epochNum, shardId, blockHash)) {
+      it->Next();
+      continue;
+    }
+
+    if (epochNum > hiEpochNum) {
+      break;
+    }
+
+    // Jump over the shards outside the range instead of reading them
+    if (shardId < loShardId) {
+      it->Seek(MicroBlockIndexKey(epochNum, loShardId));
+      continue;
+    }
+    if (shardId > hiShardId) {
+      if (epochNum == hiEpochNum) {
+        break;
+      }
+      it->Seek(MicroBlockIndexKey(epochNum + 1, loShardId));
+      continue;
+    }
+
+    if (!func(blockHash)) {
+      break;
+    }
+    it->Next();
+  }
+}
+
+bool BlockStorage::MigrateKeys() {
+  LOG_MARKER();
+
+  bool ret = true;
+  for (const auto& db : {m_dsBlockchainDB, m_txBlockchainDB, m_blockLinkDB,
+                         m_dsCommitteeDB, m_shardStructureDB,
+                         m_stateDeltaDB}) {
+    if (db->MigrateBlockNumKeys() < 0) {
+      ret = false;
+    }
+  }
+
+  vector<unsigned char> isIndexed;
+  if (GetMetadata(MetaType::MICROBLOCKINDEXED, isIndexed)) {
+    return ret;
+  }
+
+  // Index the micro blocks a batch at a time, resuming after the last one
+  unsigned int count = 0;
+  string resumeKey;
+  bool isDone = false;
+  while (!isDone) {
+    lock_guard<mutex> g(m_mutexMigration);
+
+    leveldb::WriteBatch batch;
+    unsigned int batchSize = 0;
+    unique_ptr<leveldb::Iterator> it(
+        m_microBlockDB->GetDB()->NewIterator(leveldb::ReadOptions()));
+    for (it->Seek(resumeKey); it->Valid(); it->Next()) {
+      if (batchSize == LevelDB::MIGRATION_BATCH_SIZE) {
+        break;
+      }
+
+      string blockString = it->value().ToString();
+      MicroBlock microBlock(
+          vector<unsigned char>(blockString.begin(), blockString.end()), 0);
+      batch.Put(MicroBlockIndexKey(microBlock.GetHeader().GetEpochNum(),
+                                   microBlock.GetHeader().GetShardId(),
+                                   microBlock.GetBlockHash()),
+                leveldb::Slice());
+      batchSize++;
+    }
+
+    isDone = !it->Valid();
+    if (!isDone) {
+      resumeKey = it->key().ToString();
+    }
+    it.reset();
+
+    if (!m_microBlockIndexDB->GetDB()
+             ->Write(leveldb::WriteOptions(), &batch)
+             .ok()) {
+      LOG_GENERAL(WARNING, "Failed to index micro blocks");
+      return false;
+    }
+    count += batchSize;
+  }
+
+  LOG_GENERAL(INFO, "Indexed " << count << " micro blocks");
+  return PutMetadata(MetaType::MICROBLOCKINDEXED, {'1'}) && ret;
+}
+
+bool BlockStorage::GetLatestTxBlockNum(uint64_t& blockNum) {
+  vector<unsigned char> latestTxBlockNumVec;
+  if (!GetMetadata(MetaType::LATESTTXBLOCKNUM, latestTxBlockNumVec)) {
+    return false;
+  }
+
+  try {
+    blockNum =
+        stoull(DataConversion::CharArrayToString(latestTxBlockNumVec));
+  } catch (exception& e) {
+    LOG_GENERAL(WARNING, "Invalid latest TxBlock num: " << e.what());
+    return false;
+  }
+
+  return true;
+}
+
+bool BlockStorage::PutLatestTxBlockNum(const uint64_t& blockNum) {
+  return PutMetadata(MetaType::LATESTTXBLOCKNUM,
+                     DataConversion::StringToCharArray(to_string(blockNum)));
+}
+
 bool BlockStorage::GetAllDSBlocks(std::list<DSBlockSharedPtr>& blocks) {
   LOG_MARKER();
 
   leveldb::Iterator* it =
       m_dsBlockchainDB->GetDB()->NewIterator(leveldb::ReadOptions());
   for (it->SeekToFirst(); it->Valid(); it->Next()) {
-    string bns = it->key().ToString();
+    string bns = BlockNumKeyToString(it->key());
     string blockString = it->value().ToString();
     if (blockString.empty()) {
       LOG_GENERAL(WARNING, "Lost one block in the chain");
@@ -368,7 +767,7 @@ bool BlockStorage::GetAllTxBlocks(std::list<TxBlockSharedPtr>& blocks) {
   leveldb::Iterator* it =
       m_txBlockchainDB->GetDB()->NewIterator(leveldb::ReadOptions());
   for (it->SeekToFirst(); it->Valid(); it->Next()) {
-    string bns = it->key().ToString();
+    string bns = BlockNumKeyToString(it->key());
     string blockString = it->value().ToString();
     if (blockString.empty()) {
       LOG_GENERAL(WARNING, "Lost one block in the chain");
@@ -423,7 +822,7 @@ bool BlockStorage::GetAllBlockLink(std::list<BlockLink>& blocklinks) {
   leveldb::Iterator* it =
       m_blockLinkDB->GetDB()->NewIterator(leveldb::ReadOptions());
   for (it->SeekToFirst(); it->Valid(); it->Next()) {
-    string bns = it->key().ToString();
+    string bns = BlockNumKeyToString(it->key());
     string blockString = it->value().ToString();
     if (blockString.empty()) {
       LOG_GENERAL(WARNING, "Lost one blocklink in the chain");
@@ -605,13 +1004,23 @@ bool BlockStorage::PutStateDelta(const uint64_t& finalBlockNum,
                                  const std::vector<unsigned char>& stateDelta) {
   LOG_MARKER();
 
-  if (0 != m_stateDeltaDB->Insert(finalBlockNum, stateDelta)) {
+  WriteBatch batch;
+  if (!PutStateDelta(finalBlockNum, stateDelta, batch) ||
+      !CommitBatch(batch)) {
     LOG_PAYLOAD(WARNING,
                 "Failed to store state delta of final block " << finalBlockNum,
                 stateDelta, Logger::MAX_BYTES_TO_DISPLAY);
     return false;
   }
 
+  return true;
+}
+
+bool BlockStorage::PutStateDelta(const uint64_t& finalBlockNum,
+                                 const std::vector<unsigned char>& stateDelta,
+                                 WriteBatch& batch) {
+  LevelDB::AddToBatch(batch.Of(m_stateDeltaDB), finalBlockNum, stateDelta);
+
   LOG_PAYLOAD(INFO, "Stored state delta of final block " << finalBlockNum,
               stateDelta, Logger::MAX_BYTES_TO_DISPLAY);
   return true;
@@ -628,7 +1037,28 @@ bool BlockStorage::GetStateDelta(const uint64_t& finalBlockNum,
   return true;
 }
 
+bool BlockStorage::PutTxBlockStats(const uint64_t& blockNum,
+                                   const std::vector<unsigned char>& stats) {
+  if (m_txBlockStatsDB->Insert(blockNum, stats) != 0) {
+    LOG_GENERAL(WARNING, "Failed to store stats of Tx block " << blockNum);
+    return false;
+  }
+  return true;
+}
+
+bool BlockStorage::GetTxBlockStats(const uint64_t& blockNum,
+                                   std::vector<unsigned char>& stats) {
+  string dataStr = m_txBlockStatsDB->Lookup(blockNum);
+  if (dataStr.empty()) {
+    return false;
+  }
+  stats = vector<unsigned char>(dataStr.begin(), dataStr.end());
+  return true;
+}
+
 bool BlockStorage::ResetDB(DBTYPE type) {
+  lock_guard<mutex> g(m_mutexMigration);
+
   bool ret = false;
   switch (type) {
     case META:
@@ -667,6 +1097,15 @@ bool BlockStorage::ResetDB(DBTYPE type) {
     case STATE_DELTA:
       ret = m_stateDeltaDB->ResetDB();
       break;
+    case TX_MICROBLOCK:
+      ret = m_txMicroBlockDB->ResetDB();
+      break;
+    case MICROBLOCK_INDEX:
+      ret = m_microBlockIndexDB->ResetDB();
+      break;
+    case TX_BLOCK_STATS:
+      ret = m_txBlockStatsDB->ResetDB();
+      break;
   }
   if (!ret) {
     LOG_GENERAL(INFO, "FAIL: Reset DB " << type << " failed");
@@ -713,6 +1152,15 @@ std::vector<std::string> BlockStorage::GetDBName(DBTYPE type) {
     case STATE_DELTA:
       ret.push_back(m_stateDeltaDB->GetDBName());
       break;
+    case TX_MICROBLOCK:
+      ret.push_back(m_txMicroBlockDB->GetDBName());
+      break;
+    case MICROBLOCK_INDEX:
+      ret.push_back(m_microBlockIndexDB->GetDBName());
+      break;
+    case TX_BLOCK_STATS:
+      ret.push_back(m_txBlockStatsDB->GetDBName());
+      break;
   }
 
   return ret;
@@ -721,15 +1169,17 @@ std::vector<std::string> BlockStorage::GetDBName(DBTYPE type) {
 bool BlockStorage::ResetAll() {
   if (!LOOKUP_NODE_MODE) {
     return ResetDB(META) && ResetDB(DS_BLOCK) && ResetDB(TX_BLOCK) &&
-           ResetDB(MICROBLOCK) && ResetDB(DS_COMMITTEE) && ResetDB(VC_BLOCK) &&
-           ResetDB(FB_BLOCK) && ResetDB(BLOCKLINK) &&
-           ResetDB(SHARD_STRUCTURE) && ResetDB(STATE_DELTA);
+           ResetDB(MICROBLOCK) && ResetDB(MICROBLOCK_INDEX) &&
+           ResetDB(DS_COMMITTEE) && ResetDB(VC_BLOCK) && ResetDB(FB_BLOCK) &&
+           ResetDB(BLOCKLINK) && ResetDB(SHARD_STRUCTURE) &&
+           ResetDB(STATE_DELTA) && ResetDB(TX_BLOCK_STATS);
   } else  // IS_LOOKUP_NODE
   {
     return ResetDB(META) && ResetDB(DS_BLOCK) && ResetDB(TX_BLOCK) &&
            ResetDB(TX_BODY) && ResetDB(TX_BODY_TMP) && ResetDB(MICROBLOCK) &&
-           ResetDB(DS_COMMITTEE) && ResetDB(VC_BLOCK) && ResetDB(FB_BLOCK) &&
-           ResetDB(BLOCKLINK) && ResetDB(SHARD_STRUCTURE) &&
-           ResetDB(STATE_DELTA);
+           ResetDB(MICROBLOCK_INDEX) && ResetDB(DS_COMMITTEE) &&
+           ResetDB(VC_BLOCK) && ResetDB(FB_BLOCK) && ResetDB(BLOCKLINK) &&
+           ResetDB(SHARD_STRUCTURE) && ResetDB(STATE_DELTA) &&
+           ResetDB(TX_MICROBLOCK) && ResetDB(TX_BLOCK_STATS);
   }
 }
@@ -20,6 +20,7 @@
 #ifndef BLOCKSTORAGE_H
 #define BLOCKSTORAGE_H
 
+#include <functional>
 #include <list>
 #include <mutex>
 #include <shared_mutex>
@@ -47,28 +48,51 @@ class BlockStorage : public Singleton<BlockStorage> {
   std::shared_ptr<LevelDB> m_txBlockchainDB;
   std::shared_ptr<LevelDB> m_txBodyDB;
   std::shared_ptr<LevelDB> m_microBlockDB;
+  std::shared_ptr<LevelDB> m_microBlockIndexDB;
   std::shared_ptr<LevelDB> m_txBodyTmpDB;
+  std::shared_ptr<LevelDB> m_txMicroBlockDB;
   std::shared_ptr<LevelDB> m_dsCommitteeDB;
   std::shared_ptr<LevelDB> m_VCBlockDB;
   std::shared_ptr<LevelDB> m_fallbackBlockDB;
   std::shared_ptr<LevelDB> m_blockLinkDB;
   std::shared_ptr<LevelDB> m_shardStructureDB;
   std::shared_ptr<LevelDB> m_stateDeltaDB;
+  std::shared_ptr<LevelDB> m_txBlockStatsDB;
+
+  /// Keeps DB resets out of the middle of a MigrateKeys batch
+  std::mutex m_mutexMigration;
 
   BlockStorage()
       : m_metadataDB(std::make_shared<LevelDB>("metadata")),
-        m_dsBlockchainDB(std::make_shared<LevelDB>("dsBlocks")),
-        m_txBlockchainDB(std::make_shared<LevelDB>("txBlocks")),
-        m_microBlockDB(std::make_shared<LevelDB>("microBlocks")),
-        m_dsCommitteeDB(std::make_shared<LevelDB>("dsCommittee")),
-        m_VCBlockDB(std::make_shared<LevelDB>("VCBlocks")),
-        m_fallbackBlockDB(std::make_shared<LevelDB>("fallbackBlocks")),
-        m_blockLinkDB(std::make_shared<LevelDB>("blockLinks")),
-        m_shardStructureDB(std::make_shared<LevelDB>("shardStructure")),
-        m_stateDeltaDB(std::make_shared<LevelDB>("stateDelta")) {
+        m_dsBlockchainDB(std::make_shared<LevelDB>("dsBlocks", "",
+                                                   LevelDB::BLOCKS, true)),
+        m_txBlockchainDB(std::make_shared<LevelDB>("txBlocks", "",
+                                                   LevelDB::BLOCKS, true)),
+        m_microBlockDB(
+            std::make_shared<LevelDB>("microBlocks", "", LevelDB::HASH_KEYED)),
+        m_microBlockIndexDB(
+            std::make_shared<LevelDB>("microBlockIndex", "", LevelDB::BLOCKS)),
+        m_dsCommitteeDB(std::make_shared<LevelDB>("dsCommittee", "",
+                                                  LevelDB::SMALL, true)),
+        m_VCBlockDB(
+            std::make_shared<LevelDB>("VCBlocks", "", LevelDB::HASH_KEYED)),
+        m_fallbackBlockDB(std::make_shared<LevelDB>("fallbackBlocks", "",
+                                                    LevelDB::HASH_KEYED)),
+        m_blockLinkDB(std::make_shared<LevelDB>("blockLinks", "",
+                                                LevelDB::BLOCKS, true)),
+        m_shardStructureDB(std::make_shared<LevelDB>("shardStructure", "",
+                                                     LevelDB::SMALL, true)),
+        m_stateDeltaDB(std::make_shared<LevelDB>("stateDelta", "",
+                                                 LevelDB::BLOCKS, true)),
+        m_txBlockStatsDB(
+            std::make_shared<LevelDB>("txBlockStats", "", LevelDB::BLOCKS)) {
     if (LOOKUP_NODE_MODE) {
-      m_txBodyDB = std::make_shared<LevelDB>("txBodies");
-      m_txBodyTmpDB = std::make_shared<LevelDB>("txBodiesTmp");
+      m_txBodyDB =
+          std::make_shared<LevelDB>("txBodies", "", LevelDB::HASH_KEYED);
+      m_txBodyTmpDB =
+          std::make_shared<LevelDB>("txBodiesTmp", "", LevelDB::HASH_KEYED);
+      m_txMicroBlockDB =
+          std::make_shared<LevelDB>("txMicroBlocks", "", LevelDB::HASH_KEYED);
     }
   };
   ~BlockStorage() = default;
@@ -89,7 +113,24 @@ class BlockStorage : public Singleton<BlockStorage> {
     FB_BLOCK,
     BLOCKLINK,
     SHARD_STRUCTURE,
-    STATE_DELTA
+    STATE_DELTA,
+    TX_MICROBLOCK,
+    MICROBLOCK_INDEX,
+    TX_BLOCK_STATS
+  };
+
+  /// Writes to one or more databases, collected by the Put* overloads that
+  /// take a batch and applied by CommitBatch. Each database then gets a
+  /// single write instead of one per entry. The databases are written in the
+  /// order they were first added to, but not atomically as a whole.
+  class WriteBatch {
+    friend class BlockStorage;
+
+    std::vector<std::pair<std::shared_ptr<LevelDB>, leveldb::WriteBatch>>
+        m_batches;
+
+    /// Returns the batch of writes to db.
+    leveldb::WriteBatch& Of(const std::shared_ptr<LevelDB>& db);
   };
 
   /// Returns the singleton BlockStorage instance.
@@ -111,13 +152,26 @@ class BlockStorage : public Singleton<BlockStorage> {
   /// Adds a Tx block to storage.
   bool PutTxBlock(const uint64_t& blockNum,
                   const std::vector<unsigned char>& body);
+  bool PutTxBlock(const uint64_t& blockNum,
+                  const std::vector<unsigned char>& body, WriteBatch& batch);
 
-  // /// Adds a micro block to storage.
-  bool PutMicroBlock(const BlockHash& blockHash,
+  /// Adds a micro block to storage, indexed by epoch and shard.
+  bool PutMicroBlock(const BlockHash& blockHash, const uint64_t& epochNum,
+                     const uint32_t& shardId,
                      const std::vector<unsigned char>& body);
 
   /// Adds a transaction body to storage.
   bool PutTxBody(const dev::h256& key, const std::vector<unsigned char>& body);
+  bool PutTxBody(const dev::h256& key, const std::vector<unsigned char>& body,
+                 WriteBatch& batch);
+
+  /// Records the micro block that includes a transaction.
+  bool PutTxMicroBlock(const TxnHash& txnHash, const BlockHash& microBlockHash);
+  bool PutTxMicroBlock(const TxnHash& txnHash, const BlockHash& microBlockHash,
+                       WriteBatch& batch);
+
+  /// Applies the writes collected in batch and empties it.
+  bool CommitBatch(WriteBatch& batch);
 
   /// Retrieves the requested DS block.
   bool GetDSBlock(const uint64_t& blockNum, DSBlockSharedPtr& block);
@@ -140,9 +194,39 @@ class BlockStorage : public Singleton<BlockStorage> {
                            const uint32_t hiShardId,
                            std::list<MicroBlockSharedPtr>& blocks);
 
+  /// Calls func with each stored DS block numbered first to last, in order,
+  /// until func returns false. Only the blocks in the range are read.
+  void ForEachDSBlock(
+      const uint64_t& first, const uint64_t& last,
+      const std::function<bool(const DSBlockSharedPtr&)>& func);
+
+  /// Calls func with each stored Tx block numbered first to last, in order,
+  /// until func returns false. Only the blocks in the range are read.
+  void ForEachTxBlock(
+      const uint64_t& first, const uint64_t& last,
+      const std::function<bool(const TxBlockSharedPtr&)>& func);
+
+  /// Calls func with the hash of each micro block with an epoch number in
+  /// [lowEpochNum, hiEpochNum] and a shard ID in [loShardId, hiShardId],
+  /// ordered by epoch and then shard, until func returns false. Only the
+  /// matching index entries are read.
+  void ForEachMicroBlockHash(const uint64_t& lowEpochNum,
+                             const uint64_t& hiEpochNum,
+                             const uint32_t& loShardId,
+                             const uint32_t& hiShardId,
+                             const std::function<bool(const BlockHash&)>& func);
+
+  /// Moves the block number keys written by older versions to the ordered
+  /// encoding and indexes the micro blocks stored before the index existed.
+  /// Runs in batches, so storage stays usable meanwhile.
+  bool MigrateKeys();
+
   /// Retrieves the requested transaction body.
   bool GetTxBody(const dev::h256& key, TxBodySharedPtr& body);
 
+  /// Retrieves the hash of the micro block that includes a transaction.
+  bool GetTxMicroBlock(const TxnHash& txnHash, BlockHash& microBlockHash);
+
   /// Deletes the requested DS block
   bool DeleteDSBlock(const uint64_t& blocknum);
 
@@ -166,6 +250,22 @@ class BlockStorage : public Singleton<BlockStorage> {
   // /// Retrieves the requested transaction body.
   // void GetTxBody(const std::string & key, TxBodySharedPtr & body);
 
+  /// Retrieves the DS blocks with the given numbers, in the same order.
+  /// Blocks are read and deserialized in parallel.
+  bool GetDSBlocks(const std::vector<uint64_t>& blockNums,
+                   std::vector<DSBlockSharedPtr>& blocks);
+
+  /// Retrieves the Tx blocks numbered first to last inclusive, in order.
+  /// Blocks are read and deserialized in parallel.
+  bool GetTxBlocks(const uint64_t& first, const uint64_t& last,
+                   std::vector<TxBlockSharedPtr>& blocks);
+
+  /// Retrieves the number of the latest stored Tx block.
+  bool GetLatestTxBlockNum(uint64_t& blockNum);
+
+  /// Saves the number of the latest stored Tx block.
+  bool PutLatestTxBlockNum(const uint64_t& blockNum);
+
   /// Retrieves all the DSBlocks
   bool GetAllDSBlocks(std::list<DSBlockSharedPtr>& blocks);
 
@@ -204,11 +304,22 @@ class BlockStorage : public Singleton<BlockStorage> {
   /// Save state delta
   bool PutStateDelta(const uint64_t& finalBlockNum,
                      const std::vector<unsigned char>& stateDelta);
+  bool PutStateDelta(const uint64_t& finalBlockNum,
+                     const std::vector<unsigned char>& stateDelta,
+                     WriteBatch& batch);
 
   /// Retrieve state delta
   bool GetStateDelta(const uint64_t& finalBlockNum,
                      std::vector<unsigned char>& stateDelta);
 
+  /// Save the cumulative stats of a Tx block
+  bool PutTxBlockStats(const uint64_t& blockNum,
+                       const std::vector<unsigned char>& stats);
+
+  /// Retrieve the cumulative stats of a Tx block
+  bool GetTxBlockStats(const uint64_t& blockNum,
+                       std::vector<unsigned char>& stats);
+
   /// Clean a DB
   bool ResetDB(DBTYPE type);
 
@@ -36,7 +36,9 @@ class ContractStorage : public Singleton<ContractStorage> {
   dev::OverlayDB m_stateDB;
   LevelDB m_codeDB;
 
-  ContractStorage() : m_stateDB("contractState"), m_codeDB("contractCode"){};
+  ContractStorage()
+      : m_stateDB("contractState"),
+        m_codeDB("contractCode", "", LevelDB::HASH_KEYED){};
 
   ~ContractStorage() = default;
 
@@ -101,28 +101,71 @@ bool Retriever::RetrieveDSBlocks(bool wakeupForUpgrade) {
 
 bool Retriever::RetrieveTxBlocks(bool wakeupForUpgrade) {
   LOG_MARKER();
-  std::list<TxBlockSharedPtr> blocks;
-  if (!BlockStorage::GetBlockStorage().GetAllTxBlocks(blocks)) {
-    LOG_GENERAL(WARNING, "RetrieveTxBlocks skipped or incompleted");
-    return false;
+
+  // The chain keeps only BLOCKCHAIN_SIZE blocks in memory and reads older
+  // ones from storage on demand, so only that window is loaded. It also
+  // covers the final blocks of the last DS epoch, whose deltas are replayed.
+  const uint64_t windowSize =
+      std::max<uint64_t>(BLOCKCHAIN_SIZE, NUM_FINAL_BLOCK_PER_POW);
+
+  std::vector<TxBlockSharedPtr> blocks;
+  uint64_t lastBlockNum = 0;
+  bool isWindowLoaded = false;
+
+  // The block stats continue from the stored entry of the block before the
+  // window. A database written before those entries were kept is scanned in
+  // full once, which stores them.
+  if (BlockStorage::GetBlockStorage().GetLatestTxBlockNum(lastBlockNum)) {
+    uint64_t firstBlockNum =
+        (lastBlockNum >= windowSize) ? lastBlockNum + 1 - windowSize : 0;
+    std::vector<unsigned char> stats;
+    isWindowLoaded =
+        (firstBlockNum == 0 || BlockStorage::GetBlockStorage().GetTxBlockStats(
+                                   firstBlockNum - 1, stats)) &&
+        BlockStorage::GetBlockStorage().GetTxBlocks(firstBlockNum,
+                                                    lastBlockNum, blocks);
   }
 
-  blocks.sort([](const TxBlockSharedPtr& a, const TxBlockSharedPtr& b) {
-    return a->GetHeader().GetBlockNum() < b->GetHeader().GetBlockNum();
-  });
+  if (!isWindowLoaded) {
+    LOG_GENERAL(INFO,
+                "No usable TxBlock tip record or stats, scanning all TxBlocks");
+
+    std::list<TxBlockSharedPtr> allBlocks;
+    if (!BlockStorage::GetBlockStorage().GetAllTxBlocks(allBlocks)) {
+      LOG_GENERAL(WARNING, "RetrieveTxBlocks skipped or incompleted");
+      return false;
+    }
+
+    allBlocks.sort([](const TxBlockSharedPtr& a, const TxBlockSharedPtr& b) {
+      return a->GetHeader().GetBlockNum() < b->GetHeader().GetBlockNum();
+    });
+
+    blocks.assign(allBlocks.begin(), allBlocks.end());
+    lastBlockNum = blocks.back()->GetHeader().GetBlockNum();
+  }
 
-  unsigned int totalSize = blocks.size();
+  uint64_t totalSize = lastBlockNum + 1;
   unsigned int extra_txblocks = totalSize % NUM_FINAL_BLOCK_PER_POW;
 
   if (wakeupForUpgrade || m_mediator.GetIsVacuousEpoch(
                               (blocks.back()->GetHeader().GetBlockNum()))) {
     // truncate the extra final blocks at last
-    for (unsigned int i = 0; i < extra_txblocks; ++i) {
+    for (unsigned int i = 0; i < extra_txblocks && !blocks.empty(); ++i) {
       BlockStorage::GetBlockStorage().DeleteTxBlock(totalSize - 1 - i);
       blocks.pop_back();
     }
   }
 
+  if (!blocks.empty()) {
+    BlockStorage::GetBlockStorage().PutLatestTxBlockNum(
+        blocks.back()->GetHeader().GetBlockNum());
+
+    if (isWindowLoaded) {
+      m_mediator.m_txBlockChain.Reset(
+          blocks.front()->GetHeader().GetBlockNum());
+    }
+  }
+
   for (const auto& block : blocks) {
     m_mediator.m_node->AddBlock(*block);
   }
@@ -207,6 +250,28 @@ bool Retriever::RetrieveBlockLink(bool wakeupForUpgrade) {
     lastDsIndex--;
   }
 
+  // Rebuilding the DS committee needs every DS block, so they are all read
+  // up front in parallel, but only the recent ones are kept in the chain
+  std::vector<uint64_t> dsBlockNums;
+  for (const auto& blocklink : blocklinks) {
+    if (std::get<BlockLinkIndex::BLOCKTYPE>(blocklink) == BlockType::DS) {
+      dsBlockNums.emplace_back(std::get<BlockLinkIndex::DSINDEX>(blocklink));
+    }
+  }
+
+  std::vector<DSBlockSharedPtr> dsBlocks;
+  if (!BlockStorage::GetBlockStorage().GetDSBlocks(dsBlockNums, dsBlocks)) {
+    dsBlocks.clear();
+  }
+
+  const uint64_t dsWindowFirst =
+      (dsBlockNums.size() > BLOCKCHAIN_SIZE)
+          ? dsBlockNums[dsBlockNums.size() - BLOCKCHAIN_SIZE]
+          : 0;
+  m_mediator.m_dsBlockChain.Reset(dsWindowFirst);
+
+  auto dsBlockItr = dsBlocks.begin();
+
   std::list<BlockLink>::iterator blocklinkItr;
   for (blocklinkItr = blocklinks.begin(); blocklinkItr != blocklinks.end();
        blocklinkItr++) {
@@ -222,8 +287,10 @@ bool Retriever::RetrieveBlockLink(bool wakeupForUpgrade) {
 
     if (std::get<BlockLinkIndex::BLOCKTYPE>(blocklink) == BlockType::DS) {
       DSBlockSharedPtr dsblock;
-      if (!BlockStorage::GetBlockStorage().GetDSBlock(
-              std::get<BlockLinkIndex::DSINDEX>(blocklink), dsblock)) {
+      if (dsBlockItr != dsBlocks.end()) {
+        dsblock = *dsBlockItr++;
+      } else if (!BlockStorage::GetBlockStorage().GetDSBlock(
+                     std::get<BlockLinkIndex::DSINDEX>(blocklink), dsblock)) {
         LOG_GENERAL(WARNING,
                     "Could not find ds block num "
                         << std::get<BlockLinkIndex::DSINDEX>(blocklink));
@@ -231,7 +298,9 @@ bool Retriever::RetrieveBlockLink(bool wakeupForUpgrade) {
       }
       m_mediator.m_node->UpdateDSCommiteeComposition(dsComm, *dsblock);
       m_mediator.m_blocklinkchain.SetBuiltDSComm(dsComm);
-      m_mediator.m_dsBlockChain.AddBlock(*dsblock);
+      if (std::get<BlockLinkIndex::DSINDEX>(blocklink) >= dsWindowFirst) {
+        m_mediator.m_dsBlockChain.AddBlock(*dsblock);
+      }
 
     } else if (std::get<BlockLinkIndex::BLOCKTYPE>(blocklink) ==
                BlockType::VC) {
@@ -17,7 +17,6 @@
  * program files.
  */
 
-#include <boost/multiprecision/cpp_dec_float.hpp>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #include <boost/multiprecision/cpp_int.hpp>
@@ -63,15 +62,11 @@ void DSBlockToProtobuf(const DSBlock& dsBlock, ProtoDSBlock& protoDSBlock);
 void TxBlockToProtobuf(const TxBlock& txBlock, ProtoTxBlock& protoTxBlock);
 
 Server::Server(Mediator& mediator) : m_mediator(mediator) {
-  m_StartTimeTx = 0;
-  m_StartTimeDs = 0;
   m_DSBlockCache.first = 0;
   m_DSBlockCache.second.resize(NUM_PAGES_CACHE * PAGE_SIZE);
   m_TxBlockCache.first = 0;
   m_TxBlockCache.second.resize(NUM_PAGES_CACHE * PAGE_SIZE);
   m_RecentTransactions.resize(TXN_PAGE_SIZE);
-  m_TxBlockCountSumPair.first = 0;
-  m_TxBlockCountSumPair.second = 0;
 }
 
 Server::~Server() {
@@ -83,19 +78,7 @@ Server::~Server() {
 ////////////////////////////////////////////////////////////////////////
 
 boost::multiprecision::uint256_t Server::GetNumTransactions(uint64_t blockNum) {
-  uint64_t currBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
-
-  if (blockNum >= currBlockNum) {
-    return 0;
-  }
-
-  uint64_t i, res = 0;
-  for (i = blockNum + 1; i <= currBlockNum; i++) {
-    res += m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
-  }
-
-  return res;
+  return m_mediator.m_txBlockChain.GetNumTxsAfter(blockNum);
 }
 
 void Server::AddToRecentTransactions(const dev::h256& txhash) {
@@ -311,11 +294,11 @@ GetDSBlockResponse Server::GetDsBlock(ProtoBlockNum& protoBlockNum) {
     uint64_t blockNum = protoBlockNum.blocknum();
 
     // Get the DS block.
-    DSBlock dsblock = m_mediator.m_dsBlockChain.GetBlock(blockNum);
+    auto dsblock = m_mediator.m_dsBlockChain.GetBlockPtr(blockNum);
 
     // Convert DSBlock to proto.
     ProtoDSBlock protoDSBlock;
-    DSBlockToProtobuf(dsblock, protoDSBlock);
+    DSBlockToProtobuf(*dsblock, protoDSBlock);
     ret.set_allocated_dsblock(&protoDSBlock);
   } catch (const char* msg) {
     ret.set_error(msg);
@@ -352,11 +335,11 @@ GetTxBlockResponse Server::GetTxBlock(ProtoBlockNum& protoBlockNum) {
     uint64_t blockNum = protoBlockNum.blocknum();
 
     // Get the tx block.
-    TxBlock txblock = m_mediator.m_txBlockChain.GetBlock(blockNum);
+    auto txblock = m_mediator.m_txBlockChain.GetBlockPtr(blockNum);
 
     // Convert txblock to proto.
     ProtoTxBlock protoTxBlock;
-    TxBlockToProtobuf(txblock, protoTxBlock);
+    TxBlockToProtobuf(*txblock, protoTxBlock);
     ret.set_allocated_txblock(&protoTxBlock);
   } catch (const char* msg) {
     ret.set_error(msg);
@@ -386,15 +369,15 @@ GetDSBlockResponse Server::GetLatestDsBlock() {
   GetDSBlockResponse ret;
 
   // Retrieve the latest DS block.
-  DSBlock dsblock = m_mediator.m_dsBlockChain.GetLastBlock();
+  auto dsblock = m_mediator.m_dsBlockChain.GetLastBlockPtr();
 
   LOG_EPOCH(INFO, to_string(m_mediator.m_currentEpochNum).c_str(),
-            "BlockNum " << dsblock.GetHeader().GetBlockNum()
-                        << "  Timestamp:        " << dsblock.GetTimestamp());
+            "BlockNum " << dsblock->GetHeader().GetBlockNum()
+                        << "  Timestamp:        " << dsblock->GetTimestamp());
 
   // Convert DSBlock to proto.
   ProtoDSBlock protoDSBlock;
-  DSBlockToProtobuf(dsblock, protoDSBlock);
+  DSBlockToProtobuf(*dsblock, protoDSBlock);
   ret.set_allocated_dsblock(&protoDSBlock);
 
   return ret;
@@ -406,15 +389,15 @@ GetTxBlockResponse Server::GetLatestTxBlock() {
   GetTxBlockResponse ret;
 
   // Get the latest tx block.
-  TxBlock txblock = m_mediator.m_txBlockChain.GetLastBlock();
+  auto txblock = m_mediator.m_txBlockChain.GetLastBlockPtr();
 
   LOG_EPOCH(INFO, to_string(m_mediator.m_currentEpochNum).c_str(),
-            "BlockNum " << txblock.GetHeader().GetBlockNum()
-                        << "  Timestamp:        " << txblock.GetTimestamp());
+            "BlockNum " << txblock->GetHeader().GetBlockNum()
+                        << "  Timestamp:        " << txblock->GetTimestamp());
 
   // Convert txblock to proto.
   ProtoTxBlock protoTxBlock;
-  TxBlockToProtobuf(txblock, protoTxBlock);
+  TxBlockToProtobuf(*txblock, protoTxBlock);
   ret.set_allocated_txblock(&protoTxBlock);
 
   return ret;
@@ -721,18 +704,9 @@ StringResponse Server::GetNumDSBlocks() {
 StringResponse Server::GetNumTransactions() {
   LOG_MARKER();
 
-  uint64_t currBlock =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
-  if (m_BlockTxPair.first < currBlock) {
-    for (uint64_t i = m_BlockTxPair.first + 1; i <= currBlock; i++) {
-      m_BlockTxPair.second +=
-          m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
-    }
-  }
-  m_BlockTxPair.first = currBlock;
-
+  // Txns in the genesis block are not counted
   StringResponse ret;
-  ret.set_result(m_BlockTxPair.second.str());
+  ret.set_result(Server::GetNumTransactions(0).str());
   return ret;
 }
 
@@ -742,9 +716,7 @@ DoubleResponse Server::GetTransactionRate() {
   DoubleResponse ret;
 
   uint64_t refBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
-
-  uint64_t refTimeTx = 0;
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   if (refBlockNum <= REF_BLOCK_DIFF) {
     if (refBlockNum <= 1) {
@@ -759,23 +731,12 @@ DoubleResponse Server::GetTransactionRate() {
     refBlockNum = refBlockNum - REF_BLOCK_DIFF;
   }
 
-  boost::multiprecision::cpp_dec_float_50 numTxns(
-      Server::GetNumTransactions(refBlockNum));
+  uint64_t numTxns = m_mediator.m_txBlockChain.GetNumTxsAfter(refBlockNum);
   LOG_GENERAL(INFO, "Num Txns: " << numTxns);
 
-  try {
-    TxBlock tx = m_mediator.m_txBlockChain.GetBlock(refBlockNum);
-    refTimeTx = tx.GetTimestamp();
-  } catch (const char* msg) {
-    if (string(msg) == "Blocknumber Absent") {
-      LOG_GENERAL(INFO, "Error in fetching ref block");
-    }
-
-    return ret;
-  }
-
+  uint64_t refTimeTx = m_mediator.m_txBlockChain.GetBlockTimestamp(refBlockNum);
   uint64_t TimeDiff =
-      m_mediator.m_txBlockChain.GetLastBlock().GetTimestamp() - refTimeTx;
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetTimestamp() - refTimeTx;
 
   if (TimeDiff == 0 || refTimeTx == 0) {
     // something went wrong
@@ -784,12 +745,8 @@ DoubleResponse Server::GetTransactionRate() {
     return ret;
   }
 
-  numTxns = numTxns * 1000000;  // conversion from microseconds to seconds
-  boost::multiprecision::cpp_dec_float_50 TimeDiffFloat =
-      static_cast<boost::multiprecision::cpp_dec_float_50>(TimeDiff);
-  boost::multiprecision::cpp_dec_float_50 ans = numTxns / TimeDiffFloat;
-
-  ret.set_result(ans.convert_to<double>());
+  // conversion from microseconds to seconds
+  ret.set_result(numTxns * 1000000.0 / TimeDiff);
   return ret;
 }
 
@@ -798,25 +755,16 @@ DoubleResponse Server::GetDSBlockRate() {
 
   DoubleResponse ret;
 
-  string numDSblockStr = to_string(m_mediator.m_dsBlockChain.GetBlockCount());
-  boost::multiprecision::cpp_dec_float_50 numDs(numDSblockStr);
-
-  if (m_StartTimeDs == 0) {  // case when m_StartTime has not been set
-    try {
-      // Refernce time chosen to be the first block's timestamp
-      DSBlock dsb = m_mediator.m_dsBlockChain.GetBlock(1);
-      m_StartTimeDs = dsb.GetTimestamp();
-    } catch (const char* msg) {
-      if (string(msg) == "Blocknumber Absent") {
-        LOG_GENERAL(INFO, "No DSBlock has been mined yet");
-      }
-
-      return ret;
-    }
+  // Reference time chosen to be the first block's timestamp
+  uint64_t startTimeDs = m_mediator.m_dsBlockChain.GetBlockTimestamp(1);
+  if (startTimeDs == 0) {
+    LOG_GENERAL(INFO, "No DSBlock has been mined yet");
+    return ret;
   }
 
   uint64_t TimeDiff =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetTimestamp() - m_StartTimeDs;
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetTimestamp() -
+      startTimeDs;
 
   if (TimeDiff == 0) {
     LOG_GENERAL(INFO, "Wait till the second block");
@@ -824,12 +772,8 @@ DoubleResponse Server::GetDSBlockRate() {
   }
 
   // To convert from microSeconds to seconds
-  numDs = numDs * 1000000;
-  boost::multiprecision::cpp_dec_float_50 TimeDiffFloat =
-      static_cast<boost::multiprecision::cpp_dec_float_50>(TimeDiff);
-  boost::multiprecision::cpp_dec_float_50 ans = numDs / TimeDiffFloat;
-
-  ret.set_result(ans.convert_to<double>());
+  ret.set_result(m_mediator.m_dsBlockChain.GetBlockCount() * 1000000.0 /
+                 TimeDiff);
   return ret;
 }
 
@@ -838,25 +782,16 @@ DoubleResponse Server::GetTxBlockRate() {
 
   DoubleResponse ret;
 
-  string numTxblockStr = to_string(m_mediator.m_txBlockChain.GetBlockCount());
-  boost::multiprecision::cpp_dec_float_50 numTx(numTxblockStr);
-
-  if (m_StartTimeTx == 0) {
-    try {
-      // Reference Time chosen to be first block's timestamp
-      TxBlock txb = m_mediator.m_txBlockChain.GetBlock(1);
-      m_StartTimeTx = txb.GetTimestamp();
-    } catch (const char* msg) {
-      if (string(msg) == "Blocknumber Absent") {
-        LOG_GENERAL(INFO, "No TxBlock has been mined yet");
-      }
-
-      return ret;
-    }
+  // Reference time chosen to be the first block's timestamp
+  uint64_t startTimeTx = m_mediator.m_txBlockChain.GetBlockTimestamp(1);
+  if (startTimeTx == 0) {
+    LOG_GENERAL(INFO, "No TxBlock has been mined yet");
+    return ret;
   }
 
   uint64_t TimeDiff =
-      m_mediator.m_txBlockChain.GetLastBlock().GetTimestamp() - m_StartTimeTx;
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetTimestamp() -
+      startTimeTx;
 
   if (TimeDiff == 0) {
     LOG_GENERAL(INFO, "Wait till the second block");
@@ -864,11 +799,8 @@ DoubleResponse Server::GetTxBlockRate() {
   }
 
   // To convert from microSeconds to seconds
-  numTx = numTx * 1000000;
-  boost::multiprecision::cpp_dec_float_50 TimeDiffFloat(to_string(TimeDiff));
-  boost::multiprecision::cpp_dec_float_50 ans = numTx / TimeDiffFloat;
-
-  ret.set_result(ans.convert_to<double>());
+  ret.set_result(m_mediator.m_txBlockChain.GetBlockCount() * 1000000.0 /
+                 TimeDiff);
   return ret;
 }
 
@@ -885,7 +817,7 @@ UInt64Response Server::GetCurrentDSEpoch() {
 
   UInt64Response ret;
   ret.set_result(
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum());
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum());
   return ret;
 }
 
@@ -899,14 +831,15 @@ ProtoBlockListing Server::DSBlockListing(ProtoPage& protoPage) {
   }
 
   uint64_t currBlockNum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
   auto maxPages = (currBlockNum / PAGE_SIZE) + 1;
   ret.set_maxpages(int(maxPages));
 
   if (m_DSBlockCache.second.size() == 0) {
     try {
       // add the hash of genesis block
-      DSBlockHeader dshead = m_mediator.m_dsBlockChain.GetBlock(0).GetHeader();
+      DSBlockHeader dshead =
+          m_mediator.m_dsBlockChain.GetBlockPtr(0)->GetHeader();
       SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
       vector<unsigned char> vec;
       dshead.Serialize(vec, 0);
@@ -929,15 +862,16 @@ ProtoBlockListing Server::DSBlockListing(ProtoPage& protoPage) {
 
   if (currBlockNum > m_DSBlockCache.first) {
     for (uint64_t i = m_DSBlockCache.first + 1; i < currBlockNum; i++) {
-      m_DSBlockCache.second.insert_new(m_DSBlockCache.second.size(),
-                                       m_mediator.m_dsBlockChain.GetBlock(i + 1)
-                                           .GetHeader()
-                                           .GetPrevHash()
-                                           .hex());
+      m_DSBlockCache.second.insert_new(
+          m_DSBlockCache.second.size(),
+          m_mediator.m_dsBlockChain.GetBlockPtr(i + 1)
+              ->GetHeader()
+              .GetPrevHash()
+              .hex());
     }
     // for the latest block
     DSBlockHeader dshead =
-        m_mediator.m_dsBlockChain.GetBlock(currBlockNum).GetHeader();
+        m_mediator.m_dsBlockChain.GetBlockPtr(currBlockNum)->GetHeader();
     SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
     vector<unsigned char> vec;
     dshead.Serialize(vec, 0);
@@ -971,8 +905,8 @@ ProtoBlockListing Server::DSBlockListing(ProtoPage& protoPage) {
          i++) {
       auto blockData = ret.add_data();
       blockData->set_hash(
-          m_mediator.m_dsBlockChain.GetBlock(currBlockNum - i + 1)
-              .GetHeader()
+          m_mediator.m_dsBlockChain.GetBlockPtr(currBlockNum - i + 1)
+              ->GetHeader()
               .GetPrevHash()
               .hex());
       blockData->set_blocknum(int(currBlockNum - i));
@@ -992,14 +926,15 @@ ProtoBlockListing Server::TxBlockListing(ProtoPage& protoPage) {
   }
 
   uint64_t currBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
   auto maxPages = (currBlockNum / PAGE_SIZE) + 1;
   ret.set_maxpages(int(maxPages));
 
   if (m_TxBlockCache.second.size() == 0) {
     try {
       // add the hash of genesis block
-      TxBlockHeader txhead = m_mediator.m_txBlockChain.GetBlock(0).GetHeader();
+      TxBlockHeader txhead =
+          m_mediator.m_txBlockChain.GetBlockPtr(0)->GetHeader();
       SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
       vector<unsigned char> vec;
       txhead.Serialize(vec, 0);
@@ -1022,15 +957,16 @@ ProtoBlockListing Server::TxBlockListing(ProtoPage& protoPage) {
 
   if (currBlockNum > m_TxBlockCache.first) {
     for (uint64_t i = m_TxBlockCache.first + 1; i < currBlockNum; i++) {
-      m_TxBlockCache.second.insert_new(m_TxBlockCache.second.size(),
-                                       m_mediator.m_txBlockChain.GetBlock(i + 1)
-                                           .GetHeader()
-                                           .GetPrevHash()
-                                           .hex());
+      m_TxBlockCache.second.insert_new(
+          m_TxBlockCache.second.size(),
+          m_mediator.m_txBlockChain.GetBlockPtr(i + 1)
+              ->GetHeader()
+              .GetPrevHash()
+              .hex());
     }
     // for the latest block
     TxBlockHeader txhead =
-        m_mediator.m_txBlockChain.GetBlock(currBlockNum).GetHeader();
+        m_mediator.m_txBlockChain.GetBlockPtr(currBlockNum)->GetHeader();
     SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
     vector<unsigned char> vec;
     txhead.Serialize(vec, 0);
@@ -1064,8 +1000,8 @@ ProtoBlockListing Server::TxBlockListing(ProtoPage& protoPage) {
          i++) {
       auto blockData = ret.add_data();
       blockData->set_hash(
-          m_mediator.m_txBlockChain.GetBlock(currBlockNum - i + 1)
-              .GetHeader()
+          m_mediator.m_txBlockChain.GetBlockPtr(currBlockNum - i + 1)
+              ->GetHeader()
               .GetPrevHash()
               .hex());
       blockData->set_blocknum(int(currBlockNum - i));
@@ -1151,7 +1087,7 @@ UIntResponse Server::GetNumTxnsTxEpoch() {
 
   try {
     ret.set_result(
-        m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetNumTxs());
+        m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetNumTxs());
   } catch (exception& e) {
     LOG_GENERAL(WARNING, e.what());
     ret.set_result(0);
@@ -1164,45 +1100,7 @@ StringResponse Server::GetNumTxnsDSEpoch() {
   LOG_MARKER();
 
   StringResponse ret;
-
-  try {
-    auto latestTxBlock = m_mediator.m_txBlockChain.GetLastBlock().GetHeader();
-    auto latestTxBlockNum = latestTxBlock.GetBlockNum();
-    auto latestDSBlockNum = latestTxBlock.GetDSBlockNum();
-
-    if (latestTxBlockNum > m_TxBlockCountSumPair.first) {
-      // Case where the DS Epoch is same
-      if (m_mediator.m_txBlockChain.GetBlock(m_TxBlockCountSumPair.first)
-              .GetHeader()
-              .GetDSBlockNum() == latestDSBlockNum) {
-        for (auto i = latestTxBlockNum; i > m_TxBlockCountSumPair.first; i--) {
-          m_TxBlockCountSumPair.second +=
-              m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
-        }
-
-      } else {  // Case if DS Epoch Changed
-        m_TxBlockCountSumPair.second = 0;
-
-        for (auto i = latestTxBlockNum; i > m_TxBlockCountSumPair.first; i--) {
-          if (m_mediator.m_txBlockChain.GetBlock(i)
-                  .GetHeader()
-                  .GetDSBlockNum() < latestDSBlockNum) {
-            break;
-          }
-          m_TxBlockCountSumPair.second +=
-              m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
-        }
-      }
-
-      m_TxBlockCountSumPair.first = latestTxBlockNum;
-    }
-
-    ret.set_result(m_TxBlockCountSumPair.second.str());
-
-  } catch (exception& e) {
-    LOG_GENERAL(WARNING, e.what());
-    ret.set_result("0");
-  }
-
+  ret.set_result(to_string(
+      m_mediator.m_txBlockChain.GetStats().GetNumTxsInLastDSEpoch()));
   return ret;
 }
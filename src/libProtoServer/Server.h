@@ -33,10 +33,6 @@ class Mediator;
 
 class Server {
   Mediator& m_mediator;
-  std::pair<uint64_t, boost::multiprecision::uint256_t> m_BlockTxPair;
-  std::pair<uint64_t, boost::multiprecision::uint256_t> m_TxBlockCountSumPair;
-  uint64_t m_StartTimeTx;
-  uint64_t m_StartTimeDs;
   std::pair<uint64_t, CircularArray<std::string>> m_DSBlockCache;
   std::pair<uint64_t, CircularArray<std::string>> m_TxBlockCache;
   static CircularArray<std::string> m_RecentTransactions;
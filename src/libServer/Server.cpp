@@ -20,7 +20,6 @@
 #include "JSONConversion.h"
 
 #include <jsonrpccpp/server.h>
-#include <boost/multiprecision/cpp_dec_float.hpp>
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #include <boost/multiprecision/cpp_int.hpp>
@@ -40,6 +39,7 @@
 #include "libNetwork/Peer.h"
 #include "libPersistence/BlockStorage.h"
 #include "libUtils/Logger.h"
+#include "libUtils/MerkleTree.h"
 #include "libUtils/TimeUtils.h"
 
 using namespace jsonrpc;
@@ -57,15 +57,11 @@ const unsigned int REF_BLOCK_DIFF = 1;
 
 Server::Server(Mediator& mediator, HttpServer& httpserver)
     : AbstractZServer(httpserver), m_mediator(mediator) {
-  m_StartTimeTx = 0;
-  m_StartTimeDs = 0;
   m_DSBlockCache.first = 0;
   m_DSBlockCache.second.resize(NUM_PAGES_CACHE * PAGE_SIZE);
   m_TxBlockCache.first = 0;
   m_TxBlockCache.second.resize(NUM_PAGES_CACHE * PAGE_SIZE);
   m_RecentTransactions.resize(TXN_PAGE_SIZE);
-  m_TxBlockCountSumPair.first = 0;
-  m_TxBlockCountSumPair.second = 0;
 }
 
 Server::~Server() {
@@ -187,7 +183,12 @@ Json::Value Server::GetTransaction(const string& transactionHash) {
       _json["error"] = "Txn Hash not Present";
       return _json;
     }
-    return JSONConversion::convertTxtoJson(*tptr);
+    Json::Value _json = JSONConversion::convertTxtoJson(*tptr);
+    Json::Value proof = GetTransactionProof(tranHash);
+    if (!proof.isNull()) {
+      _json["proof"] = proof;
+    }
+    return _json;
   } catch (exception& e) {
     Json::Value _json;
     LOG_GENERAL(INFO, "[Error]" << e.what() << " Input: " << transactionHash);
@@ -196,11 +197,43 @@ Json::Value Server::GetTransaction(const string& transactionHash) {
   }
 }
 
+Json::Value Server::GetTransactionProof(const dev::h256& tranHash) {
+  BlockHash microBlockHash;
+  MicroBlockSharedPtr microBlock;
+  if (!BlockStorage::GetBlockStorage().GetTxMicroBlock(tranHash,
+                                                       microBlockHash) ||
+      !BlockStorage::GetBlockStorage().GetMicroBlock(microBlockHash,
+                                                     microBlock)) {
+    return Json::nullValue;
+  }
+
+  const vector<TxnHash>& tranHashes = microBlock->GetTranHashes();
+  auto it = find(tranHashes.begin(), tranHashes.end(), tranHash);
+  if (it == tranHashes.end()) {
+    return Json::nullValue;
+  }
+  size_t index = distance(tranHashes.begin(), it);
+
+  vector<dev::h256> siblings;
+  MerkleTree(tranHashes).GetProof(index, siblings);
+
+  Json::Value _json;
+  _json["microBlockHash"] = microBlockHash.hex();
+  _json["txRootHash"] = microBlock->GetHeader().GetTxRootHash().hex();
+  _json["index"] = to_string(index);
+  _json["count"] = to_string(tranHashes.size());
+  _json["siblings"] = Json::arrayValue;
+  for (const auto& sibling : siblings) {
+    _json["siblings"].append(sibling.hex());
+  }
+  return _json;
+}
+
 Json::Value Server::GetDsBlock(const string& blockNum) {
   try {
     uint64_t BlockNum = stoull(blockNum);
     return JSONConversion::convertDSblocktoJson(
-        m_mediator.m_dsBlockChain.GetBlock(BlockNum));
+        *m_mediator.m_dsBlockChain.GetBlockPtr(BlockNum));
   } catch (const char* msg) {
     Json::Value _json;
     _json["Error"] = msg;
@@ -232,7 +265,7 @@ Json::Value Server::GetTxBlock(const string& blockNum) {
   try {
     uint64_t BlockNum = stoull(blockNum);
     return JSONConversion::convertTxBlocktoJson(
-        m_mediator.m_txBlockChain.GetBlock(BlockNum));
+        *m_mediator.m_txBlockChain.GetBlockPtr(BlockNum));
   } catch (const char* msg) {
     Json::Value _json;
     _json["Error"] = msg;
@@ -261,32 +294,32 @@ Json::Value Server::GetTxBlock(const string& blockNum) {
 }
 
 string Server::GetMinimumGasPrice() {
-  return m_mediator.m_dsBlockChain.GetLastBlock()
-      .GetHeader()
+  return m_mediator.m_dsBlockChain.GetLastBlockPtr()
+      ->GetHeader()
       .GetGasPrice()
       .str();
 }
 
 Json::Value Server::GetLatestDsBlock() {
   LOG_MARKER();
-  DSBlock Latest = m_mediator.m_dsBlockChain.GetLastBlock();
+  auto Latest = m_mediator.m_dsBlockChain.GetLastBlockPtr();
 
   LOG_EPOCH(INFO, to_string(m_mediator.m_currentEpochNum).c_str(),
-            "BlockNum " << Latest.GetHeader().GetBlockNum()
-                        << "  Timestamp:        " << Latest.GetTimestamp());
+            "BlockNum " << Latest->GetHeader().GetBlockNum()
+                        << "  Timestamp:        " << Latest->GetTimestamp());
 
-  return JSONConversion::convertDSblocktoJson(Latest);
+  return JSONConversion::convertDSblocktoJson(*Latest);
 }
 
 Json::Value Server::GetLatestTxBlock() {
   LOG_MARKER();
-  TxBlock Latest = m_mediator.m_txBlockChain.GetLastBlock();
+  auto Latest = m_mediator.m_txBlockChain.GetLastBlockPtr();
 
   LOG_EPOCH(INFO, to_string(m_mediator.m_currentEpochNum).c_str(),
-            "BlockNum " << Latest.GetHeader().GetBlockNum()
-                        << "  Timestamp:        " << Latest.GetTimestamp());
+            "BlockNum " << Latest->GetHeader().GetBlockNum()
+                        << "  Timestamp:        " << Latest->GetTimestamp());
 
-  return JSONConversion::convertTxBlocktoJson(Latest);
+  return JSONConversion::convertTxBlocktoJson(*Latest);
 }
 
 Json::Value Server::GetBalance(const string& address) {
@@ -526,52 +559,33 @@ string Server::GetNumDSBlocks() {
 }
 
 uint8_t Server::GetPrevDSDifficulty() {
-  return m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDSDifficulty();
+  return m_mediator.m_dsBlockChain.GetLastBlockPtr()
+      ->GetHeader()
+      .GetDSDifficulty();
 }
 
 uint8_t Server::GetPrevDifficulty() {
-  return m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetDifficulty();
+  return m_mediator.m_dsBlockChain.GetLastBlockPtr()
+      ->GetHeader()
+      .GetDifficulty();
 }
 
 string Server::GetNumTransactions() {
   LOG_MARKER();
 
-  uint64_t currBlock =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
-  if (m_BlockTxPair.first < currBlock) {
-    for (uint64_t i = m_BlockTxPair.first + 1; i <= currBlock; i++) {
-      m_BlockTxPair.second +=
-          m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
-    }
-  }
-  m_BlockTxPair.first = currBlock;
-
-  return m_BlockTxPair.second.str();
+  // Txns in the genesis block are not counted
+  return to_string(Server::GetNumTransactions(0));
 }
 
 size_t Server::GetNumTransactions(uint64_t blockNum) {
-  uint64_t currBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
-
-  if (blockNum >= currBlockNum) {
-    return 0;
-  }
-
-  size_t i, res = 0;
-
-  for (i = blockNum + 1; i <= currBlockNum; i++) {
-    res += m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
-  }
-
-  return res;
+  return m_mediator.m_txBlockChain.GetNumTxsAfter(blockNum);
 }
+
 double Server::GetTransactionRate() {
   LOG_MARKER();
 
   uint64_t refBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
-
-  uint64_t refTimeTx = 0;
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
 
   if (refBlockNum <= REF_BLOCK_DIFF) {
     if (refBlockNum <= 1) {
@@ -586,22 +600,12 @@ double Server::GetTransactionRate() {
     refBlockNum = refBlockNum - REF_BLOCK_DIFF;
   }
 
-  boost::multiprecision::cpp_dec_float_50 numTxns(
-      Server::GetNumTransactions(refBlockNum));
+  uint64_t numTxns = Server::GetNumTransactions(refBlockNum);
   LOG_GENERAL(INFO, "Num Txns: " << numTxns);
 
-  try {
-    TxBlock tx = m_mediator.m_txBlockChain.GetBlock(refBlockNum);
-    refTimeTx = tx.GetTimestamp();
-  } catch (const char* msg) {
-    if (string(msg) == "Blocknumber Absent") {
-      LOG_GENERAL(INFO, "Error in fetching ref block");
-    }
-    return 0;
-  }
-
+  uint64_t refTimeTx = m_mediator.m_txBlockChain.GetBlockTimestamp(refBlockNum);
   uint64_t TimeDiff =
-      m_mediator.m_txBlockChain.GetLastBlock().GetTimestamp() - refTimeTx;
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetTimestamp() - refTimeTx;
 
   if (TimeDiff == 0 || refTimeTx == 0) {
     // something went wrong
@@ -609,78 +613,55 @@ double Server::GetTransactionRate() {
                           << TimeDiff << " refTimeTx:" << refTimeTx);
     return 0;
   }
-  numTxns = numTxns * 1000000;  // conversion from microseconds to seconds
-  boost::multiprecision::cpp_dec_float_50 TimeDiffFloat =
-      static_cast<boost::multiprecision::cpp_dec_float_50>(TimeDiff);
-  boost::multiprecision::cpp_dec_float_50 ans = numTxns / TimeDiffFloat;
 
-  return ans.convert_to<double>();
+  // conversion from microseconds to seconds
+  return numTxns * 1000000.0 / TimeDiff;
 }
 
 double Server::GetDSBlockRate() {
   LOG_MARKER();
 
-  string numDSblockStr = to_string(m_mediator.m_dsBlockChain.GetBlockCount());
-  boost::multiprecision::cpp_dec_float_50 numDs(numDSblockStr);
-
-  if (m_StartTimeDs == 0)  // case when m_StartTime has not been set
-  {
-    try {
-      // Refernce time chosen to be the first block's timestamp
-      DSBlock dsb = m_mediator.m_dsBlockChain.GetBlock(1);
-      m_StartTimeDs = dsb.GetTimestamp();
-    } catch (const char* msg) {
-      if (string(msg) == "Blocknumber Absent") {
-        LOG_GENERAL(INFO, "No DSBlock has been mined yet");
-      }
-      return 0;
-    }
+  // Reference time chosen to be the first block's timestamp
+  uint64_t startTimeDs = m_mediator.m_dsBlockChain.GetBlockTimestamp(1);
+  if (startTimeDs == 0) {
+    LOG_GENERAL(INFO, "No DSBlock has been mined yet");
+    return 0;
   }
+
   uint64_t TimeDiff =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetTimestamp() - m_StartTimeDs;
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetTimestamp() -
+      startTimeDs;
 
   if (TimeDiff == 0) {
     LOG_GENERAL(INFO, "Wait till the second block");
     return 0;
   }
+
   // To convert from microSeconds to seconds
-  numDs = numDs * 1000000;
-  boost::multiprecision::cpp_dec_float_50 TimeDiffFloat =
-      static_cast<boost::multiprecision::cpp_dec_float_50>(TimeDiff);
-  boost::multiprecision::cpp_dec_float_50 ans = numDs / TimeDiffFloat;
-  return ans.convert_to<double>();
+  return m_mediator.m_dsBlockChain.GetBlockCount() * 1000000.0 / TimeDiff;
 }
 
 double Server::GetTxBlockRate() {
   LOG_MARKER();
 
-  string numTxblockStr = to_string(m_mediator.m_txBlockChain.GetBlockCount());
-  boost::multiprecision::cpp_dec_float_50 numTx(numTxblockStr);
-
-  if (m_StartTimeTx == 0) {
-    try {
-      // Reference Time chosen to be first block's timestamp
-      TxBlock txb = m_mediator.m_txBlockChain.GetBlock(1);
-      m_StartTimeTx = txb.GetTimestamp();
-    } catch (const char* msg) {
-      if (string(msg) == "Blocknumber Absent") {
-        LOG_GENERAL(INFO, "No TxBlock has been mined yet");
-      }
-      return 0;
-    }
+  // Reference time chosen to be the first block's timestamp
+  uint64_t startTimeTx = m_mediator.m_txBlockChain.GetBlockTimestamp(1);
+  if (startTimeTx == 0) {
+    LOG_GENERAL(INFO, "No TxBlock has been mined yet");
+    return 0;
   }
+
   uint64_t TimeDiff =
-      m_mediator.m_txBlockChain.GetLastBlock().GetTimestamp() - m_StartTimeTx;
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetTimestamp() -
+      startTimeTx;
 
   if (TimeDiff == 0) {
     LOG_GENERAL(INFO, "Wait till the second block");
     return 0;
   }
+
   // To convert from microSeconds to seconds
-  numTx = numTx * 1000000;
-  boost::multiprecision::cpp_dec_float_50 TimeDiffFloat(to_string(TimeDiff));
-  boost::multiprecision::cpp_dec_float_50 ans = numTx / TimeDiffFloat;
-  return ans.convert_to<double>();
+  return m_mediator.m_txBlockChain.GetBlockCount() * 1000000.0 / TimeDiff;
 }
 
 string Server::GetCurrentMiniEpoch() {
@@ -693,14 +674,14 @@ string Server::GetCurrentDSEpoch() {
   LOG_MARKER();
 
   return to_string(
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum());
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum());
 }
 
 Json::Value Server::DSBlockListing(unsigned int page) {
   LOG_MARKER();
 
   uint64_t currBlockNum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
   Json::Value _json;
 
   auto maxPages = (currBlockNum / PAGE_SIZE) + 1;
@@ -710,7 +691,8 @@ Json::Value Server::DSBlockListing(unsigned int page) {
   if (m_DSBlockCache.second.size() == 0) {
     try {
       // add the hash of genesis block
-      DSBlockHeader dshead = m_mediator.m_dsBlockChain.GetBlock(0).GetHeader();
+      DSBlockHeader dshead =
+          m_mediator.m_dsBlockChain.GetBlockPtr(0)->GetHeader();
       SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
       vector<unsigned char> vec;
       dshead.Serialize(vec, 0);
@@ -732,15 +714,16 @@ Json::Value Server::DSBlockListing(unsigned int page) {
 
   if (currBlockNum > m_DSBlockCache.first) {
     for (uint64_t i = m_DSBlockCache.first + 1; i < currBlockNum; i++) {
-      m_DSBlockCache.second.insert_new(m_DSBlockCache.second.size(),
-                                       m_mediator.m_dsBlockChain.GetBlock(i + 1)
-                                           .GetHeader()
-                                           .GetPrevHash()
-                                           .hex());
+      m_DSBlockCache.second.insert_new(
+          m_DSBlockCache.second.size(),
+          m_mediator.m_dsBlockChain.GetBlockPtr(i + 1)
+              ->GetHeader()
+              .GetPrevHash()
+              .hex());
     }
     // for the latest block
     DSBlockHeader dshead =
-        m_mediator.m_dsBlockChain.GetBlock(currBlockNum).GetHeader();
+        m_mediator.m_dsBlockChain.GetBlockPtr(currBlockNum)->GetHeader();
     SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
     vector<unsigned char> vec;
     dshead.Serialize(vec, 0);
@@ -775,10 +758,11 @@ Json::Value Server::DSBlockListing(unsigned int page) {
     for (uint64_t i = offset; i < PAGE_SIZE + offset && i <= currBlockNum;
          i++) {
       tmpJson.clear();
-      tmpJson["Hash"] = m_mediator.m_dsBlockChain.GetBlock(currBlockNum - i + 1)
-                            .GetHeader()
-                            .GetPrevHash()
-                            .hex();
+      tmpJson["Hash"] =
+          m_mediator.m_dsBlockChain.GetBlockPtr(currBlockNum - i + 1)
+              ->GetHeader()
+              .GetPrevHash()
+              .hex();
       tmpJson["BlockNum"] = int(currBlockNum - i);
       _json["data"].append(tmpJson);
     }
@@ -791,7 +775,7 @@ Json::Value Server::TxBlockListing(unsigned int page) {
   LOG_MARKER();
 
   uint64_t currBlockNum =
-      m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
   Json::Value _json;
 
   auto maxPages = (currBlockNum / PAGE_SIZE) + 1;
@@ -801,7 +785,8 @@ Json::Value Server::TxBlockListing(unsigned int page) {
   if (m_TxBlockCache.second.size() == 0) {
     try {
       // add the hash of genesis block
-      TxBlockHeader txhead = m_mediator.m_txBlockChain.GetBlock(0).GetHeader();
+      TxBlockHeader txhead =
+          m_mediator.m_txBlockChain.GetBlockPtr(0)->GetHeader();
       SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
       vector<unsigned char> vec;
       txhead.Serialize(vec, 0);
@@ -823,15 +808,16 @@ Json::Value Server::TxBlockListing(unsigned int page) {
 
   if (currBlockNum > m_TxBlockCache.first) {
     for (uint64_t i = m_TxBlockCache.first + 1; i < currBlockNum; i++) {
-      m_TxBlockCache.second.insert_new(m_TxBlockCache.second.size(),
-                                       m_mediator.m_txBlockChain.GetBlock(i + 1)
-                                           .GetHeader()
-                                           .GetPrevHash()
-                                           .hex());
+      m_TxBlockCache.second.insert_new(
+          m_TxBlockCache.second.size(),
+          m_mediator.m_txBlockChain.GetBlockPtr(i + 1)
+              ->GetHeader()
+              .GetPrevHash()
+              .hex());
     }
     // for the latest block
     TxBlockHeader txhead =
-        m_mediator.m_txBlockChain.GetBlock(currBlockNum).GetHeader();
+        m_mediator.m_txBlockChain.GetBlockPtr(currBlockNum)->GetHeader();
     SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
     vector<unsigned char> vec;
     txhead.Serialize(vec, 0);
@@ -867,10 +853,11 @@ Json::Value Server::TxBlockListing(unsigned int page) {
     for (uint64_t i = offset; i < PAGE_SIZE + offset && i <= currBlockNum;
          i++) {
       tmpJson.clear();
-      tmpJson["Hash"] = m_mediator.m_txBlockChain.GetBlock(currBlockNum - i + 1)
-                            .GetHeader()
-                            .GetPrevHash()
-                            .hex();
+      tmpJson["Hash"] =
+          m_mediator.m_txBlockChain.GetBlockPtr(currBlockNum - i + 1)
+              ->GetHeader()
+              .GetPrevHash()
+              .hex();
       tmpJson["BlockNum"] = int(currBlockNum - i);
       _json["data"].append(tmpJson);
     }
@@ -952,7 +939,7 @@ uint32_t Server::GetNumTxnsTxEpoch() {
   LOG_MARKER();
 
   try {
-    return m_mediator.m_txBlockChain.GetLastBlock().GetHeader().GetNumTxs();
+    return m_mediator.m_txBlockChain.GetLastBlockPtr()->GetHeader().GetNumTxs();
   } catch (exception& e) {
     LOG_GENERAL(WARNING, e.what());
     return 0;
@@ -962,44 +949,6 @@ uint32_t Server::GetNumTxnsTxEpoch() {
 string Server::GetNumTxnsDSEpoch() {
   LOG_MARKER();
 
-  try {
-    auto latestTxBlock = m_mediator.m_txBlockChain.GetLastBlock().GetHeader();
-    auto latestTxBlockNum = latestTxBlock.GetBlockNum();
-    auto latestDSBlockNum = latestTxBlock.GetDSBlockNum();
-
-    if (latestTxBlockNum > m_TxBlockCountSumPair.first) {
-      // Case where the DS Epoch is same
-      if (m_mediator.m_txBlockChain.GetBlock(m_TxBlockCountSumPair.first)
-              .GetHeader()
-              .GetDSBlockNum() == latestDSBlockNum) {
-        for (auto i = latestTxBlockNum; i > m_TxBlockCountSumPair.first; i--) {
-          m_TxBlockCountSumPair.second +=
-              m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
-        }
-      }
-      // Case if DS Epoch Changed
-      else {
-        m_TxBlockCountSumPair.second = 0;
-
-        for (auto i = latestTxBlockNum; i > m_TxBlockCountSumPair.first; i--) {
-          if (m_mediator.m_txBlockChain.GetBlock(i)
-                  .GetHeader()
-                  .GetDSBlockNum() < latestDSBlockNum) {
-            break;
-          }
-          m_TxBlockCountSumPair.second +=
-              m_mediator.m_txBlockChain.GetBlock(i).GetHeader().GetNumTxs();
-        }
-      }
-
-      m_TxBlockCountSumPair.first = latestTxBlockNum;
-    }
-
-    return m_TxBlockCountSumPair.second.str();
-  }
-
-  catch (exception& e) {
-    LOG_GENERAL(WARNING, e.what());
-    return "0";
-  }
+  return to_string(
+      m_mediator.m_txBlockChain.GetStats().GetNumTxsInLastDSEpoch());
 }
@@ -394,10 +394,6 @@ class AbstractZServer : public jsonrpc::AbstractServer<AbstractZServer> {
 
 class Server : public AbstractZServer {
   Mediator& m_mediator;
-  std::pair<uint64_t, boost::multiprecision::uint128_t> m_BlockTxPair;
-  std::pair<uint64_t, boost::multiprecision::uint128_t> m_TxBlockCountSumPair;
-  uint64_t m_StartTimeTx;
-  uint64_t m_StartTimeDs;
   std::pair<uint64_t, CircularArray<std::string>> m_DSBlockCache;
   std::pair<uint64_t, CircularArray<std::string>> m_TxBlockCache;
   static CircularArray<std::string> m_RecentTransactions;
@@ -446,6 +442,10 @@ class Server : public AbstractZServer {
   // block
   size_t GetNumTransactions(uint64_t blockNum);
 
+  // gets the Merkle inclusion proof of a transaction against the txn root of
+  // its micro block, or a null value if the micro block is not stored
+  static Json::Value GetTransactionProof(const dev::h256& tranHash);
+
   Json::Value GetSmartContractState(const std::string& address);
   Json::Value GetSmartContractInit(const std::string& address);
   Json::Value GetSmartContractCode(const std::string& address);
@@ -0,0 +1,466 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include "AsyncLogWriter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+using namespace std;
+
+namespace {
+// Record header: timestamp (8), tid (4), flags (1), level length (1),
+// function length (1), epoch length (2), message length (4), all little
+// endian, followed by the four strings
+const size_t HEADER_SIZE = 21;
+const uint8_t FLAG_RAW = 0x01;
+const uint8_t FLAG_CONTINUED = 0x02;
+const size_t MAX_LEVEL_LEN = 7;
+const size_t MAX_FUNCTION_LEN = 30;
+const size_t MAX_EPOCH_LEN = 32;
+const unsigned int IDLE_WAIT_IN_MS = 5;
+
+atomic<uint64_t> g_nextWriterId{1};
+
+void PutUint(string& dst, uint64_t value, unsigned int bytes) {
+  for (unsigned int i = 0; i < bytes; i++) {
+    dst.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+  }
+}
+
+uint64_t GetUint(const char* src, unsigned int bytes) {
+  uint64_t value = 0;
+  for (unsigned int i = 0; i < bytes; i++) {
+    value |= static_cast<uint64_t>(static_cast<unsigned char>(src[i]))
+             << (8 * i);
+  }
+  return value;
+}
+
+// Returns the full length of the record starting at src, or 0 if fewer than
+// avail bytes hold it
+size_t GetRecordLen(const char* src, size_t avail) {
+  if (avail < HEADER_SIZE) {
+    return 0;
+  }
+  size_t len = HEADER_SIZE + GetUint(src + 13, 1) + GetUint(src + 14, 1) +
+               GetUint(src + 15, 2) + GetUint(src + 17, 4);
+  return len <= avail ? len : 0;
+}
+
+void DecodeRecord(const char* src, AsyncLogWriter::Record& record) {
+  record.m_timestamp = GetUint(src, 8);
+  record.m_tid = GetUint(src + 8, 4);
+  record.m_raw = (GetUint(src + 12, 1) & FLAG_RAW) != 0;
+  record.m_continued = (GetUint(src + 12, 1) & FLAG_CONTINUED) != 0;
+  size_t levelLen = GetUint(src + 13, 1);
+  size_t functionLen = GetUint(src + 14, 1);
+  size_t epochLen = GetUint(src + 15, 2);
+  size_t messageLen = GetUint(src + 17, 4);
+
+  const char* pos = src + HEADER_SIZE;
+  record.m_level.assign(pos, levelLen);
+  pos += levelLen;
+  record.m_function.assign(pos, functionLen);
+  pos += functionLen;
+  record.m_epoch.assign(pos, epochLen);
+  pos += epochLen;
+  record.m_message.assign(pos, messageLen);
+}
+}  // namespace
+
+/// Single-producer single-consumer byte ring. The logging thread owning it
+/// appends whole records and the writer thread takes everything available.
+class AsyncLogWriter::Ring {
+ public:
+  Ring() : m_buffer(new char[RING_SIZE]) {}
+
+  bool TryPush(const string& bytes) {
+    uint64_t head = m_head.load(memory_order_relaxed);
+    uint64_t tail = m_tail.load(memory_order_acquire);
+
+    if (head - tail + bytes.size() > RING_SIZE) {
+      return false;
+    }
+
+    size_t pos = head % RING_SIZE;
+    size_t first = min(bytes.size(), RING_SIZE - pos);
+    memcpy(&m_buffer[pos], bytes.data(), first);
+    memcpy(&m_buffer[0], bytes.data() + first, bytes.size() - first);
+
+    m_head.store(head + bytes.size(), memory_order_release);
+    return true;
+  }
+
+  void PopAll(string& out) {
+    uint64_t tail = m_tail.load(memory_order_relaxed);
+    uint64_t head = m_head.load(memory_order_acquire);
+    size_t len = head - tail;
+
+    size_t pos = tail % RING_SIZE;
+    size_t first = min(len, RING_SIZE - pos);
+    out.append(&m_buffer[pos], first);
+    out.append(&m_buffer[0], len - first);
+
+    m_tail.store(head, memory_order_release);
+  }
+
+  bool Empty() const {
+    return m_head.load(memory_order_acquire) ==
+           m_tail.load(memory_order_relaxed);
+  }
+
+  atomic<bool> m_closed{false};
+
+ private:
+  unique_ptr<char[]> m_buffer;
+  atomic<uint64_t> m_head{0};
+  atomic<uint64_t> m_tail{0};
+};
+
+struct AsyncLogWriter::Entry {
+  uint64_t m_timestamp;
+  const char* m_data;
+  size_t m_len;
+};
+
+const string AsyncLogWriter::BINARY_MAGIC("ZILLOG1\n");
+
+AsyncLogWriter::AsyncLogWriter(const string& prefix, bool binary,
+                               streampos maxFileSize)
+    : m_id(g_nextWriterId++),
+      m_prefix(prefix),
+      m_binary(binary),
+      m_maxFileSize(maxFileSize) {
+  OpenNextFile();
+  m_writerThread = thread(&AsyncLogWriter::WriterLoop, this);
+}
+
+AsyncLogWriter::~AsyncLogWriter() {
+  {
+    lock_guard<mutex> g(m_flushMutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+  m_writerThread.join();
+
+  if (m_file != nullptr) {
+    fclose(m_file);
+  }
+}
+
+void AsyncLogWriter::Write(const string& level, uint32_t tid,
+                           const char* function, const char* epoch,
+                           const char* message) {
+  Push(false, level, tid, function, epoch, message, strlen(message));
+}
+
+void AsyncLogWriter::WriteRaw(const string& level, const string& message) {
+  Push(true, level, 0, "", "", message.data(), message.size());
+}
+
+void AsyncLogWriter::Push(bool raw, const string& level, uint32_t tid,
+                          const char* function, const char* epoch,
+                          const char* message, size_t messageLen) {
+  // Reused per thread so steady-state logging does not allocate
+  static thread_local string bytes;
+
+  size_t levelLen = min(level.size(), MAX_LEVEL_LEN);
+  size_t functionLen = strnlen(function, MAX_FUNCTION_LEN);
+  size_t epochLen = strnlen(epoch, MAX_EPOCH_LEN);
+
+  uint64_t timestamp = chrono::duration_cast<chrono::microseconds>(
+                           chrono::system_clock::now().time_since_epoch())
+                           .count();
+
+  shared_ptr<Ring> ring = GetThreadRing();
+
+  // A record must fit in the ring, so long messages go out in pieces
+  size_t offset = 0;
+  do {
+    size_t pieceLen = messageLen - offset;
+    if (pieceLen > MAX_RECORD_MESSAGE_LEN) {
+      pieceLen = MAX_RECORD_MESSAGE_LEN;
+    }
+    uint8_t flags = (raw ? FLAG_RAW : 0) | (offset > 0 ? FLAG_CONTINUED : 0);
+
+    bytes.clear();
+    PutUint(bytes, timestamp, 8);
+    PutUint(bytes, tid, 4);
+    PutUint(bytes, flags, 1);
+    PutUint(bytes, levelLen, 1);
+    PutUint(bytes, functionLen, 1);
+    PutUint(bytes, epochLen, 2);
+    PutUint(bytes, pieceLen, 4);
+    bytes.append(level, 0, levelLen);
+    bytes.append(function, functionLen);
+    bytes.append(epoch, epochLen);
+    bytes.append(message + offset, pieceLen);
+
+    while (!ring->TryPush(bytes)) {
+      m_ringFullWaits++;
+      m_wake.notify_one();
+      this_thread::sleep_for(chrono::microseconds(100));
+    }
+
+    offset += pieceLen;
+  } while (offset < messageLen);
+}
+
+shared_ptr<AsyncLogWriter::Ring> AsyncLogWriter::GetThreadRing() {
+  struct Holder {
+    uint64_t m_writerId = 0;
+    shared_ptr<Ring> m_ring;
+
+    ~Holder() {
+      if (m_ring) {
+        m_ring->m_closed = true;
+      }
+    }
+  };
+  static thread_local Holder holder;
+
+  if (holder.m_writerId != m_id) {
+    if (holder.m_ring) {
+      holder.m_ring->m_closed = true;
+    }
+    holder.m_ring = make_shared<Ring>();
+    holder.m_writerId = m_id;
+
+    lock_guard<mutex> g(m_ringsMutex);
+    m_rings.emplace_back(holder.m_ring);
+  }
+
+  return holder.m_ring;
+}
+
+void AsyncLogWriter::Flush() {
+  unique_lock<mutex> lock(m_flushMutex);
+  uint64_t ticket = ++m_flushRequested;
+  m_wake.notify_all();
+  m_flushed.wait(lock, [this, ticket]() { return m_flushDone >= ticket; });
+}
+
+void AsyncLogWriter::WriterLoop() {
+  while (true) {
+    uint64_t ticket;
+    bool stop;
+    {
+      lock_guard<mutex> g(m_flushMutex);
+      ticket = m_flushRequested;
+      stop = m_stop;
+    }
+
+    size_t written = Drain();
+
+    {
+      lock_guard<mutex> g(m_flushMutex);
+      if (ticket > m_flushDone) {
+        m_flushDone = ticket;
+        m_flushed.notify_all();
+      }
+    }
+
+    if (stop) {
+      break;
+    }
+
+    if (written == 0) {
+      unique_lock<mutex> lock(m_flushMutex);
+      m_wake.wait_for(lock, chrono::milliseconds(IDLE_WAIT_IN_MS), [this]() {
+        return m_stop || m_flushRequested > m_flushDone;
+      });
+    }
+  }
+}
+
+size_t AsyncLogWriter::Drain() {
+  vector<shared_ptr<Ring>> rings;
+  {
+    lock_guard<mutex> g(m_ringsMutex);
+    rings = m_rings;
+  }
+
+  vector<string> chunks(rings.size());
+  vector<Entry> entries;
+
+  for (size_t i = 0; i < rings.size(); i++) {
+    rings[i]->PopAll(chunks[i]);
+
+    const char* pos = chunks[i].data();
+    size_t avail = chunks[i].size();
+    size_t len;
+    while ((len = GetRecordLen(pos, avail)) > 0) {
+      entries.push_back({GetUint(pos, 8), pos, len});
+      pos += len;
+      avail -= len;
+    }
+  }
+
+  {
+    // Rings of exited threads go once they have been emptied
+    lock_guard<mutex> g(m_ringsMutex);
+    m_rings.erase(remove_if(m_rings.begin(), m_rings.end(),
+                            [](const shared_ptr<Ring>& ring) {
+                              return ring->m_closed && ring->Empty();
+                            }),
+                  m_rings.end());
+  }
+
+  if (entries.empty()) {
+    return 0;
+  }
+
+  stable_sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) {
+                return a.m_timestamp < b.m_timestamp;
+              });
+
+  string out;
+  Record record;
+  for (const auto& entry : entries) {
+    if (m_binary) {
+      out.append(entry.m_data, entry.m_len);
+    } else {
+      DecodeRecord(entry.m_data, record);
+      FormatRecord(record, out);
+    }
+  }
+
+  lock_guard<mutex> g(m_fileMutex);
+  if (m_file != nullptr) {
+    fwrite(out.data(), 1, out.size(), m_file);
+    fflush(m_file);
+    m_fileSize += out.size();
+
+    if (m_fileSize >= static_cast<uint64_t>(m_maxFileSize)) {
+      OpenNextFile();
+    }
+  }
+
+  return entries.size();
+}
+
+bool AsyncLogWriter::OpenNextFile() {
+  if (m_file != nullptr) {
+    fclose(m_file);
+  }
+
+  m_seqNum++;
+
+  // Filename = m_prefix + 5-digit sequence number + "-log.txt" or "-log.bin"
+  char buf[16] = {0};
+  snprintf(buf, sizeof(buf), m_binary ? "-%05u-log.bin" : "-%05u-log.txt",
+           m_seqNum);
+  m_fileName = m_prefix + buf;
+
+  m_file = fopen(m_fileName.c_str(), "ab");
+  if (m_file == nullptr) {
+    cerr << "Failed to open log file " << m_fileName << endl;
+    return false;
+  }
+
+  m_fileSize = ftell(m_file);
+  if (m_binary && m_fileSize == 0) {
+    fwrite(BINARY_MAGIC.data(), 1, BINARY_MAGIC.size(), m_file);
+    m_fileSize = BINARY_MAGIC.size();
+  }
+
+  return true;
+}
+
+string AsyncLogWriter::GetFileName() const {
+  lock_guard<mutex> g(m_fileMutex);
+  return m_fileName;
+}
+
+void AsyncLogWriter::FormatRecord(const Record& record, string& out) {
+  out += '[';
+  out += record.m_level;
+  out.append(MAX_LEVEL_LEN - min(record.m_level.size(), MAX_LEVEL_LEN), ' ');
+  out += ']';
+
+  if (record.m_raw) {
+    if (record.m_continued) {
+      out += "(continued) ";
+    }
+    out += record.m_message;
+    if (record.m_message.empty() || record.m_message.back() != '\n') {
+      out += '\n';
+    }
+    return;
+  }
+
+  time_t seconds = record.m_timestamp / 1000000;
+  struct tm tm;
+  gmtime_r(&seconds, &tm);
+
+  char buf[96];
+  snprintf(buf, sizeof(buf), "[%5u][%02d:%02d:%02d:%3u][%-30.30s]",
+           record.m_tid, tm.tm_hour, tm.tm_min, tm.tm_sec,
+           static_cast<unsigned int>(record.m_timestamp / 1000 % 1000),
+           record.m_function.c_str());
+  out += buf;
+
+  if (!record.m_epoch.empty()) {
+    out += "[Epoch ";
+    out += record.m_epoch;
+    out += "] ";
+  } else {
+    out += ' ';
+  }
+
+  if (record.m_continued) {
+    out += "(continued) ";
+  }
+  out += record.m_message;
+  out += '\n';
+}
+
+bool AsyncLogWriter::DecodeBinary(istream& in, ostream& out) {
+  string magic(BINARY_MAGIC.size(), '\0');
+  if (!in.read(&magic[0], magic.size()) || magic != BINARY_MAGIC) {
+    return false;
+  }
+
+  string bytes(HEADER_SIZE, '\0');
+  string line;
+  Record record;
+
+  while (in.read(&bytes[0], HEADER_SIZE)) {
+    size_t bodyLen = GetUint(&bytes[13], 1) + GetUint(&bytes[14], 1) +
+                     GetUint(&bytes[15], 2) + GetUint(&bytes[17], 4);
+    bytes.resize(HEADER_SIZE + bodyLen);
+    if (!in.read(&bytes[HEADER_SIZE], bodyLen)) {
+      return false;
+    }
+
+    DecodeRecord(bytes.data(), record);
+    line.clear();
+    FormatRecord(record, line);
+    out << line;
+
+    bytes.resize(HEADER_SIZE);
+  }
+
+  // Stopping anywhere but on a record boundary means the file is truncated
+  return in.gcount() == 0;
+}
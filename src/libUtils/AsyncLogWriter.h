@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#ifndef __ASYNCLOGWRITER_H__
+#define __ASYNCLOGWRITER_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Asynchronous writer for the main log. Every logging thread appends records
+/// to its own lock-free ring buffer, and a single writer thread drains the
+/// rings in timestamp order and writes them to rolling files, either as text
+/// lines or in a compact binary format that DecodeBinary turns back into text.
+class AsyncLogWriter {
+ public:
+  /// One decoded log record.
+  struct Record {
+    uint64_t m_timestamp;  // microseconds since the epoch
+    uint32_t m_tid;
+    bool m_raw;  // message is written as is after the level
+    std::string m_level;
+    std::string m_function;
+    std::string m_epoch;
+    std::string m_message;
+    bool m_continued = false;  // rest of the message of the record before
+  };
+
+  /// Capacity in bytes of each thread's ring buffer.
+  static const size_t RING_SIZE = 128 * 1024;
+
+  /// Longest message one record holds. Longer messages are split over several
+  /// records, and each continuation is written as its own line marked
+  /// "(continued)".
+  static const size_t MAX_RECORD_MESSAGE_LEN = RING_SIZE / 2;
+
+  /// Bytes at the start of every binary log file.
+  static const std::string BINARY_MAGIC;
+
+  /// Constructor. Files are named prefix-NNNNN-log.txt, or .bin in binary
+  /// mode, and roll over once they reach maxFileSize bytes.
+  AsyncLogWriter(const std::string& prefix, bool binary,
+                 std::streampos maxFileSize);
+
+  /// Destructor. Writes out everything queued so far.
+  ~AsyncLogWriter();
+
+  /// Queues one log line from the calling thread. epoch may be empty.
+  void Write(const std::string& level, uint32_t tid, const char* function,
+             const char* epoch, const char* message);
+
+  /// Queues a line that was already formatted, written after the level only.
+  void WriteRaw(const std::string& level, const std::string& message);
+
+  /// Blocks until every record queued before the call has been written.
+  void Flush();
+
+  /// Returns the name of the file currently written to.
+  std::string GetFileName() const;
+
+  /// Returns how many times a logging thread waited on a full ring buffer.
+  uint64_t GetRingFullWaits() const { return m_ringFullWaits; }
+
+  /// Appends the text log line for the record, including the newline.
+  static void FormatRecord(const Record& record, std::string& out);
+
+  /// Decodes a binary log into text lines. Returns false on malformed input.
+  static bool DecodeBinary(std::istream& in, std::ostream& out);
+
+ private:
+  class Ring;
+  struct Entry;
+
+  AsyncLogWriter(const AsyncLogWriter&) = delete;
+  AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+  void Push(bool raw, const std::string& level, uint32_t tid,
+            const char* function, const char* epoch, const char* message,
+            size_t messageLen);
+  std::shared_ptr<Ring> GetThreadRing();
+  void WriterLoop();
+  size_t Drain();
+  bool OpenNextFile();
+
+  const uint64_t m_id;
+  const std::string m_prefix;
+  const bool m_binary;
+  const std::streampos m_maxFileSize;
+
+  std::mutex m_ringsMutex;
+  std::vector<std::shared_ptr<Ring>> m_rings;
+  std::atomic<uint64_t> m_ringFullWaits{0};
+
+  mutable std::mutex m_fileMutex;
+  FILE* m_file = nullptr;
+  std::string m_fileName;
+  unsigned int m_seqNum = 0;
+  uint64_t m_fileSize = 0;
+
+  std::mutex m_flushMutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_flushed;
+  uint64_t m_flushRequested = 0;
+  uint64_t m_flushDone = 0;
+  bool m_stop = false;
+
+  std::thread m_writerThread;
+};
+
+#endif  // __ASYNCLOGWRITER_H__
@@ -25,7 +25,8 @@
 #include "libUtils/Logger.h"
 
 /// Utility class for executing a function in one or more separate detached
-/// threads.
+/// threads. Node code uses it for service loops and tasks that block for
+/// rounds, and posts short tasks to Executor instead.
 class DetachedFunction {
  public:
   /// Retry limit for launching the detached threads.
@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include "Executor.h"
+#include "common/Constants.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace {
+uint64_t ElapsedUs(steady_clock::time_point from,
+                   steady_clock::time_point to) {
+  return to > from ? duration_cast<microseconds>(to - from).count() : 0;
+}
+}  // namespace
+
+// Bound to references (duration constructors), so they need a definition
+const unsigned int Executor::TICK_IN_MS;
+const unsigned int Executor::WHEEL_SLOTS;
+const unsigned int Executor::IDLE_TIMEOUT_IN_SECONDS;
+
+Executor::Executor(unsigned int maxThreads, unsigned int statsInterval)
+    : m_maxThreads(max(maxThreads, 1u)), m_wheel(WHEEL_SLOTS) {
+  m_timerThread = thread(&Executor::TimerLoop, this);
+
+  if (statsInterval > 0) {
+    ExecutePeriodically(seconds(statsInterval), [this]() { LogStats(); });
+  }
+}
+
+Executor::~Executor() {
+  {
+    lock_guard<mutex> g(m_timerMutex);
+    m_shutdown = true;
+  }
+  m_timerAdded.notify_all();
+  m_timerThread.join();
+
+  unique_lock<mutex> lock(m_mutex);
+  m_taskAvailable.notify_all();
+  m_workerExited.wait(lock, [this]() { return m_threads == 0; });
+}
+
+Executor& Executor::GetInstance() {
+  // Never destroyed, as service loops keep their pool threads until exit
+  static Executor* executor =
+      new Executor(EXECUTOR_MAX_THREADS, EXECUTOR_STATS_INTERVAL);
+  return *executor;
+}
+
+void Executor::Execute(const Task& task) {
+  lock_guard<mutex> g(m_mutex);
+
+  if (m_shutdown) {
+    LOG_GENERAL(WARNING, "Executor stopped, task dropped");
+    return;
+  }
+
+  m_queue.push_back({task, steady_clock::now()});
+  m_maxQueueDepth = max(m_maxQueueDepth, m_queue.size());
+
+  if (m_idleThreads > m_wakeups) {
+    m_wakeups++;
+    m_taskAvailable.notify_one();
+  } else if (m_threads < m_maxThreads) {
+    SpawnWorker();
+  }
+}
+
+void Executor::SpawnWorker() {
+  try {
+    thread(&Executor::WorkerLoop, this).detach();
+    m_threads++;
+  } catch (const system_error& e) {
+    LOG_GENERAL(WARNING, "Failed to start executor thread, "
+                             << m_threads << " running, queue depth "
+                             << m_queue.size() << ": " << e.what());
+  }
+}
+
+void Executor::WorkerLoop() {
+  unique_lock<mutex> lock(m_mutex);
+
+  while (true) {
+    while (m_queue.empty()) {
+      if (m_shutdown) {
+        m_threads--;
+        m_workerExited.notify_all();
+        return;
+      }
+
+      m_idleThreads++;
+      cv_status status =
+          m_taskAvailable.wait_for(lock, seconds(IDLE_TIMEOUT_IN_SECONDS));
+      m_idleThreads--;
+      if (m_wakeups > 0) {
+        m_wakeups--;
+      }
+
+      if (status == cv_status::timeout && m_queue.empty()) {
+        m_threads--;
+        m_workerExited.notify_all();
+        return;
+      }
+    }
+
+    QueuedTask job = move(m_queue.front());
+    m_queue.pop_front();
+
+    uint64_t latency = ElapsedUs(job.m_queued, steady_clock::now());
+    m_executed++;
+    m_totalQueueLatencyUs += latency;
+    m_maxQueueLatencyUs = max(m_maxQueueLatencyUs, latency);
+
+    lock.unlock();
+    try {
+      job.m_task();
+    } catch (const exception& e) {
+      LOG_GENERAL(WARNING, "Executor task threw: " << e.what());
+    }
+    lock.lock();
+  }
+}
+
+void Executor::ExecuteAfter(milliseconds delay, const Task& task) {
+  lock_guard<mutex> g(m_timerMutex);
+
+  if (m_shutdown) {
+    return;
+  }
+
+  steady_clock::time_point now = steady_clock::now();
+  steady_clock::time_point due = now + delay;
+
+  if (m_pendingTimers == 0) {
+    // The timer thread is idle, so restart the ticks from now
+    m_nextTick = now + milliseconds(TICK_IN_MS);
+  }
+
+  // Slot m_cursor + n is processed at m_nextTick + (n - 1) ticks, so round up
+  // to never fire early
+  uint64_t ticks = 1;
+  if (due > m_nextTick) {
+    const uint64_t tickUs = TICK_IN_MS * 1000;
+    ticks += (ElapsedUs(m_nextTick, due) + tickUs - 1) / tickUs;
+  }
+
+  size_t slot = (m_cursor + ticks) % WHEEL_SLOTS;
+  m_wheel[slot].push_back({(ticks - 1) / WHEEL_SLOTS, due, task});
+
+  m_pendingTimers++;
+  m_maxPendingTimers = max(m_maxPendingTimers, m_pendingTimers);
+  m_timerAdded.notify_one();
+}
+
+Executor::TimerId Executor::ExecutePeriodically(milliseconds period,
+                                                const Task& task) {
+  auto periodic = make_shared<Periodic>();
+  TimerId id = 0;
+
+  {
+    lock_guard<mutex> g(m_timerMutex);
+    id = ++m_nextTimerId;
+    m_periodic.emplace(id, periodic);
+  }
+
+  SchedulePeriodic(period, task, periodic);
+  return id;
+}
+
+void Executor::SchedulePeriodic(milliseconds period, const Task& task,
+                                const shared_ptr<Periodic>& periodic) {
+  ExecuteAfter(period, [this, period, task, periodic]() {
+    {
+      // Held while the task runs, so that Cancel() waits for it
+      lock_guard<mutex> g(periodic->m_mutex);
+      if (periodic->m_cancelled) {
+        return;
+      }
+      task();
+    }
+    SchedulePeriodic(period, task, periodic);
+  });
+}
+
+void Executor::Cancel(TimerId id) {
+  shared_ptr<Periodic> periodic;
+
+  {
+    lock_guard<mutex> g(m_timerMutex);
+    auto it = m_periodic.find(id);
+    if (it == m_periodic.end()) {
+      return;
+    }
+    periodic = move(it->second);
+    m_periodic.erase(it);
+  }
+
+  lock_guard<mutex> g(periodic->m_mutex);
+  periodic->m_cancelled = true;
+}
+
+void Executor::TimerLoop() {
+  unique_lock<mutex> lock(m_timerMutex);
+
+  while (!m_shutdown) {
+    if (m_pendingTimers == 0) {
+      // Nothing to fire, so sleep until a timer is added instead of ticking
+      m_timerAdded.wait(
+          lock, [this]() { return m_shutdown || m_pendingTimers > 0; });
+      continue;
+    }
+
+    if (m_timerAdded.wait_until(lock, m_nextTick,
+                                [this]() { return m_shutdown.load(); })) {
+      break;
+    }
+
+    vector<Task> due;
+    steady_clock::time_point now = steady_clock::now();
+
+    while (m_nextTick <= now) {
+      m_cursor = (m_cursor + 1) % WHEEL_SLOTS;
+      vector<Timer>& slot = m_wheel[m_cursor];
+
+      for (size_t i = 0; i < slot.size();) {
+        if (slot[i].m_rounds > 0) {
+          slot[i].m_rounds--;
+          i++;
+          continue;
+        }
+
+        uint64_t lateness = ElapsedUs(slot[i].m_due, now);
+        m_firedTimers++;
+        m_totalTimerLatenessUs += lateness;
+        m_maxTimerLatenessUs = max(m_maxTimerLatenessUs, lateness);
+
+        due.emplace_back(move(slot[i].m_task));
+        slot[i] = move(slot.back());
+        slot.pop_back();
+        m_pendingTimers--;
+      }
+
+      m_nextTick += milliseconds(TICK_IN_MS);
+    }
+
+    if (!due.empty()) {
+      lock.unlock();
+      for (const auto& task : due) {
+        Execute(task);
+      }
+      lock.lock();
+    }
+  }
+}
+
+Executor::Stats Executor::GetStats() const {
+  Stats stats{};
+
+  {
+    lock_guard<mutex> g(m_mutex);
+    stats.m_threads = m_threads;
+    stats.m_idleThreads = m_idleThreads;
+    stats.m_queueDepth = m_queue.size();
+    stats.m_maxQueueDepth = m_maxQueueDepth;
+    stats.m_executed = m_executed;
+    stats.m_avgQueueLatencyUs =
+        m_executed > 0 ? m_totalQueueLatencyUs / m_executed : 0;
+    stats.m_maxQueueLatencyUs = m_maxQueueLatencyUs;
+  }
+
+  {
+    lock_guard<mutex> g(m_timerMutex);
+    stats.m_pendingTimers = m_pendingTimers;
+    stats.m_maxPendingTimers = m_maxPendingTimers;
+    stats.m_firedTimers = m_firedTimers;
+    stats.m_avgTimerLatenessUs =
+        m_firedTimers > 0 ? m_totalTimerLatenessUs / m_firedTimers : 0;
+    stats.m_maxTimerLatenessUs = m_maxTimerLatenessUs;
+  }
+
+  return stats;
+}
+
+void Executor::LogStats() const {
+  Stats stats = GetStats();
+
+  LOG_GENERAL(INFO, "Threads=" << stats.m_threads << " (idle "
+                               << stats.m_idleThreads << ", max "
+                               << m_maxThreads << ")");
+  LOG_GENERAL(INFO, "Tasks: depth=" << stats.m_queueDepth << " max="
+                                    << stats.m_maxQueueDepth
+                                    << " run=" << stats.m_executed
+                                    << " latency avg/max(us)="
+                                    << stats.m_avgQueueLatencyUs << "/"
+                                    << stats.m_maxQueueLatencyUs);
+  LOG_GENERAL(INFO, "Timers: pending=" << stats.m_pendingTimers << " max="
+                                       << stats.m_maxPendingTimers
+                                       << " fired=" << stats.m_firedTimers
+                                       << " lateness avg/max(us)="
+                                       << stats.m_avgTimerLatenessUs << "/"
+                                       << stats.m_maxTimerLatenessUs);
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#ifndef __EXECUTOR_H__
+#define __EXECUTOR_H__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Shared executor for short background tasks and timers. Tasks run on a
+/// bounded set of reusable threads, delayed and periodic tasks wait on a
+/// hashed timer wheel, and both queues keep depth and latency statistics.
+/// Once every thread is busy, tasks and due timers wait in the queue, so
+/// service loops and tasks that block for rounds use DetachedFunction.
+class Executor {
+ public:
+  using Task = std::function<void()>;
+  /// Identifies a periodic task, for Cancel().
+  using TimerId = uint64_t;
+
+  /// Resolution of the timer wheel.
+  static const unsigned int TICK_IN_MS = 10;
+  /// Number of slots on the timer wheel (about 5 seconds per revolution).
+  static const unsigned int WHEEL_SLOTS = 512;
+  /// Seconds an idle pool thread waits for work before exiting.
+  static const unsigned int IDLE_TIMEOUT_IN_SECONDS = 60;
+
+  /// Snapshot of the task and timer queue statistics.
+  struct Stats {
+    size_t m_threads;
+    size_t m_idleThreads;
+    size_t m_queueDepth;
+    size_t m_maxQueueDepth;
+    uint64_t m_executed;
+    uint64_t m_avgQueueLatencyUs;
+    uint64_t m_maxQueueLatencyUs;
+    size_t m_pendingTimers;
+    size_t m_maxPendingTimers;
+    uint64_t m_firedTimers;
+    uint64_t m_avgTimerLatenessUs;
+    uint64_t m_maxTimerLatenessUs;
+  };
+
+  /// Constructor. Statistics are logged every statsInterval seconds unless 0.
+  Executor(unsigned int maxThreads, unsigned int statsInterval = 0);
+
+  /// Destructor. Drops pending timers and waits for queued tasks to finish.
+  ~Executor();
+
+  /// Returns the process-wide executor.
+  static Executor& GetInstance();
+
+  /// Runs the task on a pool thread, queueing it while all threads are busy.
+  void Execute(const Task& task);
+
+  /// Runs the task on a pool thread once the delay has elapsed.
+  void ExecuteAfter(std::chrono::milliseconds delay, const Task& task);
+
+  /// Runs the task every period, the next run being scheduled once the
+  /// current one returns.
+  TimerId ExecutePeriodically(std::chrono::milliseconds period,
+                              const Task& task);
+
+  /// Stops a periodic task. Once this returns the task is not running and
+  /// will not run again, so it may be called from the destructor of what the
+  /// task refers to, but not from the task itself.
+  void Cancel(TimerId id);
+
+  /// Returns the current queue statistics.
+  Stats GetStats() const;
+
+  /// Logs the current queue statistics.
+  void LogStats() const;
+
+ private:
+  struct QueuedTask {
+    Task m_task;
+    std::chrono::steady_clock::time_point m_queued;
+  };
+
+  struct Timer {
+    uint64_t m_rounds;
+    std::chrono::steady_clock::time_point m_due;
+    Task m_task;
+  };
+
+  struct Periodic {
+    std::mutex m_mutex;
+    bool m_cancelled = false;
+  };
+
+  Executor(const Executor&) = delete;
+  Executor& operator=(const Executor&) = delete;
+
+  void SpawnWorker();
+  void WorkerLoop();
+  void TimerLoop();
+  void SchedulePeriodic(std::chrono::milliseconds period, const Task& task,
+                        const std::shared_ptr<Periodic>& periodic);
+
+  const unsigned int m_maxThreads;
+  std::atomic<bool> m_shutdown{false};
+
+  // Task queue, guarded by m_mutex
+  mutable std::mutex m_mutex;
+  std::condition_variable m_taskAvailable;
+  std::condition_variable m_workerExited;
+  std::deque<QueuedTask> m_queue;
+  size_t m_threads = 0;
+  size_t m_idleThreads = 0;
+  size_t m_wakeups = 0;
+  size_t m_maxQueueDepth = 0;
+  uint64_t m_executed = 0;
+  uint64_t m_totalQueueLatencyUs = 0;
+  uint64_t m_maxQueueLatencyUs = 0;
+
+  // Timer wheel, guarded by m_timerMutex
+  mutable std::mutex m_timerMutex;
+  std::condition_variable m_timerAdded;
+  std::vector<std::vector<Timer>> m_wheel;
+  size_t m_cursor = 0;
+  std::chrono::steady_clock::time_point m_nextTick;
+  size_t m_pendingTimers = 0;
+  size_t m_maxPendingTimers = 0;
+  uint64_t m_firedTimers = 0;
+  uint64_t m_totalTimerLatenessUs = 0;
+  uint64_t m_maxTimerLatenessUs = 0;
+  std::map<TimerId, std::shared_ptr<Periodic>> m_periodic;
+  TimerId m_nextTimerId = 0;
+  std::thread m_timerThread;
+};
+
+#endif  // __EXECUTOR_H__
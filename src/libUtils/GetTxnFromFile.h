@@ -70,7 +70,8 @@ bool getTransactionsFromFile(std::fstream& f, unsigned int startNum,
     f.read((char*)&buffTxn[0], txnSize);
 
     Transaction txn;
-    if (!Messenger::GetTransaction(buffTxn, 0, txn)) {
+    if (!Messenger::GetTransaction(buffTxn, 0, txn,
+                                   Messenger::TrustLevel::TRUSTED_STORAGE)) {
       LOG_GENERAL(WARNING, "Messenger::GetTransaction failed.");
       return false;
     }
@@ -18,6 +18,7 @@
  */
 
 #include "Logger.h"
+#include "AsyncLogWriter.h"
 
 #include <pthread.h>
 #include <sys/syscall.h>
@@ -27,22 +28,12 @@
 using namespace std;
 using namespace g3;
 
-string MyCustomFormatting(const LogMessage& msg) {
-  string res = string("[") + msg.level();
-
-  for (unsigned int i = msg.level().size(); i < WARNING.text.size(); ++i) {
-    res += " ";
-  }
-
-  res += "]";
-  return res;
-}
-
 namespace {
 /// helper function to get tid with better cross-platform support
 inline pid_t getCurrentPid() {
 #if defined(__linux__)
-  return syscall(SYS_gettid);
+  static thread_local pid_t tid = syscall(SYS_gettid);
+  return tid;
 #elif defined(__APPLE__) && defined(__MACH__)
   uint64_t tid64;
   pthread_threadid_np(NULL, &tid64);
@@ -52,14 +43,31 @@ inline pid_t getCurrentPid() {
   return 0;
 #endif
 }
+
+/// g3log sink for the main log. Only fatal messages and crash reports still
+/// go through g3log, so each one is written out before g3log aborts.
+struct ForwardSink {
+  AsyncLogWriter* m_writer;
+
+  explicit ForwardSink(AsyncLogWriter* writer) : m_writer(writer) {}
+
+  void ReceiveLogMessage(LogMessageMover logEntry) {
+    m_writer->WriteRaw(logEntry.get().level(), logEntry.get().message());
+    m_writer->Flush();
+  }
+};
 };  // namespace
 
+atomic<int> Logger::s_minLevel{numeric_limits<int>::min()};
+
 const streampos Logger::MAX_FILE_SIZE =
     1024 * 1024 * 100;  // 100MB per log file
 
-Logger::Logger(const char* prefix, bool log_to_file, streampos max_file_size) {
+Logger::Logger(const char* prefix, bool log_to_file, streampos max_file_size,
+               bool binary) {
   this->m_logToFile = log_to_file;
   this->m_maxFileSize = max_file_size;
+  this->m_binary = binary;
 
   if (log_to_file) {
     m_fileNamePrefix = prefix ? prefix : "common";
@@ -71,10 +79,7 @@ Logger::Logger(const char* prefix, bool log_to_file, streampos max_file_size) {
 Logger::~Logger() { m_logFile.close(); }
 
 void Logger::checkLog() {
-  std::ifstream in(m_fileName.c_str(),
-                   std::ifstream::ate | std::ifstream::binary);
-
-  if (in.tellg() >= m_maxFileSize) {
+  if (m_logFile.tellp() >= m_maxFileSize) {
     m_logFile.close();
     newLog();
   }
@@ -84,41 +89,40 @@ void Logger::newLog() {
   m_seqNum++;
   m_bRefactor = (m_fileNamePrefix == "zilliqa");
 
-  // Filename = m_fileNamePrefix + 5-digit sequence number + "-log.txt"
-  char buf[16] = {0};
-  snprintf(buf, sizeof(buf), (m_bRefactor ? "-%05d-log" : "-%05d-log.txt"),
-           m_seqNum);
-  m_fileName = m_fileNamePrefix + buf;
-
   if (m_bRefactor) {
+    // The main log rolls over inside the async writer
+    m_asyncWriter = make_unique<AsyncLogWriter>(m_fileNamePrefix, m_binary,
+                                                m_maxFileSize);
+    m_fileName = m_asyncWriter->GetFileName();
     logworker = LogWorker::createLogWorker();
-    auto sinkHandle = logworker->addSink(
-        std::make_unique<FileSink>(m_fileName.c_str(), "./", ""),
-        &FileSink::fileWrite);
-    sinkHandle->call(&g3::FileSink::overrideLogDetails, &MyCustomFormatting)
-        .wait();
-    sinkHandle->call(&g3::FileSink::overrideLogHeader, "").wait();
+    logworker->addSink(make_unique<ForwardSink>(m_asyncWriter.get()),
+                       &ForwardSink::ReceiveLogMessage);
     initializeLogging(logworker.get());
-  } else {
-    m_logFile.open(m_fileName.c_str(), ios_base::app);
+    return;
   }
+
+  // Filename = m_fileNamePrefix + 5-digit sequence number + "-log.txt"
+  char buf[16] = {0};
+  snprintf(buf, sizeof(buf), "-%05d-log.txt", m_seqNum);
+  m_fileName = m_fileNamePrefix + buf;
+  m_logFile.open(m_fileName.c_str(), ios_base::app);
 }
 
 Logger& Logger::GetLogger(const char* fname_prefix, bool log_to_file,
-                          streampos max_file_size) {
-  static Logger logger(fname_prefix, log_to_file, max_file_size);
+                          streampos max_file_size, bool binary) {
+  static Logger logger(fname_prefix, log_to_file, max_file_size, binary);
   return logger;
 }
 
 Logger& Logger::GetStateLogger(const char* fname_prefix, bool log_to_file,
                                streampos max_file_size) {
-  static Logger logger(fname_prefix, log_to_file, max_file_size);
+  static Logger logger(fname_prefix, log_to_file, max_file_size, false);
   return logger;
 }
 
 Logger& Logger::GetEpochInfoLogger(const char* fname_prefix, bool log_to_file,
                                    streampos max_file_size) {
-  static Logger logger(fname_prefix, log_to_file, max_file_size);
+  static Logger logger(fname_prefix, log_to_file, max_file_size, false);
   return logger;
 }
 
@@ -133,14 +137,30 @@ void Logger::LogState(const char* msg, const char*) {
   }
 }
 
+void Logger::logFatal(const char* msg, const char* epoch,
+                      const char* function) {
+  // g3log still handles fatal messages so that the node aborts after them
+  m_asyncWriter->Flush();
+
+  auto cur = chrono::system_clock::now();
+  auto cur_time_t = chrono::system_clock::to_time_t(cur);
+  struct tm cur_tm;
+  gmtime_r(&cur_time_t, &cur_tm);
+  LOG(FATAL) << "[" << PAD(GetPid(), TID_LEN) << "]["
+             << put_time(&cur_tm, "%H:%M:%S:") << PAD(get_ms(cur), 3) << "]["
+             << LIMIT(function, MAX_FUNCNAME_LEN) << "]"
+             << (epoch != nullptr ? "[Epoch " : "")
+             << (epoch != nullptr ? epoch : "")
+             << (epoch != nullptr ? "] " : " ") << msg;
+}
+
 void Logger::LogGeneral(LEVELS level, const char* msg, const char* function) {
-  if (IsG3Log()) {
-    auto cur = chrono::system_clock::now();
-    auto cur_time_t = chrono::system_clock::to_time_t(cur);
-    LOG(level) << "[" << PAD(GetPid(), TID_LEN) << "]["
-               << put_time(gmtime(&cur_time_t), "%H:%M:%S:")
-               << PAD(get_ms(cur), 3) << "]["
-               << LIMIT(function, MAX_FUNCNAME_LEN) << "] " << msg;
+  if (m_asyncWriter) {
+    if (level.value >= FATAL.value) {
+      logFatal(msg, nullptr, function);
+    } else if (logLevel(level)) {
+      m_asyncWriter->Write(level.text, GetPid(), function, "", msg);
+    }
     return;
   }
 
@@ -165,8 +185,17 @@ void Logger::LogGeneral(LEVELS level, const char* msg, const char* function) {
   }
 }
 
-void Logger::LogEpoch([[gnu::unused]] LEVELS level, const char* msg,
-                      const char* epoch, const char* function) {
+void Logger::LogEpoch(LEVELS level, const char* msg, const char* epoch,
+                      const char* function) {
+  if (m_asyncWriter) {
+    if (level.value >= FATAL.value) {
+      logFatal(msg, epoch, function);
+    } else if (logLevel(level)) {
+      m_asyncWriter->Write(level.text, GetPid(), function, epoch, msg);
+    }
+    return;
+  }
+
   lock_guard<mutex> guard(m);
 
   if (m_logToFile) {
@@ -190,11 +219,29 @@ void Logger::LogEpoch([[gnu::unused]] LEVELS level, const char* msg,
   }
 }
 
-void Logger::LogPayload([[gnu::unused]] LEVELS level, const char* msg,
+void Logger::LogPayload(LEVELS level, const char* msg,
                         const std::vector<unsigned char>& payload,
                         size_t max_bytes_to_display, const char* function) {
+  if (m_asyncWriter && level.value < FATAL.value && !logLevel(level)) {
+    return;
+  }
+
   std::unique_ptr<char[]> payload_string;
   GetPayloadS(payload, max_bytes_to_display, payload_string);
+
+  if (m_asyncWriter) {
+    std::ostringstream oss;
+    oss << msg << " (Len=" << payload.size() << "): " << payload_string.get()
+        << (payload.size() > max_bytes_to_display ? "..." : "");
+    if (level.value >= FATAL.value) {
+      logFatal(oss.str().c_str(), nullptr, function);
+    } else {
+      m_asyncWriter->Write(level.text, GetPid(), function, "",
+                           oss.str().c_str());
+    }
+    return;
+  }
+
   lock_guard<mutex> guard(m);
 
   if (m_logToFile) {
@@ -271,12 +318,26 @@ void Logger::DisplayLevelAbove(LEVELS level) {
   if (level != INFO && level != WARNING && level != FATAL) return;
 
   g3::log_levels::setHighest(level);
+  s_minLevel = level.value;
 }
 
-void Logger::EnableLevel(LEVELS level) { g3::log_levels::enable(level); }
+void Logger::EnableLevel(LEVELS level) {
+  g3::log_levels::enable(level);
+
+  int minLevel = s_minLevel;
+  while (level.value < minLevel &&
+         !s_minLevel.compare_exchange_weak(minLevel, level.value)) {
+  }
+}
 
 void Logger::DisableLevel(LEVELS level) { g3::log_levels::disable(level); }
 
+void Logger::Flush() {
+  if (m_asyncWriter) {
+    m_asyncWriter->Flush();
+  }
+}
+
 pid_t Logger::GetPid() { return getCurrentPid(); }
 
 void Logger::GetPayloadS(const std::vector<unsigned char>& payload,
@@ -303,12 +364,15 @@ void Logger::GetPayloadS(const std::vector<unsigned char>& payload,
   res.get()[payload_string_len - 1] = '\0';
 }
 
-ScopeMarker::ScopeMarker(const char* function) : m_function(function) {
-  Logger& logger = Logger::GetLogger(NULL, true);
-  logger.LogGeneral(INFO, "BEGIN", this->m_function.c_str());
+ScopeMarker::ScopeMarker(const char* function)
+    : m_function(function), m_enabled(Logger::IsEnabled(INFO)) {
+  if (m_enabled) {
+    Logger::GetLogger(NULL, true).LogGeneral(INFO, "BEGIN", m_function);
+  }
 }
 
 ScopeMarker::~ScopeMarker() {
-  Logger& logger = Logger::GetLogger(NULL, true);
-  logger.LogGeneral(INFO, "END", m_function.c_str());
+  if (m_enabled) {
+    Logger::GetLogger(NULL, true).LogGeneral(INFO, "END", m_function);
+  }
 }
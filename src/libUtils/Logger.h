@@ -24,9 +24,12 @@
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 #include <boost/multiprecision/cpp_int.hpp>
 #pragma GCC diagnostic pop
+#include <atomic>
 #include <chrono>
 #include <fstream>
 #include <iomanip>
+#include <limits>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
@@ -41,19 +44,28 @@
                  << std::string(s).substr(0, len)
 #define PAD(n, len) std::setw(len) << std::setfill(' ') << std::right << n
 
+class AsyncLogWriter;
+
 /// Utility logging class for outputting messages to stdout or file.
 class Logger {
  private:
   std::mutex m;
   bool m_logToFile;
   std::streampos m_maxFileSize;
+  bool m_binary;
+  std::unique_ptr<AsyncLogWriter> m_asyncWriter;
   std::unique_ptr<g3::LogWorker> logworker;
 
-  Logger(const char* prefix, bool log_to_file, std::streampos max_file_size);
+  /// Lowest level value that may be logged, checked before any formatting.
+  static std::atomic<int> s_minLevel;
+
+  Logger(const char* prefix, bool log_to_file, std::streampos max_file_size,
+         bool binary);
   ~Logger();
 
   void checkLog();
   void newLog();
+  void logFatal(const char* msg, const char* epoch, const char* function);
 
   std::string m_fileNamePrefix;
   std::string m_fileName;
@@ -77,9 +89,11 @@ class Logger {
   /// Limits the output file size before rolling over to new output file.
   static const std::streampos MAX_FILE_SIZE;
 
-  /// Returns the singleton instance for the main Logger.
+  /// Returns the singleton instance for the main Logger. The main log file
+  /// ("zilliqa" prefix) is written asynchronously, as text or binary.
   static Logger& GetLogger(const char* fname_prefix, bool log_to_file,
-                           std::streampos max_file_size = MAX_FILE_SIZE);
+                           std::streampos max_file_size = MAX_FILE_SIZE,
+                           bool binary = false);
 
   /// Returns the singleton instance for the state/reporting Logger.
   static Logger& GetStateLogger(const char* fname_prefix, bool log_to_file,
@@ -125,8 +139,14 @@ class Logger {
   /// Disable the log level
   void DisableLevel(LEVELS level);
 
-  /// See if we need to use g3log or not
-  bool IsG3Log() { return (m_logToFile && m_bRefactor); };
+  /// Returns false if messages of this level are filtered out, so the log
+  /// macros can skip building them.
+  static bool IsEnabled(const LEVELS& level) {
+    return level.value >= s_minLevel.load(std::memory_order_relaxed);
+  }
+
+  /// Blocks until the messages logged so far have been written out.
+  void Flush();
 
   /// Get current process id
   static pid_t GetPid();
@@ -139,7 +159,8 @@ class Logger {
 
 /// Utility class for automatically logging function or code block exit.
 class ScopeMarker {
-  std::string m_function;
+  const char* m_function;
+  bool m_enabled;
 
  public:
   /// Constructor.
@@ -150,6 +171,8 @@ class ScopeMarker {
 };
 
 #define INIT_FILE_LOGGER(fname_prefix) Logger::GetLogger(fname_prefix, true)
+#define INIT_BINARY_FILE_LOGGER(fname_prefix) \
+  Logger::GetLogger(fname_prefix, true, Logger::MAX_FILE_SIZE, true)
 #define INIT_STDOUT_LOGGER() Logger::GetLogger(NULL, false)
 #define INIT_STATE_LOGGER(fname_prefix) \
   Logger::GetStateLogger(fname_prefix, true)
@@ -166,69 +189,33 @@ class ScopeMarker {
     Logger::GetStateLogger(NULL, true)                             \
         .LogState(oss.str().c_str(), __FUNCTION__);                \
   }
-#define LOG_GENERAL(level, msg)                                           \
-  {                                                                       \
-    if (Logger::GetLogger(NULL, true).IsG3Log()) {                        \
-      auto cur = std::chrono::system_clock::now();                        \
-      auto cur_time_t = std::chrono::system_clock::to_time_t(cur);        \
-      LOG(level) << "[" << PAD(Logger::GetPid(), Logger::TID_LEN) << "][" \
-                 << std::put_time(gmtime(&cur_time_t), "%H:%M:%S:")       \
-                 << PAD(get_ms(cur), 3) << "]["                           \
-                 << LIMIT(__FUNCTION__, Logger::MAX_FUNCNAME_LEN) << "] " \
-                 << msg;                                                  \
-    } else {                                                              \
-      std::ostringstream oss;                                             \
-      oss << msg;                                                         \
-      Logger::GetLogger(NULL, true)                                       \
-          .LogGeneral(level, oss.str().c_str(), __FUNCTION__);            \
-    }                                                                     \
+#define LOG_GENERAL(level, msg)                                \
+  {                                                            \
+    if (Logger::IsEnabled(level)) {                            \
+      std::ostringstream oss;                                  \
+      oss << msg;                                              \
+      Logger::GetLogger(NULL, true)                            \
+          .LogGeneral(level, oss.str().c_str(), __FUNCTION__); \
+    }                                                          \
   }
-#define LOG_EPOCH(level, epoch, msg)                                      \
-  {                                                                       \
-    if (Logger::GetLogger(NULL, true).IsG3Log()) {                        \
-      auto cur = std::chrono::system_clock::now();                        \
-      auto cur_time_t = std::chrono::system_clock::to_time_t(cur);        \
-      LOG(level) << "[" << PAD(Logger::GetPid(), Logger::TID_LEN) << "][" \
-                 << std::put_time(gmtime(&cur_time_t), "%H:%M:%S:")       \
-                 << PAD(get_ms(cur), 3) << "]["                           \
-                 << LIMIT(__FUNCTION__, Logger::MAX_FUNCNAME_LEN) << "]"  \
-                 << "[Epoch " << epoch << "] " << msg;                    \
-    } else {                                                              \
-      std::ostringstream oss;                                             \
-      oss << msg;                                                         \
-      Logger::GetLogger(NULL, true)                                       \
-          .LogEpoch(level, epoch, oss.str().c_str(), __FUNCTION__);       \
-    }                                                                     \
+#define LOG_EPOCH(level, epoch, msg)                                     \
+  {                                                                      \
+    if (Logger::IsEnabled(level)) {                                      \
+      std::ostringstream oss;                                            \
+      oss << msg;                                                        \
+      Logger::GetLogger(NULL, true)                                      \
+          .LogEpoch(level, oss.str().c_str(), epoch, __FUNCTION__);      \
+    }                                                                    \
   }
-#define LOG_PAYLOAD(level, msg, payload, max_bytes_to_display)                 \
-  {                                                                            \
-    if (Logger::GetLogger(NULL, true).IsG3Log()) {                             \
-      std::unique_ptr<char[]> payload_string;                                  \
-      Logger::GetPayloadS(payload, max_bytes_to_display, payload_string);      \
-      auto cur = std::chrono::system_clock::now();                             \
-      auto cur_time_t = std::chrono::system_clock::to_time_t(cur);             \
-      if ((payload).size() > max_bytes_to_display) {                           \
-        LOG(level) << "[" << PAD(Logger::GetPid(), Logger::TID_LEN) << "]["    \
-                   << std::put_time(gmtime(&cur_time_t), "%H:%M:%S:")          \
-                   << PAD(get_ms(cur), 3) << "]["                              \
-                   << LIMIT(__FUNCTION__, Logger::MAX_FUNCNAME_LEN) << "] "    \
-                   << msg << " (Len=" << (payload).size()                      \
-                   << "): " << payload_string.get() << "...";                  \
-      } else {                                                                 \
-        LOG(level) << "[" << PAD(Logger::GetPid(), Logger::TID_LEN) << "]["    \
-                   << std::put_time(gmtime(&cur_time_t), "%H:%M:%S:")          \
-                   << PAD(get_ms(cur), 3) << "]["                              \
-                   << LIMIT(__FUNCTION__, Logger::MAX_FUNCNAME_LEN) << "] "    \
-                   << msg << " (Len=" << (payload).size()                      \
-                   << "): " << payload_string.get();                           \
-      }                                                                        \
-    } else {                                                                   \
-      std::ostringstream oss;                                                  \
-      oss << msg;                                                              \
-      Logger::GetLogger(NULL, true)                                            \
-          .LogPayload(level, oss.str().c_str(), payload, max_bytes_to_display, \
-                      __FUNCTION__);                                           \
-    }                                                                          \
+#define LOG_PAYLOAD(level, msg, payload, max_bytes_to_display)               \
+  {                                                                          \
+    if (Logger::IsEnabled(level)) {                                          \
+      std::ostringstream oss;                                                \
+      oss << msg;                                                            \
+      Logger::GetLogger(NULL, true)                                          \
+          .LogPayload(level, oss.str().c_str(), payload,                     \
+                      max_bytes_to_display, __FUNCTION__);                   \
+    }                                                                        \
   }
 #define LOG_DISPLAY_LEVEL_ABOVE(level) \
   { Logger::GetLogger(NULL, true).DisplayLevelAbove(level); }
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include "MerkleTree.h"
+
+#include <cstring>
+#include <thread>
+#include "libCrypto/Sha2.h"
+#include "libUtils/ThreadPool.h"
+
+using namespace std;
+using namespace dev;
+
+namespace {
+const unsigned char NODE_PREFIX = 0x01;
+
+// Hashes nodes[2i], nodes[2i + 1] into parents[i] for i in [begin, end)
+void HashLevel(const vector<h256>& nodes, vector<h256>& parents, size_t begin,
+               size_t end) {
+  for (size_t i = begin; i < end; i++) {
+    size_t left = 2 * i;
+    parents[i] = (left + 1 < nodes.size())
+                     ? MerkleTree::HashPair(nodes[left], nodes[left + 1])
+                     : nodes[left];
+  }
+}
+}  // namespace
+
+MerkleTree::MerkleTree(const vector<h256>& leaves) {
+  if (leaves.empty()) {
+    return;
+  }
+
+  m_levels.emplace_back(leaves);
+
+  while (m_levels.back().size() > 1) {
+    const vector<h256>& nodes = m_levels.back();
+    vector<h256> parents((nodes.size() + 1) / 2);
+
+    if (parents.size() < PARALLEL_THRESHOLD) {
+      HashLevel(nodes, parents, 0, parents.size());
+    } else {
+      static ThreadPool pool(max(thread::hardware_concurrency(), 1u),
+                             "MerklePool");
+
+      // Hand out chunks rather than single pairs to keep scheduling cheap
+      const size_t CHUNK = 256;
+      pool.ParallelFor(0, (parents.size() + CHUNK - 1) / CHUNK,
+                       [&](size_t chunk) {
+                         HashLevel(nodes, parents, chunk * CHUNK,
+                                   min(parents.size(), (chunk + 1) * CHUNK));
+                       });
+    }
+
+    m_levels.emplace_back(move(parents));
+  }
+}
+
+void MerkleTree::Append(const h256& leaf) {
+  if (m_levels.empty()) {
+    m_levels.emplace_back();
+  }
+
+  m_levels[0].emplace_back(leaf);
+  UpdatePath(m_levels[0].size() - 1);
+}
+
+bool MerkleTree::Update(size_t index, const h256& leaf) {
+  if (index >= GetLeafCount()) {
+    return false;
+  }
+
+  m_levels[0][index] = leaf;
+  UpdatePath(index);
+  return true;
+}
+
+void MerkleTree::UpdatePath(size_t index) {
+  for (size_t level = 0; m_levels[level].size() > 1; level++) {
+    const vector<h256>& nodes = m_levels[level];
+    size_t parent = index / 2;
+    size_t left = 2 * parent;
+    h256 value = (left + 1 < nodes.size())
+                     ? HashPair(nodes[left], nodes[left + 1])
+                     : nodes[left];
+
+    if (level + 1 == m_levels.size()) {
+      m_levels.emplace_back();
+    }
+
+    vector<h256>& parents = m_levels[level + 1];
+    if (parent == parents.size()) {
+      parents.emplace_back(value);
+    } else {
+      parents[parent] = value;
+    }
+
+    index = parent;
+  }
+}
+
+size_t MerkleTree::GetLeafCount() const {
+  return m_levels.empty() ? 0 : m_levels[0].size();
+}
+
+h256 MerkleTree::GetRoot() const {
+  return GetLeafCount() == 0 ? h256() : m_levels.back()[0];
+}
+
+bool MerkleTree::GetProof(size_t index, vector<h256>& proof) const {
+  if (index >= GetLeafCount()) {
+    return false;
+  }
+
+  proof.clear();
+  for (size_t level = 0; m_levels[level].size() > 1; level++) {
+    size_t sibling = index ^ 1;
+    if (sibling < m_levels[level].size()) {
+      proof.emplace_back(m_levels[level][sibling]);
+    }
+    index /= 2;
+  }
+
+  return true;
+}
+
+bool MerkleTree::VerifyProof(const h256& leaf, size_t index, size_t count,
+                             const vector<h256>& proof, const h256& root) {
+  if (index >= count) {
+    return false;
+  }
+
+  h256 hash = leaf;
+  size_t used = 0;
+
+  for (size_t size = count; size > 1; size = (size + 1) / 2) {
+    if ((index ^ 1) < size) {
+      if (used == proof.size()) {
+        return false;
+      }
+      hash = (index & 1) ? HashPair(proof[used], hash)
+                         : HashPair(hash, proof[used]);
+      used++;
+    }
+    index /= 2;
+  }
+
+  return used == proof.size() && hash == root;
+}
+
+h256 MerkleTree::HashPair(const h256& left, const h256& right) {
+  unsigned char input[1 + 2 * h256::size];
+  input[0] = NODE_PREFIX;
+  memcpy(&input[1], left.data(), h256::size);
+  memcpy(&input[1 + h256::size], right.data(), h256::size);
+
+  h256 parent;
+  SHA2<HASH_TYPE::HASH_VARIANT_256>::Hash(input, sizeof(input), parent);
+  return parent;
+}
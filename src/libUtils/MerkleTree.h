@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#ifndef __MERKLETREE_H__
+#define __MERKLETREE_H__
+
+#include <vector>
+
+#include "depends/common/FixedHash.h"
+
+/// Binary Merkle tree over transaction hashes. A parent is
+/// SHA256(0x01 || left || right), and an unpaired last node moves up a level
+/// unchanged. Leaves can be appended or replaced in O(log n), and any leaf
+/// has an O(log n) inclusion proof against the root.
+class MerkleTree {
+ public:
+  /// Levels with at least this many nodes are hashed on several threads.
+  static const size_t PARALLEL_THRESHOLD = 2048;
+
+  /// Constructor for an empty tree.
+  MerkleTree() = default;
+
+  /// Constructor. Builds every level from the leaves.
+  explicit MerkleTree(const std::vector<dev::h256>& leaves);
+
+  /// Adds a leaf after the last one.
+  void Append(const dev::h256& leaf);
+
+  /// Replaces the leaf at index. Returns false if there is no such leaf.
+  bool Update(size_t index, const dev::h256& leaf);
+
+  /// Returns the number of leaves.
+  size_t GetLeafCount() const;
+
+  /// Returns the root, or a zero hash for an empty tree.
+  dev::h256 GetRoot() const;
+
+  /// Fills proof with the siblings on the path from the leaf at index to the
+  /// root, bottom up. Returns false if there is no such leaf.
+  bool GetProof(size_t index, std::vector<dev::h256>& proof) const;
+
+  /// Returns true if proof links the leaf at index, out of count leaves, to
+  /// root.
+  static bool VerifyProof(const dev::h256& leaf, size_t index, size_t count,
+                          const std::vector<dev::h256>& proof,
+                          const dev::h256& root);
+
+  /// Returns the parent of two nodes.
+  static dev::h256 HashPair(const dev::h256& left, const dev::h256& right);
+
+ private:
+  void UpdatePath(size_t index);
+
+  // m_levels[0] holds the leaves and m_levels.back() the root
+  std::vector<std::vector<dev::h256>> m_levels;
+};
+
+#endif  // __MERKLETREE_H__
@@ -18,7 +18,7 @@
  */
 
 #include "RootComputation.h"
-#include "libCrypto/Sha2.h"
+#include "MerkleTree.h"
 
 using namespace std;
 using namespace dev;
@@ -43,47 +43,43 @@ inline const TxnHash& GetHash(const TransactionWithReceipt& item) {
 }
 };  // namespace
 
+// Root of the binary Merkle tree over the hashes of every container in turn
 template <typename... Container>
-TxnHash ConcatTranAndHash(const Container&... conts) {
-  LOG_MARKER();
-
-  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
-  bool hasValue = false;
+TxnHash MerkleRootOf(const Container&... conts) {
+  size_t count = 0;
+  (void)std::initializer_list<int>{(count += conts.size(), 0)...};
 
-  (void)std::initializer_list<int>{(
-      [](const auto& list, decltype(sha2)& sha2, bool& hasValue) {
-        if (list.empty()) {
-          return;
-        }
-        hasValue = true;
+  vector<h256> leaves;
+  leaves.reserve(count);
 
-        for (auto& item : list) {
-          sha2.Update(GetHash(item).asBytes());
-        }
-      }(conts, sha2, hasValue),
-      0)...};
+  (void)std::initializer_list<int>{([&leaves](const auto& list) {
+                                      for (auto& item : list) {
+                                        leaves.emplace_back(GetHash(item));
+                                      }
+                                    }(conts),
+                                    0)...};
 
-  return hasValue ? TxnHash{sha2.Finalize()} : TxnHash();
+  return TxnHash{MerkleTree(leaves).GetRoot()};
 }
 
 h256 ComputeRoot(const vector<h256>& hashes) {
   LOG_MARKER();
 
-  return ConcatTranAndHash(hashes);
+  return MerkleRootOf(hashes);
 }
 
 TxnHash ComputeRoot(const list<Transaction>& receivedTransactions,
                     const list<Transaction>& submittedTransactions) {
   LOG_MARKER();
 
-  return ConcatTranAndHash(receivedTransactions, submittedTransactions);
+  return MerkleRootOf(receivedTransactions, submittedTransactions);
 }
 
 TxnHash ComputeRoot(
     const unordered_map<TxnHash, Transaction>& processedTransactions) {
   LOG_MARKER();
 
-  return ConcatTranAndHash(processedTransactions);
+  return MerkleRootOf(processedTransactions);
 }
 
 TxnHash ComputeRoot(
@@ -91,11 +87,11 @@ TxnHash ComputeRoot(
     const unordered_map<TxnHash, Transaction>& submittedTransactions) {
   LOG_MARKER();
 
-  return ConcatTranAndHash(receivedTransactions, submittedTransactions);
+  return MerkleRootOf(receivedTransactions, submittedTransactions);
 }
 
 TxnHash ComputeRoot(const vector<TransactionWithReceipt>& transactions) {
   LOG_MARKER();
 
-  return ConcatTranAndHash(transactions);
+  return MerkleRootOf(transactions);
 }
\ No newline at end of file
@@ -20,81 +20,229 @@
 #ifndef CONCURRENT_THREADPOOL_H
 #define CONCURRENT_THREADPOOL_H
 
+#include <algorithm>
+#include <atomic>
 #include <condition_variable>
-#include <functional>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <thread>
-
-/**
- *  Set to 1 to use vector instead of queue for jobs container to improve
- *  memory locality however changes job order from FIFO to LIFO.
- */
-#define CONTIGUOUS_JOBS_MEMORY 0
-#if CONTIGUOUS_JOBS_MEMORY
+#include <type_traits>
+#include <utility>
 #include <vector>
-#else
-#include <queue>
-#endif
+
+#include "libUtils/Logger.h"
 
 /**
- * Simple thread pool that creates `threadCount` threads upon its creation, and
- * pulls from a queue to get new jobs. This class requires a number of C++11
- * features be present in your compiler.
+ * Thread pool that creates `threadCount` threads upon its creation. Every
+ * thread owns a queue per priority; jobs added from outside the pool are
+ * spread over the threads round-robin, jobs added from inside a job go to the
+ * queue of the running thread. A thread that runs out of work steals from the
+ * others, and higher priority jobs anywhere in the pool run before lower
+ * priority ones.
  */
 class ThreadPool {
  public:
-  typedef std::function<void()> Job;
+  /// Job priority lanes, highest first.
+  enum Priority : unsigned int { HIGH = 0, NORMAL, NUM_PRIORITIES };
+
+  /// Move-only callable. Small callables are stored inline without a heap
+  /// allocation.
+  class Job {
+   public:
+    Job() : _impl(nullptr) {}
+
+    template <typename F, typename = typename std::enable_if<!std::is_same<
+                              typename std::decay<F>::type, Job>::value>::type>
+    Job(F&& func) : _impl(nullptr) {
+      using Impl = Callable<typename std::decay<F>::type>;
+      if (sizeof(Impl) <= sizeof(_buffer) &&
+          alignof(Impl) <= alignof(decltype(_buffer)) &&
+          std::is_nothrow_move_constructible<Impl>::value) {
+        _impl = new (&_buffer) Impl(std::forward<F>(func));
+      } else {
+        _impl = new Impl(std::forward<F>(func));
+      }
+    }
+
+    Job(Job&& other) noexcept : _impl(nullptr) { *this = std::move(other); }
+
+    Job& operator=(Job&& other) noexcept {
+      if (this != &other) {
+        Reset();
+        if (other.IsInline()) {
+          _impl = other._impl->MoveTo(&_buffer);
+          other.Reset();
+        } else {
+          _impl = other._impl;
+          other._impl = nullptr;
+        }
+      }
+      return *this;
+    }
+
+    Job(const Job&) = delete;
+    Job& operator=(const Job&) = delete;
+
+    ~Job() { Reset(); }
+
+    explicit operator bool() const { return _impl != nullptr; }
+
+    void operator()() { _impl->Run(); }
+
+   private:
+    struct Base {
+      virtual ~Base() {}
+      virtual void Run() = 0;
+      virtual Base* MoveTo(void* buffer) noexcept = 0;
+    };
+
+    template <typename F>
+    struct Callable : Base {
+      template <typename G>
+      explicit Callable(G&& func) : _func(std::forward<G>(func)) {}
+      void Run() override { _func(); }
+      Base* MoveTo(void* buffer) noexcept override {
+        return new (buffer) Callable(std::move(_func));
+      }
+      F _func;
+    };
+
+    bool IsInline() const {
+      return _impl == reinterpret_cast<const Base*>(&_buffer);
+    }
+
+    void Reset() {
+      if (IsInline()) {
+        _impl->~Base();
+      } else {
+        delete _impl;
+      }
+      _impl = nullptr;
+    }
+
+    std::aligned_storage<6 * sizeof(void*), alignof(std::max_align_t)>::type
+        _buffer;
+    Base* _impl;
+  };
 
   /// Constructor.
-#if CONTIGUOUS_JOBS_MEMORY
-  explicit ThreadPool(const unsigned int threadCount,
-                      const std::string& poolName,
-                      const unsigned int jobsReserveCount = 0)
-#else
   explicit ThreadPool(const unsigned int threadCount,
                       const std::string& poolName)
-#endif
-      : _jobsLeft(0),
+      : _workers(std::max(threadCount, 1u)),
+        _queued(0),
+        _jobsLeft(0),
+        _searching(0),
+        _sleeping(0),
+        _nextWorker(0),
         _bailout(false),
-        _poolName(poolName),
-        _jobAvailableVar(),
-        _waitVar(),
-        _jobsLeftMutex(),
-        _queueMutex() {
-    _threads.reserve(threadCount);
-    for (unsigned int index = 0; index < threadCount; ++index) {
-      _threads.push_back(std::thread([this] { this->Task(); }));
+        _poolName(poolName) {
+    for (auto& queued : _queuedPerLane) {
+      queued = 0;
     }
 
-#if CONTIGUOUS_JOBS_MEMORY
-    if (jobsReserveCount > 0) {
-      _queue.reserve(jobsReserveCount);
+    _threads.reserve(_workers.size());
+    for (unsigned int index = 0; index < _workers.size(); ++index) {
+      _threads.push_back(std::thread([this, index] { this->Task(index); }));
     }
-#endif
   }
 
   /// Destructor (JoinAll on deconstruction).
   ~ThreadPool() { JoinAll(); }
 
-  /// Adds a new job to the pool. If there are no jobs in the queue, a thread is
-  /// woken up to take the job. If all threads are busy, the job is added to the
-  /// end of the queue.
-  void AddJob(const Job& job) {
-    std::lock(_queueMutex, _jobsLeftMutex);
-    std::lock_guard<std::mutex> lg1(_queueMutex, std::adopt_lock);
-    std::lock_guard<std::mutex> lg2(_jobsLeftMutex, std::adopt_lock);
-
-#if CONTIGUOUS_JOBS_MEMORY
-    _queue.push_back(job);
-#else
-    _queue.push(job);
-#endif
+  /// Adds a new job to the pool and wakes up a sleeping thread, if any, to
+  /// take it.
+  void AddJob(Job job, Priority priority = NORMAL) {
+    const auto& current = CurrentWorker();
+    const unsigned int index =
+        (current.first == this)
+            ? current.second
+            : _nextWorker.fetch_add(1, std::memory_order_relaxed) %
+                  _workers.size();
+
     ++_jobsLeft;
-    _jobAvailableVar.notify_one();
+    {
+      Worker& worker = _workers[index];
+      std::lock_guard<std::mutex> lock(worker._mutex);
+      worker._jobs[priority].push_back(std::move(job));
+    }
+    ++_queuedPerLane[priority];
+    ++_queued;
+
+    // A searching thread will find the job, otherwise wake one up
+    if (_searching == 0) {
+      WakeOne();
+    }
+  }
+
+  /// Adds a new job to the pool and returns a future for its result.
+  template <typename F, typename Result = typename std::result_of<
+                            typename std::decay<F>::type()>::type>
+  std::future<Result> Submit(F&& func, Priority priority = NORMAL) {
+    std::packaged_task<Result()> task(std::forward<F>(func));
+    std::future<Result> result = task.get_future();
+    AddJob(std::move(task), priority);
+    return result;
+  }
+
+  /// Calls func(i) for every i in [begin, end) using the pool threads and the
+  /// calling thread, and returns once all calls have finished. May be called
+  /// from inside a job of the same pool.
+  template <typename F>
+  void ParallelFor(size_t begin, size_t end, const F& func,
+                   Priority priority = NORMAL) {
+    if (begin >= end) {
+      return;
+    }
+
+    struct State {
+      std::atomic<size_t> _next;
+      std::atomic<size_t> _remaining;
+      size_t _end;
+      size_t _grain;
+      std::mutex _mutex;
+      std::condition_variable _doneVar;
+    };
 
-    if (0 == _jobsLeft % 10) {
-      LOG_GENERAL(INFO, "PoolName: " << _poolName << " JobLeft: " << _jobsLeft);
+    const size_t count = end - begin;
+    auto state = std::make_shared<State>();
+    state->_next = begin;
+    state->_remaining = count;
+    state->_end = end;
+    state->_grain = std::max<size_t>(1, count / (4 * (_workers.size() + 1)));
+
+    // Helpers only touch func while they hold a claimed range, and the caller
+    // does not return before every claimed range is done
+    auto run = [state, &func]() {
+      while (true) {
+        const size_t first = state->_next.fetch_add(state->_grain);
+        if (first >= state->_end) {
+          return;
+        }
+        const size_t last = std::min(first + state->_grain, state->_end);
+        for (size_t i = first; i < last; ++i) {
+          func(i);
+        }
+        if (state->_remaining.fetch_sub(last - first) == last - first) {
+          std::lock_guard<std::mutex> lock(state->_mutex);
+          state->_doneVar.notify_all();
+        }
+      }
+    };
+
+    const size_t helpers =
+        std::min<size_t>(_workers.size(), (count - 1) / state->_grain);
+    for (size_t i = 0; i < helpers; ++i) {
+      AddJob(run, priority);
     }
+
+    run();
+
+    std::unique_lock<std::mutex> lock(state->_mutex);
+    state->_doneVar.wait(lock, [&state] { return state->_remaining == 0; });
   }
 
   /// Joins with all threads. Blocks until all threads have completed. The queue
@@ -103,7 +251,7 @@ class ThreadPool {
   void JoinAll() {
     // scoped lock
     {
-      std::lock_guard<std::mutex> lock(_queueMutex);
+      std::lock_guard<std::mutex> lock(_sleepMutex);
       if (_bailout) {
         return;
       }
@@ -120,9 +268,10 @@ class ThreadPool {
           thread.join();
         }
       } catch (const std::system_error& e) {
-        LOG_GENERAL(WARNING, "Caught system_error with code "
-                                 << e.code() << " meaning " << e.what()
-                                 << '\n');
+        LOG_GENERAL(WARNING, "PoolName: " << _poolName
+                                           << " caught system_error with code "
+                                           << e.code() << " meaning "
+                                           << e.what() << '\n');
       }
     }
   }
@@ -130,10 +279,8 @@ class ThreadPool {
   /// Waits for the pool to empty before continuing. This does not call
   /// `std::thread::join`, it only waits until all jobs have finished executing.
   void WaitAll() {
-    std::unique_lock<std::mutex> lock(_jobsLeftMutex);
-    if (_jobsLeft > 0) {
-      _waitVar.wait(lock, [this] { return _jobsLeft == 0; });
-    }
+    std::unique_lock<std::mutex> lock(_waitMutex);
+    _waitVar.wait(lock, [this] { return _jobsLeft == 0; });
   }
 
   /// Gets the vector of threads themselves, in order to set the affinity, or
@@ -141,67 +288,124 @@ class ThreadPool {
   std::vector<std::thread>& GetThreads() { return _threads; }
 
  private:
+  struct Worker {
+    std::mutex _mutex;
+    std::deque<Job> _jobs[NUM_PRIORITIES];
+  };
+
+  /// The pool and worker index the calling thread belongs to, if any.
+  static std::pair<const ThreadPool*, unsigned int>& CurrentWorker() {
+    static thread_local std::pair<const ThreadPool*, unsigned int> current{
+        nullptr, 0};
+    return current;
+  }
+
+  /// Takes the next job, preferring higher priorities, then the own queue of
+  /// the thread, then the newest job queued by another thread.
+  bool TryPop(const unsigned int index, Job& job) {
+    for (unsigned int priority = 0; priority < NUM_PRIORITIES; ++priority) {
+      if (_queuedPerLane[priority] == 0) {
+        continue;
+      }
+
+      for (unsigned int i = 0; i < _workers.size(); ++i) {
+        Worker& worker = _workers[(index + i) % _workers.size()];
+        std::lock_guard<std::mutex> lock(worker._mutex);
+        auto& jobs = worker._jobs[priority];
+        if (jobs.empty()) {
+          continue;
+        }
+
+        // Own jobs are taken in order, stolen ones from the other end
+        if (i == 0) {
+          job = std::move(jobs.front());
+          jobs.pop_front();
+        } else {
+          job = std::move(jobs.back());
+          jobs.pop_back();
+        }
+
+        --_queuedPerLane[priority];
+        --_queued;
+        return true;
+      }
+    }
+
+    return false;
+  }
+
   /**
-   *  Take the next job in the queue and run it.
-   *  Notify the main thread that a job has completed.
+   *  Take the next job and run it.
+   *  Notify the waiting threads when the pool becomes empty.
    */
-  void Task() {
+  void Task(const unsigned int index) {
+    CurrentWorker() = {this, index};
+    ++_searching;
+
     while (true) {
       Job job;
 
-      // scoped lock
-      {
-        std::unique_lock<std::mutex> lock(_queueMutex);
+      if (!TryPop(index, job)) {
+        std::unique_lock<std::mutex> lock(_sleepMutex);
+        ++_sleeping;
+        // Stop searching before the last look at _queued, so that AddJob
+        // either sees no searcher and wakes us, or we see its job
+        --_searching;
+        // Wait for a job if we don't have any.
+        _jobAvailableVar.wait(lock, [this] { return _queued > 0 || _bailout; });
+        ++_searching;
+        --_sleeping;
 
         if (_bailout) {
           return;
         }
 
-        // Wait for a job if we don't have any.
-        _jobAvailableVar.wait(lock,
-                              [this] { return !_queue.empty() || _bailout; });
+        continue;
+      }
 
-        if (_bailout) {
-          return;
-        }
+      // Hand the search over to another thread if more jobs are waiting
+      if (--_searching == 0 && _queued > 0) {
+        WakeOne();
+      }
 
-        // Get job from the queue
-#if CONTIGUOUS_JOBS_MEMORY
-        job = _queue.back();
-        _queue.pop_back();
-#else
-        job = _queue.front();
-        _queue.pop();
-#endif
+      if (_bailout) {
+        return;
       }
 
       job();
 
-      // scoped lock
-      {
-        std::lock_guard<std::mutex> lock(_jobsLeftMutex);
-        --_jobsLeft;
+      if (--_jobsLeft == 0) {
+        std::lock_guard<std::mutex> lock(_waitMutex);
+        _waitVar.notify_all();
       }
 
-      _waitVar.notify_one();
+      ++_searching;
+    }
+  }
+
+  /// Wakes up a sleeping thread, if any.
+  void WakeOne() {
+    if (_sleeping > 0) {
+      std::lock_guard<std::mutex> lock(_sleepMutex);
+      _jobAvailableVar.notify_one();
     }
   }
 
   std::vector<std::thread> _threads;
-#if CONTIGUOUS_JOBS_MEMORY
-  std::vector<Job> _queue;
-#else
-  std::queue<Job> _queue;
-#endif
-
-  int _jobsLeft;
-  bool _bailout;
+  std::vector<Worker> _workers;
+
+  std::atomic<unsigned int> _queuedPerLane[NUM_PRIORITIES];
+  std::atomic<unsigned int> _queued;
+  std::atomic<unsigned int> _jobsLeft;
+  std::atomic<unsigned int> _searching;
+  std::atomic<unsigned int> _sleeping;
+  std::atomic<unsigned int> _nextWorker;
+  std::atomic<bool> _bailout;
   std::string _poolName;
   std::condition_variable _jobAvailableVar;
   std::condition_variable _waitVar;
-  std::mutex _jobsLeftMutex;
-  std::mutex _queueMutex;
+  std::mutex _sleepMutex;
+  std::mutex _waitMutex;
 };
 
-#undef CONTIGUOUS_JOBS_MEMORY
 #endif  // CONCURRENT_THREADPOOL_H
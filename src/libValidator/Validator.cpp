@@ -17,10 +17,14 @@
  * program files.
  */
 
+#include <algorithm>
+#include <thread>
 #include <vector>
 
 #include "Validator.h"
+#include "libCrypto/Sha2.h"
 #include "libData/AccountData/Account.h"
+#include "libData/AccountData/VerifiedTxnCache.h"
 #include "libMediator/Mediator.h"
 #include "libUtils/BitVector.h"
 
@@ -29,7 +33,9 @@ using namespace boost::multiprecision;
 
 using ShardingHash = dev::h256;
 
-Validator::Validator(Mediator& mediator) : m_mediator(mediator) {}
+Validator::Validator(Mediator& mediator)
+    : m_mediator(mediator),
+      m_checkPool(max(thread::hardware_concurrency(), 1u), "TxnCheckPool") {}
 
 Validator::~Validator() {}
 
@@ -37,8 +43,32 @@ bool Validator::VerifyTransaction(const Transaction& tran) const {
   vector<unsigned char> txnData;
   tran.SerializeCoreFields(txnData, 0);
 
-  return Schnorr::GetInstance().Verify(txnData, tran.GetSignature(),
-                                       tran.GetSenderPubKey());
+  // The cache may only be trusted if the ID really is the hash of this txn
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
+  sha2.Update(txnData);
+  const vector<unsigned char>& hash = sha2.Finalize();
+  const bool idMatches = equal(hash.begin(), hash.end(),
+                               tran.GetTranID().begin(),
+                               tran.GetTranID().end());
+
+  vector<unsigned char> sigBytes;
+  tran.GetSignature().Serialize(sigBytes, 0);
+
+  if (idMatches &&
+      VerifiedTxnCache::GetInstance().Contains(tran.GetTranID(), sigBytes)) {
+    return true;
+  }
+
+  if (!Schnorr::GetInstance().Verify(txnData, tran.GetSignature(),
+                                     tran.GetSenderPubKey())) {
+    return false;
+  }
+
+  if (idMatches) {
+    VerifiedTxnCache::GetInstance().Add(tran.GetTranID(), sigBytes);
+  }
+
+  return true;
 }
 
 bool Validator::CheckCreatedTransaction(const Transaction& tx,
@@ -90,6 +120,45 @@ bool Validator::CheckCreatedTransactionFromLookup(const Transaction& tx) {
 
   // LOG_MARKER();
 
+  return CheckTxnFieldsFromLookup(
+             tx, m_mediator.m_dsBlockChain.GetLastBlockPtr()
+                     ->GetHeader()
+                     .GetGasPrice()) &&
+         CheckTxnSenderFromLookup(tx);
+}
+
+void Validator::CheckCreatedTransactionsFromLookup(
+    const vector<Transaction>& txns, vector<Transaction>& checkedTxns) {
+  if (LOOKUP_NODE_MODE) {
+    LOG_GENERAL(WARNING,
+                "Validator::CheckCreatedTransactionsFromLookup not expected "
+                "to be called from LookUp node.");
+    checkedTxns.insert(checkedTxns.end(), txns.begin(), txns.end());
+    return;
+  }
+
+  const uint128_t minGasPrice =
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetGasPrice();
+
+  // Signatures and the other stateless checks are spread over the pool, each
+  // result lands in its own slot so the outcome doesn't depend on scheduling
+  vector<unsigned char> fieldsValid(txns.size(), false);
+  m_checkPool.ParallelFor(0, txns.size(), [&](size_t i) {
+    fieldsValid[i] = CheckTxnFieldsFromLookup(txns[i], minGasPrice);
+  });
+
+  // The account store is read in packet order on this thread only
+  for (size_t i = 0; i < txns.size(); i++) {
+    if (fieldsValid[i] && CheckTxnSenderFromLookup(txns[i])) {
+      checkedTxns.emplace_back(txns[i]);
+    } else {
+      LOG_GENERAL(WARNING, "Txn is not valid.");
+    }
+  }
+}
+
+bool Validator::CheckTxnFieldsFromLookup(const Transaction& tx,
+                                         const uint128_t& minGasPrice) const {
   // Check if from account is sharded here
   const PubKey& senderPubKey = tx.GetSenderPubKey();
   Address fromAddr = Account::GetAddressFromPublicKey(senderPubKey);
@@ -124,14 +193,10 @@ bool Validator::CheckCreatedTransactionFromLookup(const Transaction& tx) {
     }
   }
 
-  if (tx.GetGasPrice() <
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetGasPrice()) {
+  if (tx.GetGasPrice() < minGasPrice) {
     LOG_EPOCH(WARNING, to_string(m_mediator.m_currentEpochNum).c_str(),
               "GasPrice " << tx.GetGasPrice()
-                          << " lower than minimum allowable "
-                          << m_mediator.m_dsBlockChain.GetLastBlock()
-                                 .GetHeader()
-                                 .GetGasPrice());
+                          << " lower than minimum allowable " << minGasPrice);
     return false;
   }
 
@@ -142,6 +207,13 @@ bool Validator::CheckCreatedTransactionFromLookup(const Transaction& tx) {
     return false;
   }
 
+  return true;
+}
+
+bool Validator::CheckTxnSenderFromLookup(const Transaction& tx) const {
+  const Address fromAddr =
+      Account::GetAddressFromPublicKey(tx.GetSenderPubKey());
+
   // Check if from account exists in local storage
   if (!AccountStore::GetInstance().IsAccountExist(fromAddr)) {
     LOG_EPOCH(WARNING, to_string(m_mediator.m_currentEpochNum).c_str(),
@@ -229,10 +301,12 @@ bool Validator::CheckDirBlocks(
   bool ret = true;
 
   uint64_t prevdsblocknum =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetBlockNum();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()->GetHeader().GetBlockNum();
   uint64_t totalIndex = index_num;
   ShardingHash prevShardingHash =
-      m_mediator.m_dsBlockChain.GetLastBlock().GetHeader().GetShardingHash();
+      m_mediator.m_dsBlockChain.GetLastBlockPtr()
+          ->GetHeader()
+          .GetShardingHash();
 
   for (const auto& dirBlock : dirBlocks) {
     if (typeid(DSBlock) == dirBlock.type()) {
@@ -22,12 +22,14 @@
 
 #include <boost/variant.hpp>
 #include <string>
+#include <vector>
 #include "libData/AccountData/Transaction.h"
 #include "libData/AccountData/TransactionReceipt.h"
 #include "libData/BlockChainData/BlockLinkChain.h"
 #include "libData/BlockData/Block.h"
 #include "libData/BlockData/Block/FallbackBlockWShardingStructure.h"
 #include "libNetwork/Peer.h"
+#include "libUtils/ThreadPool.h"
 
 class Mediator;
 
@@ -45,6 +47,12 @@ class ValidatorBase {
 
   virtual bool CheckCreatedTransactionFromLookup(const Transaction& tx) = 0;
 
+  /// Checks a packet of txns from lookup, the valid ones are appended to
+  /// checkedTxns in their original order
+  virtual void CheckCreatedTransactionsFromLookup(
+      const std::vector<Transaction>& txns,
+      std::vector<Transaction>& checkedTxns) = 0;
+
   virtual bool CheckDirBlocks(
       const std::vector<boost::variant<
           DSBlock, VCBlock, FallbackBlockWShardingStructure>>& dirBlocks,
@@ -69,6 +77,10 @@ class Validator : public ValidatorBase {
 
   bool CheckCreatedTransactionFromLookup(const Transaction& tx) override;
 
+  void CheckCreatedTransactionsFromLookup(
+      const std::vector<Transaction>& txns,
+      std::vector<Transaction>& checkedTxns) override;
+
   template <class Container, class DirectoryBlock>
   bool CheckBlockCosignature(const DirectoryBlock& block,
                              const Container& commKeys);
@@ -85,6 +97,18 @@ class Validator : public ValidatorBase {
       const std::deque<std::pair<PubKey, Peer>>& dsComm,
       const BlockLink& latestBlockLink) override;
   Mediator& m_mediator;
+
+ private:
+  /// Checks that only need the txn itself (sharding, gas price, signature)
+  /// and may run concurrently
+  bool CheckTxnFieldsFromLookup(
+      const Transaction& tx,
+      const boost::multiprecision::uint128_t& minGasPrice) const;
+
+  /// Checks against the account store, which must not run concurrently
+  bool CheckTxnSenderFromLookup(const Transaction& tx) const;
+
+  ThreadPool m_checkPool;
 };
 
 #endif  // __VALIDATOR_H__
\ No newline at end of file
@@ -29,6 +29,7 @@
 #include "libCrypto/Sha2.h"
 #include "libData/AccountData/Address.h"
 #include "libNetwork/Guard.h"
+#include "libPersistence/BlockStorage.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/DetachedFunction.h"
 #include "libUtils/Logger.h"
@@ -61,6 +62,32 @@ void Zilliqa::LogSelfNodeInfo(const std::pair<PrivKey, PubKey>& key,
                                      << peer.m_listenPortHost);
 }
 
+/// Consensus rounds time out, so their messages are processed ahead of
+/// transaction and block sharing traffic.
+static ThreadPool::Priority GetPriority(const vector<unsigned char>& message) {
+  if (message.size() <= MessageOffset::INST) {
+    return ThreadPool::NORMAL;
+  }
+
+  const unsigned char msg_type = message.at(MessageOffset::TYPE);
+  const unsigned char ins_type = message.at(MessageOffset::INST);
+
+  if (msg_type == MessageType::DIRECTORY) {
+    if (ins_type == DSInstructionType::DSBLOCKCONSENSUS ||
+        ins_type == DSInstructionType::FINALBLOCKCONSENSUS ||
+        ins_type == DSInstructionType::VIEWCHANGECONSENSUS) {
+      return ThreadPool::HIGH;
+    }
+  } else if (msg_type == MessageType::NODE) {
+    if (ins_type == NodeInstructionType::MICROBLOCKCONSENSUS ||
+        ins_type == NodeInstructionType::FALLBACKCONSENSUS) {
+      return ThreadPool::HIGH;
+    }
+  }
+
+  return ThreadPool::NORMAL;
+}
+
 void Zilliqa::ProcessMessage(pair<vector<unsigned char>, Peer>* message) {
   if (message->first.size() >= MessageOffset::BODY) {
     const unsigned char msg_type = message->first.at(MessageOffset::TYPE);
@@ -118,7 +145,8 @@ Zilliqa::Zilliqa(const std::pair<PrivKey, PubKey>& key, const Peer& peer,
         // For now, we use a thread pool to handle this message
         // Eventually processing will be single-threaded
         m_queuePool.AddJob(
-            [this, message]() mutable -> void { ProcessMessage(message); });
+            [this, message]() mutable -> void { ProcessMessage(message); },
+            GetPriority(message->first));
       }
       std::this_thread::sleep_for(std::chrono::microseconds(1));
     }
@@ -176,6 +204,10 @@ Zilliqa::Zilliqa(const std::pair<PrivKey, PubKey>& key, const Peer& peer,
       }
     }
 
+    // Rewrite any keys left by older versions once the history is loaded
+    DetachedFunction(1,
+                     []() { BlockStorage::GetBlockStorage().MigrateKeys(); });
+
     LogSelfNodeInfo(key, peer);
 
     switch (syncType) {
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+// Compares the ways of computing transaction IDs with SHA2. Not part of the
+// test suite; run it manually:
+//   ./Bench_Sha2 [txns] [rounds]
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "libCrypto/Sha2.h"
+
+using namespace std;
+using namespace std::chrono;
+
+using Sha256 = SHA2<HASH_TYPE::HASH_VARIANT_256>;
+
+namespace {
+// Serialized TransactionCoreInfo of a plain transfer: version, nonce, toAddr,
+// senderPubKey, amount, gasPrice, gasLimit and empty code and data
+const size_t TXN_CORE_SIZE = 4 + 8 + 20 + 33 + 16 + 16 + 8 + 4 + 4;
+
+template <typename F>
+double Measure(unsigned int rounds, const F& func) {
+  auto start = steady_clock::now();
+  for (unsigned int i = 0; i < rounds; i++) {
+    func();
+  }
+  return duration<double, milli>(steady_clock::now() - start).count();
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const size_t numTxns = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000;
+  const unsigned int rounds = argc > 2 ? strtoul(argv[2], nullptr, 10) : 20;
+
+  mt19937 rng(1);
+  vector<vector<unsigned char>> txns(numTxns,
+                                     vector<unsigned char>(TXN_CORE_SIZE));
+  for (auto& txn : txns) {
+    for (auto& byte : txn) {
+      byte = rng();
+    }
+  }
+
+  vector<Sha256::Buffer> inputs;
+  for (const auto& txn : txns) {
+    inputs.emplace_back(txn.data(), txn.size());
+  }
+  vector<dev::h256> tranIDs(numTxns);
+
+  // What Transaction did before: a vector in and a vector out per txn
+  double legacy = Measure(rounds, [&]() {
+    for (size_t i = 0; i < numTxns; i++) {
+      Sha256 sha2;
+      sha2.Update(txns[i]);
+      const vector<unsigned char>& output = sha2.Finalize();
+      copy(output.begin(), output.end(), tranIDs[i].asArray().begin());
+    }
+  });
+  const dev::h256 check = tranIDs.back();
+
+  double single = Measure(rounds, [&]() {
+    for (size_t i = 0; i < numTxns; i++) {
+      Sha256::Hash(txns[i], tranIDs[i]);
+    }
+  });
+
+  double batch =
+      Measure(rounds, [&]() { Sha256::HashBatch(inputs, tranIDs); });
+
+  if (tranIDs.back() != check) {
+    cerr << "Hashes differ" << endl;
+    return 1;
+  }
+
+  double multiBuffer = 0;
+  if (SHA256MultiBuffer::IsSupported()) {
+    multiBuffer = Measure(rounds, [&]() {
+      SHA256MultiBuffer::Hash(inputs.data(), numTxns, tranIDs.data());
+    });
+
+    if (tranIDs.back() != check) {
+      cerr << "Multi-buffer hashes differ" << endl;
+      return 1;
+    }
+  }
+
+  const double total = static_cast<double>(numTxns) * rounds;
+  cout << numTxns << " txns x " << rounds << " rounds" << endl;
+  cout << "  Update/Finalize: " << legacy << " ms, "
+       << total / legacy * 1000 << " txn/s" << endl;
+  cout << "  Hash:            " << single << " ms, "
+       << total / single * 1000 << " txn/s" << endl;
+  cout << "  HashBatch:       " << batch << " ms, " << total / batch * 1000
+       << " txn/s ("
+       << (SHA256MultiBuffer::IsPreferred() ? "multi-buffer" : "one by one")
+       << ")" << endl;
+  if (multiBuffer > 0) {
+    cout << "  Multi-buffer:    " << multiBuffer << " ms, "
+         << total / multiBuffer * 1000 << " txn/s" << endl;
+  }
+
+  return 0;
+}
@@ -18,6 +18,7 @@
  */
 
 #include <cstring>
+#include <map>
 #include "libCrypto/Schnorr.h"
 #include "libUtils/Logger.h"
 #include "libUtils/TimeUtils.h"
@@ -223,6 +224,80 @@ BOOST_AUTO_TEST_CASE(test_performance) {
   }
 }
 
+/**
+ * \brief test_pubkey_compare_performance
+ *
+ * \details Compare committee sort and map lookup costs using the cached key
+ * encoding against converting the points on every comparison
+ */
+BOOST_AUTO_TEST_CASE(test_pubkey_compare_performance) {
+  Schnorr& schnorr = Schnorr::GetInstance();
+  const EC_GROUP* group = schnorr.GetCurve().m_group.get();
+
+  const unsigned int committee_size = 600;
+  vector<PubKey> committee;
+  for (unsigned int i = 0; i < committee_size; i++) {
+    committee.emplace_back(schnorr.GenKeyPair().second);
+  }
+
+  /// How PubKey::operator< used to compare keys
+  auto legacy_less = [group](const PubKey& l, const PubKey& r) {
+    unique_ptr<BN_CTX, void (*)(BN_CTX*)> ctx(BN_CTX_new(), BN_CTX_free);
+    unique_ptr<BIGNUM, void (*)(BIGNUM*)> lhs(
+        EC_POINT_point2bn(group, l.m_P.get(), POINT_CONVERSION_COMPRESSED,
+                          NULL, ctx.get()),
+        BN_clear_free);
+    unique_ptr<BIGNUM, void (*)(BIGNUM*)> rhs(
+        EC_POINT_point2bn(group, r.m_P.get(), POINT_CONVERSION_COMPRESSED,
+                          NULL, ctx.get()),
+        BN_clear_free);
+    return BN_cmp(lhs.get(), rhs.get()) == -1;
+  };
+
+  vector<PubKey> legacy_sorted(committee);
+  auto t = r_timer_start();
+  sort(legacy_sorted.begin(), legacy_sorted.end(), legacy_less);
+  LOG_GENERAL(INFO, "Committee sort, converting points (usec) = "
+                        << r_timer_end(t));
+
+  vector<PubKey> sorted(committee);
+  t = r_timer_start();
+  sort(sorted.begin(), sorted.end());
+  LOG_GENERAL(INFO, "Committee sort, cached encoding (usec)  = "
+                        << r_timer_end(t));
+
+  BOOST_CHECK_MESSAGE(legacy_sorted == sorted,
+                      "Cached encoding changed the key order");
+
+  map<PubKey, unsigned int, decltype(legacy_less)> legacy_map(legacy_less);
+  map<PubKey, unsigned int> cached_map;
+  for (unsigned int i = 0; i < committee_size; i++) {
+    legacy_map.emplace(committee[i], i);
+    cached_map.emplace(committee[i], i);
+  }
+
+  t = r_timer_start();
+  for (const auto& key : committee) {
+    BOOST_CHECK(legacy_map.find(key) != legacy_map.end());
+  }
+  LOG_GENERAL(INFO, "Map lookups, converting points (usec)   = "
+                        << r_timer_end(t));
+
+  t = r_timer_start();
+  for (const auto& key : committee) {
+    BOOST_CHECK(cached_map.find(key) != cached_map.end());
+  }
+  LOG_GENERAL(INFO, "Map lookups, cached encoding (usec)     = "
+                        << r_timer_end(t));
+
+  /// Equal keys hash equally, whichever way they were built
+  vector<unsigned char> bytes;
+  committee[0].Serialize(bytes, 0);
+  PubKey deserialized(bytes, 0);
+  BOOST_CHECK(deserialized == committee[0]);
+  BOOST_CHECK(hash<PubKey>()(deserialized) == hash<PubKey>()(committee[0]));
+}
+
 /**
  * \brief test_serialization
  *
@@ -105,4 +105,82 @@ BOOST_AUTO_TEST_CASE(SHA256_002_check_896bitsx3_updatewithoffset) {
   BOOST_CHECK_EQUAL(is_equal, true);
 }
 
+/**
+ * \brief SHA256_check_fixed_size_api
+ *
+ * \details Test the allocation-free and batch SHA256 functions against the
+ * vector based ones
+ */
+BOOST_AUTO_TEST_CASE(SHA256_003_check_fixed_size_api) {
+  const unsigned char input[] =
+      "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  unsigned int inputSize = strlen((const char*)input);
+
+  dev::h256 digest;
+  SHA2<HASH_TYPE::HASH_VARIANT_256>::Hash(input, inputSize, digest);
+  BOOST_CHECK_EQUAL(
+      digest.hex(),
+      "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+  SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
+  sha2.Update(input, 0);
+  sha2.Finalize(digest);
+  BOOST_CHECK_EQUAL(
+      digest.hex(),
+      "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+}
+
+/**
+ * \brief SHA256_check_batch
+ *
+ * \details Test batch hashing, and the multi-buffer kernel on its own where
+ * the CPU supports it, against hashing one buffer at a time
+ */
+BOOST_AUTO_TEST_CASE(SHA256_004_check_batch) {
+  using Sha256 = SHA2<HASH_TYPE::HASH_VARIANT_256>;
+
+  // Every length up to five blocks, so the padding falls at each offset and
+  // lanes finish at different times
+  vector<vector<unsigned char>> buffers;
+  for (unsigned int i = 0; i <= 320; i++) {
+    buffers.emplace_back(i);
+    for (unsigned int j = 0; j < i; j++) {
+      buffers.back()[j] = (unsigned char)(i * 31 + j);
+    }
+  }
+
+  vector<dev::h256> expected(buffers.size());
+  for (unsigned int i = 0; i < buffers.size(); i++) {
+    Sha256::Hash(buffers[i], expected[i]);
+  }
+
+  vector<dev::h256> digests;
+  Sha256::HashBatch(buffers, digests);
+  BOOST_CHECK(digests == expected);
+
+  // Fewer buffers than lanes
+  vector<vector<unsigned char>> few(buffers.begin() + 60, buffers.begin() + 63);
+  Sha256::HashBatch(few, digests);
+  BOOST_CHECK(digests ==
+              vector<dev::h256>(expected.begin() + 60, expected.begin() + 63));
+
+  if (!SHA256MultiBuffer::IsSupported()) {
+    BOOST_TEST_MESSAGE("No AVX2, multi-buffer kernel not tested");
+    return;
+  }
+
+  vector<Sha256::Buffer> inputs;
+  for (const auto& buffer : buffers) {
+    inputs.emplace_back(buffer.data(), buffer.size());
+  }
+
+  for (size_t count : {(size_t)1, (size_t)SHA256MultiBuffer::LANES + 1,
+                       inputs.size()}) {
+    digests.assign(count, dev::h256());
+    SHA256MultiBuffer::Hash(inputs.data(), count, digests.data());
+    BOOST_CHECK(digests ==
+                vector<dev::h256>(expected.begin(), expected.begin() + count));
+  }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+// Measures AccountStore::MoveUpdatesToDisk with the same number of changed
+// accounts per commit and a growing number of cached accounts. Not part of
+// the test suite; run it manually from a directory holding constants.xml:
+//   ./Bench_AccountStoreCommit [max cached accounts]
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "libData/AccountData/AccountStore.h"
+#include "libUtils/Logger.h"
+#include "libUtils/TimeUtils.h"
+
+using namespace std;
+
+namespace {
+const unsigned int CHANGED_ACCOUNTS = 1000;
+const unsigned int NUM_COMMITS = 10;
+
+Address MakeAddress(unsigned int i) {
+  Address address;
+  memcpy(address.data(), &i, sizeof(i));
+  return address;
+}
+
+void Run(unsigned int numCached) {
+  AccountStore& accountStore = AccountStore::GetInstance();
+  accountStore.Init();
+
+  for (unsigned int i = 0; i < numCached; i++) {
+    accountStore.AddAccountDuringDeserialization(MakeAddress(i), {i, 0});
+  }
+  accountStore.MoveUpdatesToDisk();
+
+  double total = 0;
+  for (unsigned int commit = 1; commit <= NUM_COMMITS; commit++) {
+    for (unsigned int i = 0; i < CHANGED_ACCOUNTS; i++) {
+      const unsigned int n = (commit * CHANGED_ACCOUNTS + i) % numCached;
+      accountStore.AddAccountDuringDeserialization(MakeAddress(n),
+                                                   {n + commit, commit});
+    }
+
+    auto start = r_timer_start();
+    accountStore.MoveUpdatesToDisk();
+    total += r_timer_end(start);
+  }
+
+  cout << numCached << " cached accounts: " << total / NUM_COMMITS / 1000
+       << " ms per commit" << endl;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  INIT_STDOUT_LOGGER();
+
+  const unsigned int maxCached =
+      argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+
+  cout << CHANGED_ACCOUNTS << " accounts changed per commit" << endl;
+  for (unsigned int numCached = CHANGED_ACCOUNTS; numCached <= maxCached;
+       numCached *= 10) {
+    Run(numCached);
+  }
+
+  return 0;
+}
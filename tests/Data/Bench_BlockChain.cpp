@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "libCrypto/Schnorr.h"
+#include "libData/BlockChainData/BlockChain.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+namespace {
+
+TxBlock MakeTxBlock(uint64_t blockNum, const PubKey& miner) {
+  TxBlockHeader header(0, 0, 0, 0, 0, BlockHash(), blockNum, TxBlockHashSet(),
+                       0, miner, 0, CommitteeHash());
+  vector<MicroBlockInfo> mbInfos(10);
+  return TxBlock(header, mbInfos, CoSignatures(600));
+}
+
+// Counts the reads done by numReaders threads while blocks are appended
+template <typename ReadFunc>
+void Run(const string& name, unsigned int numReaders, ReadFunc read) {
+  const unsigned int numBlocks = 5000;
+  const PubKey miner = Schnorr::GetInstance().GenKeyPair().second;
+
+  vector<TxBlock> blocks;
+  for (unsigned int i = 0; i < numBlocks; i++) {
+    blocks.emplace_back(MakeTxBlock(i, miner));
+  }
+
+  TxBlockChain chain;
+  chain.AddBlock(blocks[0]);
+
+  atomic<bool> done(false);
+  atomic<uint64_t> reads(0);
+  vector<thread> readers;
+  for (unsigned int i = 0; i < numReaders; i++) {
+    readers.emplace_back([&]() {
+      uint64_t count = 0;
+      while (!done) {
+        read(chain);
+        count++;
+      }
+      reads += count;
+    });
+  }
+
+  auto start = chrono::steady_clock::now();
+  for (unsigned int i = 1; i < numBlocks; i++) {
+    chain.AddBlock(blocks[i]);
+  }
+  done = true;
+  auto elapsed = chrono::duration_cast<chrono::milliseconds>(
+                     chrono::steady_clock::now() - start)
+                     .count();
+
+  for (auto& reader : readers) {
+    reader.join();
+  }
+
+  cout << name << ": " << numBlocks << " blocks appended in " << elapsed
+       << " ms with " << numReaders << " readers, " << reads << " reads"
+       << endl;
+}
+
+}  // namespace
+
+// Compares copying blocks out of the chain with sharing them, while the
+// chain is being appended to
+int main() {
+  INIT_STDOUT_LOGGER();
+
+  const unsigned int numReaders =
+      max(thread::hardware_concurrency(), 2u) - 1;
+
+  Run("GetLastBlock (copy)", numReaders, [](TxBlockChain& chain) {
+    return chain.GetLastBlock().GetHeader().GetBlockNum();
+  });
+  Run("GetLastBlockPtr", numReaders, [](TxBlockChain& chain) {
+    return chain.GetLastBlockPtr()->GetHeader().GetBlockNum();
+  });
+  Run("GetBlockPtr", numReaders, [](TxBlockChain& chain) {
+    return chain.GetBlockPtr(chain.GetBlockCount() / 2)
+        ->GetHeader()
+        .GetBlockNum();
+  });
+
+  return 0;
+}
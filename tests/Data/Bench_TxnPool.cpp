@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+#include "libCrypto/Schnorr.h"
+#include "libData/AccountData/TxnPool.h"
+#include "libUtils/Logger.h"
+
+using namespace boost::multiprecision;
+using namespace std;
+
+// Fills the pool with 1M txns from 1000 senders, then drains it in gas order
+// with the nonces applied as a leader would
+int main() {
+  INIT_STDOUT_LOGGER();
+
+  const unsigned int numSenders = 1000;
+  const unsigned int txnsPerSender = 1000;
+
+  vector<PubKey> senders;
+  for (unsigned int i = 0; i < numSenders; i++) {
+    senders.emplace_back(Schnorr::GetInstance().GenKeyPair().second);
+  }
+
+  vector<Transaction> txns;
+  txns.reserve(numSenders * txnsPerSender);
+  for (unsigned int nonce = 0; nonce < txnsPerSender; nonce++) {
+    for (unsigned int i = 0; i < numSenders; i++) {
+      TxnHash tranID;
+      const unsigned int n = nonce * numSenders + i;
+      memcpy(tranID.data(), &n, sizeof(n));
+      txns.emplace_back(tranID, 0, nonce + 1, Address(), senders[i], 0,
+                        (n * 2654435761u) % 1000, 1, vector<unsigned char>(),
+                        vector<unsigned char>(), Signature());
+    }
+  }
+
+  TxnPool pool(txns.size());
+
+  auto start = chrono::steady_clock::now();
+  for (const auto& t : txns) {
+    pool.insert(t);
+  }
+  auto inserted = chrono::steady_clock::now();
+
+  unordered_map<Address, uint64_t> nonces;
+  auto getNonce = [&nonces](const Address& addr) -> uint128_t {
+    return nonces[addr];
+  };
+
+  Transaction t;
+  unsigned int count = 0;
+  while (pool.findOne(t, getNonce)) {
+    nonces[t.GetSenderAddr()] = t.GetNonce();
+    count++;
+  }
+  auto drained = chrono::steady_clock::now();
+
+  cout << "insert " << txns.size() << " txns: "
+       << chrono::duration_cast<chrono::milliseconds>(inserted - start).count()
+       << " ms" << endl;
+  cout << "findOne " << count << " txns: "
+       << chrono::duration_cast<chrono::milliseconds>(drained - inserted)
+              .count()
+       << " ms" << endl;
+
+  return 0;
+}
@@ -18,6 +18,8 @@
  */
 
 #include <array>
+#include <chrono>
+#include <cstring>
 #include <string>
 
 #define BOOST_TEST_MODULE accountstoretest
@@ -28,11 +30,132 @@
 #include "libData/AccountData/Account.h"
 #include "libData/AccountData/AccountStore.h"
 #include "libData/AccountData/Address.h"
+#include "libPersistence/ContractStorage.h"
 #include "libUtils/DataConversion.h"
 #include "libUtils/Logger.h"
 
+using namespace std;
+
+namespace {
+Address MakeAddress(unsigned int i) {
+  Address address;
+  memcpy(address.data(), &i, sizeof(i));
+  return address;
+}
+
+// Code differs on every run, so code left on disk by an earlier run can't
+// pass for code written by this one
+vector<unsigned char> MakeCode() {
+  auto now = chrono::steady_clock::now().time_since_epoch().count();
+  string code = "contract Test" + to_string(now);
+  return vector<unsigned char>(code.begin(), code.end());
+}
+}  // namespace
+
 BOOST_AUTO_TEST_SUITE(accountstoretest)
 
+BOOST_AUTO_TEST_CASE(commitWritesOnlyNewContractCode) {
+  INIT_STDOUT_LOGGER();
+
+  AccountStore& accountStore = AccountStore::GetInstance();
+  accountStore.Init();
+
+  const Address contractAddr = MakeAddress(1);
+  const Address plainAddr = MakeAddress(2);
+  const vector<unsigned char> code = MakeCode();
+
+  Account contract(0, 0);
+  contract.SetCode(code);
+  accountStore.AddAccountTemp(contractAddr, contract);
+  accountStore.AddAccountTemp(plainAddr, {5, 1});
+
+  // A delta that creates both accounts, applied as it would be on commit
+  BOOST_REQUIRE(accountStore.SerializeDelta());
+  vector<unsigned char> delta;
+  accountStore.GetSerializedDelta(delta);
+  BOOST_REQUIRE(accountStore.DeserializeDelta(delta, 0));
+
+  BOOST_CHECK_EQUAL(accountStore.GetNumDirtyAccounts(), 2);
+  BOOST_CHECK_EQUAL(accountStore.GetNumNewContracts(), 1);
+
+  accountStore.MoveUpdatesToDisk();
+
+  BOOST_CHECK_EQUAL(accountStore.GetNumDirtyAccounts(), 0);
+  BOOST_CHECK_EQUAL(accountStore.GetNumNewContracts(), 0);
+  BOOST_CHECK(ContractStorage::GetContractStorage().GetContractCode(
+                  contractAddr) == code);
+  BOOST_CHECK(
+      ContractStorage::GetContractStorage().GetContractCode(plainAddr).empty());
+
+  // A later balance change to the plain account is not a new contract
+  accountStore.AddAccountDuringDeserialization(plainAddr, {6, 2});
+  BOOST_CHECK_EQUAL(accountStore.GetNumDirtyAccounts(), 1);
+  BOOST_CHECK_EQUAL(accountStore.GetNumNewContracts(), 0);
+  accountStore.MoveUpdatesToDisk();
+  BOOST_CHECK(
+      ContractStorage::GetContractStorage().GetContractCode(plainAddr).empty());
+
+  accountStore.InitTemp();
+}
+
+BOOST_AUTO_TEST_CASE(discardRollsBackContractStorage) {
+  INIT_STDOUT_LOGGER();
+
+  AccountStore& accountStore = AccountStore::GetInstance();
+  accountStore.Init();
+
+  const Address contractAddr = MakeAddress(3);
+
+  Account contract(0, 0);
+  contract.SetCode(MakeCode());
+  contract.SetStorage("count", "Uint32", "0", true);
+  accountStore.AddAccountDuringDeserialization(contractAddr, contract, true);
+  accountStore.MoveUpdatesToDisk();
+
+  Account* account = accountStore.GetAccount(contractAddr);
+  BOOST_REQUIRE(account != nullptr);
+  const dev::h256 savedRoot = account->GetStorageRoot();
+  BOOST_REQUIRE(savedRoot != dev::h256());
+
+  account->SetStorage("count", "Uint32", "1", true);
+  BOOST_REQUIRE(account->GetStorageRoot() != savedRoot);
+  accountStore.AddAccountDuringDeserialization(contractAddr, *account);
+  BOOST_CHECK_EQUAL(accountStore.GetNumDirtyAccounts(), 1);
+  BOOST_CHECK_EQUAL(accountStore.GetNumNewContracts(), 0);
+
+  accountStore.DiscardUnsavedUpdates();
+
+  BOOST_CHECK_EQUAL(accountStore.GetNumDirtyAccounts(), 0);
+  BOOST_CHECK_EQUAL(accountStore.GetNumNewContracts(), 0);
+
+  account = accountStore.GetAccount(contractAddr);
+  BOOST_REQUIRE(account != nullptr);
+  BOOST_CHECK(account->GetStorageRoot() == savedRoot);
+  const Json::Value storage = account->GetStorageJson();
+  BOOST_REQUIRE(storage.isArray() && !storage.empty());
+  BOOST_CHECK_EQUAL(storage[0]["vname"].asString(), "count");
+  BOOST_CHECK_EQUAL(storage[0]["value"].asString(), "0");
+}
+
+BOOST_AUTO_TEST_CASE(initSoftClearsUnsavedChanges) {
+  INIT_STDOUT_LOGGER();
+
+  AccountStore& accountStore = AccountStore::GetInstance();
+  accountStore.Init();
+
+  Account contract(0, 0);
+  contract.SetCode(MakeCode());
+  accountStore.AddAccountDuringDeserialization(MakeAddress(4), contract, true);
+  accountStore.AddAccountDuringDeserialization(MakeAddress(5), {1, 0});
+  BOOST_CHECK_EQUAL(accountStore.GetNumDirtyAccounts(), 2);
+  BOOST_CHECK_EQUAL(accountStore.GetNumNewContracts(), 1);
+
+  accountStore.InitSoft();
+
+  BOOST_CHECK_EQUAL(accountStore.GetNumDirtyAccounts(), 0);
+  BOOST_CHECK_EQUAL(accountStore.GetNumNewContracts(), 0);
+}
+
 BOOST_AUTO_TEST_CASE(commitAndRollback) {
   INIT_STDOUT_LOGGER();
 
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <vector>
+#include "libData/BlockChainData/BlockStatsIndex.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE blockstatsindextest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(blockstatsindextest)
+
+BOOST_AUTO_TEST_CASE(test_ranges) {
+  INIT_STDOUT_LOGGER();
+
+  BlockStatsIndex stats;
+  uint64_t first = 0, last = 0;
+  BOOST_CHECK(!stats.GetRange(first, last));
+  BOOST_CHECK_EQUAL(stats.GetNumTxsAfter(0), 0);
+
+  // Block i carries i txns, 10 * i gas and was mined at time 100 * i
+  for (uint64_t i = 0; i <= 10; i++) {
+    stats.Add(i, 100 * i, i, 10 * i, i / 4);
+  }
+
+  BOOST_CHECK(stats.GetRange(first, last));
+  BOOST_CHECK_EQUAL(first, 0);
+  BOOST_CHECK_EQUAL(last, 10);
+  BOOST_CHECK_EQUAL(stats.GetNumTxsAfter(0), 55);
+  BOOST_CHECK_EQUAL(stats.GetNumTxsAfter(7), 8 + 9 + 10);
+  BOOST_CHECK_EQUAL(stats.GetNumTxsAfter(10), 0);
+  BOOST_CHECK_EQUAL(stats.GetNumTxsAfter(20), 0);
+  BOOST_CHECK(stats.GetGasUsedAfter(5) == 10 * (6 + 7 + 8 + 9 + 10));
+
+  uint64_t timestamp = 0;
+  BOOST_CHECK(stats.GetTimestamp(3, timestamp));
+  BOOST_CHECK_EQUAL(timestamp, 300);
+  BOOST_CHECK(!stats.GetTimestamp(11, timestamp));
+
+  // Blocks 8 to 10 are in DS epoch 2
+  BOOST_CHECK_EQUAL(stats.GetNumTxsInLastDSEpoch(), 8 + 9 + 10);
+
+  stats.Reset();
+  BOOST_CHECK(!stats.GetRange(first, last));
+}
+
+BOOST_AUTO_TEST_CASE(test_rewrite_and_gap) {
+  INIT_STDOUT_LOGGER();
+
+  BlockStatsIndex stats;
+  for (uint64_t i = 5; i <= 9; i++) {
+    stats.Add(i, 100 * i, 1);
+  }
+
+  // Starting mid-chain only the indexed blocks are counted
+  BOOST_CHECK_EQUAL(stats.GetNumTxsAfter(0), 5);
+  BOOST_CHECK_EQUAL(stats.GetNumTxsInLastDSEpoch(), 5);
+
+  // Re-adding block 8 drops block 9
+  stats.Add(8, 800, 3);
+  uint64_t first = 0, last = 0;
+  BOOST_CHECK(stats.GetRange(first, last));
+  BOOST_CHECK_EQUAL(last, 8);
+  BOOST_CHECK_EQUAL(stats.GetNumTxsAfter(6), 1 + 3);
+
+  // A gap restarts the index
+  stats.Add(12, 1200, 4);
+  BOOST_CHECK(stats.GetRange(first, last));
+  BOOST_CHECK_EQUAL(first, 12);
+  BOOST_CHECK_EQUAL(last, 12);
+  BOOST_CHECK_EQUAL(stats.GetNumTxsAfter(0), 4);
+}
+
+BOOST_AUTO_TEST_CASE(test_seed_and_serialize) {
+  INIT_STDOUT_LOGGER();
+
+  BlockStatsIndex stats;
+  for (uint64_t i = 0; i <= 5; i++) {
+    stats.Add(i, 100 * i, i, 10 * i, i / 4);
+  }
+
+  // The stored entry of block 5 round-trips
+  BlockStatsIndex::Entry entry{};
+  BOOST_CHECK(stats.GetEntry(5, entry));
+  vector<unsigned char> stored;
+  entry.Serialize(stored);
+  BOOST_CHECK(stored.size() == BlockStatsIndex::Entry::SIZE);
+
+  BlockStatsIndex::Entry loaded{};
+  BOOST_CHECK(loaded.Deserialize(stored));
+  BOOST_CHECK_EQUAL(loaded.m_cumNumTxs, 15);
+  BOOST_CHECK(loaded.m_cumGasUsed == 150);
+  BOOST_CHECK_EQUAL(loaded.m_timestamp, 500);
+  BOOST_CHECK_EQUAL(loaded.m_dsBlockNum, 1);
+  BOOST_CHECK_EQUAL(loaded.m_dsEpochStartNumTxs, 0 + 1 + 2 + 3);
+  stored.pop_back();
+  BOOST_CHECK(!loaded.Deserialize(stored));
+
+  // A restarted index seeded from it continues the counters of blocks 0 to 5
+  BlockStatsIndex restarted;
+  restarted.Seed(5, entry);
+  for (uint64_t i = 6; i <= 10; i++) {
+    restarted.Add(i, 100 * i, i, 10 * i, i / 4);
+    stats.Add(i, 100 * i, i, 10 * i, i / 4);
+  }
+
+  uint64_t first = 0, last = 0;
+  BOOST_CHECK(restarted.GetRange(first, last));
+  BOOST_CHECK_EQUAL(first, 5);
+  BOOST_CHECK_EQUAL(last, 10);
+  BOOST_CHECK_EQUAL(restarted.GetNumTxsAfter(0), stats.GetNumTxsAfter(0));
+  BOOST_CHECK_EQUAL(restarted.GetNumTxsAfter(7), stats.GetNumTxsAfter(7));
+  BOOST_CHECK(restarted.GetGasUsedAfter(5) == stats.GetGasUsedAfter(5));
+  BOOST_CHECK_EQUAL(restarted.GetNumTxsInLastDSEpoch(),
+                    stats.GetNumTxsInLastDSEpoch());
+
+  // DS epoch 1 started before the seeded block
+  restarted.Seed(5, entry);
+  restarted.Add(6, 600, 6, 60, 1);
+  BOOST_CHECK_EQUAL(restarted.GetNumTxsInLastDSEpoch(), 4 + 5 + 6);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
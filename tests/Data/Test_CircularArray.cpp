@@ -69,4 +69,25 @@ BOOST_AUTO_TEST_CASE(CircularArray_test) {
   BOOST_CHECK_MESSAGE(arr[103] == 2, "arr[103] != 2!");
 }
 
+BOOST_AUTO_TEST_CASE(CircularArray_skip_test) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  CircularArray<int> arr;
+  arr.resize(10);
+
+  // Only the tail of a 1000 element sequence is inserted
+  arr.skip(990);
+  BOOST_CHECK_MESSAGE(arr.size() == 990, "arr.size() != 990!");
+
+  for (int i = 990; i < 1000; i++) {
+    arr.insert_new(arr.size(), i);
+  }
+
+  BOOST_CHECK_MESSAGE(arr.size() == 1000, "arr.size() != 1000!");
+  BOOST_CHECK_MESSAGE(arr[995] == 995, "arr[995] != 995!");
+  BOOST_CHECK_MESSAGE(arr.back() == 999, "arr.back() != 999!");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <map>
+#include <vector>
+#include "libCrypto/Schnorr.h"
+#include "libData/AccountData/TxnPool.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE txnpooltest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace boost::multiprecision;
+using namespace std;
+
+namespace {
+
+Transaction MakeTxn(unsigned char id, const PubKey& sender, uint64_t nonce,
+                    const uint128_t& gasPrice) {
+  TxnHash tranID;
+  tranID.asArray().at(0) = id;
+  return Transaction(tranID, 0, nonce, Address(), sender, 0, gasPrice, 1, {},
+                     {}, Signature());
+}
+
+// Takes txns until none is executable, applying each to the account nonces
+vector<unsigned char> Drain(TxnPool& pool, map<Address, uint64_t>& nonces) {
+  auto getNonce = [&nonces](const Address& addr) -> uint128_t {
+    return nonces[addr];
+  };
+
+  vector<unsigned char> ids;
+  Transaction t;
+  while (pool.findOne(t, getNonce)) {
+    ids.emplace_back(t.GetTranID().asArray().at(0));
+    nonces[t.GetSenderAddr()] = t.GetNonce();
+  }
+  return ids;
+}
+
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(txnpooltest)
+
+BOOST_AUTO_TEST_CASE(test_order) {
+  INIT_STDOUT_LOGGER();
+
+  const PubKey sender1 = Schnorr::GetInstance().GenKeyPair().second;
+  const PubKey sender2 = Schnorr::GetInstance().GenKeyPair().second;
+
+  TxnPool pool;
+  BOOST_CHECK(pool.insert(MakeTxn(3, sender1, 1, 10)));
+  BOOST_CHECK(pool.insert(MakeTxn(1, sender1, 2, 20)));
+  BOOST_CHECK(pool.insert(MakeTxn(2, sender2, 1, 20)));
+  BOOST_CHECK(!pool.insert(MakeTxn(2, sender2, 1, 20)));
+  BOOST_CHECK_EQUAL(pool.size(), 3);
+
+  // Highest gas price first among the sender heads, the next txn of a sender
+  // only becomes a candidate once its head is taken
+  map<Address, uint64_t> nonces;
+  BOOST_CHECK(Drain(pool, nonces) == vector<unsigned char>({2, 3, 1}));
+  BOOST_CHECK_EQUAL(pool.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_same_nonce) {
+  INIT_STDOUT_LOGGER();
+
+  const PubKey sender = Schnorr::GetInstance().GenKeyPair().second;
+
+  TxnPool pool;
+  BOOST_CHECK(pool.insert(MakeTxn(1, sender, 1, 10)));
+
+  // A lower price is ignored, a higher one replaces the pooled txn
+  BOOST_CHECK(pool.insert(MakeTxn(2, sender, 1, 5)));
+  BOOST_CHECK(!pool.exist(MakeTxn(2, sender, 1, 5).GetTranID()));
+  BOOST_CHECK(pool.insert(MakeTxn(3, sender, 1, 30)));
+  BOOST_CHECK(pool.exist(MakeTxn(3, sender, 1, 30).GetTranID()));
+  BOOST_CHECK(!pool.exist(MakeTxn(1, sender, 1, 10).GetTranID()));
+  BOOST_CHECK_EQUAL(pool.size(), 1);
+
+  map<Address, uint64_t> nonces;
+  BOOST_CHECK(Drain(pool, nonces) == vector<unsigned char>({3}));
+}
+
+BOOST_AUTO_TEST_CASE(test_nonce_gap) {
+  INIT_STDOUT_LOGGER();
+
+  const PubKey sender1 = Schnorr::GetInstance().GenKeyPair().second;
+  const PubKey sender2 = Schnorr::GetInstance().GenKeyPair().second;
+  const Address addr1 = MakeTxn(0, sender1, 0, 0).GetSenderAddr();
+
+  TxnPool pool;
+  BOOST_CHECK(pool.insert(MakeTxn(1, sender1, 3, 50)));
+  BOOST_CHECK(pool.insert(MakeTxn(2, sender1, 2, 40)));
+  BOOST_CHECK(pool.insert(MakeTxn(3, sender2, 1, 10)));
+
+  // sender1 misses nonce 1 and is skipped in spite of its higher prices
+  map<Address, uint64_t> nonces;
+  BOOST_CHECK(Drain(pool, nonces) == vector<unsigned char>({3}));
+  BOOST_CHECK_EQUAL(pool.size(), 2);
+
+  // The missing nonce unblocks the sender
+  BOOST_CHECK(pool.insert(MakeTxn(4, sender1, 1, 5)));
+  BOOST_CHECK(Drain(pool, nonces) == vector<unsigned char>({4, 2, 1}));
+  BOOST_CHECK_EQUAL(pool.size(), 0);
+
+  // A sender stays blocked until the round ends, even if its account nonce
+  // moves on meanwhile
+  BOOST_CHECK(pool.insert(MakeTxn(5, sender1, 6, 10)));
+  BOOST_CHECK(Drain(pool, nonces).empty());
+  nonces[addr1] = 5;
+  BOOST_CHECK(Drain(pool, nonces).empty());
+  pool.unblockSenders();
+  BOOST_CHECK(Drain(pool, nonces) == vector<unsigned char>({5}));
+
+  // Txns already applied are dropped
+  BOOST_CHECK(pool.insert(MakeTxn(6, sender1, 6, 10)));
+  BOOST_CHECK(pool.insert(MakeTxn(7, sender1, 7, 10)));
+  BOOST_CHECK(Drain(pool, nonces) == vector<unsigned char>({7}));
+  BOOST_CHECK_EQUAL(pool.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(test_get) {
+  INIT_STDOUT_LOGGER();
+
+  const PubKey sender = Schnorr::GetInstance().GenKeyPair().second;
+  const Transaction txn = MakeTxn(1, sender, 1, 10);
+
+  TxnPool pool;
+  BOOST_CHECK(pool.insert(txn));
+
+  Transaction t;
+  BOOST_CHECK(pool.get(txn.GetTranID(), t));
+  BOOST_CHECK_EQUAL(t.GetNonce(), 1);
+
+  pool.clear();
+  BOOST_CHECK_EQUAL(pool.size(), 0);
+  BOOST_CHECK(!pool.get(txn.GetTranID(), t));
+}
+
+BOOST_AUTO_TEST_CASE(test_eviction) {
+  INIT_STDOUT_LOGGER();
+
+  vector<PubKey> senders;
+  for (unsigned int i = 0; i < 4; i++) {
+    senders.emplace_back(Schnorr::GetInstance().GenKeyPair().second);
+  }
+
+  TxnPool pool(2);
+  BOOST_CHECK(pool.insert(MakeTxn(1, senders[0], 1, 10)));
+  BOOST_CHECK(pool.insert(MakeTxn(2, senders[1], 1, 20)));
+
+  // The cheapest txn is refused while the pool is full
+  BOOST_CHECK(!pool.insert(MakeTxn(3, senders[2], 1, 5)));
+  BOOST_CHECK(pool.insert(MakeTxn(4, senders[3], 1, 30)));
+  BOOST_CHECK_EQUAL(pool.size(), 2);
+  BOOST_CHECK(!pool.exist(MakeTxn(1, senders[0], 1, 10).GetTranID()));
+
+  map<Address, uint64_t> nonces;
+  BOOST_CHECK(Drain(pool, nonces) == vector<unsigned char>({4, 2}));
+}
+
+BOOST_AUTO_TEST_CASE(test_churn) {
+  INIT_STDOUT_LOGGER();
+
+  vector<PubKey> senders;
+  for (unsigned int i = 0; i < 8; i++) {
+    senders.emplace_back(Schnorr::GetInstance().GenKeyPair().second);
+  }
+
+  // Stale heap entries must never surface after repeated replacements
+  TxnPool pool;
+  unsigned char id = 0;
+  for (unsigned int round = 1; round <= 20; round++) {
+    for (const auto& sender : senders) {
+      BOOST_CHECK(pool.insert(MakeTxn(++id, sender, 1, round)));
+    }
+  }
+  BOOST_CHECK_EQUAL(pool.size(), senders.size());
+
+  map<Address, uint64_t> nonces;
+  const vector<unsigned char> ids = Drain(pool, nonces);
+  BOOST_CHECK_EQUAL(ids.size(), senders.size());
+  for (const auto& i : ids) {
+    BOOST_CHECK_GT(i, id - senders.size());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
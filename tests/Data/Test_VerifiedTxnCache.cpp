@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <cstring>
+#include <vector>
+#include "common/Constants.h"
+#include "libData/AccountData/VerifiedTxnCache.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE verifiedtxncachetest
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(verifiedtxncachetest)
+
+BOOST_AUTO_TEST_CASE(test_contains) {
+  INIT_STDOUT_LOGGER();
+
+  VerifiedTxnCache& cache = VerifiedTxnCache::GetInstance();
+  cache.Clear();
+
+  TxnHash tranID;
+  tranID.asArray().at(0) = 1;
+  const vector<unsigned char> signature{1, 2, 3};
+
+  BOOST_CHECK(!cache.Contains(tranID, signature));
+  cache.Add(tranID, signature);
+  BOOST_CHECK(cache.Contains(tranID, signature));
+
+  // The same ID with another signature has not been verified
+  BOOST_CHECK(!cache.Contains(tranID, {1, 2, 4}));
+}
+
+BOOST_AUTO_TEST_CASE(test_capacity) {
+  INIT_STDOUT_LOGGER();
+
+  VerifiedTxnCache& cache = VerifiedTxnCache::GetInstance();
+  cache.Clear();
+
+  const vector<unsigned char> signature{1, 2, 3};
+  auto makeID = [](unsigned int i) {
+    TxnHash tranID;
+    memcpy(tranID.data(), &i, sizeof(i));
+    return tranID;
+  };
+
+  for (unsigned int i = 0; i <= VERIFIED_TXN_CACHE_SIZE; i++) {
+    cache.Add(makeID(i), signature);
+  }
+
+  // Only the oldest entry is dropped
+  BOOST_CHECK(!cache.Contains(makeID(0), signature));
+  BOOST_CHECK(cache.Contains(makeID(1), signature));
+  BOOST_CHECK(cache.Contains(makeID(VERIFIED_TXN_CACHE_SIZE), signature));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include "libCrypto/Schnorr.h"
+#include "libDirectoryService/DirectoryService.h"
+#include "libUtils/HashUtils.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+const unsigned int NODES_PER_SHARD = 600;
+
+// Sorts N PoW submissions and verifies a correctly ordered sharding structure
+// built from them, for N from 600 to 20000
+int main() {
+  INIT_STDOUT_LOGGER();
+
+  const vector<unsigned int> numSubmissions{600, 2000, 5000, 10000, 20000};
+  const vector<unsigned char> lastBlockHash(BLOCK_HASH_SIZE, 1);
+
+  vector<PubKey> keys;
+  for (unsigned int i = 0; i < numSubmissions.back(); i++) {
+    keys.emplace_back(Schnorr::GetInstance().GenKeyPair().second);
+  }
+
+  for (const auto& n : numSubmissions) {
+    MapOfPubKeyPoW pows;
+    for (unsigned int i = 0; i < n; i++) {
+      array<unsigned char, 32> result{};
+      const unsigned int r = i * 2654435761u;
+      copy_n(reinterpret_cast<const unsigned char*>(&r), sizeof(r),
+             result.begin());
+      pows.emplace(keys[i], PoWSolution(i, result, result, 0, 0));
+    }
+
+    auto start = chrono::steady_clock::now();
+    VectorOfPoWSoln sortedPoWSolns = DirectoryService::SortPoWSoln(pows);
+    auto sorted = chrono::steady_clock::now();
+
+    // Order the nodes the way the DS leader does
+    vector<pair<vector<unsigned char>, PubKey>> ordering;
+    vector<unsigned char> hashVec(lastBlockHash);
+    hashVec.resize(BLOCK_HASH_SIZE + BLOCK_HASH_SIZE);
+    for (const auto& soln : sortedPoWSolns) {
+      copy(soln.first.begin(), soln.first.end(),
+           hashVec.begin() + BLOCK_HASH_SIZE);
+      ordering.emplace_back(HashUtils::BytesToHash(hashVec), soln.second);
+    }
+    sort(ordering.begin(), ordering.end());
+
+    DequeOfShard shards;
+    for (unsigned int i = 0; i < ordering.size(); i++) {
+      if (i % NODES_PER_SHARD == 0) {
+        shards.emplace_back();
+      }
+      shards.back().emplace_back(ordering[i].second, Peer(), 0);
+    }
+
+    auto built = chrono::steady_clock::now();
+    uint32_t misorderNodes = 0;
+    bool result = DirectoryService::VerifyPoWOrderingCore(
+        shards, sortedPoWSolns, MapOfPubKeyPoW(), lastBlockHash, misorderNodes);
+    auto verified = chrono::steady_clock::now();
+
+    cout << n << " submissions: sort "
+         << chrono::duration_cast<chrono::microseconds>(sorted - start).count()
+         << " us, verify "
+         << chrono::duration_cast<chrono::microseconds>(verified - built)
+                .count()
+         << " us, " << (result ? "ok" : "failed") << ", " << misorderNodes
+         << " misordered" << endl;
+  }
+
+  return 0;
+}
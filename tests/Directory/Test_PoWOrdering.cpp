@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+#include "libConsensus/ConsensusCommon.h"
+#include "libCrypto/Schnorr.h"
+#include "libDirectoryService/DirectoryService.h"
+#include "libUtils/HashUtils.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE powordering
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+using IsShardGuard = function<bool(const PubKey&)>;
+
+// The map based sorting that SortAndTrimPoWSoln replaced, kept as the
+// reference its output must match.
+VectorOfPoWSoln RefSortPoWSoln(const MapOfPubKeyPoW& mapOfPoWs,
+                               unsigned int commSize,
+                               const IsShardGuard& isShardGuard) {
+  map<array<unsigned char, 32>, PubKey> PoWOrderSorter;
+  for (const auto& powsoln : mapOfPoWs) {
+    PoWOrderSorter[powsoln.second.result] = powsoln.first;
+  }
+
+  VectorOfPoWSoln sortedPoWSolns;
+  if (commSize > 0) {
+    const unsigned int numNodesTotal = PoWOrderSorter.size();
+    const unsigned int numNodesTrimmed =
+        (numNodesTotal < commSize) ? numNodesTotal
+                                   : numNodesTotal - (numNodesTotal % commSize);
+
+    unsigned int count = 0;
+    if (!isShardGuard) {
+      for (auto kv = PoWOrderSorter.begin();
+           (kv != PoWOrderSorter.end()) && (count < numNodesTrimmed);
+           kv++, count++) {
+        sortedPoWSolns.emplace_back(*kv);
+      }
+    } else {
+      unsigned int trimmedGuardCount =
+          ceil(numNodesTrimmed * ConsensusCommon::TOLERANCE_FRACTION);
+      unsigned int trimmedNonGuardCount = numNodesTrimmed - trimmedGuardCount;
+
+      if (trimmedGuardCount + trimmedNonGuardCount < numNodesTrimmed) {
+        trimmedGuardCount +=
+            (numNodesTrimmed - trimmedGuardCount - trimmedNonGuardCount);
+      }
+
+      map<array<unsigned char, 32>, PubKey> FilteredPoWOrderSorter;
+      map<array<unsigned char, 32>, PubKey> ShadowPoWOrderSorter =
+          PoWOrderSorter;
+
+      for (auto kv = PoWOrderSorter.begin();
+           (kv != PoWOrderSorter.end()) && (count < numNodesTrimmed); kv++) {
+        if (isShardGuard(kv->second)) {
+          if (count == trimmedGuardCount) {
+            break;
+          }
+          FilteredPoWOrderSorter.emplace(*kv);
+          ShadowPoWOrderSorter.erase(kv->first);
+          count++;
+        }
+      }
+
+      for (auto kv = ShadowPoWOrderSorter.begin();
+           (kv != ShadowPoWOrderSorter.end()) && (count < numNodesTrimmed);
+           kv++) {
+        FilteredPoWOrderSorter.emplace(*kv);
+        count++;
+      }
+
+      for (auto kv : FilteredPoWOrderSorter) {
+        sortedPoWSolns.emplace_back(kv);
+      }
+    }
+  } else {
+    for (const auto& kv : PoWOrderSorter) {
+      sortedPoWSolns.emplace_back(kv);
+    }
+  }
+
+  return sortedPoWSolns;
+}
+
+// The linear search based ordering check that VerifyPoWOrderingCore replaced
+bool RefVerifyPoWOrdering(const DequeOfShard& shards,
+                          const VectorOfPoWSoln& sortedPoWSolns,
+                          const MapOfPubKeyPoW& allPoWsFromTheLeader,
+                          const vector<unsigned char>& lastBlockHash,
+                          uint32_t& misorderNodes) {
+  set<PubKey> keyset;
+  vector<unsigned char> hashVec(BLOCK_HASH_SIZE + BLOCK_HASH_SIZE);
+  copy(lastBlockHash.begin(), lastBlockHash.end(), hashVec.begin());
+  bool ret = true;
+  vector<unsigned char> vec(BLOCK_HASH_SIZE), preVec(BLOCK_HASH_SIZE);
+  misorderNodes = 0;
+  for (const auto& shard : shards) {
+    for (const auto& shardNode : shard) {
+      const PubKey& toFind = get<SHARD_NODE_PUBKEY>(shardNode);
+      auto it = find_if(sortedPoWSolns.cbegin(), sortedPoWSolns.cend(),
+                        [&toFind](const VectorOfPoWSoln::value_type& item) {
+                          return item.second == toFind;
+                        });
+
+      array<unsigned char, 32> result;
+      if (it == sortedPoWSolns.cend()) {
+        auto itLeaderMap = allPoWsFromTheLeader.find(toFind);
+        if (itLeaderMap != allPoWsFromTheLeader.end()) {
+          result = itLeaderMap->second.result;
+        } else {
+          ret = false;
+          break;
+        }
+      } else {
+        result = it->first;
+      }
+
+      if (!keyset.insert(toFind).second) {
+        ret = false;
+        break;
+      }
+
+      copy(result.begin(), result.end(), hashVec.begin() + BLOCK_HASH_SIZE);
+      const vector<unsigned char>& sortHashVec =
+          HashUtils::BytesToHash(hashVec);
+      if (sortHashVec < vec) {
+        ++misorderNodes;
+        vec = preVec;
+        continue;
+      }
+      preVec = vec;
+      vec = sortHashVec;
+    }
+    if (!ret) {
+      break;
+    }
+  }
+  return ret;
+}
+
+vector<PubKey> GenKeys(unsigned int n) {
+  vector<PubKey> keys;
+  for (unsigned int i = 0; i < n; i++) {
+    keys.emplace_back(Schnorr::GetInstance().GenKeyPair().second);
+  }
+  return keys;
+}
+
+// Gives each key a solution whose first byte is drawn from [0, spread), so a
+// small spread makes many keys share a solution
+MapOfPubKeyPoW GenPoWs(const vector<PubKey>& keys, unsigned int spread,
+                       mt19937& rng) {
+  MapOfPubKeyPoW pows;
+  for (unsigned int i = 0; i < keys.size(); i++) {
+    array<unsigned char, 32> result{};
+    result[0] = rng() % spread;
+    if (spread > 256) {
+      result[1] = rng() % 256;
+      result[2] = rng() % 256;
+    }
+    pows.emplace(keys[i], PoWSolution(i, result, result, 0, 0));
+  }
+  return pows;
+}
+
+void CheckSortMatches(const MapOfPubKeyPoW& pows, unsigned int commSize,
+                      const IsShardGuard& isShardGuard) {
+  const VectorOfPoWSoln expected =
+      RefSortPoWSoln(pows, commSize, isShardGuard);
+  const VectorOfPoWSoln actual =
+      DirectoryService::SortAndTrimPoWSoln(pows, commSize, isShardGuard);
+  BOOST_CHECK_MESSAGE(expected == actual,
+                      "Sorted solutions differ for " << pows.size()
+                                                     << " submissions and "
+                                                        "committee size "
+                                                     << commSize);
+}
+
+// Orders the nodes the way the DS leader does and splits them into shards
+DequeOfShard BuildShards(const VectorOfPoWSoln& sortedPoWSolns,
+                         const vector<unsigned char>& lastBlockHash,
+                         unsigned int shardSize) {
+  vector<pair<vector<unsigned char>, PubKey>> ordering;
+  vector<unsigned char> hashVec(lastBlockHash);
+  hashVec.resize(BLOCK_HASH_SIZE + BLOCK_HASH_SIZE);
+  for (const auto& soln : sortedPoWSolns) {
+    copy(soln.first.begin(), soln.first.end(),
+         hashVec.begin() + BLOCK_HASH_SIZE);
+    ordering.emplace_back(HashUtils::BytesToHash(hashVec), soln.second);
+  }
+  sort(ordering.begin(), ordering.end());
+
+  DequeOfShard shards;
+  for (unsigned int i = 0; i < ordering.size(); i++) {
+    if (i % shardSize == 0) {
+      shards.emplace_back();
+    }
+    shards.back().emplace_back(ordering[i].second, Peer(), 0);
+  }
+  return shards;
+}
+
+void CheckVerifyMatches(const DequeOfShard& shards,
+                        const VectorOfPoWSoln& sortedPoWSolns,
+                        const MapOfPubKeyPoW& allPoWsFromTheLeader,
+                        const vector<unsigned char>& lastBlockHash,
+                        bool expectedRet) {
+  uint32_t expectedMisorder = 0, actualMisorder = 0;
+  BOOST_CHECK_EQUAL(
+      RefVerifyPoWOrdering(shards, sortedPoWSolns, allPoWsFromTheLeader,
+                           lastBlockHash, expectedMisorder),
+      expectedRet);
+  BOOST_CHECK_EQUAL(DirectoryService::VerifyPoWOrderingCore(
+                        shards, sortedPoWSolns, allPoWsFromTheLeader,
+                        lastBlockHash, actualMisorder),
+                    expectedRet);
+  BOOST_CHECK_EQUAL(actualMisorder, expectedMisorder);
+}
+
+BOOST_AUTO_TEST_SUITE(powordering)
+
+BOOST_AUTO_TEST_CASE(test_sort_duplicates) {
+  INIT_STDOUT_LOGGER();
+
+  mt19937 rng(1);
+  const vector<PubKey> keys = GenKeys(60);
+  const MapOfPubKeyPoW pows = GenPoWs(keys, 8, rng);
+
+  CheckSortMatches(pows, 0, nullptr);
+
+  // Of the keys sharing a solution, the last one in key order is kept
+  map<array<unsigned char, 32>, PubKey> lastKey;
+  for (const auto& kv : pows) {
+    lastKey[kv.second.result] = kv.first;
+  }
+  const VectorOfPoWSoln sorted =
+      DirectoryService::SortAndTrimPoWSoln(pows, 0, nullptr);
+  BOOST_REQUIRE_EQUAL(sorted.size(), lastKey.size());
+  for (const auto& soln : sorted) {
+    BOOST_CHECK(soln.second == lastKey[soln.first]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_sort_trim_without_guards) {
+  INIT_STDOUT_LOGGER();
+
+  mt19937 rng(2);
+  const vector<PubKey> keys = GenKeys(100);
+  for (const auto spread : {16u, 65536u}) {
+    const MapOfPubKeyPoW pows = GenPoWs(keys, spread, rng);
+    for (const auto commSize : {1u, 7u, 10u, 33u, 100u, 150u}) {
+      CheckSortMatches(pows, commSize, nullptr);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_sort_trim_with_guards) {
+  INIT_STDOUT_LOGGER();
+
+  mt19937 rng(3);
+  const vector<PubKey> keys = GenKeys(100);
+  const set<PubKey> guards{keys.begin(), keys.begin() + 30};
+  auto isShardGuard = [&guards](const PubKey& pubKey) {
+    return guards.find(pubKey) != guards.end();
+  };
+
+  for (const auto spread : {16u, 65536u}) {
+    const MapOfPubKeyPoW pows = GenPoWs(keys, spread, rng);
+    for (const auto commSize : {1u, 7u, 10u, 33u, 100u, 150u}) {
+      CheckSortMatches(pows, commSize, isShardGuard);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_sort_guard_overflow) {
+  INIT_STDOUT_LOGGER();
+
+  mt19937 rng(4);
+  const vector<PubKey> keys = GenKeys(100);
+  const set<PubKey> guards{keys.begin(), keys.begin() + 90};
+  auto isShardGuard = [&guards](const PubKey& pubKey) {
+    return guards.find(pubKey) != guards.end();
+  };
+
+  const MapOfPubKeyPoW pows = GenPoWs(keys, 65536, rng);
+  for (const auto commSize : {7u, 10u, 33u}) {
+    CheckSortMatches(pows, commSize, isShardGuard);
+
+    // More guards than the guard slots allow, so the guards left over compete
+    // with the other nodes for the remaining slots
+    const VectorOfPoWSoln sorted =
+        DirectoryService::SortAndTrimPoWSoln(pows, commSize, isShardGuard);
+    BOOST_CHECK_EQUAL(sorted.size(), pows.size() - (pows.size() % commSize));
+    BOOST_CHECK(is_sorted(sorted.begin(), sorted.end()));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_verify_ordering) {
+  INIT_STDOUT_LOGGER();
+
+  mt19937 rng(5);
+  const vector<unsigned char> lastBlockHash(BLOCK_HASH_SIZE, 1);
+  const vector<PubKey> keys = GenKeys(80);
+  const MapOfPubKeyPoW pows = GenPoWs(keys, 65536, rng);
+  const VectorOfPoWSoln sorted =
+      DirectoryService::SortAndTrimPoWSoln(pows, 0, nullptr);
+  const DequeOfShard shards = BuildShards(sorted, lastBlockHash, 20);
+
+  // Correct ordering
+  CheckVerifyMatches(shards, sorted, MapOfPubKeyPoW(), lastBlockHash, true);
+
+  // Misordered nodes, next to each other and far apart
+  DequeOfShard misordered = shards;
+  swap(misordered[0][3], misordered[0][4]);
+  swap(misordered[1][0], misordered[1][19]);
+  swap(misordered[2][5], misordered[3][5]);
+  CheckVerifyMatches(misordered, sorted, MapOfPubKeyPoW(), lastBlockHash,
+                     true);
+
+  // A key that appears twice in the sharding structure
+  DequeOfShard duplicated = shards;
+  duplicated[2][7] = duplicated[1][7];
+  CheckVerifyMatches(duplicated, sorted, MapOfPubKeyPoW(), lastBlockHash,
+                     false);
+
+  // A key missing from the sorted solutions but known to the leader
+  VectorOfPoWSoln partial = sorted;
+  const PubKey dropped = get<SHARD_NODE_PUBKEY>(shards[1][2]);
+  partial.erase(remove_if(partial.begin(), partial.end(),
+                          [&dropped](const VectorOfPoWSoln::value_type& soln) {
+                            return soln.second == dropped;
+                          }),
+                partial.end());
+  CheckVerifyMatches(shards, partial, pows, lastBlockHash, true);
+
+  // A key that nobody has a solution for
+  CheckVerifyMatches(shards, partial, MapOfPubKeyPoW(), lastBlockHash, false);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
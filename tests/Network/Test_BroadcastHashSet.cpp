@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include "libNetwork/BroadcastHashSet.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE broadcasthashset
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(broadcasthashset)
+
+BOOST_AUTO_TEST_CASE(test_insert) {
+  INIT_STDOUT_LOGGER();
+
+  BroadcastHashSet hashes(3);
+
+  for (unsigned int i = 0; i < 100; ++i) {
+    BOOST_CHECK_MESSAGE(hashes.Insert(dev::h256(i)),
+                        "New hash should be inserted!");
+  }
+
+  for (unsigned int i = 0; i < 200; ++i) {
+    BOOST_CHECK_MESSAGE(hashes.Contains(dev::h256(i)) == (i < 100),
+                        "Hash " << i << " lookup is wrong!");
+  }
+
+  for (unsigned int i = 0; i < 100; ++i) {
+    BOOST_CHECK_MESSAGE(!hashes.Insert(dev::h256(i)),
+                        "Duplicate hash should not be inserted!");
+  }
+
+  BOOST_CHECK_MESSAGE(hashes.Size() == 100, "Wrong number of hashes!");
+}
+
+BOOST_AUTO_TEST_CASE(test_expiry) {
+  INIT_STDOUT_LOGGER();
+
+  BroadcastHashSet hashes(3);
+
+  hashes.Insert(dev::h256(1));
+  hashes.Rotate();
+  hashes.Insert(dev::h256(2));
+  hashes.Rotate();
+
+  BOOST_CHECK_MESSAGE(hashes.Contains(dev::h256(1)),
+                      "Hash should survive two rotations!");
+  BOOST_CHECK_MESSAGE(!hashes.Insert(dev::h256(1)),
+                      "Unexpired hash should not be inserted again!");
+
+  hashes.Rotate();
+
+  BOOST_CHECK_MESSAGE(!hashes.Contains(dev::h256(1)),
+                      "Hash should expire after three rotations!");
+  BOOST_CHECK_MESSAGE(hashes.Contains(dev::h256(2)),
+                      "Newer hash should not expire yet!");
+  BOOST_CHECK_MESSAGE(hashes.Size() == 1, "Wrong number of hashes!");
+
+  BOOST_CHECK_MESSAGE(hashes.Insert(dev::h256(1)),
+                      "Expired hash should be inserted again!");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -18,206 +18,594 @@
  */
 
 #include <arpa/inet.h>
+#include <event2/event.h>
+#include <event2/thread.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
 #include <chrono>
-#include <iostream>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
 #include <vector>
+
+#include "common/Constants.h"
+#include "libNetwork/ConnectionPool.h"
 #include "libNetwork/P2PComm.h"
+#include "libNetwork/SendScheduler.h"
 #include "libUtils/DetachedFunction.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE p2pcomm
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_NO_MAIN
+#include <boost/test/unit_test.hpp>
 
 using namespace std;
-chrono::high_resolution_clock::time_point startTime;
-
-void process_message(pair<vector<unsigned char>, Peer>* message) {
-  LOG_MARKER();
-
-  if (message->first.size() < 10) {
-    LOG_GENERAL(INFO, "Received message '"
-                          << (char*)&message->first.at(0) << "' at port "
-                          << message->second.m_listenPortHost
-                          << " from address " << message->second.m_ipAddress);
-  } else {
-    chrono::duration<double, std::milli> time_span =
-        chrono::high_resolution_clock::now() - startTime;
-    LOG_GENERAL(INFO, "Received " << message->first.size() / (1024 * 1024)
-                                  << " MB message in " << time_span.count()
-                                  << " ms");
-    LOG_GENERAL(INFO, "Benchmark: " << (1000 * message->first.size()) /
-                                           (time_span.count() * 1024 * 1024)
-                                    << " MBps");
-  }
-
-  delete message;
-}
-
-static bool comparePairSecond(
-    const std::pair<std::vector<unsigned char>,
-                    chrono::time_point<chrono::system_clock>>& a,
-    const std::pair<std::vector<unsigned char>,
-                    chrono::time_point<chrono::system_clock>>& b) {
-  return a.second < b.second;
-}
-
-void TestRemoveBroadcast() {
-  LOG_MARKER();
-
-  static const unsigned int BROADCAST_INTERVAL = 5;
-  static const unsigned int BROADCAST_EXPIRY = 10;
-  static const unsigned int hashNum = 100000;
-  static set<vector<unsigned char>> broadcastHashes;
-  static mutex broadcastHashesMutex;
-  static deque<
-      pair<vector<unsigned char>, chrono::time_point<chrono::system_clock>>>
-      broadcastToRemoved;
-  static mutex broadcastToRemovedMutex;
-  static const chrono::time_point<chrono::system_clock> initTime =
-      chrono::system_clock::now();
-
-  LOG_GENERAL(INFO, "Start TestRemoveBroadcast, BROADCAST_INTERVAL = "
-                        << BROADCAST_INTERVAL
-                        << ", BROADCAST_EXPIRY = " << BROADCAST_EXPIRY
-                        << ", hashNum = " << hashNum << ".");
-
-  // Filled in broadcastHashes (hashNum)
-  auto FillHash = []() mutable -> void {
-    LOG_GENERAL(INFO, "Start to fill broadcastHashes...");
-
-    for (unsigned int i = 0; i < hashNum; ++i) {
-      lock_guard<mutex> g(broadcastHashesMutex);
-      string hash = to_string(i);
-      broadcastHashes.emplace(hash.begin(), hash.end());
-    }
 
-    LOG_GENERAL(INFO, "Finished fill " << broadcastHashes.size()
-                                       << " broadcastHashes.");
-  };
+namespace {
+const unsigned int PUMP_PORT = 30303;
+const unsigned int HDR_LEN = 6;
+const chrono::seconds WAIT_TIMEOUT(10);
 
-  DetachedFunction(1, FillHash);
-  this_thread::sleep_for(chrono::seconds(1));
+Peer LocalPeer(unsigned int port, const string& ip = "127.0.0.1") {
+  struct in_addr addr;
+  inet_aton(ip.c_str(), &addr);
+  return Peer(addr.s_addr, port);
+}
 
-  // Filled in broadcastToRemoved (hashNum / 2)
-  auto FillRemove = []() mutable -> void {
-    LOG_GENERAL(INFO, "Start to fill broadcastToRemoved...");
-    chrono::time_point<chrono::system_clock> currentTime = initTime;
-    for (unsigned int i = 0; i < hashNum; i += 2) {
-      lock_guard<mutex> g(broadcastToRemovedMutex);
-      string hash = to_string(i);
-      vector<unsigned char> hashS(hash.begin(), hash.end());
+vector<unsigned char> Header(unsigned char startByte, uint32_t length) {
+  return {(unsigned char)(MSG_VERSION & 0xFF),
+          startByte,
+          (unsigned char)(length >> 24),
+          (unsigned char)(length >> 16),
+          (unsigned char)(length >> 8),
+          (unsigned char)length};
+}
 
-      if (i > 0 && 0 == (i % 100)) {
-        currentTime += chrono::seconds(1);
-      }
+vector<unsigned char> Frame(const vector<unsigned char>& message) {
+  vector<unsigned char> frame = Header(START_BYTE_NORMAL, message.size());
+  frame.insert(frame.end(), message.begin(), message.end());
+  return frame;
+}
+
+vector<unsigned char> Message(size_t size, unsigned char seed) {
+  vector<unsigned char> message(size);
+  for (size_t i = 0; i < size; i++) {
+    message[i] = seed + i;
+  }
+  return message;
+}
+
+/// Returns a port nothing listens on, at least for the moment.
+unsigned int UnusedPort() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bind(fd, (struct sockaddr*)&addr, sizeof(addr));
+  socklen_t len = sizeof(addr);
+  getsockname(fd, (struct sockaddr*)&addr, &len);
+  close(fd);
+  return ntohs(addr.sin_port);
+}
 
-      broadcastToRemoved.emplace_back(hashS, currentTime);
+int ConnectTo(unsigned int port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+  if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  struct timeval timeout = {WAIT_TIMEOUT.count(), 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  return fd;
+}
+
+bool WriteAll(int fd, const unsigned char* data, size_t size) {
+  while (size > 0) {
+    ssize_t n = write(fd, data, size);
+    if (n <= 0) {
+      return false;
+    }
+    data += n;
+    size -= n;
+  }
+  return true;
+}
+
+/// Collects the messages P2PComm dispatches.
+class MessageQueue {
+  mutex m_mutex;
+  condition_variable m_cv;
+  deque<vector<unsigned char>> m_messages;
+
+ public:
+  void Push(vector<unsigned char>&& message) {
+    lock_guard<mutex> g(m_mutex);
+    m_messages.emplace_back(move(message));
+    m_cv.notify_all();
+  }
+
+  bool Pop(vector<unsigned char>& message,
+           const chrono::milliseconds& timeout) {
+    unique_lock<mutex> g(m_mutex);
+    if (!m_cv.wait_for(g, timeout, [this] { return !m_messages.empty(); })) {
+      return false;
     }
+    message = move(m_messages.front());
+    m_messages.pop_front();
+    return true;
+  }
+};
 
-    LOG_GENERAL(INFO, "Finished fill " << broadcastToRemoved.size()
-                                       << " broadcastToRemoved.");
-  };
+MessageQueue& Received() {
+  static MessageQueue queue;
+  return queue;
+}
 
-  DetachedFunction(1, FillRemove);
-  this_thread::sleep_for(chrono::seconds(1));
+/// Starts the P2PComm message pump once for the whole test module and waits
+/// until it accepts connections.
+bool StartPump() {
+  static bool started = [] {
+    auto dispatcher = [](pair<vector<unsigned char>, Peer>* message) {
+      Received().Push(move(message->first));
+      delete message;
+    };
+    auto func = [dispatcher]() mutable -> void {
+      P2PComm::GetInstance().StartMessagePump(PUMP_PORT, dispatcher, nullptr);
+    };
+    DetachedFunction(1, func);
+
+    for (unsigned int i = 0; i < 100; i++) {
+      int fd = ConnectTo(PUMP_PORT);
+      if (fd >= 0) {
+        close(fd);
+        return true;
+      }
+      this_thread::sleep_for(chrono::milliseconds(50));
+    }
+    return false;
+  }();
+  return started;
+}
 
-  auto RemoveChecking = []() mutable -> void {
-    LOG_GENERAL(INFO, "Start to remove hash, 100 seconds checking...");
+/// Plain socket server that records what each accepted connection receives.
+/// Connections are only read from once reading is enabled.
+class TestListener {
+  struct Connection {
+    int m_fd;
+    vector<unsigned char> m_data;
+  };
 
-    queue<unsigned int> answer;
-    answer.push(100000);
-    unsigned int cur = 99950;
+  int m_fd;
+  unsigned int m_port;
+  mutex m_mutex;
+  condition_variable m_cv;
+  bool m_reading;
+  bool m_stopping;
+  deque<Connection> m_connections;
+  thread m_acceptThread;
+  vector<thread> m_readThreads;
+
+  void Accept() {
+    while (true) {
+      int fd = accept(m_fd, nullptr, nullptr);
+      if (fd < 0) {
+        return;
+      }
 
-    for (unsigned int i = 0; i < 19; ++i) {
-      answer.push(cur);
-      cur -= 250;
+      lock_guard<mutex> g(m_mutex);
+      if (m_stopping) {
+        close(fd);
+        return;
+      }
+      m_connections.push_back({fd, {}});
+      m_readThreads.emplace_back(&TestListener::Read, this,
+                                 m_connections.size() - 1);
+      m_cv.notify_all();
     }
+  }
 
-    vector<unsigned char> emptyHash;
-    chrono::time_point<chrono::system_clock> currentTime = initTime;
+  void Read(size_t index) {
+    int fd = -1;
+    {
+      unique_lock<mutex> g(m_mutex);
+      m_cv.wait(g, [this] { return m_reading || m_stopping; });
+      fd = m_connections[index].m_fd;
+    }
 
+    unsigned char buffer[65536];
     while (true) {
-      this_thread::sleep_for(chrono::seconds(BROADCAST_INTERVAL));
-      currentTime += chrono::seconds(BROADCAST_INTERVAL);
-      lock(broadcastToRemovedMutex, broadcastHashesMutex);
-      lock_guard<mutex> g(broadcastToRemovedMutex, adopt_lock);
-      lock_guard<mutex> g2(broadcastHashesMutex, adopt_lock);
-
-      if (broadcastToRemoved.empty() ||
-          broadcastToRemoved.front().second >
-              currentTime - chrono::seconds(BROADCAST_EXPIRY)) {
-        LOG_GENERAL(INFO, "After " << chrono::duration_cast<chrono::seconds>(
-                                          currentTime - initTime)
-                                          .count()
-                                   << " seconds, broadcastHashes size remained "
-                                   << broadcastHashes.size());
-
-        LOG_GENERAL(INFO,
-                    "Checking " << ((answer.front() == broadcastHashes.size())
-                                        ? "PASS!"
-                                        : "FAILED!"));
-        answer.pop();
-        continue;
+      ssize_t n = read(fd, buffer, sizeof(buffer));
+      if (n <= 0) {
+        return;
       }
+      lock_guard<mutex> g(m_mutex);
+      auto& data = m_connections[index].m_data;
+      data.insert(data.end(), buffer, buffer + n);
+      m_cv.notify_all();
+    }
+  }
 
-      auto up = upper_bound(
-          broadcastToRemoved.begin(), broadcastToRemoved.end(),
-          make_pair(emptyHash, currentTime - chrono::seconds(BROADCAST_EXPIRY)),
-          comparePairSecond);
+ public:
+  /// Listens on all interfaces. A small receive buffer makes senders of
+  /// large messages wait for us to read.
+  TestListener(unsigned int port = 0, bool reading = true,
+               int receiveBuffer = 0)
+      : m_reading(reading), m_stopping(false) {
+    m_fd = socket(AF_INET, SOCK_STREAM, 0);
+    int enable = 1;
+    setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    if (receiveBuffer > 0) {
+      setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &receiveBuffer,
+                 sizeof(receiveBuffer));
+    }
 
-      for (auto it = broadcastToRemoved.begin(); it != up; ++it) {
-        broadcastHashes.erase(it->first);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    BOOST_REQUIRE(bind(m_fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+    BOOST_REQUIRE(listen(m_fd, 128) == 0);
+
+    socklen_t len = sizeof(addr);
+    getsockname(m_fd, (struct sockaddr*)&addr, &len);
+    m_port = ntohs(addr.sin_port);
+
+    m_acceptThread = thread(&TestListener::Accept, this);
+  }
+
+  ~TestListener() {
+    {
+      lock_guard<mutex> g(m_mutex);
+      m_stopping = true;
+      for (auto& conn : m_connections) {
+        shutdown(conn.m_fd, SHUT_RDWR);
       }
+      m_cv.notify_all();
+    }
+    shutdown(m_fd, SHUT_RDWR);
+
+    // Accept() may still add threads until it has returned
+    m_acceptThread.join();
+    for (auto& t : m_readThreads) {
+      t.join();
+    }
+
+    for (auto& conn : m_connections) {
+      close(conn.m_fd);
+    }
+    close(m_fd);
+  }
 
-      broadcastToRemoved.erase(broadcastToRemoved.begin(), up);
+  unsigned int Port() const { return m_port; }
 
-      LOG_GENERAL(INFO, "After " << chrono::duration_cast<chrono::seconds>(
-                                        currentTime - initTime)
-                                        .count()
-                                 << " seconds, broadcastHashes size reduce to "
-                                 << broadcastHashes.size());
+  size_t NumAccepted() {
+    lock_guard<mutex> g(m_mutex);
+    return m_connections.size();
+  }
 
-      LOG_GENERAL(INFO,
-                  "Checking " << ((answer.front() == broadcastHashes.size())
-                                      ? "PASS!"
-                                      : "FAILED!"));
+  void StartReading() {
+    lock_guard<mutex> g(m_mutex);
+    m_reading = true;
+    m_cv.notify_all();
+  }
 
-      answer.pop();
+  /// Waits until connection index has received at least size bytes.
+  vector<unsigned char> WaitForData(size_t index, size_t size) {
+    unique_lock<mutex> g(m_mutex);
+    m_cv.wait_for(g, WAIT_TIMEOUT, [this, index, size] {
+      return (index < m_connections.size()) &&
+             (m_connections[index].m_data.size() >= size);
+    });
+    return index < m_connections.size() ? m_connections[index].m_data
+                                        : vector<unsigned char>();
+  }
+
+  void CloseConnection(size_t index) {
+    lock_guard<mutex> g(m_mutex);
+    shutdown(m_connections.at(index).m_fd, SHUT_RDWR);
+  }
+};
+
+/// Runs an event loop for a ConnectionPool on its own thread.
+struct PoolFixture {
+  struct event_base* m_base;
+  ConnectionPool m_pool;
+  thread m_thread;
+
+  PoolFixture() {
+    BOOST_REQUIRE(evthread_use_pthreads() == 0);
+    m_base = event_base_new();
+    BOOST_REQUIRE(m_base != nullptr);
+    m_pool.SetEventBase(m_base);
+    m_thread = thread(
+        [this] { event_base_loop(m_base, EVLOOP_NO_EXIT_ON_EMPTY); });
+  }
+
+  ~PoolFixture() {
+    event_base_loopbreak(m_base);
+    m_thread.join();
+    m_pool.SetEventBase(nullptr);
+    event_base_free(m_base);
+  }
+
+  bool WaitForPoolSize(size_t size) {
+    auto deadline = chrono::steady_clock::now() + WAIT_TIMEOUT;
+    while (m_pool.Size() != size) {
+      if (chrono::steady_clock::now() > deadline) {
+        return false;
+      }
+      this_thread::sleep_for(chrono::milliseconds(10));
     }
-  };
+    return true;
+  }
 
-  DetachedFunction(1, RemoveChecking);
-  this_thread::sleep_for(chrono::seconds(100));
+  SendScheduler::Stats Schedule(vector<Peer>&& peers,
+                                const vector<unsigned char>& message,
+                                const function<void()>& whileSending = {}) {
+    auto result = make_shared<promise<SendScheduler::Stats>>();
+    future<SendScheduler::Stats> stats = result->get_future();
+    SendScheduler::Start(
+        m_pool, move(peers), Header(START_BYTE_NORMAL, message.size()),
+        make_shared<const vector<unsigned char>>(message),
+        [result](const SendScheduler::Stats& s) { result->set_value(s); });
+
+    if (whileSending) {
+      whileSending();
+    }
+
+    BOOST_REQUIRE(stats.wait_for(chrono::seconds(60)) ==
+                  future_status::ready);
+    return stats.get();
+  }
+};
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(p2pcomm)
+
+BOOST_AUTO_TEST_CASE(test_receive_back_to_back_frames) {
+  INIT_STDOUT_LOGGER();
+  BOOST_REQUIRE(StartPump());
+
+  const vector<vector<unsigned char>> messages = {
+      Message(1, 1), Message(5000, 2), Message(100, 3)};
+  vector<unsigned char> frames;
+  for (const auto& message : messages) {
+    const auto frame = Frame(message);
+    frames.insert(frames.end(), frame.begin(), frame.end());
+  }
+
+  // All frames in a single write on one connection
+  int fd = ConnectTo(PUMP_PORT);
+  BOOST_REQUIRE(fd >= 0);
+  BOOST_REQUIRE(WriteAll(fd, frames.data(), frames.size()));
+
+  for (const auto& expected : messages) {
+    vector<unsigned char> message;
+    BOOST_REQUIRE_MESSAGE(Received().Pop(message, WAIT_TIMEOUT),
+                          "Frame of " << expected.size() << " bytes lost!");
+    BOOST_CHECK_MESSAGE(message == expected, "Frames out of order!");
+  }
+
+  close(fd);
 }
 
-int main() {
+BOOST_AUTO_TEST_CASE(test_receive_partial_frames) {
   INIT_STDOUT_LOGGER();
+  BOOST_REQUIRE(StartPump());
+
+  const vector<unsigned char> expected = Message(100000, 4);
+  const vector<unsigned char> frame = Frame(expected);
+  const size_t splits[] = {3, HDR_LEN + 1, HDR_LEN + expected.size() / 2,
+                           frame.size()};
+
+  int fd = ConnectTo(PUMP_PORT);
+  BOOST_REQUIRE(fd >= 0);
+
+  // Nothing is dispatched until the last piece of the frame is in
+  size_t written = 0;
+  vector<unsigned char> message;
+  for (size_t split : splits) {
+    BOOST_CHECK_MESSAGE(!Received().Pop(message, chrono::milliseconds(200)),
+                        "Message dispatched after " << written << " bytes!");
+    BOOST_REQUIRE(WriteAll(fd, frame.data() + written, split - written));
+    written = split;
+  }
 
-  auto func = []() mutable -> void {
-    P2PComm::GetInstance().StartMessagePump(30303, process_message, nullptr);
-  };
+  BOOST_REQUIRE_MESSAGE(Received().Pop(message, WAIT_TIMEOUT),
+                        "Message lost!");
+  BOOST_CHECK_MESSAGE(message == expected, "Message corrupted!");
 
-  DetachedFunction(1, func);
+  close(fd);
+}
 
-  this_thread::sleep_for(chrono::seconds(1));  // short delay to prepare socket
+BOOST_AUTO_TEST_CASE(test_receive_oversized_frame) {
+  INIT_STDOUT_LOGGER();
+  BOOST_REQUIRE(StartPump());
+
+  int fd = ConnectTo(PUMP_PORT);
+  BOOST_REQUIRE(fd >= 0);
+
+  // Rejected on the header alone, without waiting for the body
+  const vector<unsigned char> header =
+      Header(START_BYTE_NORMAL, MAX_MESSAGE_SIZE_IN_BYTES + 1);
+  BOOST_REQUIRE(WriteAll(fd, header.data(), header.size()));
+
+  unsigned char byte;
+  BOOST_CHECK_MESSAGE(read(fd, &byte, 1) == 0,
+                      "Connection not closed after oversized frame!");
+  close(fd);
+
+  vector<unsigned char> message;
+  BOOST_CHECK_MESSAGE(!Received().Pop(message, chrono::milliseconds(200)),
+                      "Oversized frame dispatched!");
+
+  // Other connections are not affected
+  const vector<unsigned char> expected = Message(10, 5);
+  const vector<unsigned char> frame = Frame(expected);
+  fd = ConnectTo(PUMP_PORT);
+  BOOST_REQUIRE(fd >= 0);
+  BOOST_REQUIRE(WriteAll(fd, frame.data(), frame.size()));
+  BOOST_REQUIRE(Received().Pop(message, WAIT_TIMEOUT));
+  BOOST_CHECK(message == expected);
+  close(fd);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_pool_back_to_back_frames, PoolFixture) {
+  INIT_STDOUT_LOGGER();
+
+  TestListener listener;
+  const Peer peer = LocalPeer(listener.Port());
+
+  atomic<unsigned int> sent(0);
+  vector<unsigned char> expected;
+  for (unsigned char i = 0; i < 3; i++) {
+    const auto message = Message(1000 * (i + 1), i);
+    const auto header = Header(START_BYTE_NORMAL, message.size());
+    BOOST_REQUIRE(m_pool.Send(
+        peer, header, make_shared<const vector<unsigned char>>(message),
+        [&sent](bool ok) { sent += ok; }));
+    expected.insert(expected.end(), header.begin(), header.end());
+    expected.insert(expected.end(), message.begin(), message.end());
+  }
+
+  BOOST_CHECK_MESSAGE(listener.WaitForData(0, expected.size()) == expected,
+                      "Frames not received in order on the connection!");
+  BOOST_CHECK_EQUAL(listener.NumAccepted(), 1);
+  BOOST_CHECK_EQUAL(m_pool.Size(), 1);
+
+  auto deadline = chrono::steady_clock::now() + WAIT_TIMEOUT;
+  while ((sent < 3) && (chrono::steady_clock::now() < deadline)) {
+    this_thread::sleep_for(chrono::milliseconds(10));
+  }
+  BOOST_CHECK_EQUAL(sent, 3);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_pool_reconnect, PoolFixture) {
+  INIT_STDOUT_LOGGER();
+
+  TestListener listener;
+  const Peer peer = LocalPeer(listener.Port());
+
+  const auto first = Frame(Message(100, 6));
+  const vector<unsigned char> header(first.begin(), first.begin() + HDR_LEN);
+  BOOST_REQUIRE(m_pool.Send(peer, header,
+                            make_shared<const vector<unsigned char>>(
+                                first.begin() + HDR_LEN, first.end())));
+  BOOST_REQUIRE(listener.WaitForData(0, first.size()) == first);
+
+  // The pool notices the remote close and drops the connection
+  listener.CloseConnection(0);
+  BOOST_REQUIRE_MESSAGE(WaitForPoolSize(0), "Closed connection still open!");
+
+  const auto second = Frame(Message(200, 7));
+  BOOST_REQUIRE(m_pool.Send(peer,
+                            {second.begin(), second.begin() + HDR_LEN},
+                            make_shared<const vector<unsigned char>>(
+                                second.begin() + HDR_LEN, second.end())));
+  BOOST_CHECK_MESSAGE(listener.WaitForData(1, second.size()) == second,
+                      "Message not sent over a new connection!");
+  BOOST_CHECK_EQUAL(listener.NumAccepted(), 2);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_scheduler_retry_backoff, PoolFixture) {
+  INIT_STDOUT_LOGGER();
 
-  struct in_addr ip_addr;
-  inet_aton("127.0.0.1", &ip_addr);
-  Peer peer = {ip_addr.s_addr, 30303};
-  vector<unsigned char> message1 = {'H', 'e', 'l',
-                                    'l', 'o', '\0'};  // Send Hello once
+  // Nobody listens, so every attempt fails
+  SendScheduler::Stats stats =
+      Schedule({LocalPeer(UnusedPort())}, Message(100, 8));
+
+  BOOST_CHECK_EQUAL(stats.m_sent, 0);
+  BOOST_CHECK_EQUAL(stats.m_failed, 1);
+  BOOST_CHECK_EQUAL(stats.m_retries, MAXRETRYCONN);
+
+  // Each retry waits at least twice as long as the one before
+  unsigned int minBackoff = 0;
+  for (unsigned int i = 0; i < MAXRETRYCONN; i++) {
+    minBackoff += SEND_RETRY_BACKOFF_IN_MS << i;
+  }
+  BOOST_CHECK_MESSAGE(stats.m_elapsed.count() >= minBackoff,
+                      "Gave up after " << stats.m_elapsed.count()
+                                       << " ms, expected at least "
+                                       << minBackoff << " ms!");
+}
 
-  P2PComm::GetInstance().SendMessage(peer, message1);
+BOOST_FIXTURE_TEST_CASE(test_scheduler_retry_succeeds, PoolFixture) {
+  INIT_STDOUT_LOGGER();
 
-  vector<Peer> peers = {peer, peer, peer};
-  vector<unsigned char> message2 = {'W', 'o', 'r',
-                                    'l', 'd', '\0'};  // Send World 3x
+  const unsigned int port = UnusedPort();
+  const vector<unsigned char> message = Message(100, 9);
+  unique_ptr<TestListener> listener;
+
+  // The peer comes up after the first attempt, before the first retry
+  SendScheduler::Stats stats =
+      Schedule({LocalPeer(port)}, message, [&listener, port] {
+        this_thread::sleep_for(
+            chrono::milliseconds(SEND_RETRY_BACKOFF_IN_MS / 2));
+        listener.reset(new TestListener(port));
+      });
+
+  BOOST_CHECK_EQUAL(stats.m_sent, 1);
+  BOOST_CHECK_EQUAL(stats.m_failed, 0);
+  BOOST_CHECK_GE(stats.m_retries, 1);
+  BOOST_CHECK(listener->WaitForData(0, HDR_LEN + message.size()) ==
+              Frame(message));
+}
 
-  P2PComm::GetInstance().SendMessage(peers, message2);
+BOOST_FIXTURE_TEST_CASE(test_scheduler_inflight_limit, PoolFixture) {
+  INIT_STDOUT_LOGGER();
 
-  vector<unsigned char> longMsg(1024 * 1024 * 1024, 'z');
-  longMsg.emplace_back('\0');
+  // Peers that do not read yet, and a message larger than the socket
+  // buffers, so no send can finish before we start reading
+  TestListener listener(0, false, 4096);
+  const unsigned int numPeers = SEND_INFLIGHT_LIMIT + 8;
+  vector<Peer> peers;
+  for (unsigned int i = 1; i <= numPeers; i++) {
+    peers.emplace_back(
+        LocalPeer(listener.Port(), "127.0.0." + to_string(i)));
+  }
 
-  startTime = chrono::high_resolution_clock::now();
-  P2PComm::GetInstance().SendMessage(peer, longMsg);
+  const vector<unsigned char> message = Message(16 * 1024 * 1024, 10);
+  size_t connectedBeforeReading = 0;
+
+  SendScheduler::Stats stats =
+      Schedule(move(peers), message, [&listener, &connectedBeforeReading] {
+        auto deadline = chrono::steady_clock::now() + WAIT_TIMEOUT;
+        while ((listener.NumAccepted() < SEND_INFLIGHT_LIMIT) &&
+               (chrono::steady_clock::now() < deadline)) {
+          this_thread::sleep_for(chrono::milliseconds(10));
+        }
+
+        // Give the scheduler the chance to exceed the limit
+        this_thread::sleep_for(chrono::milliseconds(500));
+        connectedBeforeReading = listener.NumAccepted();
+        listener.StartReading();
+      });
+
+  BOOST_CHECK_EQUAL(connectedBeforeReading, SEND_INFLIGHT_LIMIT);
+  BOOST_CHECK_EQUAL(stats.m_sent, numPeers);
+  BOOST_CHECK_EQUAL(stats.m_failed, 0);
+  BOOST_CHECK_EQUAL(listener.NumAccepted(), numPeers);
+}
 
-  TestRemoveBroadcast();
+BOOST_AUTO_TEST_SUITE_END()
 
-  return 0;
+// The message pump and its send queue thread run until the process ends, so
+// leave without destroying the P2PComm singleton under them
+int main(int argc, char* argv[]) {
+  int result = boost::unit_test::unit_test_main(&init_unit_test, argc, argv);
+  cout.flush();
+  _exit(result);
 }
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "libPOW/pow.h"
+#include "libUtils/Logger.h"
+
+using namespace std;
+
+const unsigned int SECONDS_PER_RUN = 5;
+
+// Reports the light CPU mining hashrate for 1 thread up to the number of cores
+int main() {
+  INIT_STDOUT_LOGGER();
+
+  POW& pow = POW::GetInstance();
+  pow.EthashConfigureClient(0);
+
+  const unsigned int numCores = max(1u, thread::hardware_concurrency());
+  vector<unsigned int> numThreads;
+  for (unsigned int n = 1; n < numCores; n *= 2) {
+    numThreads.emplace_back(n);
+  }
+  numThreads.emplace_back(numCores);
+
+  ethash_hash256 headerHash{};
+  for (const auto& n : numThreads) {
+    // No solution is expected at this difficulty, so the run lasts until the
+    // miner is stopped
+    thread stopper([&pow]() {
+      this_thread::sleep_for(chrono::seconds(SECONDS_PER_RUN));
+      pow.StopMining();
+    });
+
+    uint64_t numHashes = 0;
+    auto start = chrono::steady_clock::now();
+    pow.MineCPU(headerHash, 200, false, n, numHashes);
+    auto elapsed = chrono::duration_cast<chrono::milliseconds>(
+                       chrono::steady_clock::now() - start)
+                       .count();
+    stopper.join();
+
+    cout << n << " threads: " << numHashes * 1000 / max<int64_t>(elapsed, 1)
+         << " H/s" << endl;
+  }
+
+  return 0;
+}
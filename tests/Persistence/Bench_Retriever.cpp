@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+// Compares loading every TxBlock on restart against loading only the recent
+// window from the tip record. Not part of the test suite; run it manually
+// from a directory holding constants.xml:
+//   ./Bench_Retriever [blocks]
+
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <vector>
+
+#include "libCrypto/Schnorr.h"
+#include "libData/BlockData/Block.h"
+#include "libPersistence/BlockStorage.h"
+#include "libUtils/TimeUtils.h"
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+  INIT_STDOUT_LOGGER();
+
+  const uint64_t numBlocks = argc > 1 ? strtoull(argv[1], nullptr, 10) : 20000;
+
+  BlockStorage& storage = BlockStorage::GetBlockStorage();
+  storage.ResetDB(BlockStorage::DBTYPE::TX_BLOCK);
+
+  const PubKey minerPubKey = Schnorr::GetInstance().GenKeyPair().second;
+  for (uint64_t i = 0; i < numBlocks; i++) {
+    TxBlock block(TxBlockHeader(TXBLOCKTYPE::FINAL, BLOCKVERSION::VERSION1, 1,
+                                1, 1, BlockHash(), i, TxBlockHashSet(), 5,
+                                minerPubKey, i / NUM_FINAL_BLOCK_PER_POW,
+                                CommitteeHash()),
+                  vector<MicroBlockInfo>(10), CoSignatures());
+
+    vector<unsigned char> serializedTxBlock;
+    block.Serialize(serializedTxBlock, 0);
+    storage.PutTxBlock(i, serializedTxBlock);
+  }
+
+  auto start = r_timer_start();
+  list<TxBlockSharedPtr> allBlocks;
+  storage.GetAllTxBlocks(allBlocks);
+  allBlocks.sort([](const TxBlockSharedPtr& a, const TxBlockSharedPtr& b) {
+    return a->GetHeader().GetBlockNum() < b->GetHeader().GetBlockNum();
+  });
+  double fullScan = r_timer_end(start);
+
+  start = r_timer_start();
+  uint64_t latestBlockNum = 0;
+  vector<TxBlockSharedPtr> recentBlocks;
+  if (!storage.GetLatestTxBlockNum(latestBlockNum) ||
+      !storage.GetTxBlocks(latestBlockNum >= BLOCKCHAIN_SIZE
+                               ? latestBlockNum + 1 - BLOCKCHAIN_SIZE
+                               : 0,
+                           latestBlockNum, recentBlocks)) {
+    cerr << "Failed to load the recent TxBlocks" << endl;
+    return 1;
+  }
+  double window = r_timer_end(start);
+
+  cout << numBlocks << " TxBlocks on disk" << endl;
+  cout << "  Full scan:     " << allBlocks.size() << " blocks in "
+       << fullScan / 1000 << " ms" << endl;
+  cout << "  Recent window: " << recentBlocks.size() << " blocks in "
+       << window / 1000 << " ms" << endl;
+
+  return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+// Compares point reads and writes of a populated state database opened with
+// the default options and with the hash keyed profile. Not part of the test
+// suite; run it manually from a directory holding constants.xml:
+//   ./Bench_StateDB [entries]
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "depends/libDatabase/LevelDB.h"
+#include "libUtils/Logger.h"
+#include "libUtils/TimeUtils.h"
+
+using namespace std;
+
+namespace {
+const unsigned int VALUE_SIZE = 110;  // About the size of a trie branch node
+const unsigned int WRITE_BATCH_SIZE = 10000;
+const unsigned int NUM_READS = 100000;
+
+void Run(const string& name, LevelDB::Profile profile,
+         const vector<dev::h256>& keys) {
+  LevelDB db("benchStateDB", "", profile);
+  db.ResetDB();
+
+  mt19937 eng(1);
+  vector<unsigned char> value(VALUE_SIZE);
+  for (auto& c : value) {
+    c = (unsigned char)eng();
+  }
+
+  // Populate the way OverlayDB::commit does, in batches
+  auto start = r_timer_start();
+  leveldb::WriteBatch batch;
+  for (unsigned int i = 0; i < keys.size(); i++) {
+    LevelDB::AddToBatch(batch, keys[i], value);
+    if ((i + 1) % WRITE_BATCH_SIZE == 0 || i + 1 == keys.size()) {
+      db.Write(batch);
+      batch.Clear();
+    }
+  }
+  double batchedWrites = r_timer_end(start);
+
+  start = r_timer_start();
+  for (unsigned int i = 0; i < WRITE_BATCH_SIZE; i++) {
+    db.Insert(keys[i], value);
+  }
+  double singleWrites = r_timer_end(start);
+
+  uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+  start = r_timer_start();
+  unsigned int found = 0;
+  for (unsigned int i = 0; i < NUM_READS; i++) {
+    found += !db.Lookup(keys[pick(eng)]).empty();
+  }
+  double hits = r_timer_end(start);
+
+  dev::h256 missingKey;
+  start = r_timer_start();
+  for (unsigned int i = 0; i < NUM_READS; i++) {
+    missingKey.randomize(eng);
+    found += !db.Lookup(missingKey).empty();
+  }
+  double misses = r_timer_end(start);
+
+  cout << name << endl;
+  cout << "  Batched writes: " << keys.size() * 1000.0 / batchedWrites
+       << " /ms" << endl;
+  cout << "  Single writes:  " << WRITE_BATCH_SIZE * 1000.0 / singleWrites
+       << " /ms" << endl;
+  cout << "  Existing reads: " << NUM_READS * 1000.0 / hits << " /ms" << endl;
+  cout << "  Missing reads:  " << NUM_READS * 1000.0 / misses << " /ms ("
+       << found << " found)" << endl;
+
+  db.DeleteDB();
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  INIT_STDOUT_LOGGER();
+
+  const size_t numEntries = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1000000;
+
+  mt19937 eng(0);
+  vector<dev::h256> keys(numEntries);
+  for (auto& key : keys) {
+    key.randomize(eng);
+  }
+
+  cout << numEntries << " entries of " << VALUE_SIZE << " bytes" << endl;
+  Run("Default options", LevelDB::SMALL, keys);
+  Run("Hash keyed profile", LevelDB::HASH_KEYED, keys);
+
+  return 0;
+}
@@ -18,6 +18,7 @@
  */
 
 #include <leveldb/db.h>
+#include <memory>
 #include <string>
 
 #include "depends/common/CommonIO.h"
@@ -126,4 +127,210 @@ BOOST_AUTO_TEST_CASE(retrieveDataStoredInTheTwoTrie) {
                       "ERROR: Trie4 cannot get the element in Trie2");
 }
 
+BOOST_AUTO_TEST_CASE(pruneUnreachableNodes) {
+  dev::OverlayDB m_db("pruneTrieDB");
+  m_db.ResetDB();
+  BOOST_REQUIRE_MESSAGE(m_db.enablePruning(2),
+                        "ERROR: Cannot enable pruning on an empty DB");
+
+  SecureTrieDB<h256, dev::OverlayDB> m_trie(&m_db);
+  m_trie.init();
+
+  vector<h256> keys;
+  for (unsigned int i = 0; i < 20; i++) {
+    keys.emplace_back(dev::h256::random());
+  }
+
+  vector<h256> roots;
+  for (unsigned int round = 0; round < 5; round++) {
+    for (const auto& key : keys) {
+      m_trie.insert(key, "value" + to_string(round) + key.hex());
+    }
+    m_db.commit({m_trie.root()});
+    roots.emplace_back(m_trie.root());
+    m_db.prune();
+  }
+
+  for (unsigned int round = 3; round < 5; round++) {
+    m_trie.setRoot(roots[round]);
+    for (const auto& key : keys) {
+      BOOST_CHECK_MESSAGE(
+          m_trie.at(key) == "value" + to_string(round) + key.hex(),
+          "ERROR: State in the pruning window is no longer readable");
+    }
+  }
+
+  for (unsigned int round = 0; round < 3; round++) {
+    BOOST_CHECK_MESSAGE(!m_db.exists(roots[round]),
+                        "ERROR: State out of the pruning window was kept");
+  }
+
+  BOOST_CHECK_MESSAGE(m_db.pruneStats().m_prunedBytes > 0,
+                      "ERROR: Pruning reclaimed nothing");
+}
+
+BOOST_AUTO_TEST_CASE(pruneStorageReferencedByValues) {
+  dev::OverlayDB storageDB("pruneStorageDB");
+  dev::OverlayDB accountDB("pruneAccountDB");
+  storageDB.ResetDB();
+  accountDB.ResetDB();
+  BOOST_REQUIRE(storageDB.enablePruning(1));
+  BOOST_REQUIRE(accountDB.enablePruning(1));
+
+  // The accounts hold nothing but the root of their storage
+  accountDB.setValueRefs(&storageDB,
+                         [](bytesConstRef value, vector<h256>& refs) {
+                           if (value.size() == h256::size) {
+                             refs.emplace_back(value);
+                           }
+                         });
+
+  SecureTrieDB<h256, dev::OverlayDB> storage(&storageDB);
+  SecureTrieDB<h256, dev::OverlayDB> accounts(&accountDB);
+  storage.init();
+  accounts.init();
+
+  h256 storageKey = dev::h256::random();
+  h256 account = dev::h256::random();
+  vector<h256> storageRoots;
+  for (unsigned int round = 0; round < 4; round++) {
+    storage.insert(storageKey, "storage" + to_string(round) + account.hex());
+    storageDB.commit();
+    storageRoots.emplace_back(storage.root());
+
+    accounts.insert(account, storage.root().ref());
+    accountDB.commit({accounts.root()});
+
+    accountDB.prune();
+    storageDB.prune();
+  }
+
+  BOOST_CHECK_MESSAGE(storageDB.exists(storageRoots.back()),
+                      "ERROR: Storage of the latest state was pruned");
+  BOOST_CHECK_MESSAGE(!storageDB.exists(storageRoots.front()),
+                      "ERROR: Storage no account refers to was kept");
+
+  string storageRoot = accounts.at(account);
+  storage.setRoot(h256(bytesConstRef(storageRoot)));
+  BOOST_CHECK_MESSAGE(
+      storage.at(storageKey) == "storage3" + account.hex(),
+      "ERROR: Cannot read the storage of the latest state");
+}
+
+BOOST_AUTO_TEST_CASE(resumePruningAfterRunWithoutIt) {
+  vector<h256> keys;
+  for (unsigned int i = 0; i < 20; i++) {
+    keys.emplace_back(dev::h256::random());
+  }
+
+  vector<h256> roots;
+  auto commitRound = [&keys, &roots](dev::OverlayDB& db) {
+    SecureTrieDB<h256, dev::OverlayDB> trie(&db);
+    if (roots.empty()) {
+      trie.init();
+    } else {
+      trie.setRoot(roots.back());
+    }
+    for (const auto& key : keys) {
+      trie.insert(key, "value" + to_string(roots.size()) + key.hex());
+    }
+    db.commit({trie.root()});
+    roots.emplace_back(trie.root());
+    db.prune();
+  };
+
+  {
+    dev::OverlayDB db("resumePruneDB");
+    db.ResetDB();
+    BOOST_REQUIRE(db.enablePruning(1));
+    commitRound(db);
+  }
+
+  // Restarted with a pruning window of 0
+  {
+    dev::OverlayDB db("resumePruneDB");
+    BOOST_REQUIRE(db.isRefCounted() && !db.isPruning());
+    commitRound(db);
+    commitRound(db);
+  }
+
+  dev::OverlayDB db("resumePruneDB");
+  BOOST_REQUIRE(db.enablePruning(1));
+  commitRound(db);
+
+  for (unsigned int round = 0; round + 1 < roots.size(); round++) {
+    BOOST_CHECK_MESSAGE(!db.exists(roots[round]),
+                        "ERROR: State committed while not pruning was kept");
+  }
+
+  SecureTrieDB<h256, dev::OverlayDB> trie(&db);
+  trie.setRoot(roots.back());
+  for (const auto& key : keys) {
+    BOOST_CHECK_MESSAGE(
+        trie.at(key) == "value" + to_string(roots.size() - 1) + key.hex(),
+        "ERROR: Cannot read the latest state");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(keepReleasesAcrossRestart) {
+  auto storageDB = make_unique<dev::OverlayDB>("pendingStorageDB");
+  dev::OverlayDB accountDB("pendingAccountDB");
+  storageDB->ResetDB();
+  accountDB.ResetDB();
+  BOOST_REQUIRE(storageDB->enablePruning(1));
+  BOOST_REQUIRE(accountDB.enablePruning(1));
+
+  accountDB.setValueRefs(storageDB.get(),
+                         [](bytesConstRef value, vector<h256>& refs) {
+                           if (value.size() == h256::size) {
+                             refs.emplace_back(value);
+                           }
+                         });
+
+  SecureTrieDB<h256, dev::OverlayDB> accounts(&accountDB);
+  accounts.init();
+
+  h256 storageKey = dev::h256::random();
+  h256 account = dev::h256::random();
+  vector<h256> storageRoots;
+  for (unsigned int round = 0; round < 2; round++) {
+    SecureTrieDB<h256, dev::OverlayDB> storage(storageDB.get());
+    if (storageRoots.empty()) {
+      storage.init();
+    } else {
+      storage.setRoot(storageRoots.back());
+    }
+    storage.insert(storageKey, "storage" + to_string(round));
+    storageDB->commit();
+    storageRoots.emplace_back(storage.root());
+
+    accounts.insert(account, storage.root().ref());
+    accountDB.commit({accounts.root()});
+  }
+
+  // Releases the reference of the first account state to its storage
+  accountDB.prune();
+
+  // Restarts the storage database before it commits those releases
+  storageDB.reset();
+  storageDB = make_unique<dev::OverlayDB>("pendingStorageDB");
+  BOOST_REQUIRE(storageDB->enablePruning(1));
+  accountDB.setValueRefs(storageDB.get(),
+                         [](bytesConstRef value, vector<h256>& refs) {
+                           if (value.size() == h256::size) {
+                             refs.emplace_back(value);
+                           }
+                         });
+
+  for (unsigned int round = 0; round < 2; round++) {
+    storageDB->commit();
+    storageDB->prune();
+  }
+
+  BOOST_CHECK_MESSAGE(!storageDB->exists(storageRoots.front()),
+                      "ERROR: Storage released before the restart was kept");
+  BOOST_CHECK_MESSAGE(storageDB->exists(storageRoots.back()),
+                      "ERROR: Storage of the latest state was pruned");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -22,6 +22,7 @@
 #include <thread>
 #include <vector>
 
+#include "libData/BlockChainData/BlockChain.h"
 #include "libData/BlockData/Block.h"
 #include "libPersistence/BlockStorage.h"
 #include "libPersistence/DB.h"
@@ -328,4 +329,129 @@ BOOST_AUTO_TEST_CASE(testRetrieveAllTheTxBlocksInDB) {
   }
 }
 
+BOOST_AUTO_TEST_CASE(testRetrieveRecentTxBlocks) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  if (BlockStorage::GetBlockStorage().ResetDB(BlockStorage::DBTYPE::TX_BLOCK)) {
+    for (int i = 0; i < 50; i++) {
+      writeBlock(i);
+    }
+
+    uint64_t latestBlockNum = 0;
+    BOOST_CHECK(
+        BlockStorage::GetBlockStorage().GetLatestTxBlockNum(latestBlockNum));
+    BOOST_CHECK_EQUAL(latestBlockNum, 49);
+
+    // Rewriting an older block must not move the tip back
+    writeBlock(10);
+    BOOST_CHECK(
+        BlockStorage::GetBlockStorage().GetLatestTxBlockNum(latestBlockNum));
+    BOOST_CHECK_EQUAL(latestBlockNum, 49);
+
+    std::vector<TxBlockSharedPtr> blocks;
+    BOOST_CHECK(BlockStorage::GetBlockStorage().GetTxBlocks(30, 49, blocks));
+    BOOST_REQUIRE_EQUAL(blocks.size(), 20);
+    for (unsigned int i = 0; i < blocks.size(); i++) {
+      BOOST_CHECK_EQUAL(blocks[i]->GetHeader().GetBlockNum(), 30 + i);
+    }
+
+    BOOST_CHECK_MESSAGE(
+        !BlockStorage::GetBlockStorage().GetTxBlocks(45, 55, blocks),
+        "GetTxBlocks shouldn't succeed with missing blocks");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testBlockStatsAfterWindowedRestart) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  if (BlockStorage::GetBlockStorage().ResetDB(
+          BlockStorage::DBTYPE::TX_BLOCK_STATS)) {
+    TxBlockChain chain;
+    for (int i = 0; i < 50; i++) {
+      chain.AddBlock(constructDummyTxBlock(i));
+    }
+
+    // A restart adds only blocks 30 to 49 and continues the stored stats
+    TxBlockChain restarted;
+    restarted.Reset(30);
+    for (int i = 30; i < 50; i++) {
+      restarted.AddBlock(constructDummyTxBlock(i));
+    }
+
+    BOOST_CHECK_EQUAL(restarted.GetNumTxsAfter(0), chain.GetNumTxsAfter(0));
+    BOOST_CHECK_EQUAL(restarted.GetNumTxsAfter(10), chain.GetNumTxsAfter(10));
+    BOOST_CHECK_EQUAL(restarted.GetNumTxsAfter(40), chain.GetNumTxsAfter(40));
+    BOOST_CHECK_EQUAL(restarted.GetBlockTimestamp(10),
+                      chain.GetBlockTimestamp(10));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testTxBlocksInNumericOrder) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  if (BlockStorage::GetBlockStorage().ResetDB(BlockStorage::DBTYPE::TX_BLOCK)) {
+    // 9 < 10 < 100 only holds if the keys sort numerically
+    for (int i = 0; i < 120; i++) {
+      writeBlock(i);
+    }
+
+    std::vector<uint64_t> blockNums;
+    BlockStorage::GetBlockStorage().ForEachTxBlock(
+        5, 105, [&blockNums](const TxBlockSharedPtr& block) {
+          blockNums.emplace_back(block->GetHeader().GetBlockNum());
+          return true;
+        });
+    BOOST_REQUIRE_EQUAL(blockNums.size(), 101);
+    for (unsigned int i = 0; i < blockNums.size(); i++) {
+      BOOST_CHECK_EQUAL(blockNums[i], 5 + i);
+    }
+
+    std::list<TxBlockSharedPtr> blocks;
+    BOOST_CHECK(BlockStorage::GetBlockStorage().GetAllTxBlocks(blocks));
+    BOOST_CHECK_EQUAL(blocks.size(), 120);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testLegacyBlockNumKeys) {
+  INIT_STDOUT_LOGGER();
+
+  LOG_MARKER();
+
+  const std::vector<unsigned char> value = {'a'};
+  {
+    LevelDB db("testBlockNumKeys", "", LevelDB::SMALL, true);
+    BOOST_REQUIRE(db.ResetDB());
+    db.Insert(std::string("5"), value);
+    db.Insert(std::string("12"), value);
+    db.Insert(boost::multiprecision::uint256_t(7), value);
+  }
+
+  // Decimal keys from older versions are only detected when opening the db
+  LevelDB db("testBlockNumKeys", "", LevelDB::SMALL, true);
+  BOOST_CHECK_EQUAL(db.Lookup(boost::multiprecision::uint256_t(5)), "a");
+  BOOST_CHECK_EQUAL(db.Lookup(boost::multiprecision::uint256_t(7)), "a");
+
+  std::vector<boost::multiprecision::uint256_t> blockNums;
+  db.ForEachInRange(0, 20,
+                    [&blockNums](const boost::multiprecision::uint256_t& num,
+                                 const leveldb::Slice&) {
+                      blockNums.emplace_back(num);
+                      return true;
+                    });
+  BOOST_REQUIRE_EQUAL(blockNums.size(), 3);
+  BOOST_CHECK(blockNums[0] == 5 && blockNums[1] == 7 && blockNums[2] == 12);
+
+  BOOST_CHECK_EQUAL(db.MigrateBlockNumKeys(), 2);
+  BOOST_CHECK(!db.Exists(std::string("12")));
+  BOOST_CHECK_EQUAL(db.Lookup(boost::multiprecision::uint256_t(12)), "a");
+
+  db.DeleteDB();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+// Compares the work-stealing ThreadPool against the single-queue pool it
+// replaced. Not part of the test suite; run it manually:
+//   ./Bench_ThreadPool [threads] [jobs]
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "libUtils/ThreadPool.h"
+
+using namespace std;
+
+/// The previous ThreadPool implementation: one queue behind one mutex.
+class LegacyThreadPool {
+ public:
+  typedef function<void()> Job;
+
+  explicit LegacyThreadPool(const unsigned int threadCount) {
+    for (unsigned int index = 0; index < threadCount; ++index) {
+      _threads.push_back(thread([this] { this->Task(); }));
+    }
+  }
+
+  ~LegacyThreadPool() {
+    {
+      lock_guard<mutex> lock(_queueMutex);
+      _bailout = true;
+    }
+    _jobAvailableVar.notify_all();
+    for (thread& t : _threads) {
+      t.join();
+    }
+  }
+
+  void AddJob(const Job& job) {
+    lock(_queueMutex, _jobsLeftMutex);
+    lock_guard<mutex> lg1(_queueMutex, adopt_lock);
+    lock_guard<mutex> lg2(_jobsLeftMutex, adopt_lock);
+    _queue.push(job);
+    ++_jobsLeft;
+    _jobAvailableVar.notify_one();
+  }
+
+  void WaitAll() {
+    unique_lock<mutex> lock(_jobsLeftMutex);
+    _waitVar.wait(lock, [this] { return _jobsLeft == 0; });
+  }
+
+ private:
+  void Task() {
+    while (true) {
+      Job job;
+      {
+        unique_lock<mutex> lock(_queueMutex);
+        _jobAvailableVar.wait(lock,
+                              [this] { return !_queue.empty() || _bailout; });
+        if (_bailout) {
+          return;
+        }
+        job = _queue.front();
+        _queue.pop();
+      }
+
+      job();
+
+      {
+        lock_guard<mutex> lock(_jobsLeftMutex);
+        --_jobsLeft;
+      }
+      _waitVar.notify_one();
+    }
+  }
+
+  vector<thread> _threads;
+  queue<Job> _queue;
+  int _jobsLeft = 0;
+  bool _bailout = false;
+  condition_variable _jobAvailableVar;
+  condition_variable _waitVar;
+  mutex _jobsLeftMutex;
+  mutex _queueMutex;
+};
+
+template <typename Pool>
+double Run(Pool& pool, const unsigned int jobs) {
+  atomic<unsigned int> count(0);
+  vector<unsigned char> payload(64, 1);
+
+  const auto start = chrono::steady_clock::now();
+  for (unsigned int i = 0; i < jobs; ++i) {
+    // Capture roughly what a message handler captures
+    pool.AddJob([&count, payload]() { count += payload[0]; });
+  }
+  pool.WaitAll();
+  const auto elapsed = chrono::steady_clock::now() - start;
+
+  return chrono::duration<double, milli>(elapsed).count();
+}
+
+int main(int argc, char* argv[]) {
+  const unsigned int threads =
+      (argc > 1) ? stoul(argv[1]) : thread::hardware_concurrency();
+  const unsigned int jobs = (argc > 2) ? stoul(argv[2]) : 1000000;
+
+  LegacyThreadPool legacy(threads);
+  ThreadPool pool(threads, "BenchPool");
+
+  cout << threads << " threads, " << jobs << " jobs" << endl;
+  cout << "LegacyThreadPool: " << Run(legacy, jobs) << " ms" << endl;
+  cout << "ThreadPool:       " << Run(pool, jobs) << " ms" << endl;
+
+  const auto start = chrono::steady_clock::now();
+  atomic<unsigned int> count(0);
+  pool.ParallelFor(0, jobs, [&count](size_t) { ++count; });
+  cout << "ParallelFor:      "
+       << chrono::duration<double, milli>(chrono::steady_clock::now() - start)
+              .count()
+       << " ms" << endl;
+
+  return 0;
+}
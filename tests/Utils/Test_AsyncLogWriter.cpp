@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "libUtils/AsyncLogWriter.h"
+
+#define BOOST_TEST_MODULE asynclogwriter
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(asynclogwriter)
+
+const unsigned int NUM_THREADS = 4;
+const unsigned int LINES_PER_THREAD = 5000;
+
+string ReadFile(const string& fileName) {
+  ifstream in(fileName, ios::binary);
+  ostringstream oss;
+  oss << in.rdbuf();
+  return oss.str();
+}
+
+void WriteLines(AsyncLogWriter& writer) {
+  vector<thread> threads;
+  for (unsigned int t = 0; t < NUM_THREADS; t++) {
+    threads.emplace_back([&writer, t]() {
+      for (unsigned int i = 0; i < LINES_PER_THREAD; i++) {
+        string msg = "thread " + to_string(t) + " line " + to_string(i);
+        writer.Write("INFO", 100 + t, "WriteLines", i % 2 ? "7" : "",
+                     msg.c_str());
+      }
+    });
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+  writer.Flush();
+}
+
+BOOST_AUTO_TEST_CASE(testTextFormat) {
+  AsyncLogWriter::Record record{
+      1540000000123456, 42, false, "INFO", "Function", "5", "hello"};
+  string line;
+  AsyncLogWriter::FormatRecord(record, line);
+  BOOST_CHECK_EQUAL(line,
+                    "[INFO   ][   42][01:46:40:123][Function                "
+                    "      ][Epoch 5] hello\n");
+
+  record.m_epoch.clear();
+  record.m_function = string(40, 'f');
+  line.clear();
+  AsyncLogWriter::FormatRecord(record, line);
+  BOOST_CHECK_EQUAL(line, "[INFO   ][   42][01:46:40:123][" + string(30, 'f') +
+                              "] hello\n");
+
+  record.m_raw = true;
+  record.m_level = "FATAL";
+  line.clear();
+  AsyncLogWriter::FormatRecord(record, line);
+  BOOST_CHECK_EQUAL(line, "[FATAL  ]hello\n");
+}
+
+BOOST_AUTO_TEST_CASE(testLongMessage) {
+  // Longer than the ring, so the writer must drain it between the pieces
+  string msg;
+  for (size_t i = 0; msg.size() < 2 * AsyncLogWriter::RING_SIZE + 10; i++) {
+    msg += to_string(i) + ' ';
+  }
+  const size_t numPieces =
+      (msg.size() + AsyncLogWriter::MAX_RECORD_MESSAGE_LEN - 1) /
+      AsyncLogWriter::MAX_RECORD_MESSAGE_LEN;
+
+  for (bool binary : {false, true}) {
+    string fileName;
+    {
+      AsyncLogWriter writer("test-asynclog-long", binary, 1024 * 1024 * 1024);
+      fileName = writer.GetFileName();
+      writer.Write("INFO", 1, "testLongMessage", "", msg.c_str());
+      writer.WriteRaw("INFO", msg);
+    }
+
+    string text = ReadFile(fileName);
+    if (binary) {
+      istringstream in(text);
+      ostringstream out;
+      BOOST_REQUIRE(AsyncLogWriter::DecodeBinary(in, out));
+      text = out.str();
+    }
+
+    // Every piece is a line, and together they hold the whole message
+    istringstream lines(text);
+    string line, joined, rawJoined;
+    unsigned int count = 0;
+    while (getline(lines, line)) {
+      const bool raw = count >= numPieces;
+      const bool continued = count % numPieces != 0;
+      const string marker = continued ? "(continued) " : "";
+      size_t pos = raw ? line.find(']') + 1 : line.find("] ") + 2;
+      BOOST_REQUIRE_EQUAL(line.compare(pos, marker.size(), marker), 0);
+      (raw ? rawJoined : joined) += line.substr(pos + marker.size());
+      count++;
+    }
+
+    BOOST_CHECK_EQUAL(count, 2 * numPieces);
+    BOOST_CHECK(joined == msg);
+    BOOST_CHECK(rawJoined == msg);
+    remove(fileName.c_str());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testTextLog) {
+  string fileName;
+  {
+    AsyncLogWriter writer("test-asynclog-text", false, 1024 * 1024 * 1024);
+    fileName = writer.GetFileName();
+    WriteLines(writer);
+  }
+
+  istringstream in(ReadFile(fileName));
+  vector<unsigned int> next(NUM_THREADS, 0);
+  string line;
+  unsigned int count = 0;
+
+  while (getline(in, line)) {
+    unsigned int t, i;
+    size_t pos = line.find("] thread ");
+    if (pos == string::npos) {
+      pos = line.find("[Epoch 7] thread ");
+      BOOST_REQUIRE(pos != string::npos);
+      pos += 8;
+    }
+    BOOST_REQUIRE_EQUAL(
+        sscanf(line.c_str() + pos + 2, "thread %u line %u", &t, &i), 2);
+
+    // Lines of one thread keep their order
+    BOOST_REQUIRE_EQUAL(i, next[t]);
+    next[t]++;
+    count++;
+  }
+
+  BOOST_CHECK_EQUAL(count, NUM_THREADS * LINES_PER_THREAD);
+  remove(fileName.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(testBinaryLog) {
+  string fileName;
+  {
+    AsyncLogWriter writer("test-asynclog-bin", true, 1024 * 1024 * 1024);
+    fileName = writer.GetFileName();
+    WriteLines(writer);
+    writer.WriteRaw("FATAL", "raw line");
+  }
+
+  string bytes = ReadFile(fileName);
+  BOOST_REQUIRE_EQUAL(bytes.substr(0, AsyncLogWriter::BINARY_MAGIC.size()),
+                      AsyncLogWriter::BINARY_MAGIC);
+
+  istringstream in(bytes);
+  ostringstream out;
+  BOOST_REQUIRE(AsyncLogWriter::DecodeBinary(in, out));
+
+  istringstream lines(out.str());
+  string line, last;
+  unsigned int count = 0;
+  while (getline(lines, line)) {
+    count++;
+    last = line;
+  }
+  BOOST_CHECK_EQUAL(count, NUM_THREADS * LINES_PER_THREAD + 1);
+  BOOST_CHECK_EQUAL(last, "[FATAL  ]raw line");
+
+  // Cut in the middle of the last record
+  istringstream truncated(bytes.substr(0, bytes.size() - 3));
+  ostringstream ignored;
+  BOOST_CHECK(!AsyncLogWriter::DecodeBinary(truncated, ignored));
+
+  istringstream notBinary("[INFO   ] text log\n");
+  BOOST_CHECK(!AsyncLogWriter::DecodeBinary(notBinary, ignored));
+
+  remove(fileName.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(testRollOver) {
+  vector<string> fileNames;
+  {
+    AsyncLogWriter writer("test-asynclog-roll", false, 64 * 1024);
+    fileNames.emplace_back(writer.GetFileName());
+    WriteLines(writer);
+    fileNames.emplace_back(writer.GetFileName());
+  }
+
+  BOOST_CHECK_NE(fileNames.front(), fileNames.back());
+
+  for (const auto& fileName : fileNames) {
+    remove(fileName.c_str());
+  }
+  for (unsigned int seq = 1; seq < 100; seq++) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "test-asynclog-roll-%05u-log.txt", seq);
+    remove(buf);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
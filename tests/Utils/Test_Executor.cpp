@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include "libUtils/Executor.h"
+#include "libUtils/Logger.h"
+
+#define BOOST_TEST_MODULE executor
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace std::chrono;
+
+BOOST_AUTO_TEST_SUITE(executor)
+
+BOOST_AUTO_TEST_CASE(testExecuteIsBounded) {
+  INIT_STDOUT_LOGGER();
+
+  const unsigned int MAX_THREADS = 4;
+  const unsigned int NUM_TASKS = 64;
+
+  atomic<unsigned int> running{0}, peak{0}, done{0};
+
+  {
+    Executor executor(MAX_THREADS);
+
+    for (unsigned int i = 0; i < NUM_TASKS; i++) {
+      executor.Execute([&]() {
+        unsigned int now = ++running;
+        unsigned int prev = peak;
+        while (now > prev && !peak.compare_exchange_weak(prev, now)) {
+        }
+        this_thread::sleep_for(milliseconds(5));
+        running--;
+        done++;
+      });
+    }
+
+    Executor::Stats stats = executor.GetStats();
+    BOOST_CHECK_LE(stats.m_threads, MAX_THREADS);
+    BOOST_CHECK_GT(stats.m_maxQueueDepth, 0);
+  }  // destructor waits for the queue to drain
+
+  BOOST_CHECK_EQUAL(done, NUM_TASKS);
+  BOOST_CHECK_LE(peak, MAX_THREADS);
+}
+
+BOOST_AUTO_TEST_CASE(testSaturatedCap) {
+  INIT_STDOUT_LOGGER();
+
+  const unsigned int MAX_THREADS = 2;
+  const unsigned int NUM_QUEUED = 3;
+
+  mutex m;
+  condition_variable cv;
+  bool released = false;
+  atomic<unsigned int> blocked{0}, ran{0};
+  atomic<bool> timerFired{false};
+
+  {
+    Executor executor(MAX_THREADS);
+
+    // Blocking tasks take every thread
+    for (unsigned int i = 0; i < MAX_THREADS; i++) {
+      executor.Execute([&]() {
+        blocked++;
+        unique_lock<mutex> lock(m);
+        cv.wait(lock, [&]() { return released; });
+      });
+    }
+    while (blocked < MAX_THREADS) {
+      this_thread::sleep_for(milliseconds(1));
+    }
+
+    // Further tasks and due timers wait in the queue
+    for (unsigned int i = 0; i < NUM_QUEUED; i++) {
+      executor.Execute([&]() { ran++; });
+    }
+    executor.ExecuteAfter(milliseconds(10), [&]() { timerFired = true; });
+    this_thread::sleep_for(milliseconds(200));
+
+    Executor::Stats stats = executor.GetStats();
+    BOOST_CHECK_EQUAL(stats.m_threads, MAX_THREADS);
+    BOOST_CHECK_EQUAL(stats.m_idleThreads, 0);
+    BOOST_CHECK_EQUAL(stats.m_queueDepth, NUM_QUEUED + 1);
+    BOOST_CHECK_EQUAL(stats.m_firedTimers, 1);
+    BOOST_CHECK_EQUAL(ran, 0);
+    BOOST_CHECK(!timerFired);
+
+    {
+      lock_guard<mutex> g(m);
+      released = true;
+    }
+    cv.notify_all();
+  }  // destructor waits for the queue to drain
+
+  BOOST_CHECK_EQUAL(ran, NUM_QUEUED);
+  BOOST_CHECK(timerFired);
+}
+
+BOOST_AUTO_TEST_CASE(testExecuteAfter) {
+  INIT_STDOUT_LOGGER();
+
+  Executor executor(2);
+  mutex m;
+  condition_variable cv;
+  vector<int> order;
+
+  auto record = [&](int value) {
+    lock_guard<mutex> g(m);
+    order.emplace_back(value);
+    cv.notify_all();
+  };
+
+  steady_clock::time_point start = steady_clock::now();
+  steady_clock::time_point fired;
+
+  // Longer than one revolution of the wheel
+  executor.ExecuteAfter(milliseconds(Executor::TICK_IN_MS *
+                                         (Executor::WHEEL_SLOTS + 10)),
+                        [&]() {
+                          fired = steady_clock::now();
+                          record(3);
+                        });
+  executor.ExecuteAfter(milliseconds(200), [&]() { record(2); });
+  executor.ExecuteAfter(milliseconds(50), [&]() { record(1); });
+
+  unique_lock<mutex> lock(m);
+  BOOST_REQUIRE(
+      cv.wait_for(lock, seconds(20), [&]() { return order.size() == 3; }));
+
+  BOOST_CHECK((order == vector<int>{1, 2, 3}));
+  BOOST_CHECK_GE(duration_cast<milliseconds>(fired - start).count(),
+                 Executor::TICK_IN_MS * (Executor::WHEEL_SLOTS + 10));
+  BOOST_CHECK_EQUAL(executor.GetStats().m_firedTimers, 3);
+  BOOST_CHECK_EQUAL(executor.GetStats().m_pendingTimers, 0);
+}
+
+BOOST_AUTO_TEST_CASE(testExecutePeriodically) {
+  INIT_STDOUT_LOGGER();
+
+  atomic<unsigned int> count{0};
+
+  {
+    Executor executor(1);
+    executor.ExecutePeriodically(milliseconds(20), [&]() { count++; });
+    this_thread::sleep_for(milliseconds(300));
+  }
+
+  BOOST_CHECK_GE(count, 3);
+
+  // Nothing may run once the executor is gone
+  unsigned int last = count;
+  this_thread::sleep_for(milliseconds(100));
+  BOOST_CHECK_EQUAL(count, last);
+}
+
+BOOST_AUTO_TEST_CASE(testCancelPeriodic) {
+  INIT_STDOUT_LOGGER();
+
+  Executor executor(2);
+  atomic<unsigned int> count{0};
+  atomic<bool> inTask{false};
+  atomic<bool> overlapped{false};
+
+  Executor::TimerId id =
+      executor.ExecutePeriodically(milliseconds(10), [&]() {
+        inTask = true;
+        this_thread::sleep_for(milliseconds(20));
+        count++;
+        inTask = false;
+      });
+  this_thread::sleep_for(milliseconds(100));
+
+  executor.Cancel(id);
+  overlapped = inTask.load();
+  unsigned int last = count;
+  this_thread::sleep_for(milliseconds(100));
+
+  BOOST_CHECK_GE(last, 1);
+  BOOST_CHECK_MESSAGE(!overlapped, "Cancel returned while the task ran");
+  BOOST_CHECK_EQUAL(count, last);
+
+  // Unknown and repeated ids are ignored
+  executor.Cancel(id);
+  executor.Cancel(id + 100);
+}
+
+BOOST_AUTO_TEST_CASE(testThrowingTask) {
+  INIT_STDOUT_LOGGER();
+
+  atomic<bool> ran{false};
+
+  {
+    Executor executor(1);
+    executor.Execute([]() { throw runtime_error("expected"); });
+    executor.Execute([&]() { ran = true; });
+  }
+
+  BOOST_CHECK(ran);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <vector>
+#include "libCrypto/Sha2.h"
+#include "libUtils/Logger.h"
+#include "libUtils/MerkleTree.h"
+
+#define BOOST_TEST_MODULE merkletree
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace dev;
+
+namespace {
+vector<h256> MakeLeaves(size_t count) {
+  vector<h256> leaves;
+  for (size_t i = 0; i < count; i++) {
+    SHA2<HASH_TYPE::HASH_VARIANT_256> sha2;
+    string s = to_string(i);
+    sha2.Update(vector<unsigned char>(s.begin(), s.end()));
+    leaves.emplace_back(h256(sha2.Finalize()));
+  }
+  return leaves;
+}
+}  // namespace
+
+BOOST_AUTO_TEST_SUITE(merkletree)
+
+BOOST_AUTO_TEST_CASE(testSmallRoots) {
+  INIT_STDOUT_LOGGER();
+
+  BOOST_CHECK(MerkleTree().GetRoot() == h256());
+
+  vector<h256> leaves = MakeLeaves(3);
+
+  BOOST_CHECK(MerkleTree({leaves[0]}).GetRoot() == leaves[0]);
+  BOOST_CHECK(MerkleTree({leaves[0], leaves[1]}).GetRoot() ==
+              MerkleTree::HashPair(leaves[0], leaves[1]));
+  BOOST_CHECK(MerkleTree(leaves).GetRoot() ==
+              MerkleTree::HashPair(MerkleTree::HashPair(leaves[0], leaves[1]),
+                                   leaves[2]));
+  BOOST_CHECK(MerkleTree::HashPair(leaves[0], leaves[1]) !=
+              MerkleTree::HashPair(leaves[1], leaves[0]));
+}
+
+BOOST_AUTO_TEST_CASE(testAppendAndUpdate) {
+  INIT_STDOUT_LOGGER();
+
+  vector<h256> leaves = MakeLeaves(50);
+  MerkleTree tree;
+
+  for (size_t i = 0; i < leaves.size(); i++) {
+    tree.Append(leaves[i]);
+    vector<h256> prefix(leaves.begin(), leaves.begin() + i + 1);
+    BOOST_CHECK_EQUAL(tree.GetLeafCount(), i + 1);
+    BOOST_CHECK(tree.GetRoot() == MerkleTree(prefix).GetRoot());
+  }
+
+  vector<h256> others = MakeLeaves(100);
+  for (size_t i = 0; i < leaves.size(); i += 7) {
+    leaves[i] = others[50 + i];
+    BOOST_CHECK(tree.Update(i, leaves[i]));
+    BOOST_CHECK(tree.GetRoot() == MerkleTree(leaves).GetRoot());
+  }
+
+  BOOST_CHECK(!tree.Update(leaves.size(), leaves[0]));
+}
+
+BOOST_AUTO_TEST_CASE(testProofs) {
+  INIT_STDOUT_LOGGER();
+
+  for (size_t count = 1; count <= 33; count++) {
+    vector<h256> leaves = MakeLeaves(count);
+    MerkleTree tree(leaves);
+    const h256 root = tree.GetRoot();
+
+    for (size_t i = 0; i < count; i++) {
+      vector<h256> proof;
+      BOOST_REQUIRE(tree.GetProof(i, proof));
+      BOOST_CHECK(MerkleTree::VerifyProof(leaves[i], i, count, proof, root));
+
+      // The proof must not hold for another leaf or position
+      BOOST_CHECK(!MerkleTree::VerifyProof(leaves[(i + 1) % count], i, count,
+                                           proof, root) ||
+                  count == 1);
+      if (count > 1) {
+        BOOST_CHECK(!MerkleTree::VerifyProof(leaves[i], (i + 1) % count,
+                                             count, proof, root));
+      }
+
+      if (!proof.empty()) {
+        proof[0][0] ^= 0xff;
+        BOOST_CHECK(
+            !MerkleTree::VerifyProof(leaves[i], i, count, proof, root));
+      }
+    }
+
+    vector<h256> proof;
+    BOOST_CHECK(!tree.GetProof(count, proof));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(testParallelBuild) {
+  INIT_STDOUT_LOGGER();
+
+  vector<h256> leaves = MakeLeaves(3 * MerkleTree::PARALLEL_THRESHOLD + 5);
+
+  MerkleTree incremental;
+  for (const auto& leaf : leaves) {
+    incremental.Append(leaf);
+  }
+
+  BOOST_CHECK(MerkleTree(leaves).GetRoot() == incremental.GetRoot());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
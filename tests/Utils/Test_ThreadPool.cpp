@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2018 Zilliqa
+ * This source code is being disclosed to you solely for the purpose of your
+ * participation in testing Zilliqa. You may view, compile and run the code for
+ * that purpose and pursuant to the protocols and algorithms that are programmed
+ * into, and intended by, the code. You may not do anything else with the code
+ * without express permission from Zilliqa Research Pte. Ltd., including
+ * modifying or publishing the code (or any part of it), and developing or
+ * forming another public or private blockchain network. This source code is
+ * provided 'as is' and no warranties are given as to title or non-infringement,
+ * merchantability or fitness for purpose and, to the extent permitted by law,
+ * all liability for your use of the code is disclaimed. Some programs in this
+ * code are governed by the GNU General Public License v3.0 (available at
+ * https://www.gnu.org/licenses/gpl-3.0.en.html) ('GPLv3'). The programs that
+ * are governed by GPLv3.0 are those programs that are located in the folders
+ * src/depends and tests/depends and which include a reference to GPLv3 in their
+ * program files.
+ */
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "libUtils/Logger.h"
+#include "libUtils/ThreadPool.h"
+
+#define BOOST_TEST_MODULE threadpool
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+
+BOOST_AUTO_TEST_SUITE(threadpool)
+
+BOOST_AUTO_TEST_CASE(test_addjob) {
+  INIT_STDOUT_LOGGER();
+
+  ThreadPool pool(4, "TestPool");
+  atomic<unsigned int> count(0);
+
+  for (unsigned int i = 0; i < 10000; ++i) {
+    pool.AddJob([&count]() { ++count; });
+  }
+
+  pool.WaitAll();
+  BOOST_CHECK_MESSAGE(count == 10000, "Not all jobs have run!");
+}
+
+BOOST_AUTO_TEST_CASE(test_move_only_job) {
+  INIT_STDOUT_LOGGER();
+
+  ThreadPool pool(2, "TestPool");
+  atomic<int> value(0);
+
+  // Too large to be stored inline
+  unique_ptr<vector<int>> large(new vector<int>(1000, 1));
+  pool.AddJob([&value, large = move(large)]() {
+    value += static_cast<int>(large->size());
+  });
+
+  pool.WaitAll();
+  BOOST_CHECK_MESSAGE(value == 1000, "Move-only job did not run!");
+}
+
+BOOST_AUTO_TEST_CASE(test_submit) {
+  INIT_STDOUT_LOGGER();
+
+  ThreadPool pool(4, "TestPool");
+  vector<future<unsigned int>> results;
+
+  for (unsigned int i = 0; i < 100; ++i) {
+    results.emplace_back(pool.Submit([i]() { return i * i; }));
+  }
+
+  for (unsigned int i = 0; i < 100; ++i) {
+    BOOST_CHECK_MESSAGE(results[i].get() == i * i, "Wrong result " << i);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_priority) {
+  INIT_STDOUT_LOGGER();
+
+  ThreadPool pool(1, "TestPool");
+  mutex m;
+  vector<ThreadPool::Priority> order;
+
+  // Keep the only thread busy until all jobs are queued
+  promise<void> start;
+  shared_future<void> started = start.get_future().share();
+  pool.AddJob([started]() { started.wait(); });
+
+  for (unsigned int i = 0; i < 10; ++i) {
+    const ThreadPool::Priority priority =
+        (i % 2 == 0) ? ThreadPool::NORMAL : ThreadPool::HIGH;
+    pool.AddJob(
+        [&m, &order, priority]() {
+          lock_guard<mutex> g(m);
+          order.emplace_back(priority);
+        },
+        priority);
+  }
+
+  start.set_value();
+  pool.WaitAll();
+
+  BOOST_REQUIRE(order.size() == 10);
+  for (unsigned int i = 0; i < 10; ++i) {
+    BOOST_CHECK_MESSAGE(order[i] == (i < 5 ? ThreadPool::HIGH
+                                           : ThreadPool::NORMAL),
+                        "High priority job ran after a normal one!");
+  }
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_for) {
+  INIT_STDOUT_LOGGER();
+
+  ThreadPool pool(4, "TestPool");
+  vector<unsigned int> values(10000, 0);
+
+  pool.ParallelFor(0, values.size(), [&values](size_t i) { values[i] = i; });
+
+  for (unsigned int i = 0; i < values.size(); ++i) {
+    BOOST_CHECK_MESSAGE(values[i] == i, "Index " << i << " not visited!");
+  }
+
+  // Nested use from inside a job must not deadlock
+  atomic<unsigned int> count(0);
+  pool.Submit([&pool, &count]() {
+        pool.ParallelFor(0, 1000, [&count](size_t) { ++count; });
+      })
+      .get();
+  BOOST_CHECK_MESSAGE(count == 1000, "Nested ParallelFor incomplete!");
+}
+
+BOOST_AUTO_TEST_SUITE_END()